@@ -0,0 +1,225 @@
+/*
+ * accum.c - CS50 'accum' module
+ *
+ * The page table grows by doubling to the largest docID seen. A page is
+ * marked when a query first touches it and listed in touched; a list is
+ * walked page by page, since its docIDs are sorted, so a page is looked
+ * up once per run of docIDs in it, not once per posting. Four
+ * consecutive docIDs in a page are added with one SSE2 instruction.
+ *
+ * accum_scores sorts the touched pages and scans each for the scores
+ * that aren't 0, four at a time with SSE2, clearing the page as it goes;
+ * every document added has a score, since counts are positive.
+ *
+ * See accum.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mem.h"
+#include "accum.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ACCUM_SIMD 1
+#else
+#define ACCUM_SIMD 0
+#endif
+
+#define ACCUM_MASK (ACCUM_PAGE - 1)
+
+// the accumulator
+struct accum {
+  int** pages;            // numPages pages, NULL until first touched
+  unsigned char* marked;  // marked[p] if page p is in touched
+  int numPages;
+  int densePages;         // pages 0 .. densePages - 1 are in block
+  int* block;             // NULL until one of them is touched
+  int* touched;           // pages touched since the last accum_scores
+  int numTouched;
+  size_t bytes;           // of all pages
+};
+
+// Static function prototypes
+static int* touch(accum_t* accum, int page);
+static void growTable(accum_t* accum, int page);
+static int compareInts(const void* first, const void* second);
+
+/*********** accum_new ***********/
+/* see accum.h for more details */
+accum_t* accum_new(int denseDocs)
+{
+  accum_t* accum = mem_calloc_assert(1, sizeof(accum_t), "Couldn't allocate accumulator");
+  accum->densePages = denseDocs > 0 ? (int) (((int64_t) denseDocs + ACCUM_MASK) >> ACCUM_PAGE_BITS) : 0;
+  return accum;
+}
+
+/*********** accum_add ***********/
+/* see accum.h for more details */
+void accum_add(accum_t* accum, const postings_t* postings)
+{
+  if (accum == NULL || postings == NULL) {
+    return;
+  }
+  const int* ids = postings->ids;
+  const int* counts = postings->counts;
+  int size = postings->size;
+  int i = 0;
+  while (i < size) {
+    int page = ids[i] >> ACCUM_PAGE_BITS;
+    int* scores = touch(accum, page);
+    int pageEnd = (page + 1) << ACCUM_PAGE_BITS;
+    while (i < size && ids[i] < pageEnd) {
+#if ACCUM_SIMD
+      // ids are increasing, so a gap of 3 over four means consecutive,
+      // and the first at most ACCUM_PAGE - 4 keeps all four in the page
+      if (i + 4 <= size && ids[i + 3] - ids[i] == 3 && (ids[i] & ACCUM_MASK) <= ACCUM_PAGE - 4) {
+        __m128i* at = (__m128i*) (scores + (ids[i] & ACCUM_MASK));
+        _mm_storeu_si128(at, _mm_add_epi32(_mm_loadu_si128(at),
+                                           _mm_loadu_si128((const __m128i*) (counts + i))));
+        i += 4;
+        continue;
+      }
+#endif
+      scores[ids[i] & ACCUM_MASK] += counts[i];
+      i++;
+    }
+  }
+}
+
+/*********** accum_scores ***********/
+/* see accum.h for more details */
+void accum_scores(accum_t* accum, postings_t* scores)
+{
+  if (scores == NULL) {
+    return;
+  }
+  *scores = postings_view(NULL, NULL, 0);
+  if (accum == NULL || accum->numTouched == 0) {
+    return;
+  }
+  qsort(accum->touched, accum->numTouched, sizeof(int), compareInts);
+  postings_reserve(scores, ACCUM_PAGE);
+
+  for (int t = 0; t < accum->numTouched; t++) {
+    int page = accum->touched[t];
+    int* pageScores = accum->pages[page];
+    int first = page << ACCUM_PAGE_BITS;
+    if (scores->capacity - scores->size < ACCUM_PAGE) {
+      postings_reserve(scores, scores->capacity * 2);
+    }
+    int* ids = scores->ids;
+    int* counts = scores->counts;
+    int size = scores->size;
+    for (int at = 0; at < ACCUM_PAGE; at += 4) {
+#if ACCUM_SIMD
+      // skip four empty scores at once
+      __m128i four = _mm_loadu_si128((const __m128i*) (pageScores + at));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(four, _mm_setzero_si128())) == 0xffff) {
+        continue;
+      }
+#endif
+      for (int k = at; k < at + 4; k++) {
+        if (pageScores[k] != 0) {
+          ids[size] = first + k;
+          counts[size++] = pageScores[k];
+        }
+      }
+    }
+    scores->size = size;
+    memset(pageScores, 0, ACCUM_PAGE * sizeof(int));
+    accum->marked[page] = 0;
+  }
+  accum->numTouched = 0;
+}
+
+/*********** accum_memory ***********/
+/* see accum.h for more details */
+size_t accum_memory(accum_t* accum)
+{
+  return accum == NULL ? 0 : accum->bytes;
+}
+
+/*********** accum_delete ***********/
+/* see accum.h for more details */
+void accum_delete(accum_t* accum)
+{
+  if (accum == NULL) {
+    return;
+  }
+  for (int p = accum->densePages; p < accum->numPages; p++) {
+    free(accum->pages[p]);
+  }
+  free(accum->block);
+  free(accum->pages);
+  free(accum->marked);
+  free(accum->touched);
+  free(accum);
+}
+
+/*********** touch ***********/
+/* Returns the scores of a page, allocating it if it has none, and
+ * lists it as touched if this query hasn't yet
+ */
+static int* touch(accum_t* accum, int page)
+{
+  if (page >= accum->numPages) {
+    growTable(accum, page);
+  }
+  if (accum->pages[page] == NULL) {
+    if (page < accum->densePages) {
+      // the whole dense block at once, and every page of it
+      if (accum->block == NULL) {
+        accum->block = mem_calloc_assert((size_t) accum->densePages * ACCUM_PAGE, sizeof(int),
+                                         "Couldn't allocate accumulator");
+        accum->bytes += (size_t) accum->densePages * ACCUM_PAGE * sizeof(int);
+      }
+      for (int p = 0; p < accum->densePages && p < accum->numPages; p++) {
+        accum->pages[p] = accum->block + (size_t) p * ACCUM_PAGE;
+      }
+    } else {
+      accum->pages[page] = mem_calloc_assert(ACCUM_PAGE, sizeof(int), "Couldn't allocate accumulator");
+      accum->bytes += ACCUM_PAGE * sizeof(int);
+    }
+  }
+  if (!accum->marked[page]) {
+    accum->marked[page] = 1;
+    accum->touched[accum->numTouched++] = page;
+  }
+  return accum->pages[page];
+}
+
+/*********** growTable ***********/
+/* Grows the page table, and the touched list, to hold page */
+static void growTable(accum_t* accum, int page)
+{
+  int numPages = accum->numPages > 0 ? accum->numPages : 16;
+  while (numPages <= page) {
+    numPages *= 2;
+  }
+  accum->pages = realloc(accum->pages, numPages * sizeof(int*));
+  accum->marked = realloc(accum->marked, numPages);
+  accum->touched = realloc(accum->touched, numPages * sizeof(int));
+  mem_assert(accum->pages, "Couldn't allocate accumulator");
+  mem_assert(accum->marked, "Couldn't allocate accumulator");
+  mem_assert(accum->touched, "Couldn't allocate accumulator");
+  int old = accum->numPages;
+  memset(accum->pages + old, 0, (numPages - old) * sizeof(int*));
+  memset(accum->marked + old, 0, numPages - old);
+  // dense pages already in the block keep pointing into it
+  for (int p = old; accum->block != NULL && p < accum->densePages && p < numPages; p++) {
+    accum->pages[p] = accum->block + (size_t) p * ACCUM_PAGE;
+  }
+  accum->numPages = numPages;
+}
+
+/*********** compareInts ***********/
+/* qsort comparator ordering ints from lowest to highest */
+static int compareInts(const void* first, const void* second)
+{
+  int a = *(const int*) first;
+  int b = *(const int*) second;
+  return (a > b) - (a < b);
+}
@@ -0,0 +1,86 @@
+/*
+ * accum.h - header file for CS50 'accum' module
+ *
+ * This module accumulates the scores of an OR query: each and-sequence's
+ * postings are added into an array indexed by docID, with no lookup or
+ * allocation per document, and one pass at the end compacts the scores
+ * into a postings list sorted by docID.
+ *
+ * The array is kept in pages of ACCUM_PAGE docIDs. Pages below the
+ * accumulator's dense limit are slices of one contiguous block, made
+ * the first time any is needed; pages past it, for corpora too large
+ * to hold a score for every document, are each allocated the first time
+ * a query touches them. Only the pages a query touched are read and
+ * cleared when its scores are compacted, and every page is kept for the
+ * next query, so an accumulator is made once and reused.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __ACCUM_H
+#define __ACCUM_H
+
+#include <stdbool.h>
+#include "postings.h"
+
+// docIDs per page
+#define ACCUM_PAGE_BITS 12
+#define ACCUM_PAGE (1 << ACCUM_PAGE_BITS)
+
+// docIDs held in the dense block by default: 16MB of scores
+#define ACCUM_DENSE_DOCS (1 << 22)
+
+/********* Global Type ***********/
+typedef struct accum accum_t;
+
+/********** Functions ***********/
+
+/*********** accum_new ***********/
+/* Creates an empty accumulator
+ *
+ * Caller provides:
+ *   How many docIDs, from 0, to keep in the dense block (rounded up to
+ *   whole pages; 0 pages everything); usually the index's
+ *   largest docID + 1, at most ACCUM_DENSE_DOCS
+ * We return:
+ *   An accumulator with no scores; nothing is allocated for the scores
+ *   until they are added
+ * Caller is responsible for:
+ *   Later calling accum_delete
+ */
+accum_t* accum_new(int denseDocs);
+
+/*********** accum_add ***********/
+/* Adds each count of a postings list to its document's score
+ *
+ * Caller provides:
+ *   A valid accumulator and a list sorted by docID, counts > 0
+ * Notes:
+ *   Exits if memory can't be allocated.
+ */
+void accum_add(accum_t* accum, const postings_t* postings);
+
+/*********** accum_scores ***********/
+/* Compacts the scores added since the last call
+ *
+ * Caller provides:
+ *   A valid accumulator and a postings_t to fill in
+ * We return:
+ *   In *scores, an owning list of every document with a score, sorted
+ *   by docID, each counted by its score
+ * We guarantee:
+ *   The accumulator is left empty, ready for the next query
+ * Caller is responsible for:
+ *   Calling postings_release on *scores
+ */
+void accum_scores(accum_t* accum, postings_t* scores);
+
+/*********** accum_memory ***********/
+/* Returns the bytes the accumulator's pages take, 0 if accum is NULL */
+size_t accum_memory(accum_t* accum);
+
+/*********** accum_delete ***********/
+/* Deletes an accumulator and all its pages; does nothing if NULL */
+void accum_delete(accum_t* accum);
+
+#endif // __ACCUM_H
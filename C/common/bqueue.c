@@ -0,0 +1,182 @@
+/*
+ * bqueue.c - CS50 'bqueue' module
+ *
+ * A ring buffer guarded by one mutex, with one condition variable for
+ * "not full" and one for "not empty".
+ *
+ * See bqueue.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "mem.h"
+#include "clock.h"
+#include "bqueue.h"
+
+/**************** file-local types ****************/
+struct bqueue {
+  void** items;           // ring of capacity slots
+  int capacity;
+  int head;               // slot of the front item
+  int size;
+  bool closed;
+  pthread_mutex_t lock;
+  pthread_cond_t notFull;
+  pthread_cond_t notEmpty;
+  double fullWait;        // seconds spent blocked in push
+  double emptyWait;       // seconds spent blocked in pop
+};
+
+/*********** bqueue_new ***********/
+/* see bqueue.h for more details */
+bqueue_t* bqueue_new(int capacity)
+{
+  if (capacity < 1) {
+    return NULL;
+  }
+  bqueue_t* queue = mem_calloc_assert(1, sizeof(bqueue_t), "Couldn't allocate queue");
+  queue->items = mem_calloc_assert(capacity, sizeof(void*), "Couldn't allocate queue");
+  queue->capacity = capacity;
+  pthread_mutex_init(&queue->lock, NULL);
+  pthread_cond_init(&queue->notFull, NULL);
+  pthread_cond_init(&queue->notEmpty, NULL);
+  return queue;
+}
+
+/*********** bqueue_push ***********/
+/* see bqueue.h for more details */
+bool bqueue_push(bqueue_t* queue, void* item)
+{
+  if (queue == NULL || item == NULL) {
+    return false;
+  }
+  pthread_mutex_lock(&queue->lock);
+  if (queue->size == queue->capacity && !queue->closed) {
+    double start = clock_now();
+    while (queue->size == queue->capacity && !queue->closed) {
+      pthread_cond_wait(&queue->notFull, &queue->lock);
+    }
+    queue->fullWait += clock_now() - start;
+  }
+  bool pushed = !queue->closed;
+  if (pushed) {
+    queue->items[(queue->head + queue->size) % queue->capacity] = item;
+    queue->size++;
+    pthread_cond_signal(&queue->notEmpty);
+  }
+  pthread_mutex_unlock(&queue->lock);
+  return pushed;
+}
+
+/*********** bqueue_tryPush ***********/
+/* see bqueue.h for more details */
+bool bqueue_tryPush(bqueue_t* queue, void* item)
+{
+  if (queue == NULL || item == NULL) {
+    return false;
+  }
+  pthread_mutex_lock(&queue->lock);
+  bool pushed = !queue->closed && queue->size < queue->capacity;
+  if (pushed) {
+    queue->items[(queue->head + queue->size) % queue->capacity] = item;
+    queue->size++;
+    pthread_cond_signal(&queue->notEmpty);
+  }
+  pthread_mutex_unlock(&queue->lock);
+  return pushed;
+}
+
+/*********** bqueue_pop ***********/
+/* see bqueue.h for more details */
+void* bqueue_pop(bqueue_t* queue)
+{
+  if (queue == NULL) {
+    return NULL;
+  }
+  pthread_mutex_lock(&queue->lock);
+  if (queue->size == 0 && !queue->closed) {
+    double start = clock_now();
+    while (queue->size == 0 && !queue->closed) {
+      pthread_cond_wait(&queue->notEmpty, &queue->lock);
+    }
+    queue->emptyWait += clock_now() - start;
+  }
+  void* item = NULL;
+  if (queue->size > 0) {
+    item = queue->items[queue->head];
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->size--;
+    pthread_cond_signal(&queue->notFull);
+  }
+  pthread_mutex_unlock(&queue->lock);
+  return item;
+}
+
+/*********** bqueue_tryPop ***********/
+/* see bqueue.h for more details */
+void* bqueue_tryPop(bqueue_t* queue)
+{
+  if (queue == NULL) {
+    return NULL;
+  }
+  pthread_mutex_lock(&queue->lock);
+  void* item = NULL;
+  if (queue->size > 0) {
+    item = queue->items[queue->head];
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->size--;
+    pthread_cond_signal(&queue->notFull);
+  }
+  pthread_mutex_unlock(&queue->lock);
+  return item;
+}
+
+/*********** bqueue_close ***********/
+/* see bqueue.h for more details */
+void bqueue_close(bqueue_t* queue)
+{
+  if (queue != NULL) {
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = true;
+    pthread_cond_broadcast(&queue->notFull);
+    pthread_cond_broadcast(&queue->notEmpty);
+    pthread_mutex_unlock(&queue->lock);
+  }
+}
+
+/*********** bqueue_waits ***********/
+/* see bqueue.h for more details */
+void bqueue_waits(bqueue_t* queue, double* fullWait, double* emptyWait)
+{
+  if (queue == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&queue->lock);
+  if (fullWait != NULL) {
+    *fullWait = queue->fullWait;
+  }
+  if (emptyWait != NULL) {
+    *emptyWait = queue->emptyWait;
+  }
+  pthread_mutex_unlock(&queue->lock);
+}
+
+/*********** bqueue_delete ***********/
+/* see bqueue.h for more details */
+void bqueue_delete(bqueue_t* queue, void (*itemdelete)(void* item))
+{
+  if (queue != NULL) {
+    for (int i = 0; itemdelete != NULL && i < queue->size; i++) {
+      itemdelete(queue->items[(queue->head + i) % queue->capacity]);
+    }
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->notFull);
+    pthread_cond_destroy(&queue->notEmpty);
+    free(queue->items);
+    free(queue);
+  }
+}
@@ -0,0 +1,84 @@
+/*
+ * bqueue.h - header file for CS50 'bqueue' module
+ *
+ * A *bqueue* is a bounded, thread-safe FIFO queue of pointers for passing
+ * work between threads. Pushing onto a full queue blocks until there is
+ * room and popping from an empty queue blocks until an item arrives, so
+ * a fast producer can run at most capacity items ahead of its consumer.
+ * Once the producers are done they close the queue; consumers then drain
+ * what is left and see NULL.
+ *
+ * The queue keeps the time threads spent blocked on it, which shows
+ * which side of it is the bottleneck.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __BQUEUE_H
+#define __BQUEUE_H
+
+#include <stdbool.h>
+
+/********* Global Type ***********/
+typedef struct bqueue bqueue_t;
+
+/********** Functions ***********/
+
+/*********** bqueue_new ***********/
+/* Creates an empty queue holding at most capacity items
+ *
+ * We return:
+ *   A new queue, or NULL if capacity < 1
+ * Caller is responsible for:
+ *   Later calling bqueue_delete
+ */
+bqueue_t* bqueue_new(int capacity);
+
+/*********** bqueue_push ***********/
+/* Adds item at the back, waiting while the queue is full
+ *
+ * We return:
+ *   true once item is queued; false if queue or item is NULL or the
+ *   queue is closed (the item then still belongs to the caller)
+ */
+bool bqueue_push(bqueue_t* queue, void* item);
+
+/*********** bqueue_tryPush ***********/
+/* Adds item at the back if there is room, without waiting; returns
+ * false if the queue is full or closed (the item is still the caller's)
+ */
+bool bqueue_tryPush(bqueue_t* queue, void* item);
+
+/*********** bqueue_pop ***********/
+/* Removes the item at the front, waiting while the queue is empty
+ *
+ * We return:
+ *   The item, or NULL once the queue is closed and empty
+ */
+void* bqueue_pop(bqueue_t* queue);
+
+/*********** bqueue_tryPop ***********/
+/* Removes the item at the front if there is one, without waiting;
+ * returns NULL if the queue is empty
+ */
+void* bqueue_tryPop(bqueue_t* queue);
+
+/*********** bqueue_close ***********/
+/* Marks the queue closed: later pushes fail, and waiting consumers
+ * wake up and see NULL once the queue is empty
+ */
+void bqueue_close(bqueue_t* queue);
+
+/*********** bqueue_waits ***********/
+/* Reports the total seconds threads have spent waiting to push onto a
+ * full queue (*fullWait) and to pop from an empty one (*emptyWait)
+ */
+void bqueue_waits(bqueue_t* queue, double* fullWait, double* emptyWait);
+
+/*********** bqueue_delete ***********/
+/* Deletes the queue, calling itemdelete (if not NULL) on each item
+ * still in it. No thread may be using the queue.
+ */
+void bqueue_delete(bqueue_t* queue, void (*itemdelete)(void* item));
+
+#endif // __BQUEUE_H
@@ -0,0 +1,23 @@
+/*
+ * clock.c - CS50 'clock' module
+ *
+ * Reads CLOCK_MONOTONIC, which no change to the wall clock moves.
+ *
+ * See clock.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include "clock.h"
+
+/*********** clock_now ***********/
+/* see clock.h for more details */
+double clock_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,21 @@
+/*
+ * clock.h - header file for CS50 'clock' module
+ *
+ * The one clock every timing in the indexer, the querier and their
+ * benchmarks is read from, so their times can be compared.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __CLOCK_H
+#define __CLOCK_H
+
+/********** Functions ***********/
+
+/*********** clock_now ***********/
+/* Returns the monotonic time in seconds, from an arbitrary start; only
+ * differences between two readings mean anything
+ */
+double clock_now(void);
+
+#endif // __CLOCK_H
@@ -0,0 +1,209 @@
+/*
+ * codec.c - CS50 'codec' module
+ *
+ * Varint docID deltas plus bit-packed counts, in blocks of CODEC_BLOCK.
+ * Varints are little-endian base-128: seven bits per byte, with the
+ * high bit set on every byte except the last. Word positions are plain
+ * varint gaps.
+ *
+ * See codec.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "codec.h"
+
+// Static function prototypes
+static unsigned char* putVarint(unsigned char* out, uint32_t value);
+static int bitWidth(uint32_t value);
+
+/*********** codec_maxBytes ***********/
+/* see codec.h for more details */
+size_t codec_maxBytes(int size)
+{
+  if (size <= 0) {
+    return 0;
+  }
+  size_t blocks = (size + CODEC_BLOCK - 1) / CODEC_BLOCK;
+  // per block a width byte; per posting a 5-byte varint and a 4-byte count
+  return blocks + (size_t) size * 9;
+}
+
+/*********** codec_encode ***********/
+/* see codec.h for more details */
+size_t codec_encode(const int* ids, const int* counts, int size, unsigned char* out)
+{
+  unsigned char* pos = out;
+  uint32_t previous = 0;
+
+  for (int start = 0; start < size; start += CODEC_BLOCK) {
+    int n = size - start < CODEC_BLOCK ? size - start : CODEC_BLOCK;
+
+    // the block's counts are packed at the width of its largest count
+    uint32_t largest = 0;
+    for (int i = 0; i < n; i++) {
+      largest |= (uint32_t) counts[start + i];
+    }
+    int width = bitWidth(largest);
+    *pos++ = width;
+
+    // docIDs as deltas from the previous one
+    for (int i = 0; i < n; i++) {
+      pos = putVarint(pos, (uint32_t) ids[start + i] - previous);
+      previous = ids[start + i];
+    }
+
+    // counts packed LSB first into a running 64-bit accumulator
+    uint64_t bits = 0;
+    int used = 0;
+    for (int i = 0; i < n; i++) {
+      bits |= (uint64_t) (uint32_t) counts[start + i] << used;
+      used += width;
+      while (used >= 8) {
+        *pos++ = bits & 0xff;
+        bits >>= 8;
+        used -= 8;
+      }
+    }
+    if (used > 0) {
+      *pos++ = bits & 0xff;
+    }
+  }
+  return pos - out;
+}
+
+/*********** codec_decode ***********/
+/* see codec.h for more details */
+bool codec_decode(const unsigned char* in, size_t length, int size, int* ids, int* counts)
+{
+  const unsigned char* pos = in;
+  const unsigned char* end = in + length;
+  uint32_t previous = 0;
+
+  for (int start = 0; start < size; start += CODEC_BLOCK) {
+    int n = size - start < CODEC_BLOCK ? size - start : CODEC_BLOCK;
+    if (pos >= end) {
+      return false;
+    }
+    int width = *pos++;
+    if (width > 32) {
+      return false;
+    }
+
+    // docID deltas
+    for (int i = 0; i < n; i++) {
+      uint32_t delta = 0;
+      int shift = 0;
+      unsigned char byte;
+      do {
+        if (pos >= end || shift > 28) {
+          return false;
+        }
+        byte = *pos++;
+        delta |= (uint32_t) (byte & 0x7f) << shift;
+        shift += 7;
+      } while (byte & 0x80);
+      previous += delta;
+      ids[start + i] = previous;
+    }
+
+    // packed counts
+    size_t packed = ((size_t) n * width + 7) / 8;
+    if ((size_t) (end - pos) < packed) {
+      return false;
+    }
+    if (width == 0) {
+      memset(counts + start, 0, n * sizeof(int));
+      continue;
+    }
+    uint64_t bits = 0;
+    int have = 0;
+    uint64_t mask = width == 32 ? 0xffffffffu : ((uint64_t) 1 << width) - 1;
+    for (int i = 0; i < n; i++) {
+      while (have < width) {
+        bits |= (uint64_t) *pos++ << have;
+        have += 8;
+      }
+      counts[start + i] = bits & mask;
+      bits >>= width;
+      have -= width;
+    }
+  }
+  return pos == end;
+}
+
+/*********** codec_maxPositionBytes ***********/
+/* see codec.h for more details */
+size_t codec_maxPositionBytes(int count)
+{
+  return count <= 0 ? 0 : (size_t) count * 5;
+}
+
+/*********** codec_encodePositions ***********/
+/* see codec.h for more details */
+size_t codec_encodePositions(const int* positions, int count, unsigned char* out)
+{
+  unsigned char* pos = out;
+  uint32_t previous = 0;
+  for (int i = 0; i < count; i++) {
+    pos = putVarint(pos, (uint32_t) positions[i] - previous);
+    previous = positions[i];
+  }
+  return pos - out;
+}
+
+/*********** codec_decodePositions ***********/
+/* see codec.h for more details */
+size_t codec_decodePositions(const unsigned char* in, size_t length, int count, int* positions)
+{
+  if (count <= 0) {
+    return 0;
+  }
+  const unsigned char* pos = in;
+  const unsigned char* end = in + length;
+  uint32_t previous = 0;
+  for (int i = 0; i < count; i++) {
+    uint32_t gap = 0;
+    int shift = 0;
+    unsigned char byte;
+    do {
+      if (pos >= end || shift > 28) {
+        return 0;
+      }
+      byte = *pos++;
+      gap |= (uint32_t) (byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    previous += gap;
+    if (positions != NULL) {
+      positions[i] = previous;
+    }
+  }
+  return pos - in;
+}
+
+/*********** putVarint ***********/
+/* Writes value as a varint and returns the position after it */
+static unsigned char* putVarint(unsigned char* out, uint32_t value)
+{
+  while (value >= 0x80) {
+    *out++ = (value & 0x7f) | 0x80;
+    value >>= 7;
+  }
+  *out++ = value;
+  return out;
+}
+
+/*********** bitWidth ***********/
+/* Number of bits needed to hold value (0 for 0) */
+static int bitWidth(uint32_t value)
+{
+  int width = 0;
+  while (value != 0) {
+    width++;
+    value >>= 1;
+  }
+  return width;
+}
@@ -0,0 +1,85 @@
+/*
+ * codec.h - header file for CS50 'codec' module
+ *
+ * This module compresses postings lists. Postings are cut into blocks
+ * of CODEC_BLOCK pairs. Within a block, docIDs are stored as varint
+ * deltas from the previous docID, followed by the block's counts
+ * bit-packed at the width of the block's largest count:
+ *
+ *   block := width:byte  delta:varint * n  packed counts:ceil(n*width/8) bytes
+ *
+ * Decoding is a single forward pass with no allocation, fast enough to
+ * run on every query term.
+ *
+ * The word positions of one posting are coded separately, as varints:
+ * the first position, then the gap to each following one.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __CODEC_H
+#define __CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// number of postings per block
+#define CODEC_BLOCK 128
+
+/********** Functions ***********/
+
+/*********** codec_maxBytes ***********/
+/* Returns the most bytes codec_encode can write for size postings */
+size_t codec_maxBytes(int size);
+
+/*********** codec_encode ***********/
+/* Compresses a postings list
+ *
+ * Caller provides:
+ *   size docIDs in strictly increasing order, their non-negative counts,
+ *   and an output buffer of at least codec_maxBytes(size) bytes
+ * We return:
+ *   The number of bytes written to out
+ */
+size_t codec_encode(const int* ids, const int* counts, int size, unsigned char* out);
+
+/*********** codec_decode ***********/
+/* Decompresses a postings list written by codec_encode
+ *
+ * Caller provides:
+ *   The encoded bytes and their length, the number of postings
+ *   they hold, and arrays with room for size ids and counts
+ * We return:
+ *   true if exactly size postings were decoded from length bytes,
+ *   false if the input is truncated or malformed
+ */
+bool codec_decode(const unsigned char* in, size_t length, int size, int* ids, int* counts);
+
+/*********** codec_maxPositionBytes ***********/
+/* Returns the most bytes codec_encodePositions can write for count positions */
+size_t codec_maxPositionBytes(int count);
+
+/*********** codec_encodePositions ***********/
+/* Codes the word positions of one posting
+ *
+ * Caller provides:
+ *   count non-negative positions in strictly increasing order, and an
+ *   output buffer of at least codec_maxPositionBytes(count) bytes
+ * We return:
+ *   The number of bytes written to out
+ */
+size_t codec_encodePositions(const int* positions, int count, unsigned char* out);
+
+/*********** codec_decodePositions ***********/
+/* Decodes count positions written by codec_encodePositions
+ *
+ * Caller provides:
+ *   The coded bytes and how many may be read, the number of positions,
+ *   and an array with room for them (may be NULL to only measure)
+ * We return:
+ *   The number of bytes the positions took, or 0 if count is not
+ *   positive or the input is truncated or malformed
+ */
+size_t codec_decodePositions(const unsigned char* in, size_t length, int count, int* positions);
+
+#endif // __CODEC_H
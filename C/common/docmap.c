@@ -0,0 +1,323 @@
+/*
+ * docmap.c - CS50 'docmap' module
+ *
+ * The writer streams each URL to a temporary file as it is added and
+ * keeps only the entries, 8 bytes a page, in memory; closing pads the
+ * URLs to an 8-byte boundary, appends the entries, writes the header
+ * last and renames the file into place. Opening maps the file read-only
+ * and checks that the entries lie inside it and the URLs end with a
+ * NUL, so a lookup only has to check its docID and URL offset.
+ *
+ * See docmap.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mem.h"
+#include "file.h"
+#include "docmap.h"
+
+/**************** file-local constants ****************/
+static const char MAGIC[8] = { 'T', 'S', 'E', 'D', 'O', 'C', 'M', 'P' };
+static const uint32_t VERSION = 1;
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const char* FILENAME = ".docmap";
+static const char* TEMP_SUFFIX = ".tmp";
+
+// URL offset of a docID with no page
+#define NO_URL UINT32_MAX
+
+/**************** file-local types ****************/
+// fixed header at offset 0; the URLs follow it
+typedef struct fileHeader {
+  char magic[8];          // MAGIC
+  uint32_t version;       // format version that wrote the file
+  uint32_t byteOrder;     // BYTE_ORDER_MARK in the writer's byte order
+  uint32_t numEntries;    // entries, for docIDs 0 .. numEntries - 1
+  uint32_t reserved;
+  uint64_t entries;       // byte offset of the entries from file start
+} fileHeader_t;
+
+// one page
+typedef struct fileEntry {
+  uint32_t url;           // offset of the URL from the end of the header, or NO_URL
+  int32_t depth;
+} fileEntry_t;
+
+// a mapped manifest
+struct docmap {
+  void* map;              // start of the mapping
+  size_t mapSize;         // length of the mapping
+  const char* urls;
+  uint64_t urlsLength;
+  const fileEntry_t* entries;
+  uint32_t numEntries;
+};
+
+// a manifest being written
+struct docmap_writer {
+  char* path;             // pageDirectory/.docmap
+  char* tempPath;         // where it is written until closed
+  FILE* fp;
+  uint64_t urlsLength;    // bytes of URLs written
+  fileEntry_t* entries;   // by docID
+  uint32_t numEntries;
+  uint32_t capacity;
+  bool ok;                // false once anything failed
+};
+
+// Static function prototypes
+static char* dirPath(const char* pageDirectory, const char* name, const char* suffix);
+static bool growEntries(docmap_writer_t* writer, uint32_t numEntries);
+
+/*********** docmap_open ***********/
+/* see docmap.h for more details */
+docmap_t* docmap_open(const char* pageDirectory)
+{
+  if (pageDirectory == NULL) {
+    return NULL;
+  }
+  char* path = dirPath(pageDirectory, FILENAME, "");
+  int fd = open(path, O_RDONLY);
+  free(path);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(fileHeader_t)) {
+    close(fd);
+    return NULL;
+  }
+  size_t size = info.st_size;
+  void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);     // the mapping keeps the file alive
+  if (map == MAP_FAILED) {
+    return NULL;
+  }
+
+  // the entries must lie inside the file, after URLs that end with a NUL
+  const fileHeader_t* header = map;
+  uint64_t urlsLength = header->entries - sizeof(fileHeader_t);
+  if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0
+      || header->byteOrder != BYTE_ORDER_MARK
+      || header->version == 0 || header->version > VERSION
+      || header->entries % 8 != 0 || header->entries < sizeof(fileHeader_t) || header->entries > size
+      || (uint64_t) header->numEntries * sizeof(fileEntry_t) > size - header->entries
+      || (urlsLength > 0 && memchr((const char*) map + sizeof(fileHeader_t), '\0', urlsLength) == NULL)) {
+    munmap(map, size);
+    return NULL;
+  }
+  const char* urls = (const char*) map + sizeof(fileHeader_t);
+  while (urlsLength > 0 && urls[urlsLength - 1] != '\0') {
+    urlsLength--;          // padding past the last NUL is no URL's
+  }
+
+  docmap_t* docs = mem_calloc_assert(1, sizeof(docmap_t), "Couldn't allocate docmap");
+  docs->map = map;
+  docs->mapSize = size;
+  docs->urls = urls;
+  docs->urlsLength = urlsLength;
+  docs->entries = (const fileEntry_t*) ((const char*) map + header->entries);
+  docs->numEntries = header->numEntries;
+  return docs;
+}
+
+/*********** docmap_numDocs ***********/
+/* see docmap.h for more details */
+int docmap_numDocs(docmap_t* docs)
+{
+  return docs == NULL || docs->numEntries == 0 ? 0 : (int) docs->numEntries - 1;
+}
+
+/*********** docmap_url ***********/
+/* see docmap.h for more details */
+const char* docmap_url(docmap_t* docs, int docID)
+{
+  if (docs == NULL || docID < 1 || (uint32_t) docID >= docs->numEntries) {
+    return NULL;
+  }
+  uint32_t url = docs->entries[docID].url;
+  return url < docs->urlsLength ? docs->urls + url : NULL;
+}
+
+/*********** docmap_depth ***********/
+/* see docmap.h for more details */
+int docmap_depth(docmap_t* docs, int docID)
+{
+  return docmap_url(docs, docID) == NULL ? -1 : docs->entries[docID].depth;
+}
+
+/*********** docmap_close ***********/
+/* see docmap.h for more details */
+void docmap_close(docmap_t* docs)
+{
+  if (docs != NULL) {
+    munmap(docs->map, docs->mapSize);
+    free(docs);
+  }
+}
+
+/*********** docmap_writerNew ***********/
+/* see docmap.h for more details */
+docmap_writer_t* docmap_writerNew(const char* pageDirectory)
+{
+  if (pageDirectory == NULL) {
+    return NULL;
+  }
+  docmap_writer_t* writer = mem_calloc_assert(1, sizeof(docmap_writer_t), "Couldn't allocate docmap writer");
+  writer->path = dirPath(pageDirectory, FILENAME, "");
+  writer->tempPath = dirPath(pageDirectory, FILENAME, TEMP_SUFFIX);
+
+  // room for the header, written for real on close
+  fileHeader_t header = { .magic = { 0 }, .version = 0, .numEntries = 0, .entries = 0 };
+  if ((writer->fp = fopen(writer->tempPath, "w")) == NULL
+      || fwrite(&header, sizeof(header), 1, writer->fp) != 1) {
+    if (writer->fp != NULL) {
+      fclose(writer->fp);
+      unlink(writer->tempPath);
+    }
+    free(writer->path);
+    free(writer->tempPath);
+    free(writer);
+    return NULL;
+  }
+  writer->ok = true;
+  return writer;
+}
+
+/*********** docmap_writerAdd ***********/
+/* see docmap.h for more details */
+bool docmap_writerAdd(docmap_writer_t* writer, int docID, const char* URL, int depth)
+{
+  if (writer == NULL || URL == NULL || docID < 1 || !writer->ok) {
+    return false;
+  }
+  size_t length = strlen(URL) + 1;
+  if (writer->urlsLength + length >= NO_URL || !growEntries(writer, (uint32_t) docID + 1)) {
+    writer->ok = false;
+    return false;
+  }
+  if (fwrite(URL, 1, length, writer->fp) != length) {
+    writer->ok = false;
+    return false;
+  }
+  writer->entries[docID].url = (uint32_t) writer->urlsLength;
+  writer->entries[docID].depth = depth;
+  writer->urlsLength += length;
+  return true;
+}
+
+/*********** docmap_writerClose ***********/
+/* see docmap.h for more details */
+bool docmap_writerClose(docmap_writer_t* writer)
+{
+  if (writer == NULL) {
+    return false;
+  }
+  // pad the URLs so the entries start on an 8-byte boundary
+  static const char zeros[8] = { 0 };
+  fileHeader_t header = { .version = VERSION, .byteOrder = BYTE_ORDER_MARK,
+                          .numEntries = writer->numEntries };
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  uint64_t end = sizeof(fileHeader_t) + writer->urlsLength;
+  header.entries = (end + 7) & ~(uint64_t) 7;
+  size_t padding = header.entries - end;
+  bool ok = writer->ok
+            && fwrite(zeros, 1, padding, writer->fp) == padding
+            && (writer->numEntries == 0
+                || fwrite(writer->entries, sizeof(fileEntry_t), writer->numEntries, writer->fp) == writer->numEntries)
+            && fseek(writer->fp, 0, SEEK_SET) == 0
+            && fwrite(&header, sizeof(header), 1, writer->fp) == 1;
+  if (fclose(writer->fp) != 0) {
+    ok = false;
+  }
+  if (!ok || rename(writer->tempPath, writer->path) != 0) {
+    unlink(writer->tempPath);
+    ok = false;
+  }
+  free(writer->entries);
+  free(writer->path);
+  free(writer->tempPath);
+  free(writer);
+  return ok;
+}
+
+/*********** docmap_build ***********/
+/* see docmap.h for more details */
+bool docmap_build(const char* pageDirectory)
+{
+  docmap_writer_t* writer = docmap_writerNew(pageDirectory);
+  if (writer == NULL) {
+    return false;
+  }
+  bool ok = true;
+  for (int id = 1; ok; id++) {
+    char name[16];
+    sprintf(name, "%d", id);
+    char* path = dirPath(pageDirectory, name, "");
+    FILE* fp = fopen(path, "r");
+    free(path);
+    if (fp == NULL) {
+      break;                      // the crawl ends at the first missing page
+    }
+    // URL on the first line, depth on the second, as pagedir_save wrote them
+    char* URL = file_readLine(fp);
+    int depth;
+    if (URL == NULL || fscanf(fp, "%d", &depth) != 1) {
+      depth = -1;
+    }
+    ok = URL == NULL || docmap_writerAdd(writer, id, URL, depth);
+    free(URL);
+    fclose(fp);
+  }
+  return docmap_writerClose(writer) && ok;
+}
+
+/*********** dirPath ***********/
+/* Returns a new string pageDirectory/name suffix; caller frees it */
+static char* dirPath(const char* pageDirectory, const char* name, const char* suffix)
+{
+  size_t size = strlen(pageDirectory) + strlen(name) + strlen(suffix) + 2;
+  char* path = mem_malloc_assert(size, "Couldn't allocate path");
+  snprintf(path, size, "%s/%s%s", pageDirectory, name, suffix);
+  return path;
+}
+
+/*********** growEntries ***********/
+/* Makes room for numEntries entries, marking new ones as having no URL;
+ * returns false if a docID that large can't be held
+ */
+static bool growEntries(docmap_writer_t* writer, uint32_t numEntries)
+{
+  if (numEntries <= writer->numEntries) {
+    return true;
+  }
+  if (numEntries > writer->capacity) {
+    uint32_t capacity = writer->capacity > 0 ? writer->capacity : 256;
+    while (capacity < numEntries) {
+      if (capacity > UINT32_MAX / 2) {
+        return false;
+      }
+      capacity *= 2;
+    }
+    writer->entries = realloc(writer->entries, (size_t) capacity * sizeof(fileEntry_t));
+    mem_assert(writer->entries, "Couldn't grow docmap");
+    writer->capacity = capacity;
+  }
+  for (uint32_t i = writer->numEntries; i < numEntries; i++) {
+    writer->entries[i].url = NO_URL;
+    writer->entries[i].depth = -1;
+  }
+  writer->numEntries = numEntries;
+  return true;
+}
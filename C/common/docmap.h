@@ -0,0 +1,124 @@
+/*
+ * docmap.h - header file for CS50 'docmap' module
+ *
+ * A *docmap* is a crawl's manifest: the URL and depth of every page,
+ * by docID, kept in one file, pageDirectory/.docmap, so that finding a
+ * page's URL takes an array access into a mapping instead of opening
+ * the page. The crawler writes it as it saves pages; the indexer writes
+ * one for a crawl that has none (see docmap_build).
+ *
+ * The file is
+ *
+ *   header | URLs | entries
+ *
+ * where the URLs are NUL-terminated and back to back, and the entries
+ * are indexed by docID, each giving the offset of its URL and its
+ * depth. Like an indexfile (see indexfile.h), numbers are in the
+ * writer's byte order and a file in the other byte order is rejected.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __DOCMAP_H
+#define __DOCMAP_H
+
+#include <stdbool.h>
+
+/********* Global Types ***********/
+typedef struct docmap docmap_t;
+typedef struct docmap_writer docmap_writer_t;
+
+/********** Functions ***********/
+
+/*********** docmap_open ***********/
+/* Maps the manifest of a page directory
+ *
+ * Caller provides:
+ *   The page directory
+ * We return:
+ *   The mapped manifest, or NULL if the directory has none, or it can't
+ *   be read or isn't a valid manifest
+ * Caller is responsible for:
+ *   Later calling docmap_close
+ */
+docmap_t* docmap_open(const char* pageDirectory);
+
+/*********** docmap_numDocs ***********/
+/* Returns the largest docID the manifest has room for, 0 if docs is NULL */
+int docmap_numDocs(docmap_t* docs);
+
+/*********** docmap_url ***********/
+/* Returns the URL of a page
+ *
+ * We return:
+ *   The URL, pointing into the mapping, or NULL if docs is NULL or the
+ *   manifest has no page docID
+ * Notes:
+ *   The URL is valid until docmap_close, and must not be freed.
+ */
+const char* docmap_url(docmap_t* docs, int docID);
+
+/*********** docmap_depth ***********/
+/* Returns the depth of a page, or -1 if docmap_url would return NULL */
+int docmap_depth(docmap_t* docs, int docID);
+
+/*********** docmap_close ***********/
+/* Unmaps a manifest; does nothing if docs is NULL */
+void docmap_close(docmap_t* docs);
+
+/*********** docmap_writerNew ***********/
+/* Starts writing the manifest of a page directory
+ *
+ * Caller provides:
+ *   The page directory
+ * We return:
+ *   A writer, or NULL if the manifest can't be written
+ * We guarantee:
+ *   The new manifest is written to a temporary file and renamed over any
+ *   old one once complete, so a querier loading the directory meanwhile
+ *   still finds the old one; a writer that stops before
+ *   docmap_writerClose leaves the old one as it was.
+ * Caller is responsible for:
+ *   Later calling docmap_writerClose
+ */
+docmap_writer_t* docmap_writerNew(const char* pageDirectory);
+
+/*********** docmap_writerAdd ***********/
+/* Records the URL and depth of page docID
+ *
+ * Caller provides:
+ *   A writer, a docID > 0 not yet added, the page's URL and its depth
+ * We return:
+ *   False if writer or URL is NULL, docID < 1, or the URL can't be
+ *   written; true otherwise
+ * Notes:
+ *   Pages may be added in any order; docIDs never added have no URL.
+ */
+bool docmap_writerAdd(docmap_writer_t* writer, int docID, const char* URL, int depth);
+
+/*********** docmap_writerClose ***********/
+/* Finishes the manifest and frees the writer
+ *
+ * We return:
+ *   True if the manifest was written completely; otherwise false, and
+ *   the directory is left with no manifest
+ */
+bool docmap_writerClose(docmap_writer_t* writer);
+
+/*********** docmap_build ***********/
+/* Writes a manifest from the pages of a crawl
+ *
+ * Caller provides:
+ *   The page directory of a crawl
+ * We do:
+ *   Read the URL and depth from the first two lines of every page, from
+ *   docID 1 to the first missing page, and write them as its manifest
+ * We return:
+ *   True if the manifest was written
+ * Notes:
+ *   For crawls made before the crawler wrote manifests; the rest of each
+ *   page is never read.
+ */
+bool docmap_build(const char* pageDirectory);
+
+#endif // __DOCMAP_H
@@ -0,0 +1,261 @@
+/*
+ * docterms.c - CS50 'docterms' module
+ *
+ * This module implements the per-document word counter used by the
+ * indexer. It is a small linear-probing table whose slots cache each
+ * word's hash and count inline, with the word text packed into a single
+ * reusable character buffer. A list of used slots records first-occurrence
+ * order, lets iteration skip empty slots and lets a clear touch only the
+ * slots that were filled. A table that keeps positions also has an
+ * occurrence log of entry numbers, one per word added, which is bucketed
+ * by entry to produce each word's positions.
+ *
+ * See docterms.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "mem.h"
+#include "hash.h"
+#include "docterms.h"
+
+// a new table starts with this many slots, and grows by doubling
+static const int INITIAL_SLOTS = 1024;
+
+// one slot of the table
+typedef struct docterm {
+  unsigned long hash;    // hash of the word; 0 marks an empty slot
+  int offset;            // where the word starts in the text buffer
+  int count;             // occurrences of the word in this document
+  int entry;             // index of the slot in used
+} docterm_t;
+
+// table structure definition
+struct docterms {
+  docterm_t* slots;      // open-addressing table
+  int capacity;          // number of slots, a power of two
+  int* used;             // slot numbers in first-occurrence order
+  int size;              // number of entries in used
+  char* text;            // packed, null terminated words
+  int textUsed;          // bytes of text in use
+  int textCapacity;      // bytes allocated for text
+  int* log;              // entry of every word added, in order, or NULL
+  int logSize;
+  int logCapacity;
+  int* starts;           // scratch for docterms_iteratePositions,
+  int* positions;        // sized to the slots and the log
+};
+
+// Static function prototypes
+static unsigned long wordHash(const char* word);
+static int findSlot(docterms_t* dt, const char* word, unsigned long hash);
+static void grow(docterms_t* dt);
+static int copyWord(docterms_t* dt, const char* word);
+
+/*********** docterms_new ***********/
+/* see docterms.h for more details */
+docterms_t* docterms_new(bool positions)
+{
+  docterms_t* dt = mem_calloc_assert(1, sizeof(docterms_t), "Couldn't allocate docterms");
+  dt->capacity = INITIAL_SLOTS;
+  dt->slots = mem_calloc_assert(dt->capacity, sizeof(docterm_t), "Couldn't allocate docterms slots");
+  // the table never holds more than 3/4 capacity entries
+  dt->used = mem_malloc_assert(dt->capacity * sizeof(int), "Couldn't allocate docterms list");
+  dt->textCapacity = INITIAL_SLOTS * 8;
+  dt->text = mem_malloc_assert(dt->textCapacity, "Couldn't allocate docterms text");
+  if (positions) {
+    dt->logCapacity = INITIAL_SLOTS * 4;
+    dt->log = mem_malloc_assert(dt->logCapacity * sizeof(int), "Couldn't allocate docterms log");
+  }
+  return dt;
+}
+
+/*********** docterms_add ***********/
+/* see docterms.h for more details */
+int docterms_add(docterms_t* dt, const char* word)
+{
+  if (dt == NULL || word == NULL) {
+    return 0;
+  }
+  unsigned long hash = wordHash(word);
+  int pos = findSlot(dt, word, hash);
+  if (dt->log != NULL && dt->logSize == dt->logCapacity) {
+    dt->logCapacity *= 2;
+    dt->log = realloc(dt->log, dt->logCapacity * sizeof(int));
+    mem_assert(dt->log, "Couldn't grow docterms log");
+  }
+
+  // seen before: just bump its count
+  if (dt->slots[pos].hash != 0) {
+    if (dt->log != NULL) {
+      dt->log[dt->logSize++] = dt->slots[pos].entry;
+    }
+    return ++dt->slots[pos].count;
+  }
+
+  // new word: grow first if that would pass 3/4 full
+  if ((dt->size + 1) * 4 > dt->capacity * 3) {
+    grow(dt);
+    pos = findSlot(dt, word, hash);
+  }
+  dt->slots[pos].hash = hash;
+  dt->slots[pos].offset = copyWord(dt, word);
+  dt->slots[pos].count = 1;
+  dt->slots[pos].entry = dt->size;
+  if (dt->log != NULL) {
+    dt->log[dt->logSize++] = dt->size;
+  }
+  dt->used[dt->size++] = pos;
+  return 1;
+}
+
+/*********** docterms_size ***********/
+/* see docterms.h for more details */
+int docterms_size(docterms_t* dt)
+{
+  return dt == NULL ? 0 : dt->size;
+}
+
+/*********** docterms_iterate ***********/
+/* see docterms.h for more details */
+void docterms_iterate(docterms_t* dt, void* arg,
+                      void (*itemfunc)(void* arg, const char* word, int count))
+{
+  if (dt == NULL || itemfunc == NULL) {
+    return;
+  }
+  for (int i = 0; i < dt->size; i++) {
+    docterm_t* slot = &dt->slots[dt->used[i]];
+    itemfunc(arg, dt->text + slot->offset, slot->count);
+  }
+}
+
+/*********** docterms_iteratePositions ***********/
+/* see docterms.h for more details */
+void docterms_iteratePositions(docterms_t* dt, void* arg,
+                               void (*itemfunc)(void* arg, const char* word,
+                                                const int* positions, int count))
+{
+  if (dt == NULL || itemfunc == NULL || dt->log == NULL) {
+    return;
+  }
+  // scratch sized like used and the log, which only ever grow
+  dt->starts = realloc(dt->starts, (dt->capacity + 1) * sizeof(int));
+  dt->positions = realloc(dt->positions, dt->logCapacity * sizeof(int));
+  mem_assert(dt->starts, "Couldn't allocate docterms positions");
+  mem_assert(dt->positions, "Couldn't allocate docterms positions");
+
+  // bucket the log by entry: starts[i] is where entry i's positions go
+  int start = 0;
+  for (int i = 0; i < dt->size; i++) {
+    dt->starts[i] = start;
+    start += dt->slots[dt->used[i]].count;
+  }
+  for (int n = 0; n < dt->logSize; n++) {
+    dt->positions[dt->starts[dt->log[n]]++] = n;
+  }
+  // each start has moved on to the next entry's
+  for (int i = 0; i < dt->size; i++) {
+    docterm_t* slot = &dt->slots[dt->used[i]];
+    itemfunc(arg, dt->text + slot->offset, dt->positions + dt->starts[i] - slot->count, slot->count);
+  }
+}
+
+/*********** docterms_clear ***********/
+/* see docterms.h for more details */
+void docterms_clear(docterms_t* dt)
+{
+  if (dt == NULL) {
+    return;
+  }
+  // only the slots we filled need resetting
+  for (int i = 0; i < dt->size; i++) {
+    dt->slots[dt->used[i]].hash = 0;
+  }
+  dt->size = 0;
+  dt->textUsed = 0;
+  dt->logSize = 0;
+}
+
+/*********** docterms_delete ***********/
+/* see docterms.h for more details */
+void docterms_delete(docterms_t* dt)
+{
+  if (dt != NULL) {
+    free(dt->slots);
+    free(dt->used);
+    free(dt->text);
+    free(dt->log);
+    free(dt->starts);
+    free(dt->positions);
+    free(dt);
+  }
+}
+
+/*********** wordHash ***********/
+/* Unreduced Jenkins hash of word, never 0 */
+static unsigned long wordHash(const char* word)
+{
+  unsigned long hash = hash_jenkins(word, ULONG_MAX);
+  return hash == 0 ? 1 : hash;
+}
+
+/*********** findSlot ***********/
+/* Returns the slot holding word, or the empty slot where it belongs */
+static int findSlot(docterms_t* dt, const char* word, unsigned long hash)
+{
+  int mask = dt->capacity - 1;
+  int pos = hash & mask;
+  while (dt->slots[pos].hash != 0) {
+    if (dt->slots[pos].hash == hash && strcmp(dt->text + dt->slots[pos].offset, word) == 0) {
+      break;
+    }
+    pos = (pos + 1) & mask;
+  }
+  return pos;
+}
+
+/*********** grow ***********/
+/* Doubles the slot array, re-placing entries in first-occurrence order */
+static void grow(docterms_t* dt)
+{
+  docterm_t* old = dt->slots;
+  int mask = dt->capacity * 2 - 1;
+
+  dt->capacity *= 2;
+  dt->slots = mem_calloc_assert(dt->capacity, sizeof(docterm_t), "Couldn't grow docterms slots");
+  dt->used = realloc(dt->used, dt->capacity * sizeof(int));
+  mem_assert(dt->used, "Couldn't grow docterms list");
+
+  for (int i = 0; i < dt->size; i++) {
+    docterm_t entry = old[dt->used[i]];
+    int pos = entry.hash & mask;
+    while (dt->slots[pos].hash != 0) {
+      pos = (pos + 1) & mask;
+    }
+    dt->slots[pos] = entry;
+    dt->used[i] = pos;
+  }
+  free(old);
+}
+
+/*********** copyWord ***********/
+/* Appends word to the text buffer and returns its offset */
+static int copyWord(docterms_t* dt, const char* word)
+{
+  int len = strlen(word) + 1;
+  if (dt->textUsed + len > dt->textCapacity) {
+    while (dt->textUsed + len > dt->textCapacity) {
+      dt->textCapacity *= 2;
+    }
+    dt->text = realloc(dt->text, dt->textCapacity);
+    mem_assert(dt->text, "Couldn't grow docterms text");
+  }
+  int offset = dt->textUsed;
+  memcpy(dt->text + offset, word, len);
+  dt->textUsed += len;
+  return offset;
+}
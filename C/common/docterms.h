@@ -0,0 +1,102 @@
+/*
+ * docterms.h - header file for CS50 'docterms' module
+ *
+ * A *docterms* table counts the distinct words of a single document.
+ * The indexer fills one while it scans a page, then flushes one
+ * (word, count) pair per distinct word into the global index, so that
+ * a word repeated many times on a page costs one index update instead
+ * of one per occurrence.
+ *
+ * The table is meant to be reused: docterms_clear empties it but keeps
+ * its memory, so after the first few pages no allocation happens.
+ * Words are handed back in the order they first appeared.
+ *
+ * A table made to keep positions also remembers the order words were
+ * added in, so it can hand back each word's positions: the n'th word
+ * added since the last clear is at position n-1.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdbool.h>
+
+/********* Global Type ***********/
+typedef struct docterms docterms_t;
+
+/********** Functions ***********/
+
+/*********** docterms_new ***********/
+/* Creates an empty docterms table
+ *
+ * Caller provides:
+ *   Whether the table is to keep positions for docterms_iteratePositions
+ * We return:
+ *   A valid pointer to an empty table
+ * Caller is responsible for:
+ *   Later calling docterms_delete
+ */
+docterms_t* docterms_new(bool positions);
+
+/*********** docterms_add ***********/
+/* Counts one more occurrence of word in the document
+ *
+ * Caller provides:
+ *   A valid pointer to a table and a null terminated string
+ * We return:
+ *   The number of times word has now been added since the last clear,
+ *   or 0 if dt or word is NULL
+ * Notes:
+ *   The table copies the string, so the caller may free it afterwards.
+ */
+int docterms_add(docterms_t* dt, const char* word);
+
+/*********** docterms_size ***********/
+/* Returns the number of distinct words added since the last clear,
+ * or 0 if dt is NULL
+ */
+int docterms_size(docterms_t* dt);
+
+/*********** docterms_iterate ***********/
+/* Calls itemfunc once for every distinct word
+ *
+ * Caller provides:
+ *   A valid table, an arbitrary arg, and an itemfunc
+ * We do:
+ *   Nothing if dt or itemfunc is NULL; otherwise call
+ *   itemfunc(arg, word, count) for each word in first-occurrence order
+ */
+void docterms_iterate(docterms_t* dt, void* arg,
+                      void (*itemfunc)(void* arg, const char* word, int count));
+
+/*********** docterms_iteratePositions ***********/
+/* Calls itemfunc once for every distinct word with its positions
+ *
+ * Caller provides:
+ *   A valid table, an arbitrary arg, and an itemfunc
+ * We do:
+ *   Nothing if dt or itemfunc is NULL; otherwise call
+ *   itemfunc(arg, word, positions, count) for each word in
+ *   first-occurrence order, positions holding the count positions
+ *   it was added at, in increasing order
+ * Notes:
+ *   positions is only valid during the call. Does nothing for a table
+ *   made without positions.
+ */
+void docterms_iteratePositions(docterms_t* dt, void* arg,
+                               void (*itemfunc)(void* arg, const char* word,
+                                                const int* positions, int count));
+
+/*********** docterms_clear ***********/
+/* Empties the table so it can be reused for the next document
+ *
+ * We guarantee:
+ *   The table keeps its allocated memory; words returned
+ *   by earlier iterations are no longer valid.
+ */
+void docterms_clear(docterms_t* dt);
+
+/*********** docterms_delete ***********/
+/* Deletes a table, returning all memory to the operating system
+ * If dt == NULL, does nothing
+ */
+void docterms_delete(docterms_t* dt);
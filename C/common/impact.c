@@ -0,0 +1,240 @@
+/*
+ * impact.c - CS50 'impact' module
+ *
+ * impact_topk is a threshold algorithm over impact blocks. Each word has
+ * a cursor at its next unread block, whose bound caps the count of any
+ * document the word hasn't shown us yet; a group's cap is the smallest
+ * of its words' times its weight, and the sum of the group caps caps
+ * the score of every unseen document. Each round reads one block, from
+ * the group with the highest cap and within it the word with the lowest
+ * (the one holding the group's cap down), and scores each document seen
+ * for the first time in full by looking it up in every word's
+ * docID-sorted postings. The best k so far are kept in a min-heap (see
+ * topk.h); once it is full and the cap falls below its worst score, no
+ * unseen document can get in.
+ *
+ * See impact.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "mem.h"
+#include "impact.h"
+#include "topk.h"
+
+// levels of impact_level; counts up to EXACT_LEVELS have their own
+#define IMPACT_LEVELS 128
+#define EXACT_LEVELS 16
+
+// Static function prototypes
+static int termBound(const impact_term_t* term, int pos);
+static int scoreDoc(const impact_term_t* terms, int numTerms, int numGroups, const int* weights,
+                    int* mins, int id);
+
+/*********** impact_level ***********/
+/* see impact.h for more details */
+int impact_level(int count)
+{
+  if (count <= EXACT_LEVELS) {
+    return count <= 0 ? 0 : count;
+  }
+  // four levels per power of two, from the two bits after the top one
+  int bit = 0;
+  while ((count >> (bit + 1)) != 0) {
+    bit++;
+  }
+  return EXACT_LEVELS + 1 + 4 * (bit - 4) + ((count >> (bit - 2)) & 3);
+}
+
+/*********** impact_bound ***********/
+/* see impact.h for more details */
+int impact_bound(int level)
+{
+  if (level <= EXACT_LEVELS) {
+    return level <= 0 ? 0 : level;
+  }
+  int bit = 4 + (level - EXACT_LEVELS - 1) / 4;
+  long long quarter = (level - EXACT_LEVELS - 1) % 4;
+  long long bound = ((4 + quarter + 1) << (bit - 2)) - 1;
+  return bound > INT_MAX ? INT_MAX : (int) bound;
+}
+
+/*********** impact_order ***********/
+/* see impact.h for more details */
+void impact_order(const postings_t* postings, int* ids, int* counts)
+{
+  if (postings == NULL || ids == NULL || counts == NULL) {
+    return;
+  }
+  // a counting sort by level is stable, so docIDs stay in order
+  int starts[IMPACT_LEVELS + 1] = { 0 };
+  for (int i = 0; i < postings->size; i++) {
+    starts[IMPACT_LEVELS - impact_level(postings->counts[i])]++;
+  }
+  int start = 0;
+  for (int slot = 0; slot <= IMPACT_LEVELS; slot++) {
+    int size = starts[slot];
+    starts[slot] = start;
+    start += size;
+  }
+  for (int i = 0; i < postings->size; i++) {
+    int at = starts[IMPACT_LEVELS - impact_level(postings->counts[i])]++;
+    ids[at] = postings->ids[i];
+    counts[at] = postings->counts[i];
+  }
+}
+
+/*********** impact_blockEnd ***********/
+/* see impact.h for more details */
+int impact_blockEnd(const postings_t* impacts, int start)
+{
+  if (impacts == NULL || start < 0 || start >= impacts->size) {
+    return impacts == NULL ? 0 : impacts->size;
+  }
+  int level = impact_level(impacts->counts[start]);
+  int low = start + 1;
+  int high = impacts->size;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (impact_level(impacts->counts[mid]) == level) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/*********** impact_topk ***********/
+/* see impact.h for more details */
+counters_t* impact_topk(const impact_term_t* terms, int numTerms, int k)
+{
+  if (terms == NULL || numTerms < 0 || k <= 0) {
+    return NULL;
+  }
+  int numGroups = 0;
+  int maxID = 0;
+  for (int t = 0; t < numTerms; t++) {
+    if (terms[t].group >= numGroups) {
+      numGroups = terms[t].group + 1;
+    }
+    if (terms[t].docs.size > 0 && terms[t].docs.ids[terms[t].docs.size - 1] > maxID) {
+      maxID = terms[t].docs.ids[terms[t].docs.size - 1];
+    }
+  }
+  int* pos = mem_calloc_assert(numTerms + 1, sizeof(int), "Couldn't allocate top k");
+  int* caps = mem_calloc_assert(numGroups + 1, sizeof(int), "Couldn't allocate top k");
+  int* mins = mem_calloc_assert(numGroups + 1, sizeof(int), "Couldn't allocate top k");
+  int* weights = mem_calloc_assert(numGroups + 1, sizeof(int), "Couldn't allocate top k");
+  for (int t = 0; t < numTerms; t++) {
+    weights[terms[t].group] = terms[t].weight;
+  }
+  unsigned char* seen = mem_calloc_assert(maxID / 8 + 1, 1, "Couldn't allocate top k");
+  topk_entry_t* heap = mem_calloc_assert(k, sizeof(topk_entry_t), "Couldn't allocate top k");
+  int heapSize = 0;
+
+  for (;;) {
+    // cap each group by its lowest word, and unseen documents by the sum
+    for (int g = 0; g < numGroups; g++) {
+      caps[g] = INT_MAX;
+    }
+    for (int t = 0; t < numTerms; t++) {
+      int bound = termBound(&terms[t], pos[t]);
+      if (bound < caps[terms[t].group]) {
+        caps[terms[t].group] = bound;
+      }
+    }
+    long long cap = 0;
+    int group = -1;
+    for (int g = 0; g < numGroups; g++) {
+      cap += (long long) caps[g] * weights[g];
+      if (caps[g] > 0 && (group < 0
+                          || (long long) caps[g] * weights[g] > (long long) caps[group] * weights[group])) {
+        group = g;
+      }
+    }
+    if (group < 0 || (heapSize == k && cap < heap[0].score)) {
+      break;
+    }
+
+    // read the next block of the group's most limiting word
+    int reader = -1;
+    for (int t = 0; t < numTerms; t++) {
+      if (terms[t].group != group || pos[t] >= terms[t].impacts.size) {
+        continue;
+      }
+      if (reader < 0 || termBound(&terms[t], pos[t]) < termBound(&terms[reader], pos[reader])
+          || (termBound(&terms[t], pos[t]) == termBound(&terms[reader], pos[reader])
+              && terms[t].impacts.size - pos[t] < terms[reader].impacts.size - pos[reader])) {
+        reader = t;
+      }
+    }
+    const postings_t* impacts = &terms[reader].impacts;
+    int end = impact_blockEnd(impacts, pos[reader]);
+    for (int i = pos[reader]; i < end; i++) {
+      int id = impacts->ids[i];
+      if (id < 0 || id > maxID || (seen[id / 8] & (1 << (id % 8))) != 0) {
+        continue;
+      }
+      seen[id / 8] |= 1 << (id % 8);
+      topk_entry_t entry = { id, scoreDoc(terms, numTerms, numGroups, weights, mins, id) };
+      if (entry.score > 0) {
+        topk_offer(heap, &heapSize, k, entry);
+      }
+    }
+    pos[reader] = end;
+  }
+
+  counters_t* best = counters_new();
+  for (int i = 0; i < heapSize; i++) {
+    counters_set(best, heap[i].id, heap[i].score);
+  }
+  free(pos);
+  free(caps);
+  free(mins);
+  free(weights);
+  free(seen);
+  free(heap);
+  return best;
+}
+
+/*********** termBound ***********/
+/* Returns the bound of a word's block at pos, 0 once it is read out */
+static int termBound(const impact_term_t* term, int pos)
+{
+  if (pos >= term->impacts.size) {
+    return 0;
+  }
+  return impact_bound(impact_level(term->impacts.counts[pos]));
+}
+
+/*********** scoreDoc ***********/
+/* Returns a document's full score, looking it up in every word's
+ * docID-sorted postings; mins is scratch with room for every group
+ */
+static int scoreDoc(const impact_term_t* terms, int numTerms, int numGroups, const int* weights,
+                    int* mins, int id)
+{
+  for (int g = 0; g < numGroups; g++) {
+    mins[g] = INT_MAX;
+  }
+  for (int t = 0; t < numTerms; t++) {
+    int* min = &mins[terms[t].group];
+    if (*min > 0) {
+      int count = postings_get(&terms[t].docs, id);
+      if (count < *min) {
+        *min = count;
+      }
+    }
+  }
+  int score = 0;
+  for (int g = 0; g < numGroups; g++) {
+    if (mins[g] != INT_MAX) {
+      score += mins[g] * weights[g];
+    }
+  }
+  return score;
+}
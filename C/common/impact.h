@@ -0,0 +1,88 @@
+/*
+ * impact.h - header file for CS50 'impact' module
+ *
+ * This module orders postings by *impact* (their count) so that a
+ * query can read each word's best documents first. Counts are quantized
+ * into levels: every count up to 16 is its own level, and above that
+ * each power of two is split into four levels. A word's impact-ordered
+ * postings are grouped into blocks of one level each, highest level
+ * first and by docID within a block; a block's bound is the largest
+ * count of its level.
+ *
+ * impact_topk uses the blocks to find the best k documents of a query
+ * without scoring every document that matches it: it reads blocks in
+ * order of their bounds, scores each new document in full, and stops as
+ * soon as no unread document could score high enough to enter the top k.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __IMPACT_H
+#define __IMPACT_H
+
+#include <stdbool.h>
+#include "counters.h"
+#include "postings.h"
+
+/********* Global Types ***********/
+// one word of a query for impact_topk
+typedef struct impact_term {
+  postings_t docs;        // the word's postings by docID (see index_get)
+  postings_t impacts;     // the same postings in impact order (see index_getImpacts)
+  int group;              // words of one group are and'ed, groups are or'ed
+  int weight;             // its group's score is added this many times (1 usually)
+} impact_term_t;
+
+/********** Functions ***********/
+
+/*********** impact_level ***********/
+/* Returns the quantized level of a count: 0 for counts <= 0, and
+ * higher levels for higher counts
+ */
+int impact_level(int count);
+
+/*********** impact_bound ***********/
+/* Returns the largest count whose level is level */
+int impact_bound(int level);
+
+/*********** impact_order ***********/
+/* Reorders postings by impact
+ *
+ * Caller provides:
+ *   A list sorted by docID, and ids and counts arrays with room
+ *   for postings->size entries each
+ * We guarantee:
+ *   ids and counts hold the list's pairs by level, highest first,
+ *   and by docID within a level
+ */
+void impact_order(const postings_t* postings, int* ids, int* counts);
+
+/*********** impact_blockEnd ***********/
+/* Returns the end of the block starting at start in impact-ordered
+ * postings: the first entry after it with a lower level, or the size
+ * of the list. Found by binary search, so the block isn't read.
+ */
+int impact_blockEnd(const postings_t* impacts, int start);
+
+/*********** impact_topk ***********/
+/* Finds the k best documents for a query
+ *
+ * Caller provides:
+ *   The query's numTerms words, those of a group with the same weight,
+ *   and k > 0
+ * We return:
+ *   A counters of at most k documents and their scores, the best by
+ *   score and then by lowest docID; a document scores the sum over
+ *   groups of the smallest count of the group's words in it, times
+ *   the group's weight, and a group missing a word in it adds nothing.
+ *   NULL if terms is NULL or k <= 0.
+ * Caller is responsible for:
+ *   Calling counters_delete on the result
+ * Notes:
+ *   The result is the same as scoring every matching document and
+ *   keeping the k best, but impact blocks past the point where no
+ *   unread document could reach the top k are never read.
+ */
+counters_t* impact_topk(const impact_term_t* terms, int numTerms, int k);
+
+#endif // __IMPACT_H
@@ -3,28 +3,82 @@
  *
  * This module implements the index data structure, which maps words
  * to a set of (document ID, count) pairs using a hashtable where
- * each key is a word and the value is a counters structure.
+ * each key is a word and the value is a postings list.
+ * An index reconstructed from a binary index file instead wraps the
+ * read-only mapping of that file (see indexfile.h), and one
+ * reconstructed from a segment manifest wraps the mappings of all its
+ * segments (see segments.h), whose lists are concatenated on lookup.
+ * Lists that a lookup decodes or joins may be kept in a cache (see
+ * postcache.h), checked before any file is read.
  *
  * See index.h for more information.
  *
  * Arthur Ufongene, May 2025
  */
 
+#include <string.h>
 #include "hashtable.h"
 #include "mem.h"
 #include "index.h"
-#include "file.h"
+#include "indexfile.h"
+#include "indextext.h"
+#include "segments.h"
+#include "impact.h"
+
+// a word and its postings, gathered from the index for saving
+typedef struct wordEntry {
+  const char* word;
+  const postings_t* postings;
+} wordEntry_t;
+
+// caller's arguments to index_iterate, passed through hashtable_iterate
+typedef struct iterateArgs {
+  void* arg;
+  void (*itemfunc)(void* arg, const char* word, const postings_t* postings);
+} iterateArgs_t;
+
+// every word of an index; held owns copies of postings that a
+// compressed mapped index only decodes for the length of a callback
+typedef struct wordList {
+  wordEntry_t* entries;
+  postings_t* held;
+  int size;
+} wordList_t;
 
 // Static function prototypes
-static void idCountPrint(void* file, int id, int count);
-static void wordPrint(void* file, const char* word, void* counter);
+static postings_t* index_postingsFor(index_t* idx, const char* word);
+static void adoptWord(void* arg, const char* word, postings_t* postings);
+static void iterateWord(void* arg, const char* word, void* postings);
+static void gatherWords(index_t* idx, wordList_t* list);
+static void countWord(void* arg, const char* word, void* postings);
+static void collectWord(void* arg, const char* word, void* postings);
+static void collectMapped(void* arg, const char* word, const postings_t* postings);
+static void releaseWords(wordList_t* list);
+static int compareWords(const void* first, const void* second);
+static index_t* mapFiles(indexfile_t** files, int numFiles);
+static bool mergeWord(void* arg, const char* word, const postings_t* postings);
+static size_t listBytes(const postings_t* postings);
+static void maxWordID(void* arg, const char* word, void* postings);
 
 // index structure definition, contains a hashtable where each key is a word,
-// and the corresponding value is a counters_t* that stores (id, count) pairs
+// and the corresponding value is a postings_t* that stores (id, count) pairs.
+// A mapped index has no hashtable and answers lookups from its files
+// instead: one for a binary index file, one per segment for a manifest.
+// bytes is a running estimate of the memory the hashtable index holds;
+// positional is set once positions have been inserted.
 struct index {
   hashtable_t* idxTable;
+  indexfile_t** mapped;
+  int numMapped;
+  size_t bytes;
+  bool positional;
+  postcache_t* cache;     // decoded lists, or NULL
 };
 
+// estimated bytes per word beyond its text and postings_t: its share of
+// the hashtable's slots and the allocator's bookkeeping
+#define WORD_OVERHEAD 64
+
 /************ index_new **********/
 /* see index.h for more details */
 index_t* index_new(int size)
@@ -50,154 +104,604 @@ index_t* index_new(int size)
 /* see index.h for more details */
 int index_incrementCount(index_t* idx, const char* word, int id)
 {
-  if (idx == NULL || word == NULL) {
-    return 0;
-  }
-  // create a new counters structure to insert if word is not present
-  counters_t* newCounter = counters_new();
-
-  // attempt to insert newCounter under 'word'; if word already exists, insertion fails
-  if (!hashtable_insert(idx->idxTable, word, newCounter)) {
-    // clean up
-    counters_delete(newCounter);
-  }
-
-  // ensure that the counter is actually in the hashtable
-  // just in case of allocation errors
-  counters_t* wordCounter;
-  if ((wordCounter = hashtable_find(idx->idxTable, word)) == NULL) {
+  postings_t* wordPostings;
+  if ((wordPostings = index_postingsFor(idx, word)) == NULL) {
     return 0;
   }
 
-  //increment the id count for the word's counters struct
-  return counters_add(wordCounter, id);
+  //increment the id count for the word's postings
+  int before = wordPostings->capacity;
+  int count = postings_add(wordPostings, id);
+  idx->bytes += (size_t) (wordPostings->capacity - before) * 2 * sizeof(int);
+  return count;
 }
 
 /******* index_insertCount *********/
 /* see index.h for more details */
 bool index_insertCount(index_t* idx, const char* word, int id, int count)
 {
-  if (idx == NULL || word == NULL) {
+  postings_t* wordPostings;
+  if ((wordPostings = index_postingsFor(idx, word)) == NULL) {
     return false;
   }
-  counters_t* newCounter = counters_new();
-  // try to insert into hashtable
-  if (!hashtable_insert(idx->idxTable, word, newCounter)) {
-  // cleanup if insertion failed
-    counters_delete(newCounter);
-  }
-  
-  // ensure that the counter is actually in the hashtable
-  // just in case of allocation errors
-  counters_t* wordCounter;
-  if ((wordCounter = hashtable_find(idx->idxTable, word)) == NULL) {
+
+  // set count for id in the postings for word
+  int before = wordPostings->capacity;
+  bool set = postings_set(wordPostings, id, count);
+  idx->bytes += (size_t) (wordPostings->capacity - before) * 2 * sizeof(int);
+  return set;
+}
+
+/******* index_insertPositions *********/
+/* see index.h for more details */
+bool index_insertPositions(index_t* idx, const char* word, int id, const int* positions, int count)
+{
+  postings_t* wordPostings;
+  if ((wordPostings = index_postingsFor(idx, word)) == NULL) {
     return false;
   }
 
-  // set count for id in the counters for word
-  return counters_set(wordCounter, id, count);
+  // append id and its positions to the word's postings
+  size_t before = listBytes(wordPostings);
+  bool added = postings_addPositions(wordPostings, id, positions, count);
+  idx->bytes += listBytes(wordPostings) - before;
+  idx->positional = idx->positional || added;
+  return added;
 }
 
-/********* index_delete ***********/
+/******* index_hasPositions *********/
 /* see index.h for more details */
-void index_delete(index_t* idx)
+bool index_hasPositions(index_t* idx)
 {
-  if (idx != NULL) {
-    // delete the hashtable, passing counters_delete to delete all internal counters
-    hashtable_delete(idx->idxTable, (void (*)(void*)) counters_delete);
-    free(idx);
+  if (idx == NULL) {
+    return false;
   }
+  if (idx->mapped != NULL) {
+    bool positional = idx->numMapped > 0;
+    for (int i = 0; i < idx->numMapped; i++) {
+      positional = positional && indexfile_hasPositions(idx->mapped[i]);
+    }
+    return positional;
+  }
+  return idx->positional;
 }
 
-/********** idCountPrint ***********/
-/* Prints the id and count of a counter entry to a file
+/********** index_postingsFor ***********/
+/* Returns the postings for word, creating them if word is new
  * 
- * file: pointer to a file struct
- * id: id of the current counter entry
- * count: count of current counter entry
+ * idx: index to look the word up in
+ * word: word whose postings we want
+ *
+ * The word is hashed and probed once; a list is only allocated
+ * the first time a word is seen. Returns NULL if idx or word is NULL,
+ * or if idx is a read-only mapped index.
  */
-static void idCountPrint(void* file, int id, int count)
+static postings_t* index_postingsFor(index_t* idx, const char* word)
 {
-  FILE* fp = (FILE*) file;
-  fprintf(fp, "%d %d ", id, count); // print in specified format to file
+  if (idx == NULL || word == NULL || idx->mapped != NULL) {
+    return NULL;
+  }
+  // find the word's slot, inserting the word if it isn't there yet
+  void** slot;
+  if ((slot = hashtable_upsert(idx->idxTable, word)) == NULL) {
+    return NULL;
+  }
+  // first occurrence of this word: give it an empty list
+  if (*slot == NULL) {
+    *slot = postings_new();
+    idx->bytes += sizeof(postings_t) + strlen(word) + 1 + WORD_OVERHEAD;
+  }
+  return (postings_t*) *slot;
 }
 
-/*********** wordPrint ************/
-/* Prints the word of an index entry to the file
- * and iterates through that entry's counter
- * 
- * file: pointer to file struct
- * word: key of the hashtable entry
- * counter: item of the hashtable entry
- */
-static void wordPrint(void* file, const char* word, void* counter)
+/********* index_memoryUsed ***********/
+/* see index.h for more details */
+size_t index_memoryUsed(index_t* idx)
+{
+  return idx == NULL ? 0 : idx->bytes;
+}
+
+/********* index_delete ***********/
+/* see index.h for more details */
+void index_delete(index_t* idx)
 {
-  FILE* fp = (FILE*) file;
-  // print the word
-  fprintf(fp, "%s ", word);
-  // iterate through the counters for that word and print each (id, count)
-  counters_iterate((counters_t*)counter, file, idCountPrint);
-  fprintf(fp, "\n"); 
+  if (idx != NULL) {
+    if (idx->mapped != NULL) {
+      // unmap the index files
+      for (int i = 0; i < idx->numMapped; i++) {
+        indexfile_close(idx->mapped[i]);
+      }
+      free(idx->mapped);
+    } else {
+      // delete the hashtable, passing postings_delete to delete all internal lists
+      hashtable_delete(idx->idxTable, (void (*)(void*)) postings_delete);
+    }
+    free(idx);
+  }
 }
 
 /*********** index_save ************/
 /* see index.h for more details */
 bool index_save(index_t* idx, char* filename)
 {
-  FILE* file;
-  // open file for writing
-  if (idx == NULL || (file = fopen(filename, "w")) == NULL) {
+  if (idx == NULL || filename == NULL) {
     return false;
   }
 
-  // iterate through the hashtable and print each word and its counters
-  hashtable_iterate(idx->idxTable, (void*) file, wordPrint);
+  // gather every word with its postings, then let indextext format
+  // them in parallel and write them out in this order
+  wordList_t list;
+  gatherWords(idx, &list);
+  const char** words = mem_calloc_assert(list.size + 1, sizeof(char*), "Couldn't allocate word list");
+  const postings_t** lists = mem_calloc_assert(list.size + 1, sizeof(postings_t*), "Couldn't allocate postings list");
+  for (int i = 0; i < list.size; i++) {
+    words[i] = list.entries[i].word;
+    lists[i] = list.entries[i].postings;
+  }
+  bool saved = indextext_write(filename, list.size, words, lists);
 
-  // close the file
-  fclose(file);
-  return true;
+  free(words);
+  free(lists);
+  releaseWords(&list);
+  return saved;
+}
+
+/*********** index_saveBinary ************/
+/* see index.h for more details */
+bool index_saveBinary(index_t* idx, char* filename, int options)
+{
+  // a mapped index is already in binary form; it can't be rewritten in place
+  if (idx == NULL || filename == NULL || idx->mapped != NULL) {
+    return false;
+  }
+
+  // gather each word with its postings
+  wordList_t list;
+  gatherWords(idx, &list);
+
+  // the binary dictionary is sorted by word
+  qsort(list.entries, list.size, sizeof(wordEntry_t), compareWords);
+
+  const char** words = mem_calloc_assert(list.size + 1, sizeof(char*), "Couldn't allocate word list");
+  const postings_t** lists = mem_calloc_assert(list.size + 1, sizeof(postings_t*), "Couldn't allocate postings list");
+  for (int i = 0; i < list.size; i++) {
+    words[i] = list.entries[i].word;
+    lists[i] = list.entries[i].postings;
+  }
+  // positions are saved whenever the index has them
+  options &= ~INDEXFILE_POSITIONS;
+  if (idx->positional) {
+    options |= INDEXFILE_POSITIONS;
+  }
+  bool saved = indexfile_write(filename, list.size, words, lists, options);
+
+  free(words);
+  free(lists);
+  releaseWords(&list);
+  return saved;
 }
 
 /*********** index_reconstruct **********/
 /* see index.h for more details */
 index_t* index_reconstruct(char* oldFilename)
 {
-  FILE* oldFile;
-  // open the saved index file for reading
-  if ((oldFile = fopen(oldFilename, "r")) == NULL) {
-    return NULL;
+  // binary index files are mapped rather than parsed
+  if (indexfile_isBinary(oldFilename)) {
+    indexfile_t* mapped;
+    if ((mapped = indexfile_open(oldFilename)) == NULL) {
+      return NULL;
+    }
+    return mapFiles(&mapped, 1);
+  }
+
+  // so is every segment of a segmented index
+  if (segments_isManifest(oldFilename)) {
+    segments_t* segs;
+    if ((segs = segments_open(oldFilename, false)) == NULL) {
+      return NULL;
+    }
+    int numSegments = segments_count(segs);
+    indexfile_t** files = mem_calloc_assert(numSegments + 1, sizeof(indexfile_t*), "Couldn't allocate index");
+    bool opened = true;
+    for (int i = 0; opened && i < numSegments; i++) {
+      opened = (files[i] = indexfile_open(segments_path(segs, i))) != NULL;
+    }
+    segments_delete(segs);
+    index_t* idx = opened ? mapFiles(files, numSegments) : NULL;
+    for (int i = 0; idx == NULL && i < numSegments; i++) {
+      indexfile_close(files[i]);
+    }
+    free(files);
+    return idx;
   }
 
-  // create a new index with a size based on number of lines in the file
+  // text index files are parsed in parallel straight into postings lists
+  indextext_t* text;
+  if ((text = indextext_load(oldFilename)) == NULL) {
+    return NULL;
+  }
+  int numWords = indextext_numWords(text);
   index_t* idx;
-  if ((idx = index_new(file_numLines(oldFile))) == NULL) {
+  if ((idx = index_new(numWords > 0 ? numWords : 1)) == NULL) {
+    indextext_delete(text);
     return NULL;
   }
+  indextext_iterate(text, idx, adoptWord);
+  indextext_delete(text);
+  return idx;
+}
 
-  // variables to hold each parsed word/id/count
-  char currWord[200];
-  int currId;
-  int currCount;
+/********** adoptWord *************/
+/* indextext_iterate helper: stores a parsed list under its word,
+ * merging it into the list already there if the word is repeated
+ */
+static void adoptWord(void* arg, const char* word, postings_t* postings)
+{
+  index_t* idx = (index_t*) arg;
+  void** slot = hashtable_upsert(idx->idxTable, word);
+  if (slot == NULL) {
+    postings_delete(postings);
+    return;
+  }
+  if (*slot == NULL) {
+    *slot = postings;
+    return;
+  }
+  for (int i = 0; i < postings->size; i++) {
+    postings_set((postings_t*) *slot, postings->ids[i], postings->counts[i]);
+  }
+  postings_delete(postings);
+}
 
-  // read each word and its (id, count) pairs from the file
-  while (fscanf(oldFile, "%s ", currWord) == 1) {
-    while (fscanf(oldFile, "%d %d ", &currId, &currCount) == 2) {
-      // try insert the data into the index
-      // If data is not inserted return null indicating an error was made
-      if (!index_insertCount(idx, currWord, currId, currCount)) {
-        return NULL;
+/********** index_get *************/
+/* See index.h for more information */
+postings_t index_get(index_t* idx, const char* word)
+{
+  postings_t postings = postings_view(NULL, NULL, 0);
+  if (idx == NULL || word == NULL) {
+    return postings;
+  }
+  if (idx->mapped != NULL) {
+    if (postcache_get(idx->cache, word, &postings)) {
+      return postings;
+    }
+    // segments hold increasing docIDs, so their lists simply concatenate
+    for (int i = 0; i < idx->numMapped; i++) {
+      postings_t part;
+      if (!indexfile_find(idx->mapped[i], word, &part)) {
+        continue;
+      }
+      if (postings.size == 0) {
+        postings_release(&postings);
+        postings = part;
+        continue;
       }
+      postings_t joined = postings_view(NULL, NULL, 0);
+      postings_append(&joined, &postings);
+      postings_append(&joined, &part);
+      postings_release(&postings);
+      postings_release(&part);
+      postings = joined;
     }
+    postcache_offer(idx->cache, word, &postings);
+    return postings;
   }
+  postings_t* stored;
+  if ((stored = hashtable_find(idx->idxTable, word)) != NULL) {
+    // a view of the whole list, positions included
+    postings = *stored;
+    postings.capacity = 0;
+    postings.posCapacity = 0;
+  }
+  return postings;
+}
 
-  // close file after processing
-  fclose(oldFile);
-  return idx;
+/*********** index_setCache ***********/
+/* see index.h for more details */
+bool index_setCache(index_t* idx, postcache_t* cache)
+{
+  if (idx == NULL || idx->mapped == NULL) {
+    return false;
+  }
+  bool decodes = idx->numMapped > 1;
+  for (int i = 0; i < idx->numMapped; i++) {
+    decodes = decodes || indexfile_isCompressed(idx->mapped[i]);
+  }
+  idx->cache = decodes ? cache : NULL;
+  return decodes && cache != NULL;
 }
 
-/********** index_get *************/
+/*********** index_frequency ***********/
+/* see index.h for more details */
+int index_frequency(index_t* idx, const char* word)
+{
+  if (idx == NULL || word == NULL) {
+    return 0;
+  }
+  if (idx->mapped != NULL) {
+    int frequency = 0;
+    for (int i = 0; i < idx->numMapped; i++) {
+      frequency += indexfile_frequency(idx->mapped[i], word);
+    }
+    return frequency;
+  }
+  postings_t* stored = hashtable_find(idx->idxTable, word);
+  return stored == NULL ? 0 : stored->size;
+}
+
+/*********** index_maxDocID ***********/
+/* see index.h for more details */
+int index_maxDocID(index_t* idx)
+{
+  int maxID = 0;
+  if (idx == NULL) {
+    return 0;
+  }
+  if (idx->mapped != NULL) {
+    for (int i = 0; i < idx->numMapped; i++) {
+      int fileMax = indexfile_maxDocID(idx->mapped[i]);
+      maxID = fileMax > maxID ? fileMax : maxID;
+    }
+    return maxID;
+  }
+  hashtable_iterate(idx->idxTable, &maxID, maxWordID);
+  return maxID;
+}
+
+/*********** index_hasBounds ***********/
+/* see index.h for more details */
+bool index_hasBounds(index_t* idx)
+{
+  if (idx == NULL || idx->mapped == NULL) {
+    return false;
+  }
+  bool bounds = idx->numMapped > 0;
+  for (int i = 0; i < idx->numMapped; i++) {
+    bounds = bounds && indexfile_hasBounds(idx->mapped[i]);
+  }
+  return bounds;
+}
+
+/*********** index_bound ***********/
+/* see index.h for more details */
+int index_bound(index_t* idx, const char* word)
+{
+  int bound = 0;
+  if (index_hasBounds(idx)) {
+    // a segment's docs are its own, so the largest of their bounds
+    for (int i = 0; i < idx->numMapped; i++) {
+      int segmentBound = indexfile_bound(idx->mapped[i], word);
+      bound = segmentBound > bound ? segmentBound : bound;
+    }
+    return bound;
+  }
+  postings_t postings = index_get(idx, word);
+  for (int i = 0; i < postings.size; i++) {
+    bound = postings.counts[i] > bound ? postings.counts[i] : bound;
+  }
+  postings_release(&postings);
+  return bound;
+}
+
+/*********** index_hasImpacts ***********/
+/* see index.h for more details */
+bool index_hasImpacts(index_t* idx)
+{
+  if (idx == NULL || idx->mapped == NULL) {
+    return false;
+  }
+  bool impacts = idx->numMapped > 0;
+  for (int i = 0; i < idx->numMapped; i++) {
+    impacts = impacts && indexfile_hasImpacts(idx->mapped[i]);
+  }
+  return impacts;
+}
+
+/********** index_getImpacts *************/
+/* See index.h for more information */
+postings_t index_getImpacts(index_t* idx, const char* word)
+{
+  postings_t impacts = postings_view(NULL, NULL, 0);
+  if (!index_hasImpacts(idx) || word == NULL) {
+    return impacts;
+  }
+  if (idx->numMapped == 1) {
+    indexfile_findImpacts(idx->mapped[0], word, &impacts);
+    return impacts;
+  }
+
+  // segments: take each level's block from every segment in segment
+  // order, so ids stay sorted within a level
+  postings_t* parts = mem_calloc_assert(idx->numMapped, sizeof(postings_t), "Couldn't allocate impacts");
+  int* at = mem_calloc_assert(idx->numMapped, sizeof(int), "Couldn't allocate impacts");
+  int total = 0;
+  for (int i = 0; i < idx->numMapped; i++) {
+    indexfile_findImpacts(idx->mapped[i], word, &parts[i]);
+    total += parts[i].size;
+  }
+  postings_reserve(&impacts, total);
+  while (impacts.size < total) {
+    int level = 0;
+    for (int i = 0; i < idx->numMapped; i++) {
+      if (at[i] < parts[i].size && impact_level(parts[i].counts[at[i]]) > level) {
+        level = impact_level(parts[i].counts[at[i]]);
+      }
+    }
+    for (int i = 0; i < idx->numMapped; i++) {
+      if (at[i] < parts[i].size && impact_level(parts[i].counts[at[i]]) == level) {
+        int end = impact_blockEnd(&parts[i], at[i]);
+        memcpy(impacts.ids + impacts.size, parts[i].ids + at[i], (end - at[i]) * sizeof(int));
+        memcpy(impacts.counts + impacts.size, parts[i].counts + at[i], (end - at[i]) * sizeof(int));
+        impacts.size += end - at[i];
+        at[i] = end;
+      }
+    }
+  }
+  for (int i = 0; i < idx->numMapped; i++) {
+    postings_release(&parts[i]);
+  }
+  free(parts);
+  free(at);
+  return impacts;
+}
+
+/********** index_iterate *************/
 /* See index.h for more information */
-counters_t* index_get(index_t* idx, char* word)
+void index_iterate(index_t* idx, void* arg,
+                   void (*itemfunc)(void* arg, const char* word, const postings_t* postings))
+{
+  if (idx == NULL || itemfunc == NULL) {
+    return;
+  }
+  if (idx->mapped != NULL) {
+    iterateArgs_t args = { arg, itemfunc };
+    indexfile_merge(idx->mapped, idx->numMapped, &args, mergeWord);
+    return;
+  }
+  // hashtable items are postings_t*, so the itemfunc can be handed
+  // to hashtable_iterate through a small adapter
+  iterateArgs_t args = { arg, itemfunc };
+  hashtable_iterate(idx->idxTable, &args, iterateWord);
+}
+
+/********** mergeWord *************/
+/* indexfile_merge adapter for index_iterate on a mapped index */
+static bool mergeWord(void* arg, const char* word, const postings_t* postings)
+{
+  iterateArgs_t* args = (iterateArgs_t*) arg;
+  args->itemfunc(args->arg, word, postings);
+  return true;
+}
+
+/********** iterateWord *************/
+/* hashtable_iterate adapter for index_iterate */
+static void iterateWord(void* arg, const char* word, void* postings)
+{
+  iterateArgs_t* args = (iterateArgs_t*) arg;
+  args->itemfunc(args->arg, word, (const postings_t*) postings);
+}
+
+/********** gatherWords *************/
+/* Fills list with every word of idx and its postings
+ *
+ * A hashtable index hands out its own lists. A mapped index hands out
+ * views into the mapping, or for a compressed file copies of the decoded
+ * lists kept in list->held. Caller must call releaseWords.
+ */
+static void gatherWords(index_t* idx, wordList_t* list)
+{
+  list->size = 0;
+  list->held = NULL;
+  if (idx->mapped != NULL) {
+    // words in several segments make this an overestimate
+    int numWords = 0;
+    for (int i = 0; i < idx->numMapped; i++) {
+      numWords += indexfile_numWords(idx->mapped[i]);
+    }
+    list->entries = mem_calloc_assert(numWords + 1, sizeof(wordEntry_t), "Couldn't allocate word list");
+    list->held = mem_calloc_assert(numWords + 1, sizeof(postings_t), "Couldn't allocate postings list");
+    index_iterate(idx, list, collectMapped);
+    return;
+  }
+  // count the words, then gather each one
+  hashtable_iterate(idx->idxTable, &list->size, countWord);
+  list->entries = mem_calloc_assert(list->size + 1, sizeof(wordEntry_t), "Couldn't allocate word list");
+  list->size = 0;
+  hashtable_iterate(idx->idxTable, list, collectWord);
+}
+
+/********** countWord *************/
+/* hashtable_iterate helper that counts words into an int */
+static void countWord(void* arg, const char* word, void* postings)
+{
+  (*(int*) arg)++;
+}
+
+/********** collectWord *************/
+/* hashtable_iterate helper that appends each word and its
+ * postings to a wordList_t
+ */
+static void collectWord(void* arg, const char* word, void* postings)
+{
+  wordList_t* list = (wordList_t*) arg;
+  list->entries[list->size].word = word;
+  list->entries[list->size].postings = (const postings_t*) postings;
+  list->size++;
+}
+
+/********** collectMapped *************/
+/* indexfile_iterate helper for gatherWords: views are kept as they are,
+ * decoded lists are copied into list->held since they are released
+ * when we return. Words point into the mapping and stay valid.
+ */
+static void collectMapped(void* arg, const char* word, const postings_t* postings)
+{
+  wordList_t* list = (wordList_t*) arg;
+  postings_t* held = &list->held[list->size];
+  if (postings->capacity == 0 && postings->posCapacity == 0) {
+    *held = *postings;
+  } else {
+    *held = postings_view(NULL, NULL, 0);
+    postings_append(held, postings);
+  }
+  list->entries[list->size].word = word;
+  list->entries[list->size].postings = held;
+  list->size++;
+}
+
+/********** releaseWords *************/
+/* Frees what gatherWords allocated */
+static void releaseWords(wordList_t* list)
+{
+  if (list->held != NULL) {
+    for (int i = 0; i < list->size; i++) {
+      postings_release(&list->held[i]);
+    }
+    free(list->held);
+  }
+  free(list->entries);
+}
+
+/********** compareWords *************/
+/* qsort comparator ordering wordEntry_t's by word */
+static int compareWords(const void* first, const void* second)
+{
+  return strcmp(((const wordEntry_t*) first)->word, ((const wordEntry_t*) second)->word);
+}
+
+/********** listBytes *************/
+/* Bytes a hashtable index's list holds in its arrays and positions */
+static size_t listBytes(const postings_t* postings)
+{
+  size_t bytes = (size_t) postings->capacity * 2 * sizeof(int);
+  if (postings->posCapacity > 0) {
+    bytes += postings->capacity * sizeof(uint64_t) + postings->posCapacity;
+  }
+  return bytes;
+}
+
+/********** mapFiles *************/
+/* Returns a read-only index over open binary index files, given in
+ * docID order; the index takes them over
+ */
+static index_t* mapFiles(indexfile_t** files, int numFiles)
 {
-  return (counters_t*) hashtable_find(idx->idxTable, word);
+  index_t* idx = mem_calloc_assert(1, sizeof(index_t), "Couldn't allocate index");
+  idx->mapped = mem_calloc_assert(numFiles + 1, sizeof(indexfile_t*), "Couldn't allocate index");
+  memcpy(idx->mapped, files, numFiles * sizeof(indexfile_t*));
+  idx->numMapped = numFiles;
+  return idx;
+}
+
+/*********** maxWordID ***********/
+/* hashtable_iterate helper raising *arg to the last docID of a word's
+ * list, its largest
+ */
+static void maxWordID(void* arg, const char* word, void* postings)
+{
+  postings_t* list = (postings_t*) postings;
+  int* maxID = (int*) arg;
+  if (list->size > 0 && list->ids[list->size - 1] > *maxID) {
+    *maxID = list->ids[list->size - 1];
+  }
 }
@@ -7,13 +7,26 @@
  * An index can either be built from scratch, or reconstructed from a save file.
  * 
  * This data structure is a wrapper for the hashtable, with each of its items
- * being a pointer to the counters data structure. 
+ * being a pointer to a postings list (see postings.h).
+ * An index can also be saved in a binary format that is reconstructed by
+ * mapping the file into memory instead of parsing it; such an index is
+ * read-only. So is an index made of several such files (segments).
+ *
+ * A *positional* index also records where in each document a word
+ * occurs (see postings.h), for phrase queries. Positions are built with
+ * index_insertPositions and only kept by the binary format.
+ *
+ * A mapped index saved with INDEXFILE_IMPACTS also hands out each
+ * word's postings in impact order (see impact.h), for top-k queries.
  *
  * Arthur Ufongene, May 2025
  */
 
 #include <stdbool.h>
-#include "counters.h"
+#include <stddef.h>
+#include "postings.h"
+#include "indexfile.h"
+#include "postcache.h"
 /********* Global Type ***********/
 typedef struct index index_t;
 
@@ -23,16 +36,25 @@ typedef struct index index_t;
 /* Creates an empty index
  * 
  * Caller provides:
- *   An integer size that is > 0
+ *   An integer size that is > 0, the expected number of words
  * We return:
  *   A valid pointer to an index data structure,
  *   or NULL if invalid size or problems with 
  *   allocation
  * Caller is responsible for:
  *   Later calling index_delete
+ * Notes:
+ *   The index grows as words are added, so size is only a hint.
  */
 index_t* index_new(int size);
 
+/*********** index_memoryUsed ***********/
+/* Returns an estimate of the bytes an index built with
+ * index_incrementCount/index_insertCount holds: its words, postings
+ * arrays and table slots. 0 for NULL or a mapped index.
+ */
+size_t index_memoryUsed(index_t* idx);
+
 /*********** index_incrementCount ***********/
 /* Increments the count of an ID for a specific word by 1
  * 
@@ -51,6 +73,28 @@ index_t* index_new(int size);
  */
 int index_incrementCount(index_t* idx, const char* word, int id);
 
+/************* index_insertPositions *************/
+/* Appends a document's word positions to the postings of a word
+ * 
+ * Caller provides:
+ *   A valid pointer to an index, a null terminated string, a positive
+ *   integer ID larger than any already inserted for the word, and the
+ *   count > 0 positions of the word in that document, increasing
+ * We return:
+ *   true if the ID was added with count as its count; false if idx or
+ *   word is NULL, the ID is out of order, or the word already has
+ *   counts inserted without positions
+ * Notes:
+ *   An index built this way is positional; use it for every word.
+ */
+bool index_insertPositions(index_t* idx, const char* word, int id, const int* positions, int count);
+
+/*********** index_hasPositions ***********/
+/* Returns true if idx holds word positions: it was built with
+ * index_insertPositions, or every file it maps was saved with them
+ */
+bool index_hasPositions(index_t* idx);
+
 /*********** index_incrementCount ***********/
 /* Deletes an index, returning all memory to operating system
  * 
@@ -80,6 +124,23 @@ void index_delete(index_t* idx);
  */
 bool index_save(index_t* idx, char* filename);
 
+/********** index_saveBinary *************/
+/* Saves an index to a specified file in the binary index format
+ * 
+ * Caller provides:
+ *   A valid pointer to an index, the name of the file to be saved to,
+ *   and INDEXFILE_* options from indexfile.h or'ed together (0 for none)
+ * We guarantee:
+ *   The file holds a header, a dictionary of the words sorted
+ *   alphabetically, and every word's postings in contiguous arrays,
+ *   ready to be mapped by index_reconstruct; and the positions of a
+ *   positional index, whatever options says
+ * We do:
+ *   If index == NULL, index is itself mapped from a binary file, or
+ *   the file can't be written, return false; else write and return true
+ */
+bool index_saveBinary(index_t* idx, char* filename, int options);
+
 /************* index_insertCount *************/
 /* Inserts a count for the specified word and ID
  * 
@@ -105,19 +166,118 @@ bool index_insertCount(index_t* idx, const char* word, int id, int count);
  *   A pointer to the in memory index if the file 
  *   can be read, NULL if otherwise
  * Note:
- *   We assume that the lines of the file are in the format:
+ *   If the file starts with the binary index magic number it is mapped
+ *   into memory with no parsing, and the index is read-only: the
+ *   increment and insert functions fail on it. A segment manifest (see
+ *   segments.h) is read the same way, every segment being mapped.
+ *   Otherwise we assume that the lines of the file are in the format:
  *   word id count [id count ...]
  */
 index_t* index_reconstruct(char* oldFilename);
 
 
+/********** index_iterate *************/
+/* Calls itemfunc once for every word in the index
+ * 
+ * Caller provides:
+ *   An index, an arbitrary arg, and an itemfunc
+ * We do:
+ *   Nothing if idx or itemfunc is NULL; otherwise call
+ *   itemfunc(arg, word, postings) for each word, in sorted order
+ *   for a mapped index and in undefined order otherwise
+ * Notes:
+ *   postings is only valid during the call.
+ */
+void index_iterate(index_t* idx, void* arg,
+                   void (*itemfunc)(void* arg, const char* word, const postings_t* postings));
+
 /********** index_get *************/
-/* Returns a pointer to the counter for a word
+/* Returns the postings for a word
  * 
  * Caller provides:
- *   An index and a word to retrieve the counter for
+ *   An index and a word to retrieve the postings for
  * We return:
- *   A pointer to the counter or NULL if word isn't in
- *   index
+ *   A read-only view of the word's (id, count) pairs sorted by id,
+ *   with their positions in a positional index;
+ *   the view is empty (size 0) if word isn't in the index
+ * Caller is responsible for:
+ *   Calling postings_release on the result when done with it
+ *   (a compressed index decodes into memory owned by the result)
+ * Notes:
+ *   A view points into the index, so it is valid until the index
+ *   is changed or deleted. With a cache (see index_setCache), a decoded
+ *   list may come from it, or be kept in it, as a view holding a lease.
+ */
+postings_t index_get(index_t* idx, const char* word);
+
+/*********** index_setCache ***********/
+/* Keeps the lists index_get decodes in a cache
+ *
+ * Caller provides:
+ *   An index and a cache (see postcache.h), or NULL for none
+ * We return:
+ *   true if idx will use the cache: it is mapped, and its lists are
+ *   decoded (a compressed file) or joined (several segments); false,
+ *   and the cache is not used, if index_get gives views into the index
+ *   anyway
+ * Caller is responsible for:
+ *   Deleting the cache, after the last list from index_get is released
+ * Notes:
+ *   Only index_get uses the cache; impact-ordered lists are decoded as
+ *   before.
+ */
+bool index_setCache(index_t* idx, postcache_t* cache);
+
+/*********** index_frequency ***********/
+/* Returns how many documents hold a word, 0 if it isn't in the index or
+ * idx or word is NULL
+ * Notes:
+ *   Only the word's entry is read, so this costs a lookup however long
+ *   its list is, and a compressed list isn't decoded.
+ */
+int index_frequency(index_t* idx, const char* word);
+
+/*********** index_maxDocID ***********/
+/* Returns the largest docID in the index, 0 if it is empty or idx is NULL
+ * Notes:
+ *   A mapped index reads it from each file's header; an index in memory
+ *   looks at the last docID of every word's list.
+ */
+int index_maxDocID(index_t* idx);
+
+/*********** index_hasBounds ***********/
+/* Returns true if idx is mapped and every file it maps stores each
+ * word's largest count (see indexfile_hasBounds)
+ */
+bool index_hasBounds(index_t* idx);
+
+/*********** index_bound ***********/
+/* Returns the largest count of a word in any document: from the files'
+ * stored bounds if index_hasBounds, else read off its postings; 0 if the
+ * word isn't in the index or idx or word is NULL
+ */
+int index_bound(index_t* idx, const char* word);
+
+/*********** index_hasImpacts ***********/
+/* Returns true if idx is mapped and every file it maps was saved
+ * with INDEXFILE_IMPACTS
+ */
+bool index_hasImpacts(index_t* idx);
+
+/********** index_getImpacts *************/
+/* Returns the postings for a word in impact order
+ * 
+ * Caller provides:
+ *   An index with impacts (see index_hasImpacts) and a word
+ * We return:
+ *   The word's (id, count) pairs by impact level, highest first, and
+ *   by id within a level; empty if the word isn't in the index or
+ *   the index has no impacts. The list isn't sorted by id, so only
+ *   its arrays should be read.
+ * Caller is responsible for:
+ *   Calling postings_release on the result when done with it
+ * Notes:
+ *   For a single file the result is a view into the mapping; the
+ *   segments of a segmented index have their blocks merged by level.
  */
-counters_t* index_get(index_t* idx, char* word);
+postings_t index_getImpacts(index_t* idx, const char* word);
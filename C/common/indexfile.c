@@ -0,0 +1,1096 @@
+/*
+ * indexfile.c - CS50 'indexfile' module
+ *
+ * This module writes and maps the binary index format. The layout is
+ *
+ *   header | section table | terms | words | dictionary hash | bounds | ids | counts
+ *
+ * or, for a compressed file,
+ *
+ *   header | section table | terms | words | dictionary hash | bounds | coded postings
+ *
+ * where the dictionary hash is a minimal perfect hash table (see mph.h)
+ * giving each word's entry in terms, so a lookup is a hash and a probe
+ * rather than a binary search; files without one are binary searched.
+ * A slot whose fingerprint doesn't match is rejected without reading
+ * its word; a match is confirmed against the stored word, so an absent
+ * word is never mistaken for another. The bounds are each word's
+ * largest count, by entry, as 32-bit integers; older files without them
+ * have none (indexfile_hasBounds). A positional file adds, before the
+ * postings,
+ *
+ *   firsts | position starts | positions
+ *
+ * giving each word's first posting, each posting's offset into the
+ * positions, and the coded positions themselves; they are indexed by
+ * posting so a single posting's positions can be found and decoded
+ * without touching the rest. A file with impacts adds
+ *
+ *   firsts | impact ids | impact counts
+ *
+ * with every word's postings again, reordered by impact (see impact.h),
+ * and a pruned file a small section recording how it was pruned.
+ * Every section starts on an 8-byte boundary. The section table
+ * records the kind, offset and length of each section, so later versions
+ * can add sections that older readers simply skip.
+ *
+ * Writing streams: the writer is told the sizes of the fixed sections up
+ * front, places every section, and then buffers each one separately,
+ * flushing with pwrite at the section's own offset. The header goes in
+ * last. Only the buffers and 8 bytes per word, the words' hashes for
+ * the dictionary hash built at the end, are held in memory, never the
+ * whole index.
+ *
+ * See indexfile.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mem.h"
+#include "codec.h"
+#include "impact.h"
+#include "mph.h"
+#include "indexfile.h"
+
+/**************** file-local constants ****************/
+static const char MAGIC[8] = { 'T', 'S', 'E', 'I', 'N', 'D', 'E', 'X' };
+static const uint32_t VERSION = 2;    // 2 added compressed postings
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// section kinds
+enum { SECTION_TERMS = 1, SECTION_WORDS = 2, SECTION_IDS = 3, SECTION_COUNTS = 4,
+       SECTION_CODED = 5, SECTION_FIRSTS = 6, SECTION_POSSTARTS = 7, SECTION_POSITIONS = 8,
+       SECTION_IMPACTIDS = 9, SECTION_IMPACTCOUNTS = 10, SECTION_PRUNING = 11,
+       SECTION_MPH = 12, SECTION_BOUNDS = 13 };
+#define MAX_SECTIONS 13
+
+/**************** file-local types ****************/
+// fixed header at offset 0
+typedef struct fileHeader {
+  char magic[8];          // MAGIC
+  uint32_t version;       // format version that wrote the file
+  uint32_t byteOrder;     // BYTE_ORDER_MARK in the writer's byte order
+  uint32_t numWords;      // entries in the terms section
+  uint32_t maxDocID;      // largest docID in any postings list
+  uint64_t numPostings;   // entries in each of the ids and counts sections
+  uint32_t numSections;   // entries in the section table that follows
+  uint32_t flags;         // INDEXFILE_* options the file was written with
+} fileHeader_t;
+
+// one entry of the section table
+typedef struct fileSection {
+  uint32_t kind;          // SECTION_* constant
+  uint32_t flags;         // reserved, 0 for now
+  uint64_t offset;        // byte offset of the section from file start
+  uint64_t length;        // byte length of the section
+} fileSection_t;
+
+// one dictionary entry; entries are sorted by word
+typedef struct fileTerm {
+  uint64_t start;         // index of the word's first posting
+                          // (byte offset of its coded postings if compressed)
+  uint32_t count;         // number of postings for the word
+  uint32_t word;          // offset of the word in the words section
+} fileTerm_t;
+
+// an opened, mapped file
+struct indexfile {
+  void* map;              // start of the mapping
+  size_t mapSize;         // length of the mapping
+  const fileHeader_t* header;
+  const fileTerm_t* terms;
+  const char* words;
+  uint64_t wordsLength;
+  const int32_t* ids;
+  const int32_t* counts;
+  const unsigned char* coded;
+  uint64_t codedLength;
+  const uint64_t* firsts;       // files with positions or impacts, else NULL
+  const uint64_t* posStarts;    // positional files only, else NULL
+  const unsigned char* positions;
+  uint64_t positionsLength;
+  const int32_t* impactIds;     // files with impacts only, else NULL
+  const int32_t* impactCounts;
+  const indexfile_pruning_t* pruning;   // pruned files only, else NULL
+  const void* mph;              // dictionary hash, NULL if missing or unusable
+  const uint32_t* bounds;       // each word's largest count, NULL if missing
+};
+
+// a section being written: bytes go to a buffer that is flushed to the
+// section's next offset in the file whenever it fills up
+typedef struct region {
+  uint64_t offset;        // where the buffered bytes go in the file
+  uint64_t limit;         // end of the section (UINT64_MAX if open-ended)
+  unsigned char* buf;
+  size_t used;
+} region_t;
+
+// the regions a writer fills; coded is only used for a compressed file,
+// the position regions for a positional one and the impact regions for
+// one with impacts, and pruning for a pruned one
+enum { REGION_TERMS, REGION_WORDS, REGION_IDS, REGION_COUNTS, REGION_CODED,
+       REGION_FIRSTS, REGION_POSSTARTS, REGION_POSITIONS,
+       REGION_IMPACTIDS, REGION_IMPACTCOUNTS, REGION_PRUNING, REGION_MPH, REGION_BOUNDS,
+       NUM_REGIONS };
+#define REGION_BYTES (1 << 20)
+
+// a file being written; see indexfile_writerNew
+struct indexfile_writer {
+  int fd;                 // on tempFilename, renamed to filename on close
+  char* filename;
+  char* tempFilename;
+  bool compressed;
+  bool positional;
+  bool impacts;
+  bool pruned;
+  bool ok;                // false after any failed write or bad call
+  fileHeader_t header;
+  fileSection_t sections[MAX_SECTIONS];
+  region_t regions[NUM_REGIONS];
+  uint64_t wordBytes;     // declared length of the words section
+  uint32_t wordsAdded;
+  uint64_t postingsAdded;
+  uint64_t wordPos;       // bytes of words written so far
+  uint64_t codedLength;   // bytes of coded postings written so far
+  uint64_t positionBytes; // declared length of the positions section
+  uint64_t positionsAdded;
+  unsigned char* scratch; // one list's coded postings
+  size_t scratchSize;
+  int* impactIds;         // one list in impact order
+  int* impactCounts;
+  int impactCapacity;
+  char* lastWord;         // previous word, to check the sort order
+  size_t lastCapacity;
+  uint64_t* hashes;       // mph_hash of every word added, for the dictionary hash
+};
+
+// totals gathered by the counting pass of indexfile_mergeWrite
+typedef struct mergeTotals {
+  int numWords;
+  uint64_t wordBytes;
+  uint64_t numPostings;
+  uint64_t positionBytes;
+} mergeTotals_t;
+
+// one file being merged: the position of its next word
+typedef struct cursor {
+  indexfile_t* file;
+  int pos;
+  int numWords;
+  int which;              // index into the files being merged
+} cursor_t;
+
+/**************** local functions ****************/
+static uint64_t align8(uint64_t offset);
+static void regionPut(indexfile_writer_t* writer, int which, const void* data, size_t length);
+static void regionFlush(indexfile_writer_t* writer, int which);
+static const fileSection_t* findSection(const fileSection_t* table, uint32_t numSections, uint32_t kind);
+static const char* termWord(indexfile_t* file, const fileTerm_t* term);
+static int findTerm(indexfile_t* file, const char* word);
+static postings_t termPostings(indexfile_t* file, uint32_t term);
+static bool cursorLess(const cursor_t* a, const cursor_t* b);
+static void siftDown(cursor_t** heap, int size, int i);
+static bool countWord(void* arg, const char* word, const postings_t* postings);
+static bool addWord(void* arg, const char* word, const postings_t* postings);
+
+/*********** indexfile_isBinary ***********/
+/* see indexfile.h for more details */
+bool indexfile_isBinary(const char* filename)
+{
+  FILE* fp;
+  if (filename == NULL || (fp = fopen(filename, "r")) == NULL) {
+    return false;
+  }
+  char magic[sizeof(MAGIC)];
+  bool binary = fread(magic, 1, sizeof(magic), fp) == sizeof(magic)
+                && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+  fclose(fp);
+  return binary;
+}
+
+/*********** indexfile_write ***********/
+/* see indexfile.h for more details */
+bool indexfile_write(const char* filename, int numWords,
+                     const char** words, const postings_t** lists, int options)
+{
+  if (filename == NULL || numWords < 0 || (numWords > 0 && (words == NULL || lists == NULL))) {
+    return false;
+  }
+  // the writer lays sections out up front, so it needs their sizes
+  uint64_t wordBytes = 0;
+  uint64_t numPostings = 0;
+  uint64_t positionBytes = 0;
+  for (int i = 0; i < numWords; i++) {
+    wordBytes += strlen(words[i]) + 1;
+    numPostings += lists[i]->size;
+    positionBytes += postings_positionBytes(lists[i]);
+  }
+  indexfile_writer_t* writer;
+  if ((writer = indexfile_writerNew(filename, numWords, wordBytes, numPostings,
+                                    positionBytes, options)) == NULL) {
+    return false;
+  }
+  for (int i = 0; i < numWords; i++) {
+    indexfile_writerAdd(writer, words[i], lists[i]);
+  }
+  return indexfile_writerClose(writer);
+}
+
+/*********** indexfile_writerNew ***********/
+/* see indexfile.h for more details */
+indexfile_writer_t* indexfile_writerNew(const char* filename, int numWords,
+                                        uint64_t wordBytes, uint64_t numPostings,
+                                        uint64_t positionBytes, int options)
+{
+  if (filename == NULL || numWords < 0) {
+    return NULL;
+  }
+  // written beside the file and renamed over it on close, so a reader
+  // that has the old file mapped never sees it truncated
+  char* tempFilename = mem_malloc_assert(strlen(filename) + sizeof(".tmp"), "Couldn't allocate file name");
+  sprintf(tempFilename, "%s.tmp", filename);
+  int fd;
+  if ((fd = open(tempFilename, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+    free(tempFilename);
+    return NULL;
+  }
+  indexfile_writer_t* writer = mem_calloc_assert(1, sizeof(indexfile_writer_t), "Couldn't allocate index writer");
+  writer->fd = fd;
+  writer->filename = mem_malloc_assert(strlen(filename) + 1, "Couldn't allocate file name");
+  strcpy(writer->filename, filename);
+  writer->tempFilename = tempFilename;
+  writer->ok = true;
+  writer->compressed = (options & INDEXFILE_COMPRESSED) != 0;
+  writer->positional = (options & INDEXFILE_POSITIONS) != 0;
+  writer->impacts = (options & INDEXFILE_IMPACTS) != 0;
+  writer->pruned = (options & INDEXFILE_PRUNED) != 0;
+  writer->wordBytes = wordBytes;
+  writer->positionBytes = positionBytes;
+  writer->hashes = mem_malloc_assert(((uint64_t) numWords + 1) * sizeof(uint64_t), "Couldn't allocate word hashes");
+
+  fileHeader_t* header = &writer->header;
+  memcpy(header->magic, MAGIC, sizeof(MAGIC));
+  header->version = VERSION;
+  header->byteOrder = BYTE_ORDER_MARK;
+  header->numWords = numWords;
+  header->numPostings = numPostings;
+  header->flags = (writer->compressed ? INDEXFILE_COMPRESSED : 0)
+                  | (writer->positional ? INDEXFILE_POSITIONS : 0)
+                  | (writer->impacts ? INDEXFILE_IMPACTS : 0)
+                  | (writer->pruned ? INDEXFILE_PRUNED : 0);
+
+  // the sections this file will hold, in file order; coded postings
+  // come last since their length is only known at the end
+  uint32_t kinds[MAX_SECTIONS];
+  uint64_t lengths[MAX_SECTIONS];
+  int regionOf[MAX_SECTIONS];
+  int n = 0;
+  kinds[n] = SECTION_TERMS;  lengths[n] = (uint64_t) numWords * sizeof(fileTerm_t);  regionOf[n++] = REGION_TERMS;
+  kinds[n] = SECTION_WORDS;  lengths[n] = wordBytes;                                regionOf[n++] = REGION_WORDS;
+  kinds[n] = SECTION_MPH;    lengths[n] = mph_bytes(numWords);                      regionOf[n++] = REGION_MPH;
+  kinds[n] = SECTION_BOUNDS; lengths[n] = (uint64_t) numWords * sizeof(uint32_t);   regionOf[n++] = REGION_BOUNDS;
+  if (writer->positional || writer->impacts) {
+    kinds[n] = SECTION_FIRSTS;    lengths[n] = (uint64_t) numWords * sizeof(uint64_t); regionOf[n++] = REGION_FIRSTS;
+  }
+  if (writer->positional) {
+    kinds[n] = SECTION_POSSTARTS; lengths[n] = numPostings * sizeof(uint64_t);       regionOf[n++] = REGION_POSSTARTS;
+    kinds[n] = SECTION_POSITIONS; lengths[n] = positionBytes;                        regionOf[n++] = REGION_POSITIONS;
+  }
+  if (writer->impacts) {
+    kinds[n] = SECTION_IMPACTIDS;    lengths[n] = numPostings * sizeof(int32_t);     regionOf[n++] = REGION_IMPACTIDS;
+    kinds[n] = SECTION_IMPACTCOUNTS; lengths[n] = numPostings * sizeof(int32_t);     regionOf[n++] = REGION_IMPACTCOUNTS;
+  }
+  if (writer->pruned) {
+    kinds[n] = SECTION_PRUNING; lengths[n] = sizeof(indexfile_pruning_t);            regionOf[n++] = REGION_PRUNING;
+  }
+  if (writer->compressed) {
+    kinds[n] = SECTION_CODED;  lengths[n] = 0;                                      regionOf[n++] = REGION_CODED;
+  } else {
+    kinds[n] = SECTION_IDS;    lengths[n] = numPostings * sizeof(int32_t);          regionOf[n++] = REGION_IDS;
+    kinds[n] = SECTION_COUNTS; lengths[n] = numPostings * sizeof(int32_t);          regionOf[n++] = REGION_COUNTS;
+  }
+  header->numSections = n;
+
+  // lay the sections out one after another on 8-byte boundaries
+  uint64_t offset = align8(sizeof(fileHeader_t) + n * sizeof(fileSection_t));
+  for (int i = 0; i < n; i++) {
+    writer->sections[i].kind = kinds[i];
+    writer->sections[i].offset = offset;
+    writer->sections[i].length = lengths[i];
+    region_t* region = &writer->regions[regionOf[i]];
+    region->offset = offset;
+    region->limit = kinds[i] == SECTION_CODED ? UINT64_MAX : offset + lengths[i];
+    region->buf = mem_malloc_assert(REGION_BYTES, "Couldn't allocate index writer buffer");
+    offset = align8(offset + lengths[i]);
+  }
+  return writer;
+}
+
+/*********** indexfile_writerAdd ***********/
+/* see indexfile.h for more details */
+bool indexfile_writerAdd(indexfile_writer_t* writer, const char* word, const postings_t* postings)
+{
+  if (writer == NULL || word == NULL || postings == NULL) {
+    return false;
+  }
+  size_t length = strlen(word) + 1;
+  if (writer->wordsAdded == writer->header.numWords
+      || writer->wordPos + length > writer->wordBytes
+      || writer->postingsAdded + postings->size > writer->header.numPostings
+      || (writer->wordsAdded > 0 && strcmp(writer->lastWord, word) >= 0)
+      || (writer->positional && postings->size > 0 && !postings_hasPositions(postings))) {
+    writer->ok = false;
+    return false;
+  }
+
+  fileTerm_t term;
+  term.count = postings->size;
+  term.word = writer->wordPos;
+  if (writer->compressed) {
+    size_t needed = codec_maxBytes(postings->size);
+    if (needed > writer->scratchSize) {
+      free(writer->scratch);
+      writer->scratch = mem_malloc_assert(needed, "Couldn't allocate coded postings");
+      writer->scratchSize = needed;
+    }
+    size_t coded = codec_encode(postings->ids, postings->counts, postings->size, writer->scratch);
+    term.start = writer->codedLength;
+    regionPut(writer, REGION_CODED, writer->scratch, coded);
+    writer->codedLength += coded;
+  } else {
+    term.start = writer->postingsAdded;
+    regionPut(writer, REGION_IDS, postings->ids, postings->size * sizeof(int32_t));
+    regionPut(writer, REGION_COUNTS, postings->counts, postings->size * sizeof(int32_t));
+  }
+  if (writer->positional || writer->impacts) {
+    regionPut(writer, REGION_FIRSTS, &writer->postingsAdded, sizeof(uint64_t));
+  }
+  if (writer->positional) {
+    // copy the list's coded positions as they are, rebasing their starts
+    uint64_t bytes = postings_positionBytes(postings);
+    if (postings->size > 0 && bytes == 0) {
+      writer->ok = false;
+      return false;
+    }
+    for (int i = 0; i < postings->size; i++) {
+      uint64_t start = writer->positionsAdded + (postings->posStarts[i] - postings->posStarts[0]);
+      regionPut(writer, REGION_POSSTARTS, &start, sizeof(start));
+    }
+    if (bytes > 0) {
+      regionPut(writer, REGION_POSITIONS, postings->positions + postings->posStarts[0], bytes);
+    }
+    writer->positionsAdded += bytes;
+  }
+  if (writer->impacts) {
+    if (postings->size > writer->impactCapacity) {
+      free(writer->impactIds);
+      free(writer->impactCounts);
+      writer->impactCapacity = postings->size * 2;
+      writer->impactIds = mem_malloc_assert(writer->impactCapacity * sizeof(int), "Couldn't allocate impacts");
+      writer->impactCounts = mem_malloc_assert(writer->impactCapacity * sizeof(int), "Couldn't allocate impacts");
+    }
+    impact_order(postings, writer->impactIds, writer->impactCounts);
+    regionPut(writer, REGION_IMPACTIDS, writer->impactIds, postings->size * sizeof(int32_t));
+    regionPut(writer, REGION_IMPACTCOUNTS, writer->impactCounts, postings->size * sizeof(int32_t));
+  }
+  uint32_t bound = 0;
+  for (int i = 0; i < postings->size; i++) {
+    if (postings->counts[i] > 0 && (uint32_t) postings->counts[i] > bound) {
+      bound = postings->counts[i];
+    }
+  }
+  regionPut(writer, REGION_BOUNDS, &bound, sizeof(bound));
+  regionPut(writer, REGION_TERMS, &term, sizeof(term));
+  regionPut(writer, REGION_WORDS, word, length);
+  writer->hashes[writer->wordsAdded] = mph_hash(word);
+
+  writer->wordsAdded++;
+  writer->wordPos += length;
+  writer->postingsAdded += postings->size;
+  if (postings->size > 0 && postings->ids[postings->size - 1] > (int) writer->header.maxDocID) {
+    writer->header.maxDocID = postings->ids[postings->size - 1];
+  }
+  if (length > writer->lastCapacity) {
+    free(writer->lastWord);
+    writer->lastCapacity = length * 2;
+    writer->lastWord = mem_malloc_assert(writer->lastCapacity, "Couldn't allocate index writer word");
+  }
+  memcpy(writer->lastWord, word, length);
+  return writer->ok;
+}
+
+/*********** indexfile_writerPruning ***********/
+/* see indexfile.h for more details */
+bool indexfile_writerPruning(indexfile_writer_t* writer, const indexfile_pruning_t* pruning)
+{
+  if (writer == NULL || pruning == NULL || !writer->pruned) {
+    return false;
+  }
+  regionPut(writer, REGION_PRUNING, pruning, sizeof(indexfile_pruning_t));
+  return writer->ok;
+}
+
+/*********** indexfile_writerClose ***********/
+/* see indexfile.h for more details */
+bool indexfile_writerClose(indexfile_writer_t* writer)
+{
+  if (writer == NULL) {
+    return false;
+  }
+  // with every word in, the dictionary hash can be built
+  if (writer->wordsAdded == writer->header.numWords) {
+    uint64_t bytes = mph_bytes(writer->header.numWords);
+    void* table = mem_malloc_assert(bytes, "Couldn't allocate dictionary hash");
+    mph_build(writer->hashes, writer->header.numWords, table);
+    regionPut(writer, REGION_MPH, table, bytes);
+    free(table);
+  }
+  for (int i = 0; i < NUM_REGIONS; i++) {
+    if (writer->regions[i].buf != NULL) {
+      regionFlush(writer, i);
+      free(writer->regions[i].buf);
+    }
+  }
+  // everything declared up front must have been added
+  bool ok = writer->ok
+            && writer->wordsAdded == writer->header.numWords
+            && writer->wordPos == writer->wordBytes
+            && writer->postingsAdded == writer->header.numPostings
+            && writer->positionsAdded == writer->positionBytes;
+
+  // the header and section table go in last, once every length is known
+  uint64_t end = 0;
+  for (uint32_t i = 0; i < writer->header.numSections; i++) {
+    if (writer->sections[i].kind == SECTION_CODED) {
+      writer->sections[i].length = writer->codedLength;
+    }
+    end = writer->sections[i].offset + writer->sections[i].length;
+  }
+  size_t tableLength = writer->header.numSections * sizeof(fileSection_t);
+  ok = ok
+       && pwrite(writer->fd, &writer->header, sizeof(fileHeader_t), 0) == sizeof(fileHeader_t)
+       && pwrite(writer->fd, writer->sections, tableLength, sizeof(fileHeader_t)) == (ssize_t) tableLength
+       && ftruncate(writer->fd, align8(end)) == 0
+       && fsync(writer->fd) == 0;     // the rename below must not land before the data does
+  if (close(writer->fd) != 0) {
+    ok = false;
+  }
+  if (!ok || rename(writer->tempFilename, writer->filename) != 0) {
+    unlink(writer->tempFilename);
+    ok = false;
+  }
+  free(writer->filename);
+  free(writer->tempFilename);
+  free(writer->scratch);
+  free(writer->impactIds);
+  free(writer->impactCounts);
+  free(writer->lastWord);
+  free(writer->hashes);
+  free(writer);
+  return ok;
+}
+
+/*********** indexfile_open ***********/
+/* see indexfile.h for more details */
+indexfile_t* indexfile_open(const char* filename)
+{
+  int fd;
+  if (filename == NULL || (fd = open(filename, O_RDONLY)) < 0) {
+    return NULL;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(fileHeader_t)) {
+    close(fd);
+    return NULL;
+  }
+  size_t size = info.st_size;
+  void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);     // the mapping keeps the file alive
+  if (map == MAP_FAILED) {
+    return NULL;
+  }
+
+  const fileHeader_t* header = map;
+  const fileSection_t* table = (const fileSection_t*) (header + 1);
+  if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0
+      || header->byteOrder != BYTE_ORDER_MARK
+      || header->version == 0 || header->version > VERSION
+      || sizeof(fileHeader_t) + (uint64_t) header->numSections * sizeof(fileSection_t) > size) {
+    munmap(map, size);
+    return NULL;
+  }
+
+  // every section must lie inside the file
+  for (uint32_t i = 0; i < header->numSections; i++) {
+    if (table[i].offset % 8 != 0 || table[i].offset > size || table[i].length > size - table[i].offset) {
+      munmap(map, size);
+      return NULL;
+    }
+  }
+  const fileSection_t* terms = findSection(table, header->numSections, SECTION_TERMS);
+  const fileSection_t* words = findSection(table, header->numSections, SECTION_WORDS);
+  const fileSection_t* ids = findSection(table, header->numSections, SECTION_IDS);
+  const fileSection_t* counts = findSection(table, header->numSections, SECTION_COUNTS);
+  const fileSection_t* coded = findSection(table, header->numSections, SECTION_CODED);
+  const fileSection_t* firsts = findSection(table, header->numSections, SECTION_FIRSTS);
+  const fileSection_t* posStarts = findSection(table, header->numSections, SECTION_POSSTARTS);
+  const fileSection_t* positions = findSection(table, header->numSections, SECTION_POSITIONS);
+  const fileSection_t* impactIds = findSection(table, header->numSections, SECTION_IMPACTIDS);
+  const fileSection_t* impactCounts = findSection(table, header->numSections, SECTION_IMPACTCOUNTS);
+  const fileSection_t* pruning = findSection(table, header->numSections, SECTION_PRUNING);
+  const fileSection_t* mph = findSection(table, header->numSections, SECTION_MPH);
+  const fileSection_t* bounds = findSection(table, header->numSections, SECTION_BOUNDS);
+  bool compressed = (header->flags & INDEXFILE_COMPRESSED) != 0;
+  bool positional = (header->flags & INDEXFILE_POSITIONS) != 0;
+  bool impacts = (header->flags & INDEXFILE_IMPACTS) != 0;
+  bool pruned = (header->flags & INDEXFILE_PRUNED) != 0;
+  bool postingsOk = compressed
+    ? coded != NULL
+    : (ids != NULL && counts != NULL
+       && ids->length == header->numPostings * sizeof(int32_t)
+       && counts->length == header->numPostings * sizeof(int32_t));
+  bool firstsOk = !(positional || impacts)
+    || (firsts != NULL && firsts->length == (uint64_t) header->numWords * sizeof(uint64_t));
+  bool positionsOk = !positional
+    || (posStarts != NULL && positions != NULL
+        && posStarts->length == header->numPostings * sizeof(uint64_t));
+  bool impactsOk = !impacts
+    || (impactIds != NULL && impactCounts != NULL
+        && impactIds->length == header->numPostings * sizeof(int32_t)
+        && impactCounts->length == header->numPostings * sizeof(int32_t));
+  bool pruningOk = !pruned || (pruning != NULL && pruning->length == sizeof(indexfile_pruning_t));
+  if (terms == NULL || words == NULL || !postingsOk || !firstsOk || !positionsOk || !impactsOk || !pruningOk
+      || terms->length != (uint64_t) header->numWords * sizeof(fileTerm_t)
+      || (words->length > 0 && ((const char*) map)[words->offset + words->length - 1] != '\0')) {
+    munmap(map, size);
+    return NULL;
+  }
+
+  indexfile_t* file = mem_calloc_assert(1, sizeof(indexfile_t), "Couldn't allocate indexfile");
+  file->map = map;
+  file->mapSize = size;
+  file->header = header;
+  file->terms = (const fileTerm_t*) ((const char*) map + terms->offset);
+  file->words = (const char*) map + words->offset;
+  file->wordsLength = words->length;
+  if (compressed) {
+    file->coded = (const unsigned char*) map + coded->offset;
+    file->codedLength = coded->length;
+  } else {
+    file->ids = (const int32_t*) ((const char*) map + ids->offset);
+    file->counts = (const int32_t*) ((const char*) map + counts->offset);
+  }
+  if (positional || impacts) {
+    file->firsts = (const uint64_t*) ((const char*) map + firsts->offset);
+  }
+  if (positional) {
+    file->posStarts = (const uint64_t*) ((const char*) map + posStarts->offset);
+    file->positions = (const unsigned char*) map + positions->offset;
+    file->positionsLength = positions->length;
+  }
+  if (impacts) {
+    file->impactIds = (const int32_t*) ((const char*) map + impactIds->offset);
+    file->impactCounts = (const int32_t*) ((const char*) map + impactCounts->offset);
+  }
+  if (pruned) {
+    file->pruning = (const indexfile_pruning_t*) ((const char*) map + pruning->offset);
+  }
+  if (mph != NULL && mph_valid((const char*) map + mph->offset, mph->length, header->numWords)) {
+    file->mph = (const char*) map + mph->offset;
+  }
+  if (bounds != NULL && bounds->length == (uint64_t) header->numWords * sizeof(uint32_t)) {
+    file->bounds = (const uint32_t*) ((const char*) map + bounds->offset);
+  }
+  return file;
+}
+
+/*********** indexfile_find ***********/
+/* see indexfile.h for more details */
+bool indexfile_find(indexfile_t* file, const char* word, postings_t* postings)
+{
+  if (postings != NULL) {
+    *postings = postings_view(NULL, NULL, 0);
+  }
+  if (file == NULL || word == NULL || postings == NULL) {
+    return false;
+  }
+  int term;
+  if ((term = findTerm(file, word)) < 0) {
+    return false;
+  }
+  *postings = termPostings(file, term);
+  return true;
+}
+
+/*********** indexfile_findImpacts ***********/
+/* see indexfile.h for more details */
+bool indexfile_findImpacts(indexfile_t* file, const char* word, postings_t* impacts)
+{
+  if (impacts != NULL) {
+    *impacts = postings_view(NULL, NULL, 0);
+  }
+  if (file == NULL || word == NULL || impacts == NULL || file->impactIds == NULL) {
+    return false;
+  }
+  int term;
+  if ((term = findTerm(file, word)) < 0) {
+    return false;
+  }
+  uint64_t first = file->firsts[term];
+  uint32_t count = file->terms[term].count;
+  if (first <= file->header->numPostings && count <= file->header->numPostings - first) {
+    *impacts = postings_view(file->impactIds + first, file->impactCounts + first, count);
+  }
+  return true;
+}
+
+/*********** indexfile_numWords ***********/
+/* see indexfile.h for more details */
+int indexfile_numWords(indexfile_t* file)
+{
+  return file == NULL ? 0 : file->header->numWords;
+}
+
+/*********** indexfile_maxDocID ***********/
+/* see indexfile.h for more details */
+int indexfile_maxDocID(indexfile_t* file)
+{
+  return file == NULL ? 0 : file->header->maxDocID;
+}
+
+/*********** indexfile_isCompressed ***********/
+/* see indexfile.h for more details */
+bool indexfile_isCompressed(indexfile_t* file)
+{
+  return file != NULL && file->coded != NULL;
+}
+
+/*********** indexfile_hasPositions ***********/
+/* see indexfile.h for more details */
+bool indexfile_hasPositions(indexfile_t* file)
+{
+  return file != NULL && file->positions != NULL;
+}
+
+/*********** indexfile_hasImpacts ***********/
+/* see indexfile.h for more details */
+bool indexfile_hasImpacts(indexfile_t* file)
+{
+  return file != NULL && file->impactIds != NULL;
+}
+
+/*********** indexfile_pruning ***********/
+/* see indexfile.h for more details */
+bool indexfile_pruning(indexfile_t* file, indexfile_pruning_t* pruning)
+{
+  if (file == NULL || file->pruning == NULL || pruning == NULL) {
+    return false;
+  }
+  *pruning = *file->pruning;
+  return true;
+}
+
+/*********** indexfile_isHashed ***********/
+/* see indexfile.h for more details */
+bool indexfile_isHashed(indexfile_t* file)
+{
+  return file != NULL && file->mph != NULL;
+}
+
+/*********** indexfile_lookup ***********/
+/* see indexfile.h for more details */
+int indexfile_lookup(indexfile_t* file, const char* word)
+{
+  return file == NULL || word == NULL ? -1 : findTerm(file, word);
+}
+
+/*********** indexfile_frequency ***********/
+/* see indexfile.h for more details */
+int indexfile_frequency(indexfile_t* file, const char* word)
+{
+  int term = indexfile_lookup(file, word);
+  return term < 0 ? 0 : (int) file->terms[term].count;
+}
+
+/*********** indexfile_hasBounds ***********/
+/* see indexfile.h for more details */
+bool indexfile_hasBounds(indexfile_t* file)
+{
+  return file != NULL && file->bounds != NULL;
+}
+
+/*********** indexfile_bound ***********/
+/* see indexfile.h for more details */
+int indexfile_bound(indexfile_t* file, const char* word)
+{
+  int term = indexfile_hasBounds(file) ? indexfile_lookup(file, word) : -1;
+  return term < 0 ? 0 : (int) file->bounds[term];
+}
+
+/*********** indexfile_word ***********/
+/* see indexfile.h for more details */
+const char* indexfile_word(indexfile_t* file, int i)
+{
+  if (file == NULL || i < 0 || (uint32_t) i >= file->header->numWords) {
+    return NULL;
+  }
+  return termWord(file, &file->terms[i]);
+}
+
+/*********** indexfile_postings ***********/
+/* see indexfile.h for more details */
+postings_t indexfile_postings(indexfile_t* file, int i)
+{
+  if (file == NULL || i < 0 || (uint32_t) i >= file->header->numWords) {
+    return postings_view(NULL, NULL, 0);
+  }
+  return termPostings(file, i);
+}
+
+/*********** indexfile_iterate ***********/
+/* see indexfile.h for more details */
+void indexfile_iterate(indexfile_t* file, void* arg,
+                       void (*itemfunc)(void* arg, const char* word,
+                                        const postings_t* postings))
+{
+  if (file == NULL || itemfunc == NULL) {
+    return;
+  }
+  for (uint32_t i = 0; i < file->header->numWords; i++) {
+    const char* word = termWord(file, &file->terms[i]);
+    if (word != NULL) {
+      postings_t postings = termPostings(file, i);
+      itemfunc(arg, word, &postings);
+      postings_release(&postings);
+    }
+  }
+}
+
+/*********** indexfile_merge ***********/
+/* see indexfile.h for more details */
+bool indexfile_merge(indexfile_t** files, int numFiles, void* arg,
+                     bool (*itemfunc)(void* arg, const char* word, const postings_t* postings))
+{
+  if (files == NULL || numFiles < 0 || itemfunc == NULL) {
+    return false;
+  }
+  cursor_t* cursors = mem_calloc_assert(numFiles + 1, sizeof(cursor_t), "Couldn't allocate merge");
+  cursor_t** heap = mem_calloc_assert(numFiles + 1, sizeof(cursor_t*), "Couldn't allocate merge");
+  cursor_t** same = mem_calloc_assert(numFiles + 1, sizeof(cursor_t*), "Couldn't allocate merge");
+  postings_t* parts = mem_calloc_assert(numFiles + 1, sizeof(postings_t), "Couldn't allocate merge");
+  postings_t merged = postings_view(NULL, NULL, 0);
+  bool ok = true;
+
+  // heap up the files with words
+  int size = 0;
+  for (int i = 0; ok && i < numFiles; i++) {
+    if ((cursors[i].file = files[i]) == NULL) {
+      ok = false;
+      break;
+    }
+    cursors[i].numWords = indexfile_numWords(cursors[i].file);
+    cursors[i].which = i;
+    if (cursors[i].numWords > 0) {
+      heap[size++] = &cursors[i];
+    }
+  }
+  for (int i = size / 2 - 1; i >= 0; i--) {
+    siftDown(heap, size, i);
+  }
+
+  while (ok && size > 0) {
+    // take every cursor on the smallest word; they come off in file order
+    const char* word = indexfile_word(heap[0]->file, heap[0]->pos);
+    int numSame = 0;
+    while (size > 0 && strcmp(indexfile_word(heap[0]->file, heap[0]->pos), word) == 0) {
+      same[numSame++] = heap[0];
+      heap[0] = heap[--size];
+      siftDown(heap, size, 0);
+    }
+
+    // concatenate the word's lists; a word in one file is passed as is
+    if (numSame == 1) {
+      postings_t list = indexfile_postings(same[0]->file, same[0]->pos);
+      ok = itemfunc(arg, word, &list);
+      postings_release(&list);
+    } else {
+      merged.size = 0;
+      merged.posLength = 0;
+      for (int i = 0; i < numSame; i++) {
+        parts[i] = indexfile_postings(same[i]->file, same[i]->pos);
+        postings_append(&merged, &parts[i]);
+        postings_release(&parts[i]);
+      }
+      ok = itemfunc(arg, word, &merged);
+    }
+
+    // move those cursors on and put back the ones with words left
+    for (int i = 0; i < numSame; i++) {
+      cursor_t* cursor = same[i];
+      if (++cursor->pos < cursor->numWords) {
+        int child = size++;
+        heap[child] = cursor;
+        // sift up
+        while (child > 0 && cursorLess(heap[child], heap[(child - 1) / 2])) {
+          cursor_t* parent = heap[(child - 1) / 2];
+          heap[(child - 1) / 2] = heap[child];
+          heap[child] = parent;
+          child = (child - 1) / 2;
+        }
+      }
+    }
+  }
+
+  postings_release(&merged);
+  free(cursors);
+  free(heap);
+  free(same);
+  free(parts);
+  return ok;
+}
+
+/*********** indexfile_mergeWrite ***********/
+/* see indexfile.h for more details */
+bool indexfile_mergeWrite(const char* filename, indexfile_t** files, int numFiles, int options)
+{
+  // the writer needs its sizes up front, so merge once to count them
+  mergeTotals_t totals = { 0, 0, 0, 0 };
+  if (filename == NULL || !indexfile_merge(files, numFiles, &totals, countWord)) {
+    return false;
+  }
+  // positions survive only if every file has them; a merge has no
+  // pruning settings to record
+  options &= ~(INDEXFILE_POSITIONS | INDEXFILE_PRUNED);
+  bool positional = numFiles > 0;
+  for (int i = 0; i < numFiles; i++) {
+    positional = positional && indexfile_hasPositions(files[i]);
+  }
+  if (positional) {
+    options |= INDEXFILE_POSITIONS;
+  }
+  // impacts are rebuilt from the merged lists, so they are kept if every
+  // file has them and added if options asks for them
+  bool impacts = numFiles > 0;
+  for (int i = 0; i < numFiles; i++) {
+    impacts = impacts && indexfile_hasImpacts(files[i]);
+  }
+  if (impacts) {
+    options |= INDEXFILE_IMPACTS;
+  }
+  indexfile_writer_t* writer = indexfile_writerNew(filename, totals.numWords, totals.wordBytes,
+                                                   totals.numPostings, totals.positionBytes, options);
+  if (writer == NULL) {
+    return false;
+  }
+  bool merged = indexfile_merge(files, numFiles, writer, addWord);
+  return indexfile_writerClose(writer) && merged;
+}
+
+/*********** indexfile_close ***********/
+/* see indexfile.h for more details */
+void indexfile_close(indexfile_t* file)
+{
+  if (file != NULL) {
+    munmap(file->map, file->mapSize);
+    free(file);
+  }
+}
+
+/*********** align8 ***********/
+/* Rounds offset up to a multiple of 8 */
+static uint64_t align8(uint64_t offset)
+{
+  return (offset + 7) & ~(uint64_t) 7;
+}
+
+/*********** regionPut ***********/
+/* Appends length bytes to one of the writer's sections */
+static void regionPut(indexfile_writer_t* writer, int which, const void* data, size_t length)
+{
+  region_t* region = &writer->regions[which];
+  if (region->offset + region->used + length > region->limit) {
+    writer->ok = false;         // more than was declared for the section
+    return;
+  }
+  if (region->used + length > REGION_BYTES) {
+    regionFlush(writer, which);
+  }
+  if (length > REGION_BYTES) {
+    // too big to buffer: write it straight through
+    if (pwrite(writer->fd, data, length, region->offset) != (ssize_t) length) {
+      writer->ok = false;
+    }
+    region->offset += length;
+    return;
+  }
+  memcpy(region->buf + region->used, data, length);
+  region->used += length;
+}
+
+/*********** regionFlush ***********/
+/* Writes a section's buffered bytes to their place in the file */
+static void regionFlush(indexfile_writer_t* writer, int which)
+{
+  region_t* region = &writer->regions[which];
+  if (region->used > 0
+      && pwrite(writer->fd, region->buf, region->used, region->offset) != (ssize_t) region->used) {
+    writer->ok = false;
+  }
+  region->offset += region->used;
+  region->used = 0;
+}
+
+/*********** findSection ***********/
+/* Returns the first section of the given kind, or NULL */
+static const fileSection_t* findSection(const fileSection_t* table, uint32_t numSections, uint32_t kind)
+{
+  for (uint32_t i = 0; i < numSections; i++) {
+    if (table[i].kind == kind) {
+      return &table[i];
+    }
+  }
+  return NULL;
+}
+
+/*********** termWord ***********/
+/* Returns the word of a dictionary entry, or NULL if its offset is bad */
+static const char* termWord(indexfile_t* file, const fileTerm_t* term)
+{
+  return term->word < file->wordsLength ? file->words + term->word : NULL;
+}
+
+/*********** findTerm ***********/
+/* Returns the word's dictionary entry, or -1: through the dictionary
+ * hash if the file has one, by binary search otherwise
+ */
+static int findTerm(indexfile_t* file, const char* word)
+{
+  if (file->mph != NULL) {
+    // the one entry the word can have, unless its fingerprint rules it
+    // out; a word that isn't in the file can still match a fingerprint,
+    // so the entry's word is compared before it is taken
+    int64_t term = mph_find(file->mph, mph_hash(word));
+    if (term < 0 || term >= file->header->numWords) {
+      return -1;
+    }
+    const char* termText = termWord(file, &file->terms[term]);
+    return termText != NULL && strcmp(word, termText) == 0 ? (int) term : -1;
+  }
+  int low = 0;
+  int high = (int) file->header->numWords - 1;
+  while (low <= high) {
+    int mid = low + (high - low) / 2;
+    const char* midWord = termWord(file, &file->terms[mid]);
+    int cmp = midWord == NULL ? -1 : strcmp(word, midWord);
+    if (cmp == 0) {
+      return mid;
+    } else if (cmp < 0) {
+      high = mid - 1;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return -1;
+}
+
+/*********** termPostings ***********/
+/* Returns dictionary entry term's postings: a view into the mapping,
+ * or a decoded list for a compressed file. The list is empty if the
+ * entry points outside the file or its coded bytes are malformed.
+ */
+static postings_t termPostings(indexfile_t* file, uint32_t term)
+{
+  const fileTerm_t* entry = &file->terms[term];
+  postings_t postings = postings_view(NULL, NULL, 0);
+
+  if (file->coded == NULL) {
+    if (entry->start <= file->header->numPostings
+        && entry->count <= file->header->numPostings - entry->start) {
+      postings = postings_view(file->ids + entry->start, file->counts + entry->start, entry->count);
+    }
+  } else {
+    // coded postings run up to the next word's (words are stored in order)
+    uint64_t end = term + 1 < file->header->numWords ? file->terms[term + 1].start : file->codedLength;
+    if (entry->count == 0 || entry->start > end || end > file->codedLength) {
+      return postings;
+    }
+    postings_reserve(&postings, entry->count);
+    if (codec_decode(file->coded + entry->start, end - entry->start, entry->count,
+                     postings.ids, postings.counts)) {
+      postings.size = entry->count;
+    } else {
+      postings_release(&postings);
+    }
+  }
+
+  // positions stay in the mapping; only their starts are looked up here
+  uint64_t first = file->firsts != NULL ? file->firsts[term] : 0;
+  if (file->positions != NULL && postings.size > 0
+      && first <= file->header->numPostings && postings.size <= file->header->numPostings - first) {
+    postings.positions = (unsigned char*) file->positions;
+    postings.posStarts = (uint64_t*) file->posStarts + first;
+    postings.posLength = file->positionsLength;
+  }
+  return postings;
+}
+
+/*********** cursorLess ***********/
+/* Merge heap order: by current word, then by file */
+static bool cursorLess(const cursor_t* a, const cursor_t* b)
+{
+  int cmp = strcmp(indexfile_word(a->file, a->pos), indexfile_word(b->file, b->pos));
+  return cmp < 0 || (cmp == 0 && a->which < b->which);
+}
+
+/*********** siftDown ***********/
+/* Restores the heap below position i */
+static void siftDown(cursor_t** heap, int size, int i)
+{
+  for (;;) {
+    int smallest = i;
+    int left = 2 * i + 1;
+    int right = left + 1;
+    if (left < size && cursorLess(heap[left], heap[smallest])) {
+      smallest = left;
+    }
+    if (right < size && cursorLess(heap[right], heap[smallest])) {
+      smallest = right;
+    }
+    if (smallest == i) {
+      return;
+    }
+    cursor_t* swap = heap[i];
+    heap[i] = heap[smallest];
+    heap[smallest] = swap;
+    i = smallest;
+  }
+}
+
+/*********** countWord ***********/
+/* indexfile_merge helper for the counting pass of indexfile_mergeWrite */
+static bool countWord(void* arg, const char* word, const postings_t* postings)
+{
+  mergeTotals_t* totals = (mergeTotals_t*) arg;
+  totals->numWords++;
+  totals->wordBytes += strlen(word) + 1;
+  totals->numPostings += postings->size;
+  totals->positionBytes += postings_positionBytes(postings);
+  return true;
+}
+
+/*********** addWord ***********/
+/* indexfile_merge helper for the writing pass of indexfile_mergeWrite */
+static bool addWord(void* arg, const char* word, const postings_t* postings)
+{
+  return indexfile_writerAdd((indexfile_writer_t*) arg, word, postings);
+}
@@ -0,0 +1,314 @@
+/*
+ * indexfile.h - header file for CS50 'indexfile' module
+ *
+ * An *indexfile* is the binary, memory-mappable form of a saved index.
+ * The file starts with a versioned header and a table of sections:
+ * a term dictionary sorted by word, the word text, and the docIDs and
+ * counts of every word stored back to back in two contiguous arrays.
+ * Every file written also holds each word's largest count, the bound
+ * on what the word adds to any document's score that top-k queries
+ * prune with (see maxscore.h), and a minimal perfect hash of its words
+ * (see mph.h), with a 32-bit fingerprint of each; a fingerprint match
+ * is confirmed against the stored word, so a word not in the file is
+ * never taken for another. Opening a file maps it read-only; lookups
+ * hash the word to its one possible dictionary entry (files without the
+ * hash binary search the dictionary instead) and hand back postings
+ * views that point straight into the mapping, so nothing is parsed or
+ * copied at load time.
+ *
+ * With INDEXFILE_COMPRESSED the two arrays are replaced by one section
+ * of postings compressed with the codec module; lookups then decode the
+ * word's postings into memory owned by the returned list.
+ *
+ * With INDEXFILE_POSITIONS the file also holds every posting's word
+ * positions (see postings.h). Lists handed out then carry them as a view
+ * into the mapping, and a posting's positions are only decoded when
+ * asked for.
+ *
+ * With INDEXFILE_IMPACTS the file also holds every word's postings a
+ * second time, in impact order (see impact.h), for queries that only
+ * want the best few documents.
+ *
+ * With INDEXFILE_PRUNED the file records how its postings were pruned
+ * (see prune.h), in a section of its own.
+ *
+ * Numbers are stored in the byte order of the machine that wrote the
+ * file; a file written on a machine with the other byte order is rejected.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __INDEXFILE_H
+#define __INDEXFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "postings.h"
+
+/********* Global Types ***********/
+typedef struct indexfile indexfile_t;
+typedef struct indexfile_writer indexfile_writer_t;
+
+// how a pruned file was pruned, as stored in it
+typedef struct indexfile_pruning {
+  uint32_t mode;            // INDEXFILE_PRUNE_* constant
+  uint32_t keep;            // best postings every word kept whatever its counts
+  double value;             // fraction of a word's top count, or percent of postings
+  uint32_t threshold;       // smallest count kept past a word's best (global mode)
+  uint32_t reserved;
+  uint64_t postingsBefore;  // postings in the full index
+  uint64_t postingsAfter;   // postings kept
+} indexfile_pruning_t;
+
+/********* Write options (may be or'ed together) ***********/
+#define INDEXFILE_COMPRESSED 0x1    // delta/varint compressed postings
+#define INDEXFILE_POSITIONS 0x2     // word positions for every posting
+#define INDEXFILE_IMPACTS 0x4       // postings in impact order as well
+#define INDEXFILE_PRUNED 0x8        // pruning settings (indexfile_writerPruning)
+
+/********* Pruning modes ***********/
+#define INDEXFILE_PRUNE_TERM 1      // by a fraction of each word's top count
+#define INDEXFILE_PRUNE_GLOBAL 2    // by one count threshold, to a target size
+
+/********** Functions ***********/
+
+/*********** indexfile_isBinary ***********/
+/* Returns true if filename can be read and starts with the
+ * binary index magic number, false otherwise
+ */
+bool indexfile_isBinary(const char* filename);
+
+/*********** indexfile_write ***********/
+/* Writes a binary index file
+ *
+ * Caller provides:
+ *   The file to create, the number of words, an array of the words
+ *   sorted by strcmp, the postings list for each word, and
+ *   INDEXFILE_* options or'ed together (0 for none)
+ * We return:
+ *   true if the whole file was written, false otherwise; with
+ *   INDEXFILE_POSITIONS, false if a non-empty list has no positions
+ */
+bool indexfile_write(const char* filename, int numWords,
+                     const char** words, const postings_t** lists, int options);
+
+/*********** indexfile_writerNew ***********/
+/* Starts writing a binary index file one word at a time
+ *
+ * Caller provides:
+ *   The file to create, the number of words that will be added, the
+ *   total of strlen(word) + 1 over those words, the total number of
+ *   postings in their lists, the total of postings_positionBytes over
+ *   them (0 without INDEXFILE_POSITIONS), and INDEXFILE_* options
+ * We return:
+ *   A writer, or NULL if the file can't be created
+ * Caller is responsible for:
+ *   Adding exactly the words declared, then calling indexfile_writerClose
+ * Notes:
+ *   Memory use is a few fixed-size buffers however large the index.
+ *   The file is written as filename.tmp and renamed to filename by
+ *   indexfile_writerClose, so a file of that name already open or
+ *   mapped by a reader is replaced whole, never overwritten in place.
+ */
+indexfile_writer_t* indexfile_writerNew(const char* filename, int numWords,
+                                        uint64_t wordBytes, uint64_t numPostings,
+                                        uint64_t positionBytes, int options);
+
+/*********** indexfile_writerAdd ***********/
+/* Appends one word and its postings
+ *
+ * Caller provides:
+ *   A writer, a word that sorts (by strcmp) after every word added so
+ *   far, and its postings
+ * We return:
+ *   false if the word is out of order, exceeds what was declared, or
+ *   can't be written; the file is then unusable
+ */
+bool indexfile_writerAdd(indexfile_writer_t* writer, const char* word, const postings_t* postings);
+
+/*********** indexfile_writerPruning ***********/
+/* Records how the file's postings were pruned
+ *
+ * Caller provides:
+ *   A writer created with INDEXFILE_PRUNED, and the settings
+ * We return:
+ *   false if the writer wasn't created with INDEXFILE_PRUNED
+ */
+bool indexfile_writerPruning(indexfile_writer_t* writer, const indexfile_pruning_t* pruning);
+
+/*********** indexfile_writerClose ***********/
+/* Finishes the file, syncs it to disk, renames it into place and
+ * frees the writer
+ *
+ * We return:
+ *   true if every declared word was added and everything was written;
+ *   otherwise the partial file is removed and any earlier file of that
+ *   name is left as it was
+ */
+bool indexfile_writerClose(indexfile_writer_t* writer);
+
+/*********** indexfile_open ***********/
+/* Maps a binary index file into memory
+ *
+ * Caller provides:
+ *   The name of a file written by indexfile_write
+ * We return:
+ *   A pointer to the opened file, or NULL if it can't be mapped
+ *   or isn't a valid binary index of a version we understand
+ * Caller is responsible for:
+ *   Later calling indexfile_close
+ */
+indexfile_t* indexfile_open(const char* filename);
+
+/*********** indexfile_find ***********/
+/* Looks up a word
+ *
+ * Caller provides:
+ *   An opened file, a word, and a postings_t to fill in
+ * We return:
+ *   true if the word is in the index, false otherwise
+ * We guarantee:
+ *   *postings is a view into the mapping (empty if the word is absent),
+ *   valid until indexfile_close; for a compressed file it is instead
+ *   a decoded list that owns its arrays
+ * Caller is responsible for:
+ *   Calling postings_release on *postings when done with it
+ */
+bool indexfile_find(indexfile_t* file, const char* word, postings_t* postings);
+
+/*********** indexfile_findImpacts ***********/
+/* Looks up a word's impact-ordered postings
+ *
+ * Caller provides:
+ *   An opened file, a word, and a postings_t to fill in
+ * We return:
+ *   true if the file has impacts and the word is in it, false otherwise
+ * We guarantee:
+ *   *impacts is a view into the mapping of the word's (id, count)
+ *   pairs in impact order (empty if the word is absent), valid until
+ *   indexfile_close. It is not sorted by docID, so only its arrays
+ *   should be read.
+ * Caller is responsible for:
+ *   Calling postings_release on *impacts when done with it
+ */
+bool indexfile_findImpacts(indexfile_t* file, const char* word, postings_t* impacts);
+
+/*********** indexfile_numWords ***********/
+/* Returns the number of words in the file, 0 if file is NULL */
+int indexfile_numWords(indexfile_t* file);
+
+/*********** indexfile_maxDocID ***********/
+/* Returns the largest docID in the file, 0 if file is NULL or empty */
+int indexfile_maxDocID(indexfile_t* file);
+
+/*********** indexfile_isCompressed ***********/
+/* Returns true if file holds compressed postings */
+bool indexfile_isCompressed(indexfile_t* file);
+
+/*********** indexfile_hasPositions ***********/
+/* Returns true if file holds word positions */
+bool indexfile_hasPositions(indexfile_t* file);
+
+/*********** indexfile_hasImpacts ***********/
+/* Returns true if file holds impact-ordered postings */
+bool indexfile_hasImpacts(indexfile_t* file);
+
+/*********** indexfile_pruning ***********/
+/* Returns true, filling in *pruning, if file records pruning settings */
+bool indexfile_pruning(indexfile_t* file, indexfile_pruning_t* pruning);
+
+/*********** indexfile_isHashed ***********/
+/* Returns true if lookups in file go through a dictionary hash */
+bool indexfile_isHashed(indexfile_t* file);
+
+/*********** indexfile_lookup ***********/
+/* Returns the position of word in sorted order, as indexfile_word and
+ * indexfile_postings take it, or -1 if the file doesn't hold it or
+ * file or word is NULL
+ */
+int indexfile_lookup(indexfile_t* file, const char* word);
+
+/*********** indexfile_frequency ***********/
+/* Returns how many documents hold word, from its entry alone, so a
+ * compressed list isn't decoded; 0 if the file doesn't hold it or
+ * file or word is NULL
+ */
+int indexfile_frequency(indexfile_t* file, const char* word);
+
+/*********** indexfile_hasBounds ***********/
+/* Returns true if file holds every word's largest count; files written
+ * before bounds were stored don't
+ */
+bool indexfile_hasBounds(indexfile_t* file);
+
+/*********** indexfile_bound ***********/
+/* Returns the largest count in word's postings, 0 if the file doesn't
+ * hold the word or has no bounds (see indexfile_hasBounds)
+ */
+int indexfile_bound(indexfile_t* file, const char* word);
+
+/*********** indexfile_word ***********/
+/* Returns the i'th word in sorted order, or NULL if i is out of range
+ * or the file is NULL; the word is valid until indexfile_close
+ */
+const char* indexfile_word(indexfile_t* file, int i);
+
+/*********** indexfile_postings ***********/
+/* Returns the postings of the i'th word, as indexfile_find would;
+ * empty if i is out of range. Caller must postings_release it.
+ */
+postings_t indexfile_postings(indexfile_t* file, int i);
+
+/*********** indexfile_iterate ***********/
+/* Calls itemfunc(arg, word, postings) for each word in sorted order
+ * Does nothing if file or itemfunc is NULL
+ * Notes:
+ *   postings is only valid during the call.
+ */
+void indexfile_iterate(indexfile_t* file, void* arg,
+                       void (*itemfunc)(void* arg, const char* word,
+                                        const postings_t* postings));
+
+/*********** indexfile_merge ***********/
+/* Merges several files word by word
+ *
+ * Caller provides:
+ *   numFiles open files in the order of the documents they hold (every
+ *   docID in files[k] comes before every docID in files[k+1]), an arg
+ *   and an itemfunc
+ * We do:
+ *   Call itemfunc(arg, word, postings) once per distinct word, in sorted
+ *   order, with the word's postings from every file concatenated in file
+ *   order (with their positions if each file's list has them); stop
+ *   early if itemfunc returns false
+ * We return:
+ *   false if any file is NULL or itemfunc returned false, else true
+ * Notes:
+ *   postings is only valid during the call. The merge holds one list
+ *   per file at a time, however large the files are.
+ */
+bool indexfile_merge(indexfile_t** files, int numFiles, void* arg,
+                     bool (*itemfunc)(void* arg, const char* word, const postings_t* postings));
+
+/*********** indexfile_mergeWrite ***********/
+/* Merges several files, as indexfile_merge does, into a new binary
+ * index file written with INDEXFILE_* options
+ *
+ * We return:
+ *   true if filename was written; false if a file is NULL or the
+ *   output can't be written
+ * Notes:
+ *   The files are merged twice, to count the output's sizes and then
+ *   to write it. The output has positions if every file does, whether
+ *   or not options asks for them, and impacts if every file does or
+ *   options asks for them.
+ */
+bool indexfile_mergeWrite(const char* filename, indexfile_t** files, int numFiles, int options);
+
+/*********** indexfile_close ***********/
+/* Unmaps the file; every view handed out becomes invalid
+ * Does nothing if file is NULL
+ */
+void indexfile_close(indexfile_t* file);
+
+#endif // __INDEXFILE_H
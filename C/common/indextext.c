@@ -0,0 +1,624 @@
+/*
+ * indextext.c - CS50 'indextext' module
+ *
+ * The writer works through the words in batches. Each batch is cut into
+ * one shard per thread, each shard holding about SHARD_BYTES of output;
+ * the threads format their shards with a hand-rolled integer formatter,
+ * and the main thread then writes the shard buffers out in order. Memory
+ * use is bounded by the batch, not by the size of the index.
+ *
+ * Both writers write filename.tmp and rename it over filename once it is
+ * complete and synced, so a querier that has the old file mapped keeps
+ * reading it whole rather than having it truncated beneath it.
+ *
+ * The loader maps the file and cuts it into one chunk per thread, each
+ * chunk starting just after a newline. Every thread parses its chunk's
+ * lines with a hand-rolled integer parser into a scratch array and copies
+ * each line's pairs into an exactly sized postings list; words are copied
+ * into a per-chunk text buffer so the mapping can be dropped once parsed.
+ *
+ * See indextext.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mem.h"
+#include "indextext.h"
+
+/**************** file-local constants ****************/
+#define MAX_THREADS 8
+#define SHARD_BYTES (4 << 20)     // output formatted per shard per batch
+#define MAX_INT_CHARS 11          // "-2147483648"
+#define CHUNK_BYTES (1 << 20)     // least input worth a loader thread
+
+// the two-digit strings "00" to "99", so each division yields two digits
+static const char DIGIT_PAIRS[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+/**************** file-local types ****************/
+// a run of consecutive words and the buffer they are formatted into
+typedef struct shard {
+  const char** words;
+  const postings_t** lists;
+  int numWords;
+  char* buf;
+  size_t capacity;
+  size_t length;
+} shard_t;
+
+// one parsed line: a word in the chunk's text buffer and its postings
+typedef struct chunkWord {
+  size_t word;
+  postings_t* postings;
+} chunkWord_t;
+
+// the lines starting in [start, end) and what they parsed into
+typedef struct chunk {
+  const char* start;
+  const char* end;
+  char* text;               // words, each NUL-terminated
+  size_t textLength;
+  size_t textCapacity;
+  chunkWord_t* words;
+  int numWords;
+  int wordCapacity;
+  int* ids;                 // scratch for the line being parsed
+  int* counts;
+  int scratchCapacity;
+  bool ok;                  // false once a malformed line is seen
+} chunk_t;
+
+// a file being written one word at a time; see indextext_writerNew
+struct indextext_writer {
+  FILE* fp;               // on tempFilename, renamed to filename on close
+  char* filename;
+  char* tempFilename;
+  char* buf;
+  size_t used;
+  bool ok;
+};
+
+struct indextext {
+  chunk_t* chunks;
+  int numChunks;
+  int numWords;
+};
+
+// Static function prototypes
+static int numThreads(int useful);
+static size_t wordBound(const char* word, const postings_t* list);
+static void* formatShard(void* arg);
+static char* formatWord(char* out, const char* word, const postings_t* list);
+static char* putInt(char* out, int value);
+static void* parseChunk(void* arg);
+static bool parseInt(const char** pos, const char* end, int* value);
+static bool addWord(chunk_t* chunk, const char* word, size_t length, int size, bool sorted);
+static char* tempName(const char* filename);
+static bool finishFile(FILE* fp, char* tempFilename, const char* filename, bool ok);
+
+/*********** indextext_write ***********/
+/* see indextext.h for more details */
+bool indextext_write(const char* filename, int numWords,
+                     const char** words, const postings_t** lists)
+{
+  if (filename == NULL || numWords < 0 || (numWords > 0 && (words == NULL || lists == NULL))) {
+    return false;
+  }
+  char* tempFilename = tempName(filename);
+  FILE* fp;
+  if ((fp = fopen(tempFilename, "w")) == NULL) {
+    free(tempFilename);
+    return false;
+  }
+
+  int threads = numThreads(numWords / 4096 + 1);
+  shard_t shards[MAX_THREADS];
+  memset(shards, 0, sizeof(shards));
+  pthread_t workers[MAX_THREADS];
+
+  bool ok = true;
+  int next = 0;
+  while (ok && next < numWords) {
+    // cut the next batch into consecutive shards, one per thread
+    int used = 0;
+    while (used < threads && next < numWords) {
+      shard_t* shard = &shards[used++];
+      shard->words = words + next;
+      shard->lists = lists + next;
+      shard->numWords = 0;
+      size_t bound = 0;
+      while (next < numWords && (shard->numWords == 0 || bound < SHARD_BYTES)) {
+        bound += wordBound(words[next], lists[next]);
+        shard->numWords++;
+        next++;
+      }
+      if (bound > shard->capacity) {
+        free(shard->buf);
+        shard->buf = mem_malloc_assert(bound, "Couldn't allocate index output buffer");
+        shard->capacity = bound;
+      }
+    }
+
+    // format shards 1.. on worker threads and shard 0 on this one;
+    // a shard whose thread can't be started is formatted here instead
+    bool started[MAX_THREADS] = { false };
+    for (int i = 1; i < used; i++) {
+      started[i] = pthread_create(&workers[i], NULL, formatShard, &shards[i]) == 0;
+    }
+    formatShard(&shards[0]);
+    for (int i = 1; i < used; i++) {
+      if (started[i]) {
+        pthread_join(workers[i], NULL);
+      } else {
+        formatShard(&shards[i]);
+      }
+    }
+
+    // write the shards out in order
+    for (int i = 0; ok && i < used; i++) {
+      ok = fwrite(shards[i].buf, 1, shards[i].length, fp) == shards[i].length;
+    }
+  }
+
+  for (int i = 0; i < MAX_THREADS; i++) {
+    free(shards[i].buf);
+  }
+  return finishFile(fp, tempFilename, filename, ok);
+}
+
+/*********** indextext_writerNew ***********/
+/* see indextext.h for more details */
+indextext_writer_t* indextext_writerNew(const char* filename)
+{
+  if (filename == NULL) {
+    return NULL;
+  }
+  char* tempFilename = tempName(filename);
+  FILE* fp;
+  if ((fp = fopen(tempFilename, "w")) == NULL) {
+    free(tempFilename);
+    return NULL;
+  }
+  indextext_writer_t* writer = mem_calloc_assert(1, sizeof(indextext_writer_t), "Couldn't allocate index writer");
+  writer->fp = fp;
+  writer->filename = mem_malloc_assert(strlen(filename) + 1, "Couldn't allocate file name");
+  strcpy(writer->filename, filename);
+  writer->tempFilename = tempFilename;
+  writer->buf = mem_malloc_assert(SHARD_BYTES, "Couldn't allocate index output buffer");
+  writer->ok = true;
+  return writer;
+}
+
+/*********** indextext_writerAdd ***********/
+/* see indextext.h for more details */
+bool indextext_writerAdd(indextext_writer_t* writer, const char* word, const postings_t* postings)
+{
+  if (writer == NULL || word == NULL || postings == NULL) {
+    return false;
+  }
+  size_t bound = wordBound(word, postings);
+  if (writer->used + bound > SHARD_BYTES && writer->used > 0) {
+    writer->ok = writer->ok && fwrite(writer->buf, 1, writer->used, writer->fp) == writer->used;
+    writer->used = 0;
+  }
+  if (bound > SHARD_BYTES) {
+    // a line too long for the buffer gets a buffer of its own
+    char* line = mem_malloc_assert(bound, "Couldn't allocate index output buffer");
+    size_t length = formatWord(line, word, postings) - line;
+    writer->ok = writer->ok && fwrite(line, 1, length, writer->fp) == length;
+    free(line);
+    return writer->ok;
+  }
+  writer->used = formatWord(writer->buf + writer->used, word, postings) - writer->buf;
+  return writer->ok;
+}
+
+/*********** indextext_writerClose ***********/
+/* see indextext.h for more details */
+bool indextext_writerClose(indextext_writer_t* writer)
+{
+  if (writer == NULL) {
+    return false;
+  }
+  bool ok = writer->ok && fwrite(writer->buf, 1, writer->used, writer->fp) == writer->used;
+  ok = finishFile(writer->fp, writer->tempFilename, writer->filename, ok);
+  free(writer->filename);
+  free(writer->buf);
+  free(writer);
+  return ok;
+}
+
+/*********** indextext_load ***********/
+/* see indextext.h for more details */
+indextext_t* indextext_load(const char* filename)
+{
+  int fd;
+  if (filename == NULL || (fd = open(filename, O_RDONLY)) < 0) {
+    return NULL;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return NULL;
+  }
+  size_t size = info.st_size;
+  const char* map = NULL;
+  if (size > 0) {
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      return NULL;
+    }
+    map = mapping;
+    posix_madvise(mapping, size, POSIX_MADV_SEQUENTIAL);
+  }
+  close(fd);
+
+  // one chunk per thread, each moved forward to start a line
+  indextext_t* text = mem_calloc_assert(1, sizeof(indextext_t), "Couldn't allocate index text");
+  int threads = numThreads(size / CHUNK_BYTES + 1);
+  text->chunks = mem_calloc_assert(threads, sizeof(chunk_t), "Couldn't allocate index chunks");
+  text->numChunks = threads;
+  const char* end = map + size;
+  const char* start = map;
+  for (int i = 0; i < threads; i++) {
+    chunk_t* chunk = &text->chunks[i];
+    const char* cut = i == threads - 1 ? end : map + size / threads * (i + 1);
+    if (cut < start) {
+      cut = start;
+    }
+    while (cut < end && cut > map && cut[-1] != '\n') {
+      cut++;
+    }
+    chunk->start = start;
+    chunk->end = cut;
+    chunk->ok = true;
+    start = cut;
+  }
+
+  pthread_t workers[MAX_THREADS];
+  bool started[MAX_THREADS] = { false };
+  for (int i = 1; i < threads; i++) {
+    started[i] = pthread_create(&workers[i], NULL, parseChunk, &text->chunks[i]) == 0;
+  }
+  parseChunk(&text->chunks[0]);
+  for (int i = 1; i < threads; i++) {
+    if (started[i]) {
+      pthread_join(workers[i], NULL);
+    } else {
+      parseChunk(&text->chunks[i]);
+    }
+  }
+  if (map != NULL) {
+    munmap((void*) map, size);
+  }
+
+  bool ok = true;
+  for (int i = 0; i < threads; i++) {
+    chunk_t* chunk = &text->chunks[i];
+    ok = ok && chunk->ok;
+    text->numWords += chunk->numWords;
+    free(chunk->ids);
+    free(chunk->counts);
+    chunk->ids = chunk->counts = NULL;
+    chunk->start = chunk->end = NULL;
+  }
+  if (!ok) {
+    indextext_delete(text);
+    return NULL;
+  }
+  return text;
+}
+
+/*********** indextext_numWords ***********/
+/* see indextext.h for more details */
+int indextext_numWords(indextext_t* text)
+{
+  return text == NULL ? 0 : text->numWords;
+}
+
+/*********** indextext_iterate ***********/
+/* see indextext.h for more details */
+void indextext_iterate(indextext_t* text, void* arg,
+                       void (*itemfunc)(void* arg, const char* word, postings_t* postings))
+{
+  if (text == NULL || itemfunc == NULL) {
+    return;
+  }
+  for (int i = 0; i < text->numChunks; i++) {
+    chunk_t* chunk = &text->chunks[i];
+    for (int w = 0; w < chunk->numWords; w++) {
+      postings_t* postings = chunk->words[w].postings;
+      if (postings != NULL) {
+        chunk->words[w].postings = NULL;    // now the caller's
+        itemfunc(arg, chunk->text + chunk->words[w].word, postings);
+      }
+    }
+  }
+}
+
+/*********** indextext_delete ***********/
+/* see indextext.h for more details */
+void indextext_delete(indextext_t* text)
+{
+  if (text != NULL) {
+    for (int i = 0; i < text->numChunks; i++) {
+      chunk_t* chunk = &text->chunks[i];
+      for (int w = 0; w < chunk->numWords; w++) {
+        postings_delete(chunk->words[w].postings);
+      }
+      free(chunk->words);
+      free(chunk->text);
+      free(chunk->ids);
+      free(chunk->counts);
+    }
+    free(text->chunks);
+    free(text);
+  }
+}
+
+/*********** numThreads ***********/
+/* Threads worth using: one per online CPU, up to MAX_THREADS,
+ * but no more than the caller says are useful
+ */
+static int numThreads(int useful)
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int threads = cpus < 1 ? 1 : (cpus > MAX_THREADS ? MAX_THREADS : (int) cpus);
+  return threads < useful ? threads : useful;
+}
+
+/*********** wordBound ***********/
+/* Largest number of bytes a word's line can take */
+static size_t wordBound(const char* word, const postings_t* list)
+{
+  // "word " + ("id count ") per posting + "\n"
+  return strlen(word) + 2 + (size_t) list->size * (2 * MAX_INT_CHARS + 2);
+}
+
+/*********** formatShard ***********/
+/* Formats every word of a shard into its buffer; a thread entry point */
+static void* formatShard(void* arg)
+{
+  shard_t* shard = (shard_t*) arg;
+  char* out = shard->buf;
+  for (int i = 0; i < shard->numWords; i++) {
+    out = formatWord(out, shard->words[i], shard->lists[i]);
+  }
+  shard->length = out - shard->buf;
+  return NULL;
+}
+
+/*********** formatWord ***********/
+/* Formats one word's line at out, which has room for wordBound bytes,
+ * and returns the position after it
+ */
+static char* formatWord(char* out, const char* word, const postings_t* list)
+{
+  size_t length = strlen(word);
+  memcpy(out, word, length);
+  out += length;
+  *out++ = ' ';
+  for (int j = 0; j < list->size; j++) {
+    out = putInt(out, list->ids[j]);
+    *out++ = ' ';
+    out = putInt(out, list->counts[j]);
+    *out++ = ' ';
+  }
+  *out++ = '\n';
+  return out;
+}
+
+/*********** putInt ***********/
+/* Writes value in decimal and returns the position after it */
+static char* putInt(char* out, int value)
+{
+  unsigned int magnitude = value;
+  if (value < 0) {
+    *out++ = '-';
+    magnitude = 0u - magnitude;
+  }
+
+  // fill a scratch buffer from the end, two digits at a time
+  char digits[MAX_INT_CHARS];
+  char* pos = digits + sizeof(digits);
+  while (magnitude >= 100) {
+    const char* pair = DIGIT_PAIRS + (magnitude % 100) * 2;
+    magnitude /= 100;
+    *--pos = pair[1];
+    *--pos = pair[0];
+  }
+  if (magnitude >= 10) {
+    const char* pair = DIGIT_PAIRS + magnitude * 2;
+    *--pos = pair[1];
+    *--pos = pair[0];
+  } else {
+    *--pos = '0' + magnitude;
+  }
+
+  size_t length = digits + sizeof(digits) - pos;
+  memcpy(out, pos, length);
+  return out + length;
+}
+
+/*********** parseChunk ***********/
+/* Parses every line of a chunk; a thread entry point
+ *
+ * A line is a word and then (id, count) pairs, separated by spaces.
+ * Blank lines are skipped and a word with no pairs is dropped, as the
+ * fscanf loader did. Anything else sets chunk->ok to false.
+ */
+static void* parseChunk(void* arg)
+{
+  chunk_t* chunk = (chunk_t*) arg;
+  const char* pos = chunk->start;
+  const char* end = chunk->end;
+
+  while (chunk->ok && pos < end) {
+    // the word: everything up to the first blank
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n')) {
+      pos++;
+    }
+    if (pos == end) {
+      break;
+    }
+    const char* word = pos;
+    while (pos < end && *pos != ' ' && *pos != '\t' && *pos != '\r' && *pos != '\n') {
+      pos++;
+    }
+    size_t length = pos - word;
+
+    // the pairs: integers up to the end of the line
+    int size = 0;
+    bool sorted = true;
+    for (;;) {
+      while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) {
+        pos++;
+      }
+      if (pos == end || *pos == '\n') {
+        break;
+      }
+      if (size == chunk->scratchCapacity) {
+        chunk->scratchCapacity = size == 0 ? 256 : size * 2;
+        chunk->ids = realloc(chunk->ids, chunk->scratchCapacity * sizeof(int));
+        chunk->counts = realloc(chunk->counts, chunk->scratchCapacity * sizeof(int));
+        mem_assert(chunk->ids, "Couldn't grow parse buffer");
+        mem_assert(chunk->counts, "Couldn't grow parse buffer");
+      }
+      int id;
+      int count;
+      if (!parseInt(&pos, end, &id)) {
+        chunk->ok = false;
+        break;
+      }
+      while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) {
+        pos++;
+      }
+      if (!parseInt(&pos, end, &count)) {
+        chunk->ok = false;
+        break;
+      }
+      if (size > 0 && id <= chunk->ids[size - 1]) {
+        sorted = false;
+      }
+      chunk->ids[size] = id;
+      chunk->counts[size] = count;
+      size++;
+    }
+    if (chunk->ok && size > 0 && !addWord(chunk, word, length, size, sorted)) {
+      chunk->ok = false;
+    }
+  }
+  return NULL;
+}
+
+/*********** parseInt ***********/
+/* Parses a non-negative decimal int at *pos, advancing *pos past it;
+ * returns false if there are no digits, they don't end at a blank or
+ * the end of the input, or the value doesn't fit in an int
+ */
+static bool parseInt(const char** pos, const char* end, int* value)
+{
+  const char* p = *pos;
+  long result = 0;
+  const char* digits = p;
+  while (p < end && *p >= '0' && *p <= '9') {
+    result = result * 10 + (*p - '0');
+    if (result > INT_MAX) {
+      return false;
+    }
+    p++;
+  }
+  if (p == digits || (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')) {
+    return false;
+  }
+  *value = (int) result;
+  *pos = p;
+  return true;
+}
+
+/*********** addWord ***********/
+/* Copies the word and the scratch pairs of the line just parsed into
+ * the chunk; pairs out of order go through postings_set, which sorts
+ * them and keeps the last count of a repeated id, as the old loader did
+ */
+static bool addWord(chunk_t* chunk, const char* word, size_t length, int size, bool sorted)
+{
+  if (chunk->textLength + length + 1 > chunk->textCapacity) {
+    size_t capacity = chunk->textCapacity == 0 ? 1 << 16 : chunk->textCapacity * 2;
+    while (capacity < chunk->textLength + length + 1) {
+      capacity *= 2;
+    }
+    chunk->text = realloc(chunk->text, capacity);
+    mem_assert(chunk->text, "Couldn't grow word buffer");
+    chunk->textCapacity = capacity;
+  }
+  if (chunk->numWords == chunk->wordCapacity) {
+    chunk->wordCapacity = chunk->wordCapacity == 0 ? 1024 : chunk->wordCapacity * 2;
+    chunk->words = realloc(chunk->words, chunk->wordCapacity * sizeof(chunkWord_t));
+    mem_assert(chunk->words, "Couldn't grow word list");
+  }
+
+  chunkWord_t* entry = &chunk->words[chunk->numWords++];
+  entry->word = chunk->textLength;
+  memcpy(chunk->text + chunk->textLength, word, length);
+  chunk->text[chunk->textLength + length] = '\0';
+  chunk->textLength += length + 1;
+
+  entry->postings = postings_new();
+  if (sorted) {
+    postings_reserve(entry->postings, size);
+    memcpy(entry->postings->ids, chunk->ids, size * sizeof(int));
+    memcpy(entry->postings->counts, chunk->counts, size * sizeof(int));
+    entry->postings->size = size;
+    return true;
+  }
+  for (int i = 0; i < size; i++) {
+    if (!postings_set(entry->postings, chunk->ids[i], chunk->counts[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*********** tempName ***********/
+/* Returns a new string naming the file written before it is renamed
+ * to filename
+ */
+static char* tempName(const char* filename)
+{
+  char* tempFilename = mem_malloc_assert(strlen(filename) + sizeof(".tmp"), "Couldn't allocate file name");
+  sprintf(tempFilename, "%s.tmp", filename);
+  return tempFilename;
+}
+
+/*********** finishFile ***********/
+/* Syncs and closes fp, then renames tempFilename to filename if ok and
+ * every step succeeded, or removes it otherwise; frees tempFilename.
+ * Returns true if filename now holds the new file
+ */
+static bool finishFile(FILE* fp, char* tempFilename, const char* filename, bool ok)
+{
+  // the rename below must not land before the data does
+  ok = fflush(fp) == 0 && fsync(fileno(fp)) == 0 && ok;
+  ok = fclose(fp) == 0 && ok;
+  if (!ok || rename(tempFilename, filename) != 0) {
+    unlink(tempFilename);
+    ok = false;
+  }
+  free(tempFilename);
+  return ok;
+}
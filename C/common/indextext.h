@@ -0,0 +1,110 @@
+/*
+ * indextext.h - header file for CS50 'indextext' module
+ *
+ * This module writes the text index format, one word per line:
+ *
+ *   word docID count docID count ...
+ *
+ * Words are cut into shards that are formatted into large buffers by
+ * several threads at once and written to the file in order, so the
+ * output is the same as printing each word in turn with fprintf.
+ *
+ * Loading works the other way round: the file is mapped, split at line
+ * boundaries, and each piece is parsed by its own thread straight into
+ * postings arrays, which are then handed to the caller.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __INDEXTEXT_H
+#define __INDEXTEXT_H
+
+#include <stdbool.h>
+#include "postings.h"
+
+/********* Global Types ***********/
+typedef struct indextext indextext_t;
+typedef struct indextext_writer indextext_writer_t;
+
+/********** Functions ***********/
+
+/*********** indextext_write ***********/
+/* Writes a text index file
+ *
+ * Caller provides:
+ *   The file to create, the number of words, an array of the words,
+ *   and the postings list for each word
+ * We return:
+ *   true if the whole file was written, false otherwise
+ * We guarantee:
+ *   Words are written in the order given. The file is written as
+ *   filename.tmp and renamed to filename once complete, so a reader of
+ *   the old file never sees it truncated; on failure the old file is
+ *   left as it was.
+ */
+bool indextext_write(const char* filename, int numWords,
+                     const char** words, const postings_t** lists);
+
+/*********** indextext_writerNew ***********/
+/* Starts writing a text index file one word at a time, for callers
+ * that produce words as they go rather than all at once
+ *
+ * We return:
+ *   A writer, or NULL if the file can't be created
+ * Caller is responsible for:
+ *   Later calling indextext_writerClose
+ */
+indextext_writer_t* indextext_writerNew(const char* filename);
+
+/*********** indextext_writerAdd ***********/
+/* Appends one word's line; returns false once any write has failed */
+bool indextext_writerAdd(indextext_writer_t* writer, const char* word, const postings_t* postings);
+
+/*********** indextext_writerClose ***********/
+/* Finishes the file and frees the writer; returns true if
+ * everything was written. Like indextext_write, the writer writes
+ * filename.tmp and this renames it to filename.
+ */
+bool indextext_writerClose(indextext_writer_t* writer);
+
+/*********** indextext_load ***********/
+/* Parses a text index file
+ *
+ * Caller provides:
+ *   The name of a text index file
+ * We return:
+ *   The parsed words and postings, or NULL if the file can't be read
+ *   or a line isn't in the format above
+ * Caller is responsible for:
+ *   Later calling indextext_delete
+ */
+indextext_t* indextext_load(const char* filename);
+
+/*********** indextext_numWords ***********/
+/* Returns the number of lines with a word and at least one pair,
+ * 0 if text is NULL
+ */
+int indextext_numWords(indextext_t* text);
+
+/*********** indextext_iterate ***********/
+/* Hands every parsed word to the caller, in file order
+ *
+ * Caller provides:
+ *   Loaded text, an arbitrary arg, and an itemfunc
+ * We do:
+ *   Nothing if text or itemfunc is NULL; otherwise call
+ *   itemfunc(arg, word, postings) once per line
+ * Notes:
+ *   itemfunc takes ownership of postings (free it with postings_delete);
+ *   word is only valid during the call. Call this at most once.
+ */
+void indextext_iterate(indextext_t* text, void* arg,
+                       void (*itemfunc)(void* arg, const char* word, postings_t* postings));
+
+/*********** indextext_delete ***********/
+/* Frees the loaded text and any postings not handed out
+ * Does nothing if text is NULL
+ */
+void indextext_delete(indextext_t* text);
+
+#endif // __INDEXTEXT_H
@@ -0,0 +1,267 @@
+/*
+ * intersect.c - CS50 'intersect' module
+ *
+ * intersect_lists sorts the lists by size and intersects the two
+ * smallest, then the result with each next list, stopping as soon as it
+ * is empty. Results alternate between two buffers sized for the
+ * smallest list, since no result is ever larger.
+ *
+ * A block merge loads four docIDs of each list and compares the first
+ * block against the second in each of its four rotations: docID k of
+ * the first block equal to docID k of rotation r is docID (k + r) % 4
+ * of the second. Whichever block ends lower is then done with, since
+ * everything in it that the other list could hold has been compared.
+ * The tails are merged one docID at a time.
+ *
+ * See intersect.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mem.h"
+#include "intersect.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define INTERSECT_SIMD 1
+#else
+#define INTERSECT_SIMD 0
+#endif
+
+// Static function prototypes
+static int merge(const postings_t* first, int i, const postings_t* second, int j, int* ids, int* counts);
+static int gallop(const postings_t* shorter, const postings_t* longer, int* ids, int* counts);
+static int mergeBlocks(const postings_t* first, const postings_t* second, int* ids, int* counts);
+static int lower(int a, int b);
+
+/*********** intersect_lists ***********/
+/* see intersect.h for more details */
+bool intersect_lists(const postings_t* lists, int numLists, postings_t* matches)
+{
+  if (matches == NULL) {
+    return false;
+  }
+  *matches = postings_view(NULL, NULL, 0);
+  if (lists == NULL || numLists < 1) {
+    return false;
+  }
+
+  // the lists by size, smallest first
+  const postings_t** bySize = mem_malloc_assert(numLists * sizeof(postings_t*), "Couldn't allocate intersection");
+  for (int k = 0; k < numLists; k++) {
+    int at = k;
+    for (; at > 0 && bySize[at - 1]->size > lists[k].size; at--) {
+      bySize[at] = bySize[at - 1];
+    }
+    bySize[at] = &lists[k];
+  }
+  int smallest = bySize[0]->size;
+  if (smallest == 0) {
+    free(bySize);
+    return true;
+  }
+
+  postings_t buffers[2] = { postings_view(NULL, NULL, 0), postings_view(NULL, NULL, 0) };
+  postings_reserve(&buffers[0], smallest);
+  if (numLists == 1) {
+    memcpy(buffers[0].ids, bySize[0]->ids, smallest * sizeof(int));
+    memcpy(buffers[0].counts, bySize[0]->counts, smallest * sizeof(int));
+    buffers[0].size = smallest;
+  } else {
+    postings_reserve(&buffers[1], smallest);
+  }
+
+  // each result is intersected with the next list into the other buffer
+  const postings_t* sofar = bySize[0];
+  int into = 0;
+  for (int k = 1; k < numLists && sofar->size > 0; k++) {
+    postings_t* result = &buffers[into];
+    result->size = intersect_pair(sofar, bySize[k], INTERSECT_AUTO, result->ids, result->counts);
+    sofar = result;
+    into = 1 - into;
+  }
+  if (numLists > 1) {
+    into = 1 - into;        // the last one written
+  }
+  *matches = buffers[into];
+  postings_release(&buffers[1 - into]);
+  free(bySize);
+  return true;
+}
+
+/*********** intersect_pair ***********/
+/* see intersect.h for more details */
+int intersect_pair(const postings_t* first, const postings_t* second, intersect_method_t method,
+                   int* ids, int* counts)
+{
+  if (first == NULL || second == NULL || first->size == 0 || second->size == 0) {
+    return 0;
+  }
+  const postings_t* shorter = first->size <= second->size ? first : second;
+  const postings_t* longer = shorter == first ? second : first;
+  if (method == INTERSECT_AUTO) {
+    // a list holding most docIDs in its span matches most of the other,
+    // and then comparing blocks only adds work to every match
+    int64_t span = (int64_t) longer->ids[longer->size - 1] - longer->ids[0] + 1;
+    if ((int64_t) shorter->size * INTERSECT_GALLOP_RATIO <= longer->size) {
+      method = INTERSECT_GALLOP;
+    } else if ((int64_t) longer->size * 2 > span) {
+      method = INTERSECT_MERGE;
+    } else {
+      method = INTERSECT_BLOCKS;
+    }
+  }
+  switch (method) {
+  case INTERSECT_GALLOP:
+    return gallop(shorter, longer, ids, counts);
+  case INTERSECT_BLOCKS:
+    return mergeBlocks(shorter, longer, ids, counts);
+  default:
+    return merge(shorter, 0, longer, 0, ids, counts);
+  }
+}
+
+/*********** intersect_seek ***********/
+/* see intersect.h for more details */
+int intersect_seek(const postings_t* list, int from, int id)
+{
+  const int* ids = list->ids;
+  int size = list->size;
+  if (from >= size || ids[from] >= id) {
+    return from;
+  }
+  // ids[low] < id throughout
+  int low = from;
+  int step = 1;
+  while (low + step < size && ids[low + step] < id) {
+    low += step;
+    step *= 2;
+  }
+  int high = low + step < size ? low + step : size;
+  low++;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (ids[mid] < id) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/*********** intersect_hasSimd ***********/
+/* see intersect.h for more details */
+bool intersect_hasSimd(void)
+{
+  return INTERSECT_SIMD;
+}
+
+/*********** merge ***********/
+/* Merges two lists one docID at a time, from first->ids[i] and
+ * second->ids[j]; returns how many docIDs were in both
+ */
+static int merge(const postings_t* first, int i, const postings_t* second, int j, int* ids, int* counts)
+{
+  int found = 0;
+  while (i < first->size && j < second->size) {
+    int a = first->ids[i];
+    int b = second->ids[j];
+    if (a < b) {
+      i++;
+    } else if (b < a) {
+      j++;
+    } else {
+      ids[found] = a;
+      counts[found++] = lower(first->counts[i++], second->counts[j++]);
+    }
+  }
+  return found;
+}
+
+/*********** gallop ***********/
+/* Finds each docID of the shorter list in the longer, each search
+ * starting where the last one ended; returns how many were found
+ */
+static int gallop(const postings_t* shorter, const postings_t* longer, int* ids, int* counts)
+{
+  int found = 0;
+  int at = 0;
+  for (int i = 0; i < shorter->size && at < longer->size; i++) {
+    int id = shorter->ids[i];
+    at = intersect_seek(longer, at, id);
+    if (at < longer->size && longer->ids[at] == id) {
+      ids[found] = id;
+      counts[found++] = lower(shorter->counts[i], longer->counts[at]);
+    }
+  }
+  return found;
+}
+
+#if INTERSECT_SIMD
+
+/*********** mergeBlocks ***********/
+/* Merges two lists four docIDs at a time with SSE2, then the tails one
+ * at a time; returns how many docIDs were in both
+ */
+static int mergeBlocks(const postings_t* first, const postings_t* second, int* ids, int* counts)
+{
+  int found = 0;
+  int i = 0;
+  int j = 0;
+  while (i + 4 <= first->size && j + 4 <= second->size) {
+    __m128i a = _mm_loadu_si128((const __m128i*) (first->ids + i));
+    __m128i b = _mm_loadu_si128((const __m128i*) (second->ids + j));
+    __m128i equal0 = _mm_cmpeq_epi32(a, b);
+    __m128i equal1 = _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1)));
+    __m128i equal2 = _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2)));
+    __m128i equal3 = _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3)));
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(_mm_or_si128(equal0, equal1),
+                                                             _mm_or_si128(equal2, equal3))));
+
+    // the matches, in order, each with the rotation it matched in
+    if (mask != 0) {
+      int rotation[4];
+      __m128i rotations = _mm_or_si128(_mm_and_si128(equal1, _mm_set1_epi32(1)),
+                                       _mm_or_si128(_mm_and_si128(equal2, _mm_set1_epi32(2)),
+                                                    _mm_and_si128(equal3, _mm_set1_epi32(3))));
+      _mm_storeu_si128((__m128i*) rotation, rotations);
+      for (int k = 0; mask != 0; k++, mask >>= 1) {
+        if (mask & 1) {
+          ids[found] = first->ids[i + k];
+          counts[found++] = lower(first->counts[i + k], second->counts[j + ((k + rotation[k]) & 3)]);
+        }
+      }
+    }
+
+    int lastA = first->ids[i + 3];
+    int lastB = second->ids[j + 3];
+    if (lastA <= lastB) {
+      i += 4;
+    }
+    if (lastB <= lastA) {
+      j += 4;
+    }
+  }
+  return found + merge(first, i, second, j, ids + found, counts + found);
+}
+
+#else
+
+/*********** mergeBlocks ***********/
+/* Without SIMD, a plain merge */
+static int mergeBlocks(const postings_t* first, const postings_t* second, int* ids, int* counts)
+{
+  return merge(first, 0, second, 0, ids, counts);
+}
+
+#endif
+
+/*********** lower ***********/
+/* Returns the lower of two counts */
+static int lower(int a, int b)
+{
+  return a < b ? a : b;
+}
@@ -0,0 +1,93 @@
+/*
+ * intersect.h - header file for CS50 'intersect' module
+ *
+ * This module intersects postings lists for AND queries: it finds the
+ * documents in every list, scoring each by its lowest count, in one pass
+ * over the sorted docID arrays with no per-document allocation.
+ *
+ * Lists are intersected two at a time, smallest first. When one list is
+ * much shorter than the other (INTERSECT_GALLOP_RATIO times or more),
+ * each of its docIDs is found in the longer one by galloping: doubling
+ * steps forward, then a binary search. Otherwise the two are merged a
+ * block of four docIDs at a time, each block of one compared against a
+ * block of the other with SIMD instructions where the compiler has them
+ * (SSE2, which every x86-64 has). Lists so dense that most docIDs will
+ * match, and every list where there is no SIMD, are merged one docID
+ * at a time.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __INTERSECT_H
+#define __INTERSECT_H
+
+#include <stdbool.h>
+#include "postings.h"
+
+// size ratio past which the shorter list gallops through the longer
+#define INTERSECT_GALLOP_RATIO 16
+
+/********* Global Type ***********/
+// how intersect_pair goes through two lists
+typedef enum {
+  INTERSECT_AUTO,         // by their sizes, as intersect_lists does
+  INTERSECT_MERGE,        // one docID at a time
+  INTERSECT_GALLOP,       // the shorter's docIDs galloped to in the longer
+  INTERSECT_BLOCKS        // four docIDs at a time
+} intersect_method_t;
+
+/********** Functions ***********/
+
+/*********** intersect_lists ***********/
+/* Intersects postings lists, scoring by the lowest count
+ *
+ * Caller provides:
+ *   numLists >= 1 lists sorted by docID (see index_get), in any order,
+ *   and a postings_t to fill in
+ * We return:
+ *   true, with *matches an owning list of the documents in every list,
+ *   each counted by the lowest of its counts; false if lists is NULL or
+ *   numLists < 1, in which case *matches is empty
+ * Caller is responsible for:
+ *   Calling postings_release on *matches
+ * Notes:
+ *   *matches has no positions. The lists themselves are not changed.
+ */
+bool intersect_lists(const postings_t* lists, int numLists, postings_t* matches);
+
+/*********** intersect_pair ***********/
+/* Intersects two lists into caller-provided arrays
+ *
+ * Caller provides:
+ *   Two lists sorted by docID, a method (see below), and arrays ids and
+ *   counts with room for the shorter list's size
+ * We return:
+ *   How many documents both lists hold, written in increasing docID
+ *   order to ids, each with its lower count in counts
+ * Notes:
+ *   Any method gives the same result; forcing one is for benchmarks.
+ *   In a build without SIMD, INTERSECT_BLOCKS is INTERSECT_MERGE.
+ */
+int intersect_pair(const postings_t* first, const postings_t* second, intersect_method_t method,
+                   int* ids, int* counts);
+
+/*********** intersect_seek ***********/
+/* Gallops to a docID in a list
+ *
+ * Caller provides:
+ *   A list sorted by docID, a position from 0 to its size, and a docID
+ * We return:
+ *   The first position from 'from' on whose docID is >= id, or the
+ *   list's size if there is none
+ * Notes:
+ *   Steps of 1, 2, 4, ... from 'from' bracket it, then a binary search
+ *   finds it within the last step, so a cursor moved forward through a
+ *   list costs O(log d) for a move of d postings.
+ */
+int intersect_seek(const postings_t* list, int from, int id);
+
+/*********** intersect_hasSimd ***********/
+/* Returns true if block merges use SIMD instructions in this build */
+bool intersect_hasSimd(void);
+
+#endif // __INTERSECT_H
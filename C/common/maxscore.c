@@ -0,0 +1,123 @@
+/*
+ * maxscore.c - CS50 'maxscore' module
+ *
+ * maxscore_topk keeps a cursor in each term's postings, and the terms
+ * sorted by bound with, for each, the sum of its bound and the bounds
+ * below it. The best k so far are kept in a min-heap (see topk.h);
+ * once it is full, its worst score is the threshold a document must
+ * beat, and every term whose running sum of bounds doesn't beat it is
+ * non-essential. Documents are taken in docID order from the essential
+ * terms' cursors only; a non-essential term's cursor is moved to a
+ * document by galloping (see intersect_seek), and only if the document
+ * could still get in with that term and those below it.
+ *
+ * Documents are visited in increasing docID order, so one that ties the
+ * threshold ranks below every document already in the heap with that
+ * score: only a score above it gets in.
+ *
+ * See maxscore.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include "mem.h"
+#include "maxscore.h"
+#include "intersect.h"
+#include "topk.h"
+
+/*********** maxscore_topk ***********/
+/* see maxscore.h for more details */
+counters_t* maxscore_topk(const maxscore_term_t* terms, int numTerms, int k,
+                          maxscore_stats_t* stats)
+{
+  if (terms == NULL || numTerms < 0 || k <= 0) {
+    return NULL;
+  }
+  // the terms by bound, lowest first, and what each adds with those below it
+  int* order = mem_calloc_assert(numTerms + 1, sizeof(int), "Couldn't allocate top k");
+  long long* upTo = mem_calloc_assert(numTerms + 1, sizeof(long long), "Couldn't allocate top k");
+  int* pos = mem_calloc_assert(numTerms + 1, sizeof(int), "Couldn't allocate top k");
+  long long postings = 0;
+  for (int t = 0; t < numTerms; t++) {
+    long long bound = (long long) terms[t].bound * terms[t].weight;
+    int at = t;
+    for (; at > 0 && (long long) terms[order[at - 1]].bound * terms[order[at - 1]].weight > bound; at--) {
+      order[at] = order[at - 1];
+    }
+    order[at] = t;
+    postings += terms[t].docs.size;
+  }
+  for (int i = 0; i < numTerms; i++) {
+    const maxscore_term_t* term = &terms[order[i]];
+    upTo[i] = (i > 0 ? upTo[i - 1] : 0) + (long long) term->bound * term->weight;
+  }
+
+  topk_entry_t* heap = mem_calloc_assert(k, sizeof(topk_entry_t), "Couldn't allocate top k");
+  int heapSize = 0;
+  long long threshold = -1;     // the heap's worst score, once it holds k
+  int essential = 0;            // order[essential] on are the essential terms
+  long long scored = 0;
+  for (;;) {
+    // the next document of any essential term
+    int id = INT_MAX;
+    for (int i = essential; i < numTerms; i++) {
+      const postings_t* docs = &terms[order[i]].docs;
+      if (pos[order[i]] < docs->size && docs->ids[pos[order[i]]] < id) {
+        id = docs->ids[pos[order[i]]];
+      }
+    }
+    if (id == INT_MAX) {
+      break;
+    }
+    scored++;
+
+    // its score from the essential terms, then from the others while
+    // they could still lift it past the threshold
+    long long score = 0;
+    for (int i = essential; i < numTerms; i++) {
+      const maxscore_term_t* term = &terms[order[i]];
+      int* at = &pos[order[i]];
+      if (*at < term->docs.size && term->docs.ids[*at] == id) {
+        score += (long long) term->docs.counts[*at] * term->weight;
+        (*at)++;
+      }
+    }
+    for (int i = essential - 1; i >= 0 && score + upTo[i] > threshold; i--) {
+      const maxscore_term_t* term = &terms[order[i]];
+      int* at = &pos[order[i]];
+      *at = intersect_seek(&term->docs, *at, id);
+      if (*at < term->docs.size && term->docs.ids[*at] == id) {
+        score += (long long) term->docs.counts[*at] * term->weight;
+      }
+    }
+
+    if (score > threshold && score > 0) {
+      topk_entry_t entry = { id, score > INT_MAX ? INT_MAX : (int) score };
+      topk_offer(heap, &heapSize, k, entry);
+      if (heapSize == k) {
+        // terms that can't lift a document past the new worst score by
+        // themselves become non-essential
+        threshold = heap[0].score;
+        while (essential < numTerms && upTo[essential] <= threshold) {
+          essential++;
+        }
+      }
+    }
+  }
+
+  counters_t* best = counters_new();
+  for (int i = 0; i < heapSize; i++) {
+    counters_set(best, heap[i].id, heap[i].score);
+  }
+  if (stats != NULL) {
+    stats->postings = postings;
+    stats->scored = scored;
+  }
+  free(order);
+  free(upTo);
+  free(pos);
+  free(heap);
+  return best;
+}
@@ -0,0 +1,70 @@
+/*
+ * maxscore.h - header file for CS50 'maxscore' module
+ *
+ * This module finds the best k documents of an OR query document at a
+ * time, with the MaxScore algorithm: it walks the terms' docID-sorted
+ * postings together, in docID order, and skips every document that
+ * can't score high enough to enter the top k, using a bound on each
+ * term's score, its largest count, that the index stores (see
+ * index_bound).
+ *
+ * The terms are ordered by bound. Once the k best so far are known,
+ * the terms whose bounds add up to no more than the worst of them are
+ * *non-essential*: a document holding only those can't get in, so
+ * only documents of the other, essential, terms are visited. Each is
+ * scored on the essential terms first; then the non-essential ones are
+ * looked up in turn, highest bound first, only while what they could
+ * add still lets the document in. As the top k get better, more terms
+ * become non-essential, and their lists are only searched, never read
+ * through.
+ *
+ * Unlike impact_topk, which needs an index built with impact-ordered
+ * postings, this needs only the usual postings and one bound per word.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __MAXSCORE_H
+#define __MAXSCORE_H
+
+#include "counters.h"
+#include "postings.h"
+
+/********* Global Types ***********/
+// one term of a query for maxscore_topk: a word, or the result of an
+// and-sequence, whose score in a document is its count there
+typedef struct maxscore_term {
+  postings_t docs;        // the term's postings by docID
+  int bound;              // no count in docs is higher (see index_bound)
+  int weight;             // its counts are added this many times (1 usually)
+} maxscore_term_t;
+
+// how much of the terms' postings maxscore_topk went through
+typedef struct maxscore_stats {
+  long long postings;     // postings of all the terms
+  long long scored;       // documents visited and scored at least in part
+} maxscore_stats_t;
+
+/********** Functions ***********/
+
+/*********** maxscore_topk ***********/
+/* Finds the k best documents for an OR of terms
+ *
+ * Caller provides:
+ *   The query's numTerms terms, k > 0, and where to count the work done,
+ *   or NULL
+ * We return:
+ *   A counters of at most k documents and their scores, the best by
+ *   score and then by lowest docID; a document scores the sum over terms
+ *   of its count times the term's weight. NULL if terms is NULL or
+ *   k <= 0.
+ * Caller is responsible for:
+ *   Calling counters_delete on the result
+ * Notes:
+ *   The result is the same as scoring every document of every term and
+ *   keeping the k best, provided every bound holds.
+ */
+counters_t* maxscore_topk(const maxscore_term_t* terms, int numTerms, int k,
+                          maxscore_stats_t* stats);
+
+#endif // __MAXSCORE_H
@@ -0,0 +1,275 @@
+/*
+ * mph.c - CS50 'mph' module
+ *
+ * A table is
+ *
+ *   header | pilots | slots
+ *
+ * with a uint32 pilot per bucket and a (fingerprint, key) pair per slot.
+ * A word's hash is first mixed with the table's seed; the low half of
+ * the result picks the bucket and the high half is the fingerprint, and
+ * mixing it again with the bucket's pilot picks the slot.
+ *
+ * Buckets are placed largest first, while most slots are still free:
+ * for each, pilots 0, 1, 2, ... are tried until one sends every key of
+ * the bucket to a distinct free slot. The last buckets hold one key and
+ * only need any free slot. Should a bucket run out of pilots, the build
+ * starts over with another seed.
+ *
+ * See mph.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mem.h"
+#include "mph.h"
+
+// seeds tried before giving up, and pilots tried per key before a new seed
+#define MAX_SEEDS 16
+#define TRIALS_PER_KEY 64
+
+// the start of a table
+typedef struct mphHeader {
+  uint64_t seed;
+  uint32_t numKeys;
+  uint32_t numBuckets;
+} mphHeader_t;
+
+// one slot of a table
+typedef struct mphSlot {
+  uint32_t fingerprint;   // high half of the key's seeded hash
+  uint32_t key;           // number of the key in the slot
+} mphSlot_t;
+
+// Static function prototypes
+static uint32_t numBucketsFor(uint32_t numKeys);
+static uint32_t* pilotsOf(const mphHeader_t* header);
+static mphSlot_t* slotsOf(const mphHeader_t* header);
+static uint64_t mix(uint64_t x);
+static uint32_t reduce(uint32_t x, uint32_t range);
+static uint32_t slotOf(uint64_t seeded, uint32_t pilot, uint32_t numKeys);
+static int placeAll(mphHeader_t* header, const uint64_t* seeded, const uint32_t* starts,
+                    const uint32_t* members, const uint32_t* order, unsigned char* taken);
+
+/*********** mph_hash ***********/
+/* see mph.h for more details */
+uint64_t mph_hash(const char* word)
+{
+  // FNV-1a, then mixed so that every bit depends on every byte
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const unsigned char* c = (const unsigned char*) word; *c != '\0'; c++) {
+    hash = (hash ^ *c) * 0x100000001b3ULL;
+  }
+  return mix(hash);
+}
+
+/*********** mph_bytes ***********/
+/* see mph.h for more details */
+uint64_t mph_bytes(uint32_t numKeys)
+{
+  uint64_t pilotBytes = (uint64_t) numBucketsFor(numKeys) * sizeof(uint32_t);
+  return sizeof(mphHeader_t) + (pilotBytes + 7) / 8 * 8 + (uint64_t) numKeys * sizeof(mphSlot_t);
+}
+
+/*********** mph_build ***********/
+/* see mph.h for more details */
+bool mph_build(const uint64_t* hashes, uint32_t numKeys, void* table)
+{
+  if ((hashes == NULL && numKeys > 0) || table == NULL) {
+    return false;
+  }
+  mphHeader_t* header = (mphHeader_t*) table;
+  memset(table, 0, mph_bytes(numKeys));
+  header->numKeys = numKeys;
+  header->numBuckets = numBucketsFor(numKeys);
+  uint32_t numBuckets = header->numBuckets;
+
+  uint64_t* seeded = mem_malloc_assert((numKeys + 1) * sizeof(uint64_t), "Couldn't allocate mph");
+  uint32_t* starts = mem_malloc_assert((numBuckets + 1) * sizeof(uint32_t), "Couldn't allocate mph");
+  uint32_t* members = mem_malloc_assert((numKeys + 1) * sizeof(uint32_t), "Couldn't allocate mph");
+  uint32_t* order = mem_malloc_assert(numBuckets * sizeof(uint32_t), "Couldn't allocate mph");
+  unsigned char* taken = mem_malloc_assert(numKeys + 1, "Couldn't allocate mph");
+
+  int placed = -1;
+  for (int attempt = 0; attempt < MAX_SEEDS && placed < 0; attempt++) {
+    header->seed = mix(0x6d70680000000000ULL + attempt);
+
+    // group the keys by bucket with a counting sort
+    memset(starts, 0, (numBuckets + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < numKeys; i++) {
+      seeded[i] = mix(hashes[i] ^ header->seed);
+      starts[reduce((uint32_t) seeded[i], numBuckets) + 1]++;
+    }
+    uint32_t largest = 0;
+    for (uint32_t b = 0; b < numBuckets; b++) {
+      largest = starts[b + 1] > largest ? starts[b + 1] : largest;
+      starts[b + 1] += starts[b];
+    }
+    for (uint32_t i = 0; i < numKeys; i++) {
+      members[starts[reduce((uint32_t) seeded[i], numBuckets)]++] = i;
+    }
+    memmove(starts + 1, starts, numBuckets * sizeof(uint32_t));
+    starts[0] = 0;
+
+    // and the buckets by size, largest first
+    uint32_t* bySize = mem_calloc_assert(largest + 2, sizeof(uint32_t), "Couldn't allocate mph");
+    for (uint32_t b = 0; b < numBuckets; b++) {
+      bySize[largest - (starts[b + 1] - starts[b]) + 1]++;
+    }
+    for (uint32_t size = 0; size <= largest; size++) {
+      bySize[size + 1] += bySize[size];
+    }
+    for (uint32_t b = 0; b < numBuckets; b++) {
+      order[bySize[largest - (starts[b + 1] - starts[b])]++] = b;
+    }
+    free(bySize);
+
+    memset(taken, 0, numKeys + 1);
+    placed = placeAll(header, seeded, starts, members, order, taken);
+  }
+
+  free(seeded);
+  free(starts);
+  free(members);
+  free(order);
+  free(taken);
+  if (placed <= 0) {
+    memset(table, 0, sizeof(mphHeader_t));    // no keys: not a valid table
+    return false;
+  }
+  return true;
+}
+
+/*********** mph_valid ***********/
+/* see mph.h for more details */
+bool mph_valid(const void* table, uint64_t length, uint32_t numKeys)
+{
+  const mphHeader_t* header = (const mphHeader_t*) table;
+  return table != NULL && length == mph_bytes(numKeys)
+         && header->numKeys == numKeys && header->numBuckets == numBucketsFor(numKeys);
+}
+
+/*********** mph_find ***********/
+/* see mph.h for more details */
+int64_t mph_find(const void* table, uint64_t hash)
+{
+  const mphHeader_t* header = (const mphHeader_t*) table;
+  if (header->numKeys == 0) {
+    return -1;
+  }
+  uint64_t seeded = mix(hash ^ header->seed);
+  uint32_t pilot = pilotsOf(header)[reduce((uint32_t) seeded, header->numBuckets)];
+  const mphSlot_t* slot = &slotsOf(header)[slotOf(seeded, pilot, header->numKeys)];
+  return slot->fingerprint == (uint32_t) (seeded >> 32) ? (int64_t) slot->key : -1;
+}
+
+/*********** placeAll ***********/
+/* Finds a pilot for every bucket, in the given order, and fills in
+ * the slots; returns 1 if all were placed, -1 if a bucket ran out of
+ * pilots (another seed may do), and 0 if a bucket holds two equal keys
+ */
+static int placeAll(mphHeader_t* header, const uint64_t* seeded, const uint32_t* starts,
+                    const uint32_t* members, const uint32_t* order, unsigned char* taken)
+{
+  uint32_t numKeys = header->numKeys;
+  uint32_t* pilots = pilotsOf(header);
+  mphSlot_t* slots = slotsOf(header);
+  uint64_t maxTrials = (uint64_t) TRIALS_PER_KEY * numKeys + 1024;
+  uint32_t wanted[64];
+
+  for (uint32_t i = 0; i < header->numBuckets; i++) {
+    uint32_t b = order[i];
+    uint32_t first = starts[b];
+    uint32_t size = starts[b + 1] - first;
+    if (size == 0) {
+      break;                  // the rest are empty too
+    }
+    if (size > sizeof(wanted) / sizeof(wanted[0])) {
+      return -1;
+    }
+    for (uint32_t j = 1; j < size; j++) {
+      for (uint32_t k = 0; k < j; k++) {
+        if (seeded[members[first + j]] == seeded[members[first + k]]) {
+          return 0;           // equal keys can never be told apart
+        }
+      }
+    }
+
+    // try pilots until every key lands on its own free slot
+    bool fits = false;
+    uint64_t pilot = 0;
+    for (; !fits && pilot < maxTrials; pilot++) {
+      fits = true;
+      for (uint32_t j = 0; fits && j < size; j++) {
+        wanted[j] = slotOf(seeded[members[first + j]], (uint32_t) pilot, numKeys);
+        fits = !taken[wanted[j]];
+        for (uint32_t k = 0; fits && k < j; k++) {
+          fits = wanted[k] != wanted[j];
+        }
+      }
+    }
+    if (!fits) {
+      return -1;
+    }
+    pilots[b] = (uint32_t) (pilot - 1);
+    for (uint32_t j = 0; j < size; j++) {
+      uint32_t key = members[first + j];
+      taken[wanted[j]] = 1;
+      slots[wanted[j]].fingerprint = (uint32_t) (seeded[key] >> 32);
+      slots[wanted[j]].key = key;
+    }
+  }
+  return 1;
+}
+
+/*********** numBucketsFor ***********/
+/* Returns the number of buckets of a table for numKeys keys */
+static uint32_t numBucketsFor(uint32_t numKeys)
+{
+  return numKeys / MPH_BUCKET_SIZE + 1;
+}
+
+/*********** pilotsOf ***********/
+/* Returns the pilots of a table, which follow its header */
+static uint32_t* pilotsOf(const mphHeader_t* header)
+{
+  return (uint32_t*) (header + 1);
+}
+
+/*********** slotsOf ***********/
+/* Returns the slots of a table, which follow its pilots */
+static mphSlot_t* slotsOf(const mphHeader_t* header)
+{
+  uint64_t pilotBytes = (uint64_t) header->numBuckets * sizeof(uint32_t);
+  return (mphSlot_t*) ((char*) (header + 1) + (pilotBytes + 7) / 8 * 8);
+}
+
+/*********** mix ***********/
+/* A 64-bit finalizer (from splitmix64): a bijection that spreads every
+ * input bit over the whole output
+ */
+static uint64_t mix(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+/*********** reduce ***********/
+/* Maps x evenly onto [0, range) without a division */
+static uint32_t reduce(uint32_t x, uint32_t range)
+{
+  return (uint32_t) (((uint64_t) x * range) >> 32);
+}
+
+/*********** slotOf ***********/
+/* Returns the slot a seeded hash goes to under pilot */
+static uint32_t slotOf(uint64_t seeded, uint32_t pilot, uint32_t numKeys)
+{
+  return reduce((uint32_t) mix(seeded ^ (pilot * 0x9e3779b97f4a7c15ULL)), numKeys);
+}
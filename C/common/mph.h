@@ -0,0 +1,77 @@
+/*
+ * mph.h - header file for CS50 'mph' module
+ *
+ * This module builds and probes a minimal perfect hash table over a
+ * fixed set of keys, for the dictionary of a binary index: once the
+ * index is written its words never change, so each can be given a slot
+ * of its own and found without comparing it to any other word.
+ *
+ * Keys are 64-bit hashes of the words (mph_hash). They are split into
+ * buckets of about MPH_BUCKET_SIZE, and each bucket gets a *pilot*, a
+ * number that, mixed into its keys' hashes, sends them to slots no
+ * other key uses; there are exactly as many slots as keys. A slot holds
+ * its key's number and a 32-bit fingerprint of its hash, so a word that
+ * isn't a key almost always fails on the fingerprint without any word
+ * being read.
+ *
+ * A table is one block of memory, made to be written into a file and
+ * used in place from a mapping.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __MPH_H
+#define __MPH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// average keys per bucket; more makes a smaller table but a slower build
+#define MPH_BUCKET_SIZE 4
+
+/********** Functions ***********/
+
+/*********** mph_hash ***********/
+/* Returns the 64-bit hash of a word that mph tables are keyed by */
+uint64_t mph_hash(const char* word);
+
+/*********** mph_bytes ***********/
+/* Returns the size in bytes of a table for numKeys keys; always a
+ * multiple of 8
+ */
+uint64_t mph_bytes(uint32_t numKeys);
+
+/*********** mph_build ***********/
+/* Builds a table over a set of keys
+ *
+ * Caller provides:
+ *   The hashes of numKeys distinct words, and mph_bytes(numKeys)
+ *   bytes of 8-byte aligned memory for the table
+ * We return:
+ *   true if the table was built: key i is then found as i. false if
+ *   no table could be found for the keys, which only happens if two
+ *   hashes are equal; the table then holds no keys (see mph_valid).
+ * Notes:
+ *   Building takes a few hash evaluations per key and about 14 bytes of
+ *   scratch per key besides the table.
+ */
+bool mph_build(const uint64_t* hashes, uint32_t numKeys, void* table);
+
+/*********** mph_valid ***********/
+/* Returns true if length bytes at table hold a table built for
+ * numKeys keys, so that mph_find can be used on it
+ */
+bool mph_valid(const void* table, uint64_t length, uint32_t numKeys);
+
+/*********** mph_find ***********/
+/* Finds a key in a valid table
+ *
+ * We return:
+ *   The number of the key with hash, or -1 if its slot's fingerprint
+ *   doesn't match. A hash that isn't a key matches a fingerprint with
+ *   probability 2^-32; a caller that can't accept that must compare
+ *   the key it gets.
+ */
+int64_t mph_find(const void* table, uint64_t hash);
+
+#endif // __MPH_H
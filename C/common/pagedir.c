@@ -79,7 +79,7 @@ bool pagedir_validate(const char* pageDirectory)
 bool pagedir_validateWriteFile(const char* filePath)
 {
   FILE* writeFile;
-  if ((writeFile = fopen(filePath,"w")) == NULL) {            // try to open file in w mode           
+  if ((writeFile = fopen(filePath,"a")) == NULL) {            // append mode, so an existing file isn't truncated
     return false;                                             // if unsuccessful return false
   }
   fclose(writeFile);
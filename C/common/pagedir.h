@@ -67,7 +67,8 @@ bool pagedir_validate(const char* pageDirectory);
 
 /*********** pagedir_validateWriteFile ***********/
 /* Validates that a given file can be written to
- * Checks if the file can be opened in write mode
+ * Checks if the file can be opened in write mode, without
+ * truncating it if it already exists
  * 
  * Caller provides:
  *   A valid string representing the file path
@@ -0,0 +1,578 @@
+/*
+ * pageloader.c - CS50 'pageloader' module
+ *
+ * The io_uring loader keeps a ring of depth slots, slot (id - firstID) %
+ * depth loading page id. Each slot opens its file with IORING_OP_OPENAT,
+ * sizes it with fstat and reads it whole with IORING_OP_READ, so up to
+ * depth opens and reads are queued in the kernel at once. When the
+ * caller takes a slot's page, the slot starts on page id + depth.
+ * The ring is driven with the raw system calls, so no library is needed.
+ * A page the ring fails to open or read for any reason but its absence
+ * is loaded with pagedir_load instead, and if io_uring_enter itself
+ * fails, every page from there on is; either is reported on stderr, so
+ * an I/O error is never taken for the end of the crawl.
+ *
+ * The fallback is a thread that loads pages with pagedir_load into a
+ * bounded queue, after asking the kernel (POSIX_FADV_WILLNEED) to start
+ * reading the next depth files.
+ *
+ * See pageloader.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _GNU_SOURCE             // syscall()
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "mem.h"
+#include "pagedir.h"
+#include "bqueue.h"
+#include "pageloader.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#if defined(__NR_io_uring_setup) && defined(IORING_OFF_SQES)
+#define HAVE_URING 1
+#endif
+
+/**************** file-local types ****************/
+typedef enum { SLOT_IDLE, SLOT_OPENING, SLOT_READING, SLOT_DONE, SLOT_MISSING, SLOT_FAILED } slotState_t;
+
+// one page being loaded through the ring
+typedef struct slot {
+  int id;                 // document this slot is loading
+  slotState_t state;
+  int fd;
+  char* path;             // pageDirectory/id; must outlive the open
+  char* buf;              // whole file, plus a terminating null
+  size_t size;            // file size from fstat
+  size_t have;            // bytes read so far
+} slot_t;
+
+#ifdef HAVE_URING
+// the submission and completion rings, mapped from the kernel
+typedef struct ring {
+  int fd;
+  unsigned* sqHead;
+  unsigned* sqTail;
+  unsigned sqMask;
+  unsigned* sqArray;
+  struct io_uring_sqe* sqes;
+  unsigned* cqHead;
+  unsigned* cqTail;
+  unsigned cqMask;
+  struct io_uring_cqe* cqes;
+  void* sqMap;
+  size_t sqMapSize;
+  void* cqMap;            // same as sqMap with IORING_FEAT_SINGLE_MMAP
+  size_t cqMapSize;
+  size_t sqesSize;
+  unsigned toSubmit;      // entries queued since the last io_uring_enter
+} ring_t;
+#endif
+
+struct pageloader {
+  const char* pageDirectory;
+  int firstID;
+  int depth;
+  int nextID;             // next page to hand out
+  int limit;              // first page known missing; nothing at or past it is loaded
+  bool uring;
+#ifdef HAVE_URING
+  bool broken;            // io_uring_enter failed; pages are loaded with pagedir_load
+  ring_t ring;
+  slot_t* slots;
+  int inFlight;           // slots with an open or read outstanding
+#endif
+  // readahead fallback
+  pthread_t thread;
+  bqueue_t* pages;
+};
+
+// Static function prototypes
+static webpage_t* parsePage(char* buf, size_t len);
+static char* pagePath(const char* pageDirectory, int id);
+static void* readAhead(void* arg);
+static void hintPage(const char* pageDirectory, int id);
+#ifdef HAVE_URING
+static bool ringOpen(ring_t* ring, unsigned entries);
+static void ringClose(ring_t* ring);
+static void ringPush(ring_t* ring, struct io_uring_sqe* sqe);
+static bool ringWait(pageloader_t* loader);
+static void slotStart(pageloader_t* loader, slot_t* slot, int id);
+static void slotComplete(pageloader_t* loader, slot_t* slot, int res);
+static void slotRead(pageloader_t* loader, slot_t* slot);
+static void slotFinish(pageloader_t* loader, slot_t* slot, slotState_t state);
+#endif
+
+/*********** pageloader_new ***********/
+/* see pageloader.h for more details */
+pageloader_t* pageloader_new(const char* pageDirectory, int firstID, int depth, bool useUring)
+{
+  if (pageDirectory == NULL || firstID < 1 || depth < 1) {
+    return NULL;
+  }
+  pageloader_t* loader = mem_calloc_assert(1, sizeof(pageloader_t), "Couldn't allocate page loader");
+  loader->pageDirectory = pageDirectory;
+  loader->firstID = firstID;
+  loader->depth = depth;
+  loader->nextID = firstID;
+  loader->limit = INT32_MAX;
+
+#ifdef HAVE_URING
+  if (useUring && ringOpen(&loader->ring, depth)) {
+    loader->uring = true;
+    loader->slots = mem_calloc_assert(depth, sizeof(slot_t), "Couldn't allocate page loader");
+    for (int i = 0; i < depth; i++) {
+      slotStart(loader, &loader->slots[i], firstID + i);
+    }
+    return loader;
+  }
+#endif
+
+  loader->pages = bqueue_new(depth);
+  if (pthread_create(&loader->thread, NULL, readAhead, loader) != 0) {
+    fprintf(stderr, "Couldn't start readahead thread\n");
+    exit(-1);
+  }
+  return loader;
+}
+
+/*********** pageloader_next ***********/
+/* see pageloader.h for more details */
+webpage_t* pageloader_next(pageloader_t* loader, int* docID)
+{
+  if (loader == NULL || loader->nextID >= loader->limit) {
+    return NULL;
+  }
+  int id = loader->nextID;
+  webpage_t* page = NULL;
+
+#ifdef HAVE_URING
+  if (loader->uring) {
+    slot_t* slot = &loader->slots[(id - loader->firstID) % loader->depth];
+    while (!loader->broken && (slot->state == SLOT_OPENING || slot->state == SLOT_READING)) {
+      if (!ringWait(loader)) {
+        fprintf(stderr, "io_uring failed at page %d (%s); loading the rest with pagedir_load\n",
+                id, strerror(errno));
+        loader->broken = true;
+      }
+    }
+    if (loader->broken) {
+      page = pagedir_load(loader->pageDirectory, id);   // leave the slots to the kernel
+    } else {
+      if (slot->state == SLOT_DONE) {
+        page = parsePage(slot->buf, slot->have);
+        slot->buf = NULL;
+      } else if (slot->state == SLOT_FAILED) {
+        fprintf(stderr, "io_uring couldn't read page %d; loading it with pagedir_load\n", id);
+        page = pagedir_load(loader->pageDirectory, id);
+      }
+      slot->state = SLOT_IDLE;
+      if (page != NULL) {
+        slotStart(loader, slot, id + loader->depth);
+      }
+    }
+  }
+#endif
+  if (!loader->uring) {
+    page = bqueue_pop(loader->pages);
+  }
+
+  if (page == NULL) {
+    loader->limit = id;           // the crawl ends here
+    return NULL;
+  }
+  loader->nextID++;
+  if (docID != NULL) {
+    *docID = id;
+  }
+  return page;
+}
+
+/*********** pageloader_isUring ***********/
+/* see pageloader.h for more details */
+bool pageloader_isUring(pageloader_t* loader)
+{
+  return loader != NULL && loader->uring;
+}
+
+/*********** pageloader_delete ***********/
+/* see pageloader.h for more details */
+void pageloader_delete(pageloader_t* loader)
+{
+  if (loader == NULL) {
+    return;
+  }
+#ifdef HAVE_URING
+  if (loader->uring) {
+    // the kernel may still write into our buffers until every op completes
+    loader->limit = loader->nextID;
+    while (!loader->broken && loader->inFlight > 0 && ringWait(loader)) {
+    }
+    for (int i = 0; i < loader->depth; i++) {
+      slot_t* slot = &loader->slots[i];
+      if (slot->state != SLOT_OPENING && slot->state != SLOT_READING) {
+        free(slot->path);       // a slot still in flight is left to the kernel
+        free(slot->buf);
+      }
+    }
+    free(loader->slots);
+    ringClose(&loader->ring);
+  }
+#endif
+  if (!loader->uring) {
+    bqueue_close(loader->pages);          // the thread's next push fails
+    pthread_join(loader->thread, NULL);
+    bqueue_delete(loader->pages, webpage_delete);
+  }
+  free(loader);
+}
+
+/*********** parsePage ***********/
+/* Builds a webpage from a page file's contents the way pagedir_load
+ * reads it: URL on the first line, then the depth, then the HTML after
+ * any whitespace. Takes ownership of buf (len bytes plus a null), which
+ * becomes the page's HTML. Returns NULL for an empty file.
+ */
+static webpage_t* parsePage(char* buf, size_t len)
+{
+  if (len == 0) {
+    free(buf);
+    return NULL;
+  }
+  char* end = buf + len;
+  *end = '\0';
+  char* newline = memchr(buf, '\n', len);
+  size_t urlLen = newline != NULL ? newline - buf : len;
+  char* url = mem_malloc_assert(urlLen + 1, "Couldn't allocate URL");
+  memcpy(url, buf, urlLen);
+  url[urlLen] = '\0';
+
+  // as fscanf("%d\n"): skip blanks, read the depth, then skip blanks after it
+  char* html = newline != NULL ? newline + 1 : end;
+  while (html < end && isspace((unsigned char) *html)) {
+    html++;
+  }
+  char* after;
+  long depth = strtol(html, &after, 10);
+  if (after != html) {
+    for (html = after; html < end && isspace((unsigned char) *html); html++) {
+    }
+  } else {
+    depth = 0;
+  }
+
+  // the HTML moves to the front of buf
+  size_t htmlLen = end - html;
+  if (htmlLen == 0) {
+    free(buf);
+    buf = NULL;
+  } else {
+    memmove(buf, html, htmlLen);
+    buf[htmlLen] = '\0';
+  }
+  webpage_t* page = webpage_new(url, depth, buf);
+  if (page == NULL) {
+    free(url);
+    free(buf);
+  }
+  return page;
+}
+
+/*********** pagePath ***********/
+/* Returns a new string pageDirectory/id, which the caller frees */
+static char* pagePath(const char* pageDirectory, int id)
+{
+  size_t size = strlen(pageDirectory) + 16;
+  char* path = mem_malloc_assert(size, "Couldn't allocate path");
+  snprintf(path, size, "%s/%d", pageDirectory, id);
+  return path;
+}
+
+/*********** readAhead ***********/
+/* Fallback loader thread: loads pages in order into the queue until one
+ * is missing or the queue is closed, keeping the kernel reading up to
+ * depth files ahead
+ */
+static void* readAhead(void* arg)
+{
+  pageloader_t* loader = (pageloader_t*) arg;
+  int hinted = loader->firstID;          // first page not yet hinted
+  for (int id = loader->firstID; ; id++) {
+    for (; hinted < id + loader->depth; hinted++) {
+      hintPage(loader->pageDirectory, hinted);
+    }
+    webpage_t* page = pagedir_load(loader->pageDirectory, id);
+    if (page == NULL) {
+      break;
+    }
+    if (!bqueue_push(loader->pages, page)) {
+      webpage_delete(page);
+      break;
+    }
+  }
+  bqueue_close(loader->pages);
+  return NULL;
+}
+
+/*********** hintPage ***********/
+/* Asks the kernel to start reading page id into the page cache */
+static void hintPage(const char* pageDirectory, int id)
+{
+  char* path = pagePath(pageDirectory, id);
+  int fd = open(path, O_RDONLY);
+  if (fd >= 0) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+  }
+  free(path);
+}
+
+#ifdef HAVE_URING
+
+/*********** ringOpen ***********/
+/* Sets up an io_uring with at least entries submission slots and maps
+ * its rings. Returns false if the kernel has no io_uring, refuses it, or
+ * lacks the open and read operations.
+ */
+static bool ringOpen(ring_t* ring, unsigned entries)
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring->fd = syscall(__NR_io_uring_setup, entries, &params);
+  if (ring->fd < 0) {
+    return false;
+  }
+
+  // IORING_OP_OPENAT and IORING_OP_READ arrived in 5.6, with the probe
+  size_t probeSize = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+  struct io_uring_probe* probe = mem_calloc_assert(1, probeSize, "Couldn't allocate probe");
+  bool supported = syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, 256) == 0
+                   && probe->last_op >= IORING_OP_READ
+                   && (probe->ops[IORING_OP_OPENAT].flags & IO_URING_OP_SUPPORTED)
+                   && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+  free(probe);
+  if (!supported) {
+    close(ring->fd);
+    return false;
+  }
+
+  ring->sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single && ring->cqMapSize > ring->sqMapSize) {
+    ring->sqMapSize = ring->cqMapSize;
+  }
+  ring->sqMap = mmap(NULL, ring->sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring->fd, IORING_OFF_SQ_RING);
+  ring->cqMap = single ? ring->sqMap
+                       : mmap(NULL, ring->cqMapSize, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+  ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring->fd, IORING_OFF_SQES);
+  if (ring->sqMap == MAP_FAILED || ring->cqMap == MAP_FAILED || ring->sqes == MAP_FAILED) {
+    if (ring->sqes != MAP_FAILED) {
+      munmap(ring->sqes, ring->sqesSize);
+    }
+    if (!single && ring->cqMap != MAP_FAILED) {
+      munmap(ring->cqMap, ring->cqMapSize);
+    }
+    if (ring->sqMap != MAP_FAILED) {
+      munmap(ring->sqMap, ring->sqMapSize);
+    }
+    close(ring->fd);
+    return false;
+  }
+
+  char* sq = ring->sqMap;
+  ring->sqHead = (unsigned*) (sq + params.sq_off.head);
+  ring->sqTail = (unsigned*) (sq + params.sq_off.tail);
+  ring->sqMask = *(unsigned*) (sq + params.sq_off.ring_mask);
+  ring->sqArray = (unsigned*) (sq + params.sq_off.array);
+  char* cq = ring->cqMap;
+  ring->cqHead = (unsigned*) (cq + params.cq_off.head);
+  ring->cqTail = (unsigned*) (cq + params.cq_off.tail);
+  ring->cqMask = *(unsigned*) (cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+  ring->toSubmit = 0;
+  return true;
+}
+
+/*********** ringClose ***********/
+/* Unmaps the rings and closes the io_uring */
+static void ringClose(ring_t* ring)
+{
+  munmap(ring->sqes, ring->sqesSize);
+  if (ring->cqMap != ring->sqMap) {
+    munmap(ring->cqMap, ring->cqMapSize);
+  }
+  munmap(ring->sqMap, ring->sqMapSize);
+  close(ring->fd);
+}
+
+/*********** ringPush ***********/
+/* Queues a copy of sqe for the next io_uring_enter. There is always
+ * room: each of the depth slots has at most one operation outstanding.
+ */
+static void ringPush(ring_t* ring, struct io_uring_sqe* sqe)
+{
+  unsigned tail = *ring->sqTail;
+  unsigned index = tail & ring->sqMask;
+  ring->sqes[index] = *sqe;
+  ring->sqArray[index] = index;
+  __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+  ring->toSubmit++;
+}
+
+/*********** ringWait ***********/
+/* Submits whatever is queued, waits for at least one completion and
+ * handles every completion available. Returns false if io_uring_enter
+ * fails.
+ */
+static bool ringWait(pageloader_t* loader)
+{
+  ring_t* ring = &loader->ring;
+  int submitted;
+  do {
+    submitted = syscall(__NR_io_uring_enter, ring->fd, ring->toSubmit, 1,
+                        IORING_ENTER_GETEVENTS, NULL, 0);
+  } while (submitted < 0 && errno == EINTR);
+  if (submitted < 0) {
+    return false;
+  }
+  ring->toSubmit -= submitted;
+
+  unsigned head = *ring->cqHead;
+  unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++) {
+    struct io_uring_cqe* cqe = &ring->cqes[head & ring->cqMask];
+    slotComplete(loader, &loader->slots[cqe->user_data], cqe->res);
+  }
+  __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+  return true;
+}
+
+/*********** slotStart ***********/
+/* Queues the open of page id in slot, unless id is past a missing page */
+static void slotStart(pageloader_t* loader, slot_t* slot, int id)
+{
+  if (id >= loader->limit) {
+    return;
+  }
+  free(slot->path);
+  slot->path = pagePath(loader->pageDirectory, id);
+  slot->id = id;
+  slot->state = SLOT_OPENING;
+  slot->fd = -1;
+  slot->buf = NULL;
+  slot->size = slot->have = 0;
+
+  struct io_uring_sqe sqe;
+  memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = IORING_OP_OPENAT;
+  sqe.fd = AT_FDCWD;
+  sqe.addr = (uintptr_t) slot->path;
+  sqe.open_flags = O_RDONLY | O_CLOEXEC;
+  sqe.user_data = slot - loader->slots;
+  ringPush(&loader->ring, &sqe);
+  loader->inFlight++;
+}
+
+/*********** slotComplete ***********/
+/* Moves a slot on after its open or read completed with result res */
+static void slotComplete(pageloader_t* loader, slot_t* slot, int res)
+{
+  if (slot->state == SLOT_OPENING) {
+    struct stat info;
+    if (res == -ENOENT) {
+      // the crawl ends at the first missing page
+      if (slot->id < loader->limit) {
+        loader->limit = slot->id;
+      }
+      slotFinish(loader, slot, SLOT_MISSING);
+      return;
+    }
+    if (res < 0) {
+      slotFinish(loader, slot, SLOT_FAILED);
+      return;
+    }
+    slot->fd = res;
+    if (slot->id >= loader->limit) {
+      slotFinish(loader, slot, SLOT_MISSING);
+      return;
+    }
+    if (fstat(slot->fd, &info) != 0) {
+      slotFinish(loader, slot, SLOT_FAILED);
+      return;
+    }
+    slot->size = info.st_size;
+    slot->buf = mem_malloc_assert(slot->size + 1, "Couldn't allocate page");
+    slot->state = SLOT_READING;
+  } else if (res == -EINTR || res == -EAGAIN) {
+    // nothing read; ask again
+  } else if (res < 0) {
+    slotFinish(loader, slot, SLOT_FAILED);
+    return;
+  } else if (res == 0) {
+    // end of file before the size fstat gave: keep what we have
+    slotFinish(loader, slot, SLOT_DONE);
+    return;
+  } else {
+    slot->have += res;
+  }
+
+  if (slot->have == slot->size) {
+    slotFinish(loader, slot, SLOT_DONE);
+  } else {
+    slotRead(loader, slot);
+  }
+}
+
+/*********** slotRead ***********/
+/* Queues a read of the rest of the slot's file */
+static void slotRead(pageloader_t* loader, slot_t* slot)
+{
+  size_t want = slot->size - slot->have;
+  struct io_uring_sqe sqe;
+  memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = IORING_OP_READ;
+  sqe.fd = slot->fd;
+  sqe.addr = (uintptr_t) (slot->buf + slot->have);
+  sqe.len = want > (1u << 30) ? (1u << 30) : want;
+  sqe.off = slot->have;
+  sqe.user_data = slot - loader->slots;
+  ringPush(&loader->ring, &sqe);
+}
+
+/*********** slotFinish ***********/
+/* Closes the slot's file, if open, and leaves it in state */
+static void slotFinish(pageloader_t* loader, slot_t* slot, slotState_t state)
+{
+  if (slot->fd >= 0) {
+    close(slot->fd);
+    slot->fd = -1;
+  }
+  if (state != SLOT_DONE) {
+    free(slot->buf);
+    slot->buf = NULL;
+  }
+  slot->state = state;
+  loader->inFlight--;
+}
+
+#endif // HAVE_URING
@@ -0,0 +1,69 @@
+/*
+ * pageloader.h - header file for CS50 'pageloader' module
+ *
+ * A *pageloader* reads the pages of a crawler directory in docID order,
+ * keeping many reads outstanding so the indexer is not left waiting on
+ * one file at a time. On Linux it batches the opens and reads through
+ * io_uring; where io_uring is missing or refused, a readahead thread
+ * loads pages ahead of the caller instead, hinting the kernel to start
+ * reading the files after them.
+ *
+ * Like pagedir_load, the loader treats the first missing page as the
+ * end of the crawl. A page io_uring fails to read is loaded with
+ * pagedir_load instead, with a message on stderr, so an I/O error
+ * doesn't end the crawl early.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __PAGELOADER_H
+#define __PAGELOADER_H
+
+#include <stdbool.h>
+#include "webpage.h"
+
+/********* Global Type ***********/
+typedef struct pageloader pageloader_t;
+
+/********** Functions ***********/
+
+/*********** pageloader_new ***********/
+/* Starts loading pages
+ *
+ * Caller provides:
+ *   The page directory, the first docID to load, how many pages to keep
+ *   in flight (depth), and whether to try io_uring at all
+ * We return:
+ *   A loader, or NULL if pageDirectory is NULL or firstID or depth < 1.
+ *   A loader that can't use io_uring falls back to a readahead thread.
+ * Caller is responsible for:
+ *   Later calling pageloader_delete
+ */
+pageloader_t* pageloader_new(const char* pageDirectory, int firstID, int depth, bool useUring);
+
+/*********** pageloader_next ***********/
+/* Returns the next page, in docID order
+ *
+ * We return:
+ *   The page, with its docID in *docID; or NULL once a page is missing
+ *   or unreadable, and for every call after that
+ * Caller is responsible for:
+ *   Later calling webpage_delete on the page
+ */
+webpage_t* pageloader_next(pageloader_t* loader, int* docID);
+
+/*********** pageloader_isUring ***********/
+/* Returns true if the loader reads through io_uring, false if it fell
+ * back to the readahead thread
+ */
+bool pageloader_isUring(pageloader_t* loader);
+
+/*********** pageloader_delete ***********/
+/* Stops loading, waits for outstanding reads and frees the loader with
+ * any pages it read ahead; does nothing if loader is NULL. If io_uring
+ * failed, the buffers of reads it never completed are not freed, since
+ * the kernel may still write to them.
+ */
+void pageloader_delete(pageloader_t* loader);
+
+#endif // __PAGELOADER_H
@@ -0,0 +1,148 @@
+/*
+ * phrase.c - CS50 'phrase' module
+ *
+ * The rarest word's list drives the intersection; every other list keeps
+ * a cursor that is moved forward by binary search to each candidate
+ * document. A document in every list has its positions decoded, word by
+ * word, and the phrase is counted by walking them together: an
+ * occurrence starting at position p needs word k at p + k.
+ *
+ * See phrase.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include "mem.h"
+#include "phrase.h"
+
+// one word's list while matching
+typedef struct wordCursor {
+  const postings_t* list;
+  int at;                 // current pair in list
+  int* positions;         // its positions in the candidate document
+  int capacity;           // room in positions
+  int next;               // first position countPhrase hasn't passed
+} wordCursor_t;
+
+// Static function prototypes
+static bool seek(wordCursor_t* cursor, int id);
+static int countPhrase(wordCursor_t* cursors, int numWords);
+
+/*********** phrase_match ***********/
+/* see phrase.h for more details */
+bool phrase_match(const postings_t* lists, int numWords, postings_t* matches)
+{
+  if (matches == NULL) {
+    return false;
+  }
+  *matches = postings_view(NULL, NULL, 0);
+  if (lists == NULL || numWords <= 0) {
+    return true;
+  }
+  int rarest = 0;
+  for (int k = 0; k < numWords; k++) {
+    if (lists[k].size == 0) {
+      return true;            // a missing word: nothing can match
+    }
+    if (!postings_hasPositions(&lists[k])) {
+      return false;
+    }
+    if (lists[k].size < lists[rarest].size) {
+      rarest = k;
+    }
+  }
+
+  wordCursor_t* cursors = mem_calloc_assert(numWords, sizeof(wordCursor_t), "Couldn't allocate phrase");
+  for (int k = 0; k < numWords; k++) {
+    cursors[k].list = &lists[k];
+  }
+
+  const postings_t* driver = &lists[rarest];
+  bool more = true;
+  for (int i = 0; more && i < driver->size; i++) {
+    int id = driver->ids[i];
+    bool everywhere = true;
+    for (int k = 0; more && everywhere && k < numWords; k++) {
+      more = seek(&cursors[k], id);
+      everywhere = more && cursors[k].list->ids[cursors[k].at] == id;
+    }
+    if (!everywhere) {
+      continue;
+    }
+
+    // a document with every word: only now are positions decoded
+    bool decoded = true;
+    for (int k = 0; decoded && k < numWords; k++) {
+      wordCursor_t* cursor = &cursors[k];
+      int count = cursor->list->counts[cursor->at];
+      if (count > cursor->capacity) {
+        cursor->capacity = count * 2;
+        cursor->positions = realloc(cursor->positions, cursor->capacity * sizeof(int));
+        mem_assert(cursor->positions, "Couldn't allocate phrase positions");
+      }
+      decoded = postings_positions(cursor->list, cursor->at, cursor->positions);
+      cursor->next = 0;
+    }
+    int found = decoded ? countPhrase(cursors, numWords) : 0;
+    if (found > 0) {
+      postings_set(matches, id, found);
+    }
+  }
+
+  for (int k = 0; k < numWords; k++) {
+    free(cursors[k].positions);
+  }
+  free(cursors);
+  return true;
+}
+
+/*********** seek ***********/
+/* Moves cursor to its first pair with an id >= id; returns false if
+ * there is none
+ */
+static bool seek(wordCursor_t* cursor, int id)
+{
+  const postings_t* list = cursor->list;
+  int low = cursor->at;
+  int high = list->size;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (list->ids[mid] < id) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  cursor->at = low;
+  return low < list->size;
+}
+
+/*********** countPhrase ***********/
+/* Counts the positions p of the first word with word k at p + k for
+ * every k; each word's positions are increasing, so one pass suffices
+ */
+static int countPhrase(wordCursor_t* cursors, int numWords)
+{
+  int found = 0;
+  const wordCursor_t* first = &cursors[0];
+  int firstCount = first->list->counts[first->at];
+  bool more = true;
+  for (int i = 0; more && i < firstCount; i++) {
+    int start = first->positions[i];
+    bool all = true;
+    for (int k = 1; more && all && k < numWords; k++) {
+      wordCursor_t* cursor = &cursors[k];
+      int count = cursor->list->counts[cursor->at];
+      while (cursor->next < count && cursor->positions[cursor->next] < start + k) {
+        cursor->next++;
+      }
+      more = cursor->next < count;
+      all = more && cursor->positions[cursor->next] == start + k;
+    }
+    if (all) {
+      found++;
+    }
+  }
+  return found;
+}
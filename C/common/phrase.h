@@ -0,0 +1,40 @@
+/*
+ * phrase.h - header file for CS50 'phrase' module
+ *
+ * This module answers phrase queries against a positional index: it
+ * finds the documents where a sequence of words occurs with each word
+ * directly after the one before. The words' postings are intersected
+ * first, and only the documents holding every word have their
+ * positions decoded and checked.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __PHRASE_H
+#define __PHRASE_H
+
+#include <stdbool.h>
+#include "postings.h"
+
+/********** Functions ***********/
+
+/*********** phrase_match ***********/
+/* Finds the documents holding a phrase
+ *
+ * Caller provides:
+ *   The postings of each of the numWords words of the phrase, in
+ *   phrase order (see index_get), and a postings_t to fill in
+ * We return:
+ *   true, with *matches an owning list of the documents where the words
+ *   occur at consecutive positions, each counted by how many times the
+ *   phrase occurs there; false if a non-empty list has no positions,
+ *   in which case *matches is empty
+ * Caller is responsible for:
+ *   Calling postings_release on *matches
+ * Notes:
+ *   Positions count only the words the indexer keeps, so words it
+ *   skips (shorter than three letters) should be left out of the phrase.
+ */
+bool phrase_match(const postings_t* lists, int numWords, postings_t* matches);
+
+#endif // __PHRASE_H
@@ -0,0 +1,162 @@
+/*
+ * plan.c - CS50 'plan' module
+ *
+ * Every term of the query goes into one array, each branch a run of it:
+ * a branch's terms are costed, sorted by cost and deduplicated in place,
+ * then compared with the branches kept so far. Sorting breaks ties by
+ * the words themselves, so two branches with the same terms, typed in
+ * any order, end up identical. A plan costs a dictionary lookup per word
+ * and reads no postings.
+ *
+ * See plan.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include "mem.h"
+#include "word.h"
+#include "plan.h"
+
+// Static function prototypes
+static int termCost(index_t* idx, const char* word, bool phrase);
+static int compareTerms(const void* first, const void* second);
+static bool sameTerms(const plan_branch_t* first, const plan_branch_t* second);
+
+/*********** plan_new ***********/
+/* see plan.h for more details */
+plan_t* plan_new(index_t* idx, char** wordSequence)
+{
+  if (idx == NULL || wordSequence == NULL) {
+    return NULL;
+  }
+  int numWords = 0;
+  while (wordSequence[numWords] != NULL) {
+    numWords++;
+  }
+  plan_t* plan = mem_calloc_assert(1, sizeof(plan_t), "Couldn't allocate plan");
+  plan->branches = mem_calloc_assert(numWords / 2 + 1, sizeof(plan_branch_t), "Couldn't allocate plan");
+  plan_term_t* terms = mem_calloc_assert(numWords + 1, sizeof(plan_term_t), "Couldn't allocate plan");
+
+  int pos = 0;
+  int used = 0;                 // terms taken by the branches kept
+  while (wordSequence[pos] != NULL) {
+    // the branch's terms, up to the next 'or'; absent if one can't match
+    plan_branch_t branch = { terms + used, 0, 1 };
+    bool absent = false;
+    for (; wordSequence[pos] != NULL && strcmp(wordSequence[pos], "or") != 0; pos++) {
+      if (strcmp(wordSequence[pos], "and") == 0 || absent) {
+        continue;
+      }
+      plan_term_t* term = &branch.terms[branch.numTerms++];
+      term->word = wordSequence[pos];
+      term->phrase = word_isPhrase(term->word);
+      term->cost = termCost(idx, term->word, term->phrase);
+      absent = term->cost == 0;
+    }
+    if (wordSequence[pos] != NULL) {
+      pos++;                    // skip the 'or'
+    }
+    if (absent) {
+      continue;
+    }
+
+    // cheapest first, each term once
+    qsort(branch.terms, branch.numTerms, sizeof(plan_term_t), compareTerms);
+    int kept = 0;
+    for (int t = 0; t < branch.numTerms; t++) {
+      if (kept == 0 || compareTerms(&branch.terms[kept - 1], &branch.terms[t]) != 0) {
+        branch.terms[kept++] = branch.terms[t];
+      }
+    }
+    branch.numTerms = kept;
+
+    // a branch already kept just counts again
+    int b = 0;
+    while (b < plan->numBranches && !sameTerms(&plan->branches[b], &branch)) {
+      b++;
+    }
+    if (b < plan->numBranches) {
+      plan->branches[b].repeats++;
+    } else {
+      plan->branches[plan->numBranches++] = branch;
+      used += branch.numTerms;
+    }
+  }
+  if (plan->numBranches == 0) {
+    free(terms);                // nothing points into them
+  }
+  return plan;
+}
+
+/*********** plan_delete ***********/
+/* see plan.h for more details */
+void plan_delete(plan_t* plan)
+{
+  if (plan != NULL) {
+    if (plan->numBranches > 0) {
+      free(plan->branches[0].terms);    // the start of every branch's terms
+    }
+    free(plan->branches);
+    free(plan);
+  }
+}
+
+/*********** termCost ***********/
+/* Returns how many documents hold a word, or for a phrase, the fewest
+ * that hold any of its words of three letters or more; 0 if it can't
+ * match
+ */
+static int termCost(index_t* idx, const char* word, bool phrase)
+{
+  if (!phrase) {
+    return index_frequency(idx, word);
+  }
+  char* words = mem_malloc_assert(strlen(word) + 1, "Couldn't allocate phrase");
+  strcpy(words, word);
+  int cost = -1;
+  char* rest;
+  for (char* each = strtok_r(words, " ", &rest); each != NULL && cost != 0; each = strtok_r(NULL, " ", &rest)) {
+    if (strlen(each) >= 3) {
+      int frequency = index_frequency(idx, each);
+      cost = cost < 0 || frequency < cost ? frequency : cost;
+    }
+  }
+  free(words);
+  return cost < 0 ? 0 : cost;
+}
+
+/*********** compareTerms ***********/
+/* qsort comparator ordering terms by cost, then words before phrases,
+ * which cost more to match, then alphabetically
+ */
+static int compareTerms(const void* first, const void* second)
+{
+  const plan_term_t* a = (const plan_term_t*) first;
+  const plan_term_t* b = (const plan_term_t*) second;
+  if (a->cost != b->cost) {
+    return (a->cost > b->cost) - (a->cost < b->cost);
+  }
+  if (a->phrase != b->phrase) {
+    return a->phrase ? 1 : -1;
+  }
+  return strcmp(a->word, b->word);
+}
+
+/*********** sameTerms ***********/
+/* Returns true if two sorted, deduplicated branches hold the same terms */
+static bool sameTerms(const plan_branch_t* first, const plan_branch_t* second)
+{
+  if (first->numTerms != second->numTerms) {
+    return false;
+  }
+  for (int t = 0; t < first->numTerms; t++) {
+    if (compareTerms(&first->terms[t], &second->terms[t]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
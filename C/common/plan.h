@@ -0,0 +1,72 @@
+/*
+ * plan.h - header file for CS50 'plan' module
+ *
+ * A *plan* says how a checked query will be evaluated, worked out from
+ * the index before any postings are read: its 'or' branches, each a set
+ * of and'ed terms (words or quoted phrases). Each term is costed by how
+ * many documents hold it, a phrase by its rarest word, and
+ *
+ *   - a branch's terms are ordered by cost, cheapest first, so its
+ *     intersection starts from the shortest list and can stop reading
+ *     lists as soon as its result is empty;
+ *   - a branch with a term no document holds can't match, and is dropped;
+ *   - a term repeated in a branch is kept once, since and'ing a list with
+ *     itself changes nothing;
+ *   - a branch repeated in the query is kept once, with how many times it
+ *     appeared, since its scores are added that many times.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __PLAN_H
+#define __PLAN_H
+
+#include <stdbool.h>
+#include "index.h"
+
+/********* Global Types ***********/
+// one and'ed term of a branch
+typedef struct plan_term {
+  const char* word;       // the word, or the phrase's words, from the sequence
+  bool phrase;            // see word_isPhrase
+  int cost;               // documents holding the word, or the phrase's rarest word
+} plan_term_t;
+
+// one 'or' branch
+typedef struct plan_branch {
+  plan_term_t* terms;     // cheapest first, none repeated
+  int numTerms;
+  int repeats;            // times the branch appears in the query
+} plan_branch_t;
+
+// a query's plan
+typedef struct plan {
+  plan_branch_t* branches;  // in the order they first appear; none repeated
+  int numBranches;          // 0 if nothing can match
+} plan_t;
+
+/********** Functions ***********/
+
+/*********** plan_new ***********/
+/* Plans a query
+ *
+ * Caller provides:
+ *   The index to evaluate it on, and a word sequence that passed
+ *   word_checkSyntax
+ * We return:
+ *   The plan, with no branches if no document can match; NULL if idx or
+ *   wordSequence is NULL
+ * Caller is responsible for:
+ *   Later calling plan_delete, and keeping wordSequence's words until then
+ * Notes:
+ *   Costs come from index_frequency, so no list is read or decoded. A
+ *   phrase's words shorter than three letters aren't costed, as they
+ *   aren't indexed; a phrase with no other words can't match.
+ */
+plan_t* plan_new(index_t* idx, char** wordSequence);
+
+/*********** plan_delete ***********/
+/* Frees a plan, but not the words it points to; does nothing if plan is NULL */
+void plan_delete(plan_t* plan);
+
+#endif // __PLAN_H
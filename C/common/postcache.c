@@ -0,0 +1,383 @@
+/*
+ * postcache.c - CS50 'postcache' module
+ *
+ * Lists are chained in a hash table of buckets, by their words, and
+ * linked from the most to the least recently used, as querycache.c
+ * keeps its answers. Frequencies are kept in a count-min sketch: four
+ * rows of byte counters, each word counted in one counter per row, at
+ * positions from the two halves of its 64-bit hash (mph_hash), and
+ * estimated by the lowest of the four. A lookup only raises the
+ * counters that are at that lowest (conservative update), and all
+ * counts stop at 15, which is as high as frequency needs to go to tell
+ * a hot word from a cold one. Once the sketch has counted ten lookups
+ * per counter of a row, every counter is halved.
+ *
+ * Each entry counts the views holding a lease on it. An evicted entry
+ * leaves the table and the list at once, but is only freed once the
+ * last of them is released. One mutex guards it all.
+ *
+ * See postcache.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "mem.h"
+#include "mph.h"
+#include "postcache.h"
+
+#define SKETCH_ROWS 4
+#define SKETCH_MAX 15              // counts stop here
+#define SKETCH_SAMPLES 10          // lookups per counter of a row before halving
+#define BUDGET_PER_COUNTER 256     // bytes of budget per counter
+#define MIN_WIDTH 1024             // counters per row, at least
+#define MAX_WIDTH (1 << 20)        // and at most
+#define FIRST_BUCKETS 64
+
+/**************** file-local types ****************/
+// one cached list; the lease is first, so a view's lease is its entry
+typedef struct entry {
+  postings_lease_t lease;
+  struct postcache* cache;
+  char* word;
+  uint64_t hash;
+  postings_t postings;    // owning
+  size_t bytes;           // the entry, its word and its list
+  int leases;             // views of it not yet released
+  bool evicted;           // out of the table, freed with its last lease
+  struct entry* next;     // in its bucket
+  struct entry* newer;    // toward the most recently used
+  struct entry* older;    // toward the least recently used
+} entry_t;
+
+struct postcache {
+  entry_t** buckets;
+  int numBuckets;
+  entry_t* newest;
+  entry_t* oldest;
+  uint8_t* sketch;        // SKETCH_ROWS rows of width counters
+  uint32_t width;         // a power of two
+  long counted;           // lookups since the sketch was last halved
+  postcache_stats_t stats;
+  pthread_mutex_t lock;
+};
+
+// Static function prototypes
+static void countWord(postcache_t* cache, uint64_t hash);
+static int frequency(postcache_t* cache, uint64_t hash);
+static uint32_t counterAt(postcache_t* cache, uint64_t hash, int row);
+static entry_t* find(postcache_t* cache, const char* word, uint64_t hash);
+static void detach(postcache_t* cache, entry_t* entry);
+static void pushNewest(postcache_t* cache, entry_t* entry);
+static void evict(postcache_t* cache, entry_t* entry);
+static void freeEntry(entry_t* entry);
+static void grow(postcache_t* cache);
+static void releaseLease(postings_lease_t* lease);
+static postings_t leasedView(entry_t* entry);
+static size_t listBytes(const postings_t* postings);
+
+/*********** postcache_new ***********/
+/* see postcache.h for more details */
+postcache_t* postcache_new(size_t budget)
+{
+  if (budget == 0) {
+    return NULL;
+  }
+  postcache_t* cache = mem_calloc_assert(1, sizeof(postcache_t), "Couldn't allocate cache");
+  cache->width = MIN_WIDTH;
+  while (cache->width < MAX_WIDTH && (size_t) cache->width * SKETCH_ROWS * BUDGET_PER_COUNTER < budget) {
+    cache->width *= 2;
+  }
+  cache->sketch = mem_calloc_assert((size_t) cache->width * SKETCH_ROWS, sizeof(uint8_t), "Couldn't allocate cache");
+  cache->numBuckets = FIRST_BUCKETS;
+  cache->buckets = mem_calloc_assert(cache->numBuckets, sizeof(entry_t*), "Couldn't allocate cache");
+  cache->stats.budget = budget;
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+/*********** postcache_get ***********/
+/* see postcache.h for more details */
+bool postcache_get(postcache_t* cache, const char* word, postings_t* postings)
+{
+  if (cache == NULL || word == NULL || postings == NULL) {
+    return false;
+  }
+  uint64_t hash = mph_hash(word);
+  pthread_mutex_lock(&cache->lock);
+  countWord(cache, hash);
+  entry_t* entry = find(cache, word, hash);
+  if (entry != NULL) {
+    detach(cache, entry);
+    pushNewest(cache, entry);
+    *postings = leasedView(entry);
+    cache->stats.hits++;
+  } else {
+    cache->stats.misses++;
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return entry != NULL;
+}
+
+/*********** postcache_offer ***********/
+/* see postcache.h for more details */
+void postcache_offer(postcache_t* cache, const char* word, postings_t* postings)
+{
+  if (cache == NULL || word == NULL || postings == NULL || postings->capacity == 0) {
+    return;
+  }
+  size_t bytes = sizeof(entry_t) + strlen(word) + 1 + listBytes(postings);
+  uint64_t hash = mph_hash(word);
+  pthread_mutex_lock(&cache->lock);
+  if (bytes > cache->stats.budget || find(cache, word, hash) != NULL) {
+    pthread_mutex_unlock(&cache->lock);
+    return;
+  }
+
+  // the least recently used lists it would need the room of; it gets in
+  // only if its word is more frequent than every one of theirs
+  int wanted = frequency(cache, hash);
+  size_t room = cache->stats.budget - cache->stats.bytes;
+  entry_t* victim = cache->oldest;
+  for (; room < bytes; victim = victim->newer) {
+    if (frequency(cache, victim->hash) >= wanted) {
+      cache->stats.rejected++;
+      pthread_mutex_unlock(&cache->lock);
+      return;
+    }
+    room += victim->bytes;
+  }
+  while (cache->oldest != victim) {
+    evict(cache, cache->oldest);
+    cache->stats.evicted++;
+  }
+
+  entry_t* entry = mem_calloc_assert(1, sizeof(entry_t), "Couldn't allocate cache entry");
+  entry->lease.release = releaseLease;
+  entry->cache = cache;
+  entry->word = mem_malloc_assert(strlen(word) + 1, "Couldn't allocate cache entry");
+  strcpy(entry->word, word);
+  entry->hash = hash;
+  entry->postings = *postings;
+  entry->bytes = bytes;
+  if (cache->stats.entries >= cache->numBuckets) {
+    grow(cache);
+  }
+  entry_t** bucket = &cache->buckets[hash & (cache->numBuckets - 1)];
+  entry->next = *bucket;
+  *bucket = entry;
+  pushNewest(cache, entry);
+  cache->stats.entries++;
+  cache->stats.bytes += bytes;
+  cache->stats.admitted++;
+  *postings = leasedView(entry);
+  pthread_mutex_unlock(&cache->lock);
+}
+
+/*********** postcache_stats ***********/
+/* see postcache.h for more details */
+void postcache_stats(postcache_t* cache, postcache_stats_t* stats)
+{
+  if (stats == NULL) {
+    return;
+  }
+  if (cache == NULL) {
+    memset(stats, 0, sizeof(postcache_stats_t));
+    return;
+  }
+  pthread_mutex_lock(&cache->lock);
+  *stats = cache->stats;
+  pthread_mutex_unlock(&cache->lock);
+}
+
+/*********** postcache_delete ***********/
+/* see postcache.h for more details */
+void postcache_delete(postcache_t* cache)
+{
+  if (cache != NULL) {
+    while (cache->oldest != NULL) {
+      evict(cache, cache->oldest);
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->sketch);
+    free(cache->buckets);
+    free(cache);
+  }
+}
+
+/*********** countWord ***********/
+/* Counts a lookup of a word in the sketch, halving every counter once
+ * enough lookups have been counted
+ */
+static void countWord(postcache_t* cache, uint64_t hash)
+{
+  int lowest = frequency(cache, hash);
+  if (lowest < SKETCH_MAX) {
+    for (int row = 0; row < SKETCH_ROWS; row++) {
+      uint8_t* counter = &cache->sketch[counterAt(cache, hash, row)];
+      if (*counter == lowest) {
+        (*counter)++;
+      }
+    }
+  }
+  if (++cache->counted >= (long) cache->width * SKETCH_SAMPLES) {
+    for (size_t i = 0; i < (size_t) cache->width * SKETCH_ROWS; i++) {
+      cache->sketch[i] /= 2;
+    }
+    cache->counted /= 2;
+  }
+}
+
+/*********** frequency ***********/
+/* Returns the sketch's estimate of how often a word was looked up lately */
+static int frequency(postcache_t* cache, uint64_t hash)
+{
+  int lowest = SKETCH_MAX;
+  for (int row = 0; row < SKETCH_ROWS; row++) {
+    int count = cache->sketch[counterAt(cache, hash, row)];
+    lowest = count < lowest ? count : lowest;
+  }
+  return lowest;
+}
+
+/*********** counterAt ***********/
+/* Returns where a word's counter in a row is: the low half of its hash
+ * stepped row times by the (odd) high half, within the row
+ */
+static uint32_t counterAt(postcache_t* cache, uint64_t hash, int row)
+{
+  uint32_t low = (uint32_t) hash;
+  uint32_t high = (uint32_t) (hash >> 32) | 1;
+  return row * cache->width + ((low + row * high) & (cache->width - 1));
+}
+
+/*********** find ***********/
+/* Returns the cached entry for word, or NULL; the caller holds the lock */
+static entry_t* find(postcache_t* cache, const char* word, uint64_t hash)
+{
+  entry_t* entry = cache->buckets[hash & (cache->numBuckets - 1)];
+  while (entry != NULL && (entry->hash != hash || strcmp(entry->word, word) != 0)) {
+    entry = entry->next;
+  }
+  return entry;
+}
+
+/*********** detach ***********/
+/* Takes an entry out of the recently used list */
+static void detach(postcache_t* cache, entry_t* entry)
+{
+  if (entry->newer != NULL) {
+    entry->newer->older = entry->older;
+  } else {
+    cache->newest = entry->older;
+  }
+  if (entry->older != NULL) {
+    entry->older->newer = entry->newer;
+  } else {
+    cache->oldest = entry->newer;
+  }
+  entry->newer = entry->older = NULL;
+}
+
+/*********** pushNewest ***********/
+/* Puts a detached entry at the front of the recently used list */
+static void pushNewest(postcache_t* cache, entry_t* entry)
+{
+  entry->older = cache->newest;
+  entry->newer = NULL;
+  if (cache->newest != NULL) {
+    cache->newest->newer = entry;
+  } else {
+    cache->oldest = entry;
+  }
+  cache->newest = entry;
+}
+
+/*********** evict ***********/
+/* Drops an entry from its bucket and the list; frees it unless views of
+ * it are still out, in which case the last one released frees it
+ */
+static void evict(postcache_t* cache, entry_t* entry)
+{
+  entry_t** at = &cache->buckets[entry->hash & (cache->numBuckets - 1)];
+  while (*at != entry) {
+    at = &(*at)->next;
+  }
+  *at = entry->next;
+  detach(cache, entry);
+  cache->stats.entries--;
+  cache->stats.bytes -= entry->bytes;
+  entry->evicted = true;
+  if (entry->leases == 0) {
+    freeEntry(entry);
+  }
+}
+
+/*********** freeEntry ***********/
+/* Frees an evicted entry and its list */
+static void freeEntry(entry_t* entry)
+{
+  postings_release(&entry->postings);
+  free(entry->word);
+  free(entry);
+}
+
+/*********** grow ***********/
+/* Doubles the buckets, and moves every entry to its new one */
+static void grow(postcache_t* cache)
+{
+  int numBuckets = cache->numBuckets * 2;
+  entry_t** buckets = mem_calloc_assert(numBuckets, sizeof(entry_t*), "Couldn't grow cache");
+  for (entry_t* entry = cache->newest; entry != NULL; entry = entry->older) {
+    entry_t** bucket = &buckets[entry->hash & (numBuckets - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+  }
+  free(cache->buckets);
+  cache->buckets = buckets;
+  cache->numBuckets = numBuckets;
+}
+
+/*********** releaseLease ***********/
+/* Called by postings_release on a view of an entry: one view fewer, and
+ * the entry is freed if it was evicted and that was the last
+ */
+static void releaseLease(postings_lease_t* lease)
+{
+  entry_t* entry = (entry_t*) lease;
+  postcache_t* cache = entry->cache;
+  pthread_mutex_lock(&cache->lock);
+  bool last = --entry->leases == 0 && entry->evicted;
+  pthread_mutex_unlock(&cache->lock);
+  if (last) {
+    freeEntry(entry);
+  }
+}
+
+/*********** leasedView ***********/
+/* Returns a view of an entry's list, positions included, holding a new
+ * lease on it; the caller holds the lock
+ */
+static postings_t leasedView(entry_t* entry)
+{
+  postings_t view = entry->postings;
+  view.capacity = 0;
+  view.posCapacity = 0;
+  view.lease = &entry->lease;
+  entry->leases++;
+  return view;
+}
+
+/*********** listBytes ***********/
+/* Returns the bytes an owning list's arrays take */
+static size_t listBytes(const postings_t* postings)
+{
+  size_t bytes = (size_t) postings->capacity * 2 * sizeof(int);
+  if (postings->posCapacity > 0) {
+    bytes += postings->posCapacity + (size_t) postings->capacity * sizeof(uint64_t);
+  }
+  return bytes;
+}
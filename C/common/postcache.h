@@ -0,0 +1,105 @@
+/*
+ * postcache.h - header file for CS50 'postcache' module
+ *
+ * A *postcache* keeps decoded postings lists, by word, so the words a
+ * query log asks for most are decoded once rather than on every query:
+ * the lists of a compressed index (indexer -c), and those of a
+ * segmented one, which are joined from every segment. See
+ * index_setCache.
+ *
+ * The cache holds at most a budget of bytes. Whether a newly decoded
+ * list gets in is decided by how often its word has been asked for
+ * (TinyLFU): every lookup, hit or miss, is counted in a small sketch of
+ * recent word frequencies, and a list that needs room is only admitted
+ * if its word is asked for more often than every least recently used
+ * list it would evict. A word seen once in a long log can't push out
+ * the lists that are asked for all the time, which plain LRU would let
+ * it do. The sketch halves its counts now and then, so it follows what
+ * is asked for lately.
+ *
+ * A cached list is handed out as a view holding a lease on it (see
+ * postings.h): it stays valid, even if it is evicted meanwhile, until
+ * the view is released. Any number of threads may use one cache at once.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __POSTCACHE_H
+#define __POSTCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "postings.h"
+
+/********* Global Types ***********/
+typedef struct postcache postcache_t;
+
+// what a cache has done so far, and holds now
+typedef struct postcache_stats {
+  long hits;              // lookups answered with a cached list
+  long misses;            // lookups that weren't
+  long admitted;          // decoded lists taken in
+  long rejected;          // decoded lists turned away, as rarer than what they'd evict
+  long evicted;           // lists dropped to make room
+  int entries;            // lists held now
+  size_t bytes;           // bytes they take
+  size_t budget;          // bytes they may take
+} postcache_stats_t;
+
+/********** Functions ***********/
+
+/*********** postcache_new ***********/
+/* Creates an empty cache
+ *
+ * Caller provides:
+ *   How many bytes the cached lists, with their words, may take
+ * We return:
+ *   A new cache, or NULL if budget is 0; every function treats a NULL
+ *   cache as one that never holds anything
+ * Caller is responsible for:
+ *   Later calling postcache_delete
+ * Notes:
+ *   The frequency sketch is sized by the budget, a byte per counter for
+ *   every 256 bytes of budget, between 4 kilobytes and 4 megabytes.
+ */
+postcache_t* postcache_new(size_t budget);
+
+/*********** postcache_get ***********/
+/* Looks up a word's decoded list, counting the lookup toward its frequency
+ *
+ * Caller provides:
+ *   The cache, a word, and where to put its list
+ * We return:
+ *   true, with *postings a view of the cached list holding a lease on
+ *   it; false if it isn't cached, or cache or word is NULL, leaving
+ *   *postings alone
+ * Caller is responsible for:
+ *   Calling postings_release on *postings
+ */
+bool postcache_get(postcache_t* cache, const char* word, postings_t* postings);
+
+/*********** postcache_offer ***********/
+/* Offers the cache a word's list, just decoded after postcache_get missed
+ *
+ * Caller provides:
+ *   The cache, the word, and its list, which owns its arrays
+ * We do:
+ *   If the list is admitted, take its arrays and make *postings a view
+ *   of them holding a lease, evicting the least recently used lists to
+ *   make room. Otherwise, or if the word is already cached, the list is
+ *   too big for the budget, or the list is a view, *postings is left as
+ *   it was. Either way the caller calls postings_release on it as usual.
+ */
+void postcache_offer(postcache_t* cache, const char* word, postings_t* postings);
+
+/*********** postcache_stats ***********/
+/* Fills in *stats with the cache's counts so far; all zero if cache is NULL */
+void postcache_stats(postcache_t* cache, postcache_stats_t* stats);
+
+/*********** postcache_delete ***********/
+/* Frees the cache and every list; does nothing if cache is NULL. No
+ * thread may be using the cache, and no view of it may be unreleased.
+ */
+void postcache_delete(postcache_t* cache);
+
+#endif // __POSTCACHE_H
@@ -0,0 +1,324 @@
+/*
+ * postings.c - CS50 'postings' module
+ *
+ * This module implements sorted (docID, count) arrays. Appending a
+ * larger id is the fast path; anything else is placed with a binary
+ * search and a memmove. Word positions, when a list has them, are
+ * appended to one growing byte buffer, with the offset of each pair's
+ * positions kept in posStarts alongside ids and counts.
+ *
+ * See postings.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "mem.h"
+#include "codec.h"
+#include "postings.h"
+
+// Static function prototypes
+static int findPos(const postings_t* postings, int id);
+static void reservePositions(postings_t* postings, uint64_t length);
+static void dropPositions(postings_t* postings);
+
+/*********** postings_new ***********/
+/* see postings.h for more details */
+postings_t* postings_new(void)
+{
+  return mem_calloc_assert(1, sizeof(postings_t), "Couldn't allocate postings");
+}
+
+/*********** postings_view ***********/
+/* see postings.h for more details */
+postings_t postings_view(const int* ids, const int* counts, int size)
+{
+  postings_t view = { (int*) ids, (int*) counts, size, 0, NULL, NULL, 0, 0, NULL };
+  return view;
+}
+
+/*********** postings_add ***********/
+/* see postings.h for more details */
+int postings_add(postings_t* postings, int id)
+{
+  if (postings == NULL || id < 0 || postings->positions != NULL) {
+    return 0;
+  }
+  int pos = findPos(postings, id);
+  if (pos < postings->size && postings->ids[pos] == id) {
+    return ++postings->counts[pos];
+  }
+  return postings_set(postings, id, 1) ? 1 : 0;
+}
+
+/*********** postings_set ***********/
+/* see postings.h for more details */
+bool postings_set(postings_t* postings, int id, int count)
+{
+  if (postings == NULL || id < 0 || count < 0) {
+    return false;
+  }
+  if ((postings->capacity == 0 && postings->ids != NULL) || postings->positions != NULL) {
+    return false;  // read-only view, or positions that would fall out of step
+  }
+  int pos = findPos(postings, id);
+  if (pos < postings->size && postings->ids[pos] == id) {
+    postings->counts[pos] = count;
+    return true;
+  }
+
+  // make room and shift larger ids up one (no shift for an append)
+  if (postings->size == postings->capacity) {
+    postings_reserve(postings, postings->capacity == 0 ? 4 : postings->capacity * 2);
+  }
+  int tail = postings->size - pos;
+  memmove(postings->ids + pos + 1, postings->ids + pos, tail * sizeof(int));
+  memmove(postings->counts + pos + 1, postings->counts + pos, tail * sizeof(int));
+  postings->ids[pos] = id;
+  postings->counts[pos] = count;
+  postings->size++;
+  return true;
+}
+
+/*********** postings_addPositions ***********/
+/* see postings.h for more details */
+bool postings_addPositions(postings_t* postings, int id, const int* positions, int count)
+{
+  if (postings == NULL || id < 0 || positions == NULL || count <= 0
+      || (postings->capacity == 0 && postings->ids != NULL)
+      || (postings->positions != NULL && postings->posCapacity == 0)
+      || (postings->size > 0 && (postings->positions == NULL || postings->ids[postings->size - 1] >= id))) {
+    return false;
+  }
+  if (postings->size == postings->capacity) {
+    postings_reserve(postings, postings->capacity == 0 ? 4 : postings->capacity * 2);
+  }
+  reservePositions(postings, postings->posLength + codec_maxPositionBytes(count));
+
+  int i = postings->size++;
+  postings->ids[i] = id;
+  postings->counts[i] = count;
+  postings->posStarts[i] = postings->posLength;
+  postings->posLength += codec_encodePositions(positions, count, postings->positions + postings->posLength);
+  return true;
+}
+
+/*********** postings_hasPositions ***********/
+/* see postings.h for more details */
+bool postings_hasPositions(const postings_t* postings)
+{
+  return postings != NULL && postings->positions != NULL;
+}
+
+/*********** postings_positions ***********/
+/* see postings.h for more details */
+bool postings_positions(const postings_t* postings, int i, int* positions)
+{
+  if (!postings_hasPositions(postings) || i < 0 || i >= postings->size || positions == NULL) {
+    return false;
+  }
+  uint64_t start = postings->posStarts[i];
+  return start < postings->posLength
+         && codec_decodePositions(postings->positions + start, postings->posLength - start,
+                                  postings->counts[i], positions) > 0;
+}
+
+/*********** postings_positionBytes ***********/
+/* see postings.h for more details */
+uint64_t postings_positionBytes(const postings_t* postings)
+{
+  if (!postings_hasPositions(postings) || postings->size == 0) {
+    return 0;
+  }
+  // a list's positions are stored in order, so they end with the last pair's
+  uint64_t first = postings->posStarts[0];
+  uint64_t last = postings->posStarts[postings->size - 1];
+  if (first > last || last >= postings->posLength) {
+    return 0;
+  }
+  size_t lastBytes = codec_decodePositions(postings->positions + last, postings->posLength - last,
+                                           postings->counts[postings->size - 1], NULL);
+  return lastBytes == 0 ? 0 : last + lastBytes - first;
+}
+
+/*********** postings_append ***********/
+/* see postings.h for more details */
+void postings_append(postings_t* dst, const postings_t* src)
+{
+  if (dst == NULL || src == NULL || src->size == 0) {
+    return;
+  }
+  bool keep = postings_hasPositions(src)
+              && (dst->size == 0 || (dst->positions != NULL && dst->posCapacity > 0));
+  int size = dst->size;
+  if (dst->capacity == 0) {
+    dropPositions(dst);         // an empty view's positions aren't ours to grow
+  }
+  postings_reserve(dst, size + src->size);
+  memcpy(dst->ids + size, src->ids, src->size * sizeof(int));
+  memcpy(dst->counts + size, src->counts, src->size * sizeof(int));
+  dst->size = size + src->size;
+
+  // src's positions are contiguous: copy their bytes and rebase the starts
+  uint64_t bytes = keep ? postings_positionBytes(src) : 0;
+  if (bytes == 0) {
+    dropPositions(dst);
+    return;
+  }
+  uint64_t first = src->posStarts[0];
+  reservePositions(dst, dst->posLength + bytes);
+  memcpy(dst->positions + dst->posLength, src->positions + first, bytes);
+  for (int i = 0; i < src->size; i++) {
+    dst->posStarts[size + i] = dst->posLength + (src->posStarts[i] - first);
+  }
+  dst->posLength += bytes;
+}
+
+/*********** postings_get ***********/
+/* see postings.h for more details */
+int postings_get(const postings_t* postings, int id)
+{
+  if (postings == NULL) {
+    return 0;
+  }
+  int pos = findPos(postings, id);
+  if (pos < postings->size && postings->ids[pos] == id) {
+    return postings->counts[pos];
+  }
+  return 0;
+}
+
+/*********** postings_iterate ***********/
+/* see postings.h for more details */
+void postings_iterate(const postings_t* postings, void* arg,
+                      void (*itemfunc)(void* arg, const int id, const int count))
+{
+  if (postings == NULL || itemfunc == NULL) {
+    return;
+  }
+  for (int i = 0; i < postings->size; i++) {
+    itemfunc(arg, postings->ids[i], postings->counts[i]);
+  }
+}
+
+/*********** postings_release ***********/
+/* see postings.h for more details */
+void postings_release(postings_t* postings)
+{
+  if (postings != NULL) {
+    if (postings->capacity > 0) {
+      free(postings->ids);
+      free(postings->counts);
+    }
+    dropPositions(postings);
+    if (postings->lease != NULL) {
+      postings->lease->release(postings->lease);
+    }
+    *postings = postings_view(NULL, NULL, 0);
+  }
+}
+
+/*********** postings_compareSizes ***********/
+/* see postings.h for more details */
+int postings_compareSizes(const void* first, const void* second)
+{
+  int a = ((const postings_t*) first)->size;
+  int b = ((const postings_t*) second)->size;
+  return (a < b) - (a > b);
+}
+
+/*********** postings_delete ***********/
+/* see postings.h for more details */
+void postings_delete(postings_t* postings)
+{
+  if (postings != NULL) {
+    postings_release(postings);
+    free(postings);
+  }
+}
+
+/*********** findPos ***********/
+/* Returns the index of the first id >= the given id */
+static int findPos(const postings_t* postings, int id)
+{
+  int size = postings->size;
+  // common case while building: id goes at (or is) the end
+  if (size == 0 || postings->ids[size - 1] < id) {
+    return size;
+  }
+  int low = 0;
+  int high = size - 1;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (postings->ids[mid] < id) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/*********** postings_reserve ***********/
+/* see postings.h for more details */
+void postings_reserve(postings_t* postings, int capacity)
+{
+  if (postings == NULL || capacity <= postings->capacity) {
+    return;
+  }
+  if (postings->capacity == 0) {
+    postings->ids = NULL;       // never realloc a view's memory
+    postings->counts = NULL;
+    postings->size = 0;
+    if (postings->lease != NULL) {
+      postings->lease->release(postings->lease);
+      postings->lease = NULL;
+    }
+  }
+  postings->ids = realloc(postings->ids, capacity * sizeof(int));
+  postings->counts = realloc(postings->counts, capacity * sizeof(int));
+  mem_assert(postings->ids, "Couldn't grow postings");
+  mem_assert(postings->counts, "Couldn't grow postings");
+  if (postings->posCapacity > 0) {
+    postings->posStarts = realloc(postings->posStarts, capacity * sizeof(uint64_t));
+    mem_assert(postings->posStarts, "Couldn't grow postings");
+  }
+  postings->capacity = capacity;
+}
+
+/*********** reservePositions ***********/
+/* Makes sure an owning list owns a positions buffer of at least length
+ * bytes, and starts for all its slots
+ */
+static void reservePositions(postings_t* postings, uint64_t length)
+{
+  if (postings->posCapacity == 0) {
+    postings->positions = NULL;
+    postings->posStarts = mem_malloc_assert(postings->capacity * sizeof(uint64_t), "Couldn't allocate positions");
+    postings->posLength = 0;
+  }
+  if (length > postings->posCapacity) {
+    uint64_t capacity = postings->posCapacity == 0 ? 64 : postings->posCapacity;
+    while (capacity < length) {
+      capacity *= 2;
+    }
+    postings->positions = realloc(postings->positions, capacity);
+    mem_assert(postings->positions, "Couldn't grow positions");
+    postings->posCapacity = capacity;
+  }
+}
+
+/*********** dropPositions ***********/
+/* Frees a list's positions if it owns them and forgets them */
+static void dropPositions(postings_t* postings)
+{
+  if (postings->posCapacity > 0) {
+    free(postings->positions);
+    free(postings->posStarts);
+  }
+  postings->positions = NULL;
+  postings->posStarts = NULL;
+  postings->posLength = 0;
+  postings->posCapacity = 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * postings.h - header file for CS50 'postings' module
+ *
+ * A *postings* list holds the (docID, count) pairs for one word, kept
+ * sorted by docID in two parallel arrays. The index builds these lists
+ * in memory, and the binary index file stores them in the same layout,
+ * so a list can either own its arrays or be a read-only view of
+ * someone else's memory (for example an mmap'ed index file).
+ *
+ * A list in a positional index also holds, for every posting, the word
+ * positions where the word occurs in the document, coded with the codec
+ * module. They are decoded one posting at a time, on demand.
+ *
+ * A view may also hold a *lease* on a list that is shared, such as one
+ * in a cache of decoded lists (see postcache.h): the list stays put
+ * until the view is released, and postings_release hands the lease back.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __POSTINGS_H
+#define __POSTINGS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/********* Global Types ***********/
+// what a view holds on a shared list: release is called, once, when the
+// view is released
+typedef struct postings_lease {
+  void (*release)(struct postings_lease* lease);
+} postings_lease_t;
+
+typedef struct postings {
+  int* ids;              // document IDs, strictly increasing
+  int* counts;           // counts[i] is the count for ids[i]
+  int size;              // number of (id, count) pairs
+  int capacity;          // slots allocated in ids/counts; 0 for a view
+  // word positions, NULL unless the list has them: the counts[i]
+  // positions of ids[i] are coded at positions + posStarts[i]
+  unsigned char* positions;
+  uint64_t* posStarts;
+  uint64_t posLength;    // bytes of positions that may be read
+  uint64_t posCapacity;  // bytes allocated for positions; 0 for a view
+  postings_lease_t* lease;  // on the shared list a view points into, or NULL
+} postings_t;
+
+/********** Functions ***********/
+
+/*********** postings_new ***********/
+/* Creates an empty, growable postings list
+ *
+ * We return:
+ *   A valid pointer to an empty list that owns its arrays
+ * Caller is responsible for:
+ *   Later calling postings_delete
+ */
+postings_t* postings_new(void);
+
+/*********** postings_view ***********/
+/* Returns a read-only view of existing id and count arrays
+ *
+ * Caller provides:
+ *   Arrays of size entries sorted by id (may be NULL if size is 0)
+ * We return:
+ *   A postings_t by value with capacity 0; it must not be modified,
+ *   and it stays valid only as long as the arrays do.
+ */
+postings_t postings_view(const int* ids, const int* counts, int size);
+
+/*********** postings_add ***********/
+/* Increments the count for id by 1, adding id with count 1 if absent
+ *
+ * Caller provides:
+ *   A list that owns its arrays and a non-negative id
+ * We return:
+ *   The new count for id, or 0 on error
+ * Notes:
+ *   Adding ids in increasing order, as the indexer does, is O(1).
+ *   Fails on a list with positions; see postings_addPositions.
+ */
+int postings_add(postings_t* postings, int id);
+
+/*********** postings_set ***********/
+/* Sets the count for id, adding id if absent
+ *
+ * Caller provides:
+ *   A list that owns its arrays, a non-negative id and count
+ * We return:
+ *   true on success, false on error or if the list is a view
+ *   or has positions
+ */
+bool postings_set(postings_t* postings, int id, int count);
+
+/*********** postings_addPositions ***********/
+/* Appends id with the word positions it occurs at
+ *
+ * Caller provides:
+ *   A list that owns its arrays and is empty or has positions, an id
+ *   larger than every id in it, and count > 0 positions in strictly
+ *   increasing order
+ * We return:
+ *   true on success; false on bad arguments, in which case the list
+ *   is unchanged. count becomes the count for id.
+ */
+bool postings_addPositions(postings_t* postings, int id, const int* positions, int count);
+
+/*********** postings_hasPositions ***********/
+/* Returns true if postings holds word positions */
+bool postings_hasPositions(const postings_t* postings);
+
+/*********** postings_positions ***********/
+/* Decodes the word positions of the i'th pair
+ *
+ * Caller provides:
+ *   A list with positions, 0 <= i < size, and an array with room
+ *   for counts[i] positions
+ * We return:
+ *   true if they were decoded, in increasing order; false if the list
+ *   has no positions, i is out of range or the coded bytes are malformed
+ */
+bool postings_positions(const postings_t* postings, int i, int* positions);
+
+/*********** postings_positionBytes ***********/
+/* Returns how many bytes the coded positions of the whole list take,
+ * from positions + posStarts[0]; 0 if it has none or they are malformed
+ */
+uint64_t postings_positionBytes(const postings_t* postings);
+
+/*********** postings_append ***********/
+/* Appends every pair of src to dst
+ *
+ * Caller provides:
+ *   A list dst that owns its arrays or is empty, and a list src whose
+ *   ids are all larger than those in dst
+ * We guarantee:
+ *   dst keeps positions if src and dst both have them (or dst was
+ *   empty and src has them), and loses them otherwise.
+ *   Exits if memory can't be allocated.
+ */
+void postings_append(postings_t* dst, const postings_t* src);
+
+/*********** postings_reserve ***********/
+/* Makes sure a list owns arrays with room for at least capacity pairs
+ *
+ * Caller provides:
+ *   A list (owning, or an empty view) and the capacity wanted
+ * We guarantee:
+ *   Existing pairs are kept; an empty view becomes an owning list.
+ *   Exits if memory can't be allocated.
+ */
+void postings_reserve(postings_t* postings, int capacity);
+
+/*********** postings_get ***********/
+/* Returns the count for id, or 0 if id is absent or postings is NULL */
+int postings_get(const postings_t* postings, int id);
+
+/*********** postings_iterate ***********/
+/* Calls itemfunc(arg, id, count) for every pair in increasing id order
+ * Does nothing if postings or itemfunc is NULL
+ */
+void postings_iterate(const postings_t* postings, void* arg,
+                      void (*itemfunc)(void* arg, const int id, const int count));
+
+/*********** postings_compareSizes ***********/
+/* qsort comparator ordering postings_t's from the longest list to the
+ * shortest, e.g. to pick an index's most frequent words
+ */
+int postings_compareSizes(const void* first, const void* second);
+
+/*********** postings_release ***********/
+/* Frees the arrays (and positions) of a postings_t held by value,
+ * if it owns them, and leaves it an empty view. The memory behind a view is not touched,
+ * but a view's lease is released. Does nothing if postings is NULL
+ */
+void postings_release(postings_t* postings);
+
+/*********** postings_delete ***********/
+/* Deletes a list made by postings_new, freeing its arrays
+ * Does nothing if postings is NULL
+ */
+void postings_delete(postings_t* postings);
+
+#endif // __POSTINGS_H
@@ -0,0 +1,278 @@
+/*
+ * prune.c - CS50 'prune' module
+ *
+ * prune_file makes three passes over the full file with
+ * indexfile_iterate. The first totals the postings and the word text
+ * and, for global pruning, builds a histogram of the counts outside
+ * each word's best PRUNE_KEEP, from which the threshold is read off
+ * top down; postings at exactly the threshold are kept first come,
+ * first served, up to the target. The second prunes every list to size
+ * the output, and the third prunes them again into the writer. A pruned
+ * list is rebuilt posting by posting, with its positions decoded and
+ * coded again.
+ *
+ * See prune.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "mem.h"
+#include "prune.h"
+
+// counts at or above this share the histogram's last bucket
+#define HISTOGRAM_COUNTS 65536
+
+// what the passes over the full file share
+typedef struct pruneState {
+  int mode;
+  double value;
+  int threshold;              // global: smallest count kept past a word's best
+  uint64_t ties;              // global: postings to keep at exactly threshold
+  uint64_t tiesLeft;          // of those, not yet met in this pass
+  int pass;                   // 1 gathers, 2 sizes, 3 writes
+  int numWords;
+  uint64_t wordBytes;
+  uint64_t before;            // postings in the full file
+  uint64_t after;             // postings kept
+  uint64_t positionBytes;     // of the kept postings
+  uint64_t alwaysKept;        // postings among some word's best
+  uint64_t* histogram;        // global pass 1: counts of the rest
+  int* scratch;               // one list's counts, then one posting's positions
+  int scratchSize;
+  indexfile_writer_t* writer;
+  bool ok;
+} pruneState_t;
+
+// Static function prototypes
+static void prunePass(void* arg, const char* word, const postings_t* postings);
+static int bestCount(pruneState_t* state, const postings_t* postings, int* above);
+static void pruneList(pruneState_t* state, const postings_t* postings, postings_t* pruned);
+static void globalThreshold(pruneState_t* state, uint64_t target);
+static void growScratch(pruneState_t* state, int size);
+static int compareDescending(const void* first, const void* second);
+static bool takeTie(pruneState_t* state);
+static uint64_t roundUp(double x);
+
+/*********** prune_file ***********/
+/* see prune.h for more details */
+bool prune_file(const char* fullFilename, const char* prunedFilename, int mode, double value,
+                indexfile_pruning_t* pruning)
+{
+  if (fullFilename == NULL || prunedFilename == NULL || strcmp(fullFilename, prunedFilename) == 0
+      || (mode == INDEXFILE_PRUNE_TERM && !(value > 0 && value <= 1))
+      || (mode == INDEXFILE_PRUNE_GLOBAL && !(value > 0 && value <= 100))
+      || (mode != INDEXFILE_PRUNE_TERM && mode != INDEXFILE_PRUNE_GLOBAL)) {
+    return false;
+  }
+  indexfile_t* full;
+  if ((full = indexfile_open(fullFilename)) == NULL) {
+    return false;
+  }
+  pruneState_t state;
+  memset(&state, 0, sizeof(state));
+  state.mode = mode;
+  state.value = value;
+  state.ok = true;
+
+  // pass 1: totals, and the global threshold from the histogram
+  state.pass = 1;
+  if (mode == INDEXFILE_PRUNE_GLOBAL) {
+    state.histogram = mem_calloc_assert(HISTOGRAM_COUNTS + 1, sizeof(uint64_t), "Couldn't allocate histogram");
+  }
+  indexfile_iterate(full, &state, prunePass);
+  if (mode == INDEXFILE_PRUNE_GLOBAL) {
+    globalThreshold(&state, roundUp(state.before * value / 100));
+  }
+
+  // pass 2: sizes of the output; pass 3: write it
+  state.pass = 2;
+  state.tiesLeft = state.ties;
+  indexfile_iterate(full, &state, prunePass);
+  int options = INDEXFILE_PRUNED
+                | (indexfile_isCompressed(full) ? INDEXFILE_COMPRESSED : 0)
+                | (indexfile_hasPositions(full) ? INDEXFILE_POSITIONS : 0)
+                | (indexfile_hasImpacts(full) ? INDEXFILE_IMPACTS : 0);
+  indexfile_pruning_t settings = { mode, PRUNE_KEEP, value, state.threshold, 0, state.before, state.after };
+  state.writer = indexfile_writerNew(prunedFilename, state.numWords, state.wordBytes,
+                                     state.after, state.positionBytes, options);
+  bool written = false;
+  if (state.writer != NULL) {
+    state.pass = 3;
+    state.tiesLeft = state.ties;
+    indexfile_iterate(full, &state, prunePass);
+    state.ok = indexfile_writerPruning(state.writer, &settings) && state.ok;
+    written = indexfile_writerClose(state.writer) && state.ok;
+  }
+  if (written && pruning != NULL) {
+    *pruning = settings;
+  }
+  free(state.histogram);
+  free(state.scratch);
+  indexfile_close(full);
+  return written;
+}
+
+/*********** prunePass ***********/
+/* indexfile_iterate helper doing one word's part of state->pass */
+static void prunePass(void* arg, const char* word, const postings_t* postings)
+{
+  pruneState_t* state = (pruneState_t*) arg;
+  if (state->pass == 1) {
+    state->numWords++;
+    state->wordBytes += strlen(word) + 1;
+    state->before += postings->size;
+    if (state->histogram != NULL) {
+      // the counts past the word's best go into the histogram
+      int above;
+      int best = bestCount(state, postings, &above);
+      int ties = PRUNE_KEEP - above;
+      for (int i = 0; i < postings->size; i++) {
+        int count = postings->counts[i];
+        if (count > best || (count == best && ties-- > 0)) {
+          state->alwaysKept++;
+        } else {
+          state->histogram[count < HISTOGRAM_COUNTS ? (count < 0 ? 0 : count) : HISTOGRAM_COUNTS]++;
+        }
+      }
+    }
+    return;
+  }
+  postings_t pruned = postings_view(NULL, NULL, 0);
+  postings_reserve(&pruned, postings->size);
+  pruneList(state, postings, &pruned);
+  if (state->pass == 2) {
+    state->after += pruned.size;
+    state->positionBytes += postings_positionBytes(&pruned);
+  } else if (!indexfile_writerAdd(state->writer, word, &pruned)) {
+    state->ok = false;
+  }
+  postings_release(&pruned);
+}
+
+/*********** bestCount ***********/
+/* Returns the count of a list's PRUNE_KEEP'th best posting (INT_MIN if
+ * it has no more than PRUNE_KEEP), and in *above how many count more
+ */
+static int bestCount(pruneState_t* state, const postings_t* postings, int* above)
+{
+  *above = 0;
+  if (postings->size <= PRUNE_KEEP) {
+    return INT_MIN;
+  }
+  growScratch(state, postings->size);
+  memcpy(state->scratch, postings->counts, postings->size * sizeof(int));
+  qsort(state->scratch, postings->size, sizeof(int), compareDescending);
+  int best = state->scratch[PRUNE_KEEP - 1];
+  while (*above < PRUNE_KEEP && state->scratch[*above] > best) {
+    (*above)++;
+  }
+  return best;
+}
+
+/*********** pruneList ***********/
+/* Copies into pruned the postings of a list that are among its best
+ * or clear the threshold, with their positions if it has them
+ */
+static void pruneList(pruneState_t* state, const postings_t* postings, postings_t* pruned)
+{
+  int above;
+  int best = bestCount(state, postings, &above);
+  int ties = PRUNE_KEEP - above;
+  int threshold = state->threshold;
+  bool global = state->mode == INDEXFILE_PRUNE_GLOBAL;
+  if (!global) {
+    // the highest count is the first sorted one, unless the list is short
+    int top = 0;
+    for (int i = 0; i < postings->size && best == INT_MIN; i++) {
+      top = postings->counts[i] > top ? postings->counts[i] : top;
+    }
+    top = best == INT_MIN ? top : state->scratch[0];
+    threshold = (int) roundUp(state->value * top);
+  }
+
+  bool positional = postings_hasPositions(postings);
+  for (int i = 0; i < postings->size; i++) {
+    int count = postings->counts[i];
+    bool kept = count > best || (count == best && ties-- > 0)
+                || (global ? count > threshold || (count == threshold && takeTie(state))
+                           : count >= threshold);
+    if (!kept) {
+      continue;
+    }
+    if (!positional) {
+      postings_set(pruned, postings->ids[i], count);
+      continue;
+    }
+    growScratch(state, count);
+    if (!postings_positions(postings, i, state->scratch)
+        || !postings_addPositions(pruned, postings->ids[i], state->scratch, count)) {
+      state->ok = false;
+    }
+  }
+}
+
+/*********** globalThreshold ***********/
+/* Sets the smallest count kept past every word's best, and how many
+ * postings of exactly that count fit, to keep target postings in all
+ */
+static void globalThreshold(pruneState_t* state, uint64_t target)
+{
+  state->threshold = INT_MAX;         // room for nothing past each word's best
+  state->ties = 0;
+  if (state->alwaysKept >= target) {
+    return;
+  }
+  uint64_t room = target - state->alwaysKept;
+  uint64_t kept = 0;
+  for (int count = HISTOGRAM_COUNTS; count > 0; count--) {
+    state->threshold = count;
+    if (kept + state->histogram[count] >= room) {
+      state->ties = room - kept;
+      return;
+    }
+    kept += state->histogram[count];
+  }
+  state->ties = UINT64_MAX;           // everything fits
+}
+
+/*********** growScratch ***********/
+/* Makes sure the scratch array holds at least size ints */
+static void growScratch(pruneState_t* state, int size)
+{
+  if (size > state->scratchSize) {
+    free(state->scratch);
+    state->scratchSize = size * 2;
+    state->scratch = mem_malloc_assert(state->scratchSize * sizeof(int), "Couldn't allocate pruning scratch");
+  }
+}
+
+/*********** compareDescending ***********/
+/* qsort comparator ordering ints from highest to lowest */
+static int compareDescending(const void* first, const void* second)
+{
+  int a = *(const int*) first;
+  int b = *(const int*) second;
+  return (a < b) - (a > b);
+}
+
+/*********** takeTie ***********/
+/* Returns true, using one up, if a posting at the threshold still fits */
+static bool takeTie(pruneState_t* state)
+{
+  if (state->tiesLeft == 0) {
+    return false;
+  }
+  state->tiesLeft--;
+  return true;
+}
+
+/*********** roundUp ***********/
+/* Returns the smallest whole number >= x, for x >= 0 */
+static uint64_t roundUp(double x)
+{
+  uint64_t whole = (uint64_t) x;
+  return whole < x ? whole + 1 : whole;
+}
@@ -0,0 +1,55 @@
+/*
+ * prune.h - header file for CS50 'prune' module
+ *
+ * This module statically prunes a binary index: it drops the low-count
+ * postings that rarely reach the top of a ranking, to make an index
+ * small enough to keep in memory. Every word keeps its PRUNE_KEEP best
+ * postings (highest count, then lowest docID), so no word disappears
+ * from the index; past those, a posting is kept only if its count
+ * clears a threshold, which is either
+ *
+ *   per term (INDEXFILE_PRUNE_TERM): a fraction of the word's highest
+ *   count, so each word loses its own tail; or
+ *
+ *   global (INDEXFILE_PRUNE_GLOBAL): one count for the whole index,
+ *   the smallest that keeps the index within a target percentage of
+ *   its postings.
+ *
+ * The pruned file records its settings (see indexfile_pruning).
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __PRUNE_H
+#define __PRUNE_H
+
+#include <stdbool.h>
+#include "indexfile.h"
+
+// best postings every word keeps, whatever the threshold
+#define PRUNE_KEEP 10
+
+/********** Functions ***********/
+
+/*********** prune_file ***********/
+/* Writes a pruned copy of a binary index file
+ *
+ * Caller provides:
+ *   A binary index file, the file to write, a mode INDEXFILE_PRUNE_TERM
+ *   with value a fraction in (0, 1] of each word's highest count, or
+ *   INDEXFILE_PRUNE_GLOBAL with value the percentage in (0, 100] of
+ *   postings to keep, and a pruning struct to fill in (or NULL)
+ * We return:
+ *   true if prunedFilename was written; false if the full file can't
+ *   be opened, the mode or value is bad, or the output can't be written
+ * We guarantee:
+ *   The pruned file has the full file's words and the same compression,
+ *   positions and impacts, and records the settings in *pruning
+ * Notes:
+ *   The full file is read three times: to gather the counts, to size
+ *   the output, and to write it. The two files must differ.
+ */
+bool prune_file(const char* fullFilename, const char* prunedFilename, int mode, double value,
+                indexfile_pruning_t* pruning);
+
+#endif // __PRUNE_H
@@ -0,0 +1,349 @@
+/*
+ * querycache.c - CS50 'querycache' module
+ *
+ * Entries are chained in a hash table of buckets, by their keys, and
+ * linked from the most to the least recently used; a lookup moves its
+ * entry to the front, and eviction takes from the back. The table
+ * doubles once it holds more entries than buckets. One mutex guards it
+ * all; answers are copied in and out under it, so a board handed out is
+ * never one that a later eviction frees.
+ *
+ * See querycache.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "mem.h"
+#include "hash.h"
+#include "word.h"
+#include "querycache.h"
+
+#define FIRST_BUCKETS 64
+
+/**************** file-local types ****************/
+// one cached answer
+typedef struct entry {
+  char* key;
+  scoreboard_t* board;
+  size_t bytes;           // the entry, its key and its board
+  struct entry* next;     // in its bucket
+  struct entry* newer;    // toward the most recently used
+  struct entry* older;    // toward the least recently used
+} entry_t;
+
+struct querycache {
+  int version;            // moves on each time the entries are cleared
+  entry_t** buckets;
+  int numBuckets;
+  entry_t* newest;
+  entry_t* oldest;
+  querycache_stats_t stats;
+  pthread_mutex_t lock;
+};
+
+// Static function prototypes
+static entry_t* find(querycache_t* cache, const char* key);
+static void detach(querycache_t* cache, entry_t* entry);
+static void pushNewest(querycache_t* cache, entry_t* entry);
+static void evict(querycache_t* cache, entry_t* entry);
+static void grow(querycache_t* cache);
+static char* branchKey(char** terms, int numTerms);
+static int compareStrings(const void* first, const void* second);
+
+/*********** querycache_new ***********/
+/* see querycache.h for more details */
+querycache_t* querycache_new(size_t budget)
+{
+  if (budget == 0) {
+    return NULL;
+  }
+  querycache_t* cache = mem_calloc_assert(1, sizeof(querycache_t), "Couldn't allocate cache");
+  cache->numBuckets = FIRST_BUCKETS;
+  cache->buckets = mem_calloc_assert(cache->numBuckets, sizeof(entry_t*), "Couldn't allocate cache");
+  cache->stats.budget = budget;
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+/*********** querycache_key ***********/
+/* see querycache.h for more details */
+char* querycache_key(char** wordSequence)
+{
+  if (wordSequence == NULL) {
+    return NULL;
+  }
+  int numWords = 0;
+  while (wordSequence[numWords] != NULL) {
+    numWords++;
+  }
+  // each branch's key, from its terms
+  char** terms = mem_calloc_assert(numWords + 1, sizeof(char*), "Couldn't allocate key");
+  char** branches = mem_calloc_assert(numWords / 2 + 2, sizeof(char*), "Couldn't allocate key");
+  int numBranches = 0;
+  size_t length = 0;
+  int pos = 0;
+  while (wordSequence[pos] != NULL) {
+    int numTerms = 0;
+    for (; wordSequence[pos] != NULL && strcmp(wordSequence[pos], "or") != 0; pos++) {
+      if (strcmp(wordSequence[pos], "and") != 0) {
+        terms[numTerms++] = wordSequence[pos];
+      }
+    }
+    if (wordSequence[pos] != NULL) {
+      pos++;                    // skip the 'or'
+    }
+    if (numTerms > 0) {
+      branches[numBranches] = branchKey(terms, numTerms);
+      length += strlen(branches[numBranches++]) + strlen(" or ");
+    }
+  }
+
+  // the branches in order, joined by 'or'
+  qsort(branches, numBranches, sizeof(char*), compareStrings);
+  char* key = mem_malloc_assert(length + 1, "Couldn't allocate key");
+  key[0] = '\0';
+  char* end = key;
+  for (int b = 0; b < numBranches; b++) {
+    if (b > 0) {
+      end = stpcpy(end, " or ");
+    }
+    end = stpcpy(end, branches[b]);
+    free(branches[b]);
+  }
+  free(branches);
+  free(terms);
+  return key;
+}
+
+/*********** querycache_get ***********/
+/* see querycache.h for more details */
+scoreboard_t* querycache_get(querycache_t* cache, const char* key)
+{
+  if (cache == NULL || key == NULL) {
+    return NULL;
+  }
+  pthread_mutex_lock(&cache->lock);
+  scoreboard_t* board = NULL;
+  entry_t* entry = find(cache, key);
+  if (entry != NULL) {
+    detach(cache, entry);
+    pushNewest(cache, entry);
+    board = scoreboard_copy(entry->board);
+    cache->stats.hits++;
+  } else {
+    cache->stats.misses++;
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return board;
+}
+
+/*********** querycache_put ***********/
+/* see querycache.h for more details */
+void querycache_put(querycache_t* cache, const char* key, int version, scoreboard_t* board)
+{
+  if (cache == NULL || key == NULL || board == NULL) {
+    return;
+  }
+  scoreboard_t* copy = scoreboard_copy(board);
+  size_t bytes = sizeof(entry_t) + strlen(key) + 1 + scoreboard_memory(copy);
+  if (bytes > cache->stats.budget) {
+    scoreboard_delete(copy);
+    return;
+  }
+
+  pthread_mutex_lock(&cache->lock);
+  if (version != cache->version || find(cache, key) != NULL) {
+    pthread_mutex_unlock(&cache->lock);
+    scoreboard_delete(copy);
+    return;
+  }
+  entry_t* entry = mem_calloc_assert(1, sizeof(entry_t), "Couldn't allocate cache entry");
+  entry->key = mem_malloc_assert(strlen(key) + 1, "Couldn't allocate cache entry");
+  strcpy(entry->key, key);
+  entry->board = copy;
+  entry->bytes = bytes;
+  if (cache->stats.entries >= cache->numBuckets) {
+    grow(cache);
+  }
+  unsigned long bucket = hash_jenkins(key, cache->numBuckets);
+  entry->next = cache->buckets[bucket];
+  cache->buckets[bucket] = entry;
+  pushNewest(cache, entry);
+  cache->stats.entries++;
+  cache->stats.bytes += bytes;
+
+  // the least recently used make room; the new entry fits by itself
+  while (cache->stats.bytes > cache->stats.budget) {
+    evict(cache, cache->oldest);
+    cache->stats.evictions++;
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+/*********** querycache_clear ***********/
+/* see querycache.h for more details */
+int querycache_clear(querycache_t* cache)
+{
+  if (cache == NULL) {
+    return 0;
+  }
+  pthread_mutex_lock(&cache->lock);
+  while (cache->oldest != NULL) {
+    evict(cache, cache->oldest);
+  }
+  int version = ++cache->version;
+  cache->stats.invalidations++;
+  pthread_mutex_unlock(&cache->lock);
+  return version;
+}
+
+/*********** querycache_stats ***********/
+/* see querycache.h for more details */
+void querycache_stats(querycache_t* cache, querycache_stats_t* stats)
+{
+  if (stats == NULL) {
+    return;
+  }
+  if (cache == NULL) {
+    memset(stats, 0, sizeof(querycache_stats_t));
+    return;
+  }
+  pthread_mutex_lock(&cache->lock);
+  *stats = cache->stats;
+  pthread_mutex_unlock(&cache->lock);
+}
+
+/*********** querycache_delete ***********/
+/* see querycache.h for more details */
+void querycache_delete(querycache_t* cache)
+{
+  if (cache != NULL) {
+    while (cache->oldest != NULL) {
+      evict(cache, cache->oldest);
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->buckets);
+    free(cache);
+  }
+}
+
+/*********** find ***********/
+/* Returns the entry for key, or NULL; the caller holds the lock */
+static entry_t* find(querycache_t* cache, const char* key)
+{
+  entry_t* entry = cache->buckets[hash_jenkins(key, cache->numBuckets)];
+  while (entry != NULL && strcmp(entry->key, key) != 0) {
+    entry = entry->next;
+  }
+  return entry;
+}
+
+/*********** detach ***********/
+/* Takes an entry out of the recently used list */
+static void detach(querycache_t* cache, entry_t* entry)
+{
+  if (entry->newer != NULL) {
+    entry->newer->older = entry->older;
+  } else {
+    cache->newest = entry->older;
+  }
+  if (entry->older != NULL) {
+    entry->older->newer = entry->newer;
+  } else {
+    cache->oldest = entry->newer;
+  }
+  entry->newer = entry->older = NULL;
+}
+
+/*********** pushNewest ***********/
+/* Puts an unlinked entry at the front of the recently used list */
+static void pushNewest(querycache_t* cache, entry_t* entry)
+{
+  entry->older = cache->newest;
+  entry->newer = NULL;
+  if (cache->newest != NULL) {
+    cache->newest->newer = entry;
+  } else {
+    cache->oldest = entry;
+  }
+  cache->newest = entry;
+}
+
+/*********** evict ***********/
+/* Drops an entry from its bucket and the list, and frees it */
+static void evict(querycache_t* cache, entry_t* entry)
+{
+  entry_t** at = &cache->buckets[hash_jenkins(entry->key, cache->numBuckets)];
+  while (*at != entry) {
+    at = &(*at)->next;
+  }
+  *at = entry->next;
+  detach(cache, entry);
+  cache->stats.entries--;
+  cache->stats.bytes -= entry->bytes;
+  scoreboard_delete(entry->board);
+  free(entry->key);
+  free(entry);
+}
+
+/*********** grow ***********/
+/* Doubles the buckets, and moves every entry to its new one */
+static void grow(querycache_t* cache)
+{
+  int numBuckets = cache->numBuckets * 2;
+  entry_t** buckets = mem_calloc_assert(numBuckets, sizeof(entry_t*), "Couldn't grow cache");
+  for (entry_t* entry = cache->newest; entry != NULL; entry = entry->older) {
+    unsigned long bucket = hash_jenkins(entry->key, numBuckets);
+    entry->next = buckets[bucket];
+    buckets[bucket] = entry;
+  }
+  free(cache->buckets);
+  cache->buckets = buckets;
+  cache->numBuckets = numBuckets;
+}
+
+/*********** branchKey ***********/
+/* Returns a new string of a branch's terms, sorted, each once, joined
+ * by spaces, with phrases in quotes; sorts terms in place
+ */
+static char* branchKey(char** terms, int numTerms)
+{
+  qsort(terms, numTerms, sizeof(char*), compareStrings);
+  size_t length = 0;
+  for (int t = 0; t < numTerms; t++) {
+    length += strlen(terms[t]) + strlen(" \"\"");
+  }
+  char* key = mem_malloc_assert(length + 1, "Couldn't allocate key");
+  char* end = key;
+  for (int t = 0; t < numTerms; t++) {
+    if (t > 0 && strcmp(terms[t], terms[t - 1]) == 0) {
+      continue;
+    }
+    if (end != key) {
+      *end++ = ' ';
+    }
+    bool phrase = word_isPhrase(terms[t]);
+    if (phrase) {
+      *end++ = '"';
+    }
+    end = stpcpy(end, terms[t]);
+    if (phrase) {
+      *end++ = '"';
+    }
+  }
+  *end = '\0';
+  return key;
+}
+
+/*********** compareStrings ***********/
+/* qsort comparator for an array of strings */
+static int compareStrings(const void* first, const void* second)
+{
+  return strcmp(*(char* const*) first, *(char* const*) second);
+}
@@ -0,0 +1,120 @@
+/*
+ * querycache.h - header file for CS50 'querycache' module
+ *
+ * A *querycache* keeps the scoreboards of recently answered queries, so
+ * a query asked again is answered without planning it or reading any
+ * postings. Queries are looked up by a canonical key (see
+ * querycache_key), so "dog and cat or fish" and "fish or cat dog" share
+ * an entry. The cache holds at most a budget of bytes, and evicts the
+ * least recently used entries to stay under it.
+ *
+ * When the index is replaced, its user clears the cache, which drops
+ * every entry and moves the cache's version on; an answer is only cached
+ * with the version of the index it came from, so one ranked on an older
+ * index, still in flight, is never cached after it. Any number of
+ * threads may use one cache at once.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __QUERYCACHE_H
+#define __QUERYCACHE_H
+
+#include <stddef.h>
+#include "scoreboard.h"
+
+/********* Global Types ***********/
+typedef struct querycache querycache_t;
+
+// what a cache has done so far, and holds now
+typedef struct querycache_stats {
+  long hits;              // lookups answered from the cache
+  long misses;            // lookups that weren't
+  long evictions;         // entries dropped to stay under the budget
+  long invalidations;     // times every entry was dropped for a replaced index
+  int entries;            // entries held now
+  size_t bytes;           // bytes they take
+  size_t budget;          // bytes they may take
+} querycache_stats_t;
+
+/********** Functions ***********/
+
+/*********** querycache_new ***********/
+/* Creates an empty cache, at version 0
+ *
+ * Caller provides:
+ *   How many bytes the cached answers, with their keys, may take
+ * We return:
+ *   A new cache, or NULL if budget is 0; every function treats a NULL
+ *   cache as one that never holds anything
+ * Caller is responsible for:
+ *   Later calling querycache_delete
+ */
+querycache_t* querycache_new(size_t budget);
+
+/*********** querycache_key ***********/
+/* Makes a query's canonical key
+ *
+ * Caller provides:
+ *   A word sequence that passed word_checkSyntax
+ * We return:
+ *   A new string naming what the query asks for: each 'or' branch's
+ *   terms sorted and each kept once, phrases in quotes, and the branches
+ *   sorted, a repeated one kept as often as it was typed, since its
+ *   scores count that many times; NULL if wordSequence is NULL
+ * Caller is responsible for:
+ *   Freeing the key
+ */
+char* querycache_key(char** wordSequence);
+
+/*********** querycache_get ***********/
+/* Looks up a query's answer
+ *
+ * Caller provides:
+ *   The cache and the query's key
+ * We return:
+ *   A copy of the cached scoreboard, and the entry is marked the most
+ *   recently used; or NULL if there is none, or cache or key is NULL
+ * Caller is responsible for:
+ *   Calling scoreboard_delete on the board
+ */
+scoreboard_t* querycache_get(querycache_t* cache, const char* key);
+
+/*********** querycache_put ***********/
+/* Caches a query's answer
+ *
+ * Caller provides:
+ *   The cache, the query's key, the cache's version when the index the
+ *   query was ranked on was loaded (0, or what querycache_clear gave),
+ *   and the query's scoreboard, which stays the caller's
+ * We do:
+ *   Cache a copy of the board under key, evicting the least recently
+ *   used entries until it fits the budget; nothing if cache, key or
+ *   board is NULL, the key is already cached, the entry alone would
+ *   exceed the budget, or the cache has been cleared since version, in
+ *   which case the answer is from an index that has been replaced
+ */
+void querycache_put(querycache_t* cache, const char* key, int version, scoreboard_t* board);
+
+/*********** querycache_clear ***********/
+/* Drops every entry, for an index that has been replaced
+ *
+ * Caller provides:
+ *   The cache
+ * We return:
+ *   The cache's new version, to put the new index's answers with; 0 if
+ *   cache is NULL
+ */
+int querycache_clear(querycache_t* cache);
+
+/*********** querycache_stats ***********/
+/* Fills in *stats with the cache's counts so far; all zero if cache is NULL */
+void querycache_stats(querycache_t* cache, querycache_stats_t* stats);
+
+/*********** querycache_delete ***********/
+/* Frees the cache and every entry; does nothing if cache is NULL. No
+ * thread may be using the cache.
+ */
+void querycache_delete(querycache_t* cache);
+
+#endif // __QUERYCACHE_H
@@ -1,73 +1,148 @@
-
 /*
  * scoreboard.c - CS50 'scoreboard' module
  *
  * This module implements a scoreboard data structure used for ranking
  * scored document IDs based on their query score. The scoreboard is
- * essentially a pointer to a calloc'd array of scoreEntry_t*'s sorted
- * by C's qsort function.
+ * a flat array of (id, score) records, sorted with topk_sort.
+ *
+ * A board of the best k is filled as a min-heap (see topk.h): its root
+ * is the worst record kept, and a new score replaces it only if it ranks
+ * higher, so each score costs at most O(log k) and the other entries are
+ * never stored. A board of every score just appends them. Either is
+ * sorted once at the end.
  *
  * Arthur Ufongene, May 2025
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include "scoreboard.h"
+#include "topk.h"
 #include "mem.h"
 #include "pagedir.h"
 
-typedef struct scoreEntry scoreEntry_t;
-
-// Internal structure to store document ID and its score
-struct scoreEntry {
-  int id;
-  int score;
-};
-
 // Internal structure for the scoreboard
 struct scoreboard {
-  int place;               // current index for iteration
-  int size;                // total number of entries
-  scoreEntry_t** board;    // array of pointers to score entries
+  int size;                // number of entries on the board
+  int capacity;            // entries the board has room for
+  int k;                   // best entries kept, 0 for all
+  int total;               // documents that matched, or SCOREBOARD_UNKNOWN
+  topk_entry_t* board;     // the entries; a min-heap while a top k is filled
 };
 
 // Internal helper function prototypes
-static int sortFunc(const void* firstAddress, const void* secondAddress);
-static void addToBoard(void* address, int id, int count);
-static scoreEntry_t* scoreEntry_new(int id, int score);
-static void scoreEntry_delete(scoreEntry_t* entry);
-static bool next(scoreboard_t* sb);
-static int getId(scoreboard_t* sb);
-static int getScore(scoreboard_t* sb);
+static scoreboard_t* boardNew(int numScores, int k);
+static void offer(void* arg, const int id, const int count);
+static void countEntry(void* arg, const int id, const int count);
+static void finish(scoreboard_t* sb);
 
 /********** scoreboard_new *************/
 /* See scoreboard.h for more information */
-scoreboard_t* scoreboard_new(counters_t* scores, int expectedSize)
+scoreboard_t* scoreboard_new(counters_t* scores, int k)
 {
-  // allocate memory for scoreboard
-  scoreboard_t* newBoard = mem_calloc_assert(1, sizeof(scoreboard_t), "No space");
+  // count the scores, for the total and to size the board
+  int numScores = 0;
+  counters_iterate(scores, &numScores, countEntry);
+  scoreboard_t* newBoard = boardNew(numScores, k);
+
+  // offer every score to the board, then sort what it kept
+  counters_iterate(scores, newBoard, offer);
+  finish(newBoard);
+  return newBoard;
+}
 
-  // allocate memory for array of score entries
-  newBoard->board = mem_calloc_assert(expectedSize, sizeof(scoreEntry_t*), "No space for scores array");
+/********** scoreboard_newPostings *************/
+/* See scoreboard.h for more information */
+scoreboard_t* scoreboard_newPostings(const postings_t* scores, int k)
+{
+  scoreboard_t* newBoard = boardNew(scores->size, k);
+  for (int i = 0; i < scores->size; i++) {
+    offer(newBoard, scores->ids[i], scores->counts[i]);
+  }
+  finish(newBoard);
+  return newBoard;
+}
 
-  newBoard->place = -1;
+/********** scoreboard_setTotal *************/
+/* See scoreboard.h for more information */
+void scoreboard_setTotal(scoreboard_t* sb, int total)
+{
+  if (sb != NULL && (total == SCOREBOARD_UNKNOWN || total >= sb->size)) {
+    sb->total = total;
+  }
+}
 
-  // pointer to the beginning of the array
-  scoreEntry_t** pos = newBoard->board;
+/********** scoreboard_size *************/
+/* See scoreboard.h for more information */
+int scoreboard_size(scoreboard_t* sb)
+{
+  return sb == NULL ? 0 : sb->size;
+}
 
-  // iterate over all counters, adding their entries to the array and moving the pos pointer
-  counters_iterate(scores, &pos, addToBoard);
+/********** scoreboard_total *************/
+/* See scoreboard.h for more information */
+int scoreboard_total(scoreboard_t* sb)
+{
+  return sb == NULL ? 0 : sb->total;
+}
 
-  // calculate actual number of entries
-  newBoard->size = pos - newBoard->board;
+/********** scoreboard_get *************/
+/* See scoreboard.h for more information */
+bool scoreboard_get(scoreboard_t* sb, int i, int* id, int* score)
+{
+  if (sb == NULL || i < 0 || i >= sb->size || id == NULL || score == NULL) {
+    return false;
+  }
+  *id = sb->board[i].id;
+  *score = sb->board[i].score;
+  return true;
+}
 
-  // sort entries by score in descending order using the qsort function
-  qsort(newBoard->board, newBoard->size, sizeof(scoreEntry_t*), sortFunc);
-  
-  return newBoard;
+/********** scoreboard_copy *************/
+/* See scoreboard.h for more information */
+scoreboard_t* scoreboard_copy(scoreboard_t* sb)
+{
+  if (sb == NULL) {
+    return NULL;
+  }
+  scoreboard_t* copy = mem_calloc_assert(1, sizeof(scoreboard_t), "No space");
+  *copy = *sb;
+  copy->capacity = sb->size;
+  copy->board = mem_calloc_assert(sb->size + 1, sizeof(topk_entry_t), "No space for scores array");
+  memcpy(copy->board, sb->board, sb->size * sizeof(topk_entry_t));
+  return copy;
+}
+
+/********** scoreboard_memory *************/
+/* See scoreboard.h for more information */
+size_t scoreboard_memory(scoreboard_t* sb)
+{
+  return sb == NULL ? 0 : sizeof(scoreboard_t) + (sb->capacity + 1) * sizeof(topk_entry_t);
+}
+
+/********** scoreboard_overlap *************/
+/* See scoreboard.h for more information */
+int scoreboard_overlap(scoreboard_t* first, scoreboard_t* second)
+{
+  if (first == NULL || second == NULL) {
+    return 0;
+  }
+  // boards are cut to a top k, so comparing every pair is cheap
+  int shared = 0;
+  for (int i = 0; i < first->size; i++) {
+    for (int j = 0; j < second->size; j++) {
+      if (first->board[i].id == second->board[j].id) {
+        shared++;
+        break;
+      }
+    }
+  }
+  return shared;
 }
 
 /********** scoreboard_print *************/
 /* See scoreboard.h for more information */
-void scoreboard_print(scoreboard_t* sb, char* pageDirectory) 
+void scoreboard_print(scoreboard_t* sb, char* pageDirectory, docmap_t* docs)
 {
   // If the scoreboard is empty, print no matches
   if (sb->size == 0) {
@@ -75,105 +150,80 @@ void scoreboard_print(scoreboard_t* sb, char* pageDirectory)
     fflush(stdout);
     return;
   }
-  char* URL;
-  printf("%d matches ranked below\n", sb->size);
-
-  // iterate and print each entry
-  while (next(sb)) {
+  if (sb->total == SCOREBOARD_UNKNOWN && sb->size == sb->k) {
+    printf("Top %d matches ranked below\n", sb->size);
+  } else if (sb->total > sb->size) {
+    printf("Top %d of %d matches ranked below\n", sb->size, sb->total);
+  } else {
+    printf("%d matches ranked below\n", sb->size);
+  }
 
-  // get URL from the page with this id, then print its score, id, and URL
-    URL = pagedir_getURL(pageDirectory, getId(sb));
-    printf("Score %3d | Doc %3d: %s\n", getScore(sb), getId(sb), URL);
-    free(URL);
+  // get URL from the manifest, or else the page, with each id, then
+  // print its score, id, and URL
+  for (int i = 0; i < sb->size; i++) {
+    const char* URL = docmap_url(docs, sb->board[i].id);
+    char* pageURL = URL == NULL ? pagedir_getURL(pageDirectory, sb->board[i].id) : NULL;
+    printf("Score %3d | Doc %3d: %s\n", sb->board[i].score, sb->board[i].id, URL != NULL ? URL : pageURL);
+    free(pageURL);
   }
   printf("\n");
   fflush(stdout);
-  // reset for reuse
-  sb->place = -1;
 }
 
 /********** scoreboard_delete *************/
 /* see scoreboard.h for more information */
 void scoreboard_delete(scoreboard_t* sb)
 {
-
-  // free each score entry
-  while (next(sb)) {
-    scoreEntry_delete(sb->board[sb->place]);
+  if (sb != NULL) {
+    free(sb->board);
+    free(sb);
   }
-
-  // free array and scoreboard struct
-  free(sb->board);
-  free(sb);
 }
 
-/********** next *************/
-/* Advance the scoreboard iterator and return true if next exists */
-static bool next(scoreboard_t* sb)
-{
-  return sb->board[++(sb->place)] != NULL;
-}
-
-/********** getId *************/
-/* Return the document ID at current position */
-static int getId(scoreboard_t* sb)
-{
-  return (sb->board[sb->place])->id;
-}
-
-/********** getScore *************/
-/* Return the score at current position */
-static int getScore(scoreboard_t* sb)
-{
-  return (sb->board[sb->place])->score;
-}
-
-/********** sortFunc *************/
-/* Sorting comparator for qsort: highest score first */
-static int sortFunc(const void* firstAddress, const void* secondAddress)
+/********** boardNew *************/
+/* Makes an empty board for numScores scores, with room for the best k
+ * of them (all of them if k is 0)
+ */
+static scoreboard_t* boardNew(int numScores, int k)
 {
-  // dereference the pointers and subtract the first from the second
-  scoreEntry_t* score1 = *((scoreEntry_t**) firstAddress);
-  scoreEntry_t* score2 = *((scoreEntry_t**) secondAddress);
-  return score2->score - score1->score;
+  scoreboard_t* newBoard = mem_calloc_assert(1, sizeof(scoreboard_t), "No space");
+  newBoard->k = k > 0 ? k : 0;
+  newBoard->total = numScores;
+  newBoard->capacity = k > 0 && k < numScores ? k : numScores;
+  newBoard->board = mem_calloc_assert(newBoard->capacity + 1, sizeof(topk_entry_t), "No space for scores array");
+  return newBoard;
 }
 
-/********** addToBoard *************/
-/* Add a new scoreEntry to the board array
+/********** offer *************/
+/* Offers a score to the board: appended while there is room, and once
+ * a top k board is full, in place of its worst entry if it ranks higher
  *
  * Called by counters_iterate with:
- *   address: a pointer to a scoreEntry_t** pointer into board array
+ *   arg: the scoreboard_t*
  *   id: docID
  *   count: score for that docID
  */
-static void addToBoard(void* address, int id, int count)
+static void offer(void* arg, const int id, const int count)
 {
-  // pointer to a pointer to the current score entry in the array
-  scoreEntry_t*** scoreAddress = (scoreEntry_t***) address;
-
-  // make sure we only write in calloc'd space
-  if (**scoreAddress == NULL) {
-    // make a new score entry at this spot in the array
-    **scoreAddress = scoreEntry_new(id, count);
-
-    // increment the spot in the array so the next entry can be added
-    (*scoreAddress)++;
+  scoreboard_t* sb = (scoreboard_t*) arg;
+  topk_entry_t entry = { id, count };
+  if (sb->k > 0) {
+    topk_offer(sb->board, &sb->size, sb->capacity, entry);
+  } else if (sb->size < sb->capacity) {
+    sb->board[sb->size++] = entry;
   }
 }
 
-/********** scoreEntry_new *************/
-/* Create a new score entry with given id and score */
-static scoreEntry_t* scoreEntry_new(int id, int score) 
+/********** countEntry *************/
+/* counters_iterate helper counting the entries into *arg */
+static void countEntry(void* arg, const int id, const int count)
 {
-  scoreEntry_t* newEntry = mem_calloc_assert(1, sizeof(scoreEntry_t), "No space");
-  newEntry->id = id;
-  newEntry->score = score;
-  return newEntry;
+  (*(int*) arg)++;
 }
 
-/********** scoreEntry_delete *************/
-/* Free memory associated with a scoreEntry */
-static void scoreEntry_delete(scoreEntry_t* entry) 
+/********** finish *************/
+/* Sorts the entries a board kept, best first */
+static void finish(scoreboard_t* sb)
 {
-  free(entry);
+  topk_sort(sb->board, sb->size);
 }
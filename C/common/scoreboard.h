@@ -2,27 +2,120 @@
  * scoreboard.h - header file for CS50 'scoreboard' module
  *
  * This module provides a scoreboard data structure that stores and ranks
- * scored document IDs from a counters data structure.
+ * scored document IDs from a counters data structure or a postings list.
+ * A board holds the best k documents of its scores (all of them if k is
+ * 0), highest score first and lowest docID first among equal scores,
+ * and how many documents matched in all.
  *
  * Arthur Ufongene, May 2025
  */
 
+#ifndef __SCOREBOARD_H
+#define __SCOREBOARD_H
+
+#include <stddef.h>
 #include "counters.h"
+#include "postings.h"
+#include "docmap.h"
 
 typedef struct scoreboard scoreboard_t;
 
+// a total that scoreboard_setTotal can't give, for a board made from
+// only the best of the matches
+#define SCOREBOARD_UNKNOWN -1
+
 /********** scoreboard_new *************/
 /* Create a new scoreboard from a counters set
  *
  * Caller provides:
  *   A counters_t* mapping docIDs to scores
- *   An int size representing the maximum expected number of scores
+ *   An int k, the number of best entries to keep, or 0 to keep all
+ * We return:
+ *   A pointer to a new scoreboard_t struct containing the best k
+ *   entries, sorted highest score first and lowest docID first among
+ *   equal scores; its total is the number of entries in scores
+ * Caller is responsible for:
+ *   Later calling scoreboard_delete to free memory
+ * Notes:
+ *   The best k are picked with a heap of k entries as the scores are
+ *   read, so n scores take O(n log k) time and room for k entries.
+ */
+scoreboard_t* scoreboard_new(counters_t* scores, int k);
+
+/********** scoreboard_newPostings *************/
+/* Create a new scoreboard from a postings list of scores
+ *
+ * Caller provides:
+ *   A postings_t* of docIDs, each counted by its score (see accum_scores)
+ *   An int k, as for scoreboard_new
  * We return:
- *   A pointer to a new scoreboard_t struct containing sorted entries
+ *   A pointer to a new scoreboard_t struct, as scoreboard_new makes;
+ *   its total is scores->size
  * Caller is responsible for:
  *   Later calling scoreboard_delete to free memory
  */
-scoreboard_t* scoreboard_new(counters_t* scores, int expectedSize);
+scoreboard_t* scoreboard_newPostings(const postings_t* scores, int k);
+
+/********** scoreboard_setTotal *************/
+/* Set the number of documents that matched in all
+ *
+ * Caller provides:
+ *   A valid scoreboard_t* and the total, or SCOREBOARD_UNKNOWN if the
+ *   board was made from only the best of the matches and the rest were
+ *   never counted
+ * We do:
+ *   Nothing if total is below the board's size and isn't SCOREBOARD_UNKNOWN
+ */
+void scoreboard_setTotal(scoreboard_t* sb, int total);
+
+/********** scoreboard_size *************/
+/* Return the number of entries on the scoreboard, 0 if sb is NULL */
+int scoreboard_size(scoreboard_t* sb);
+
+/********** scoreboard_total *************/
+/* Return the number of documents that matched, SCOREBOARD_UNKNOWN if
+ * that isn't known, or 0 if sb is NULL
+ */
+int scoreboard_total(scoreboard_t* sb);
+
+/********** scoreboard_get *************/
+/* Get one entry of the scoreboard
+ *
+ * Caller provides:
+ *   A valid scoreboard_t*, a rank i from 0 (the best) to size - 1, and
+ *   where to put the entry's docID and score
+ * We return:
+ *   True, with *id and *score set; false if sb is NULL or i out of range
+ */
+bool scoreboard_get(scoreboard_t* sb, int i, int* id, int* score);
+
+/********** scoreboard_copy *************/
+/* Copy a scoreboard
+ *
+ * Caller provides:
+ *   A valid scoreboard_t*, or NULL
+ * We return:
+ *   A new board with the same entries, in the same order, and the same
+ *   total, taking only the room its entries need; NULL if sb is NULL
+ * Caller is responsible for:
+ *   Later calling scoreboard_delete on the copy
+ */
+scoreboard_t* scoreboard_copy(scoreboard_t* sb);
+
+/********** scoreboard_memory *************/
+/* Return the bytes a scoreboard takes, its entries included; 0 if sb is NULL */
+size_t scoreboard_memory(scoreboard_t* sb);
+
+/********** scoreboard_overlap *************/
+/* Count the documents two scoreboards share
+ *
+ * Caller provides:
+ *   Two valid scoreboard_t*, usually both of the same k
+ * We return:
+ *   How many docIDs of the first are also on the second, whatever
+ *   their scores; 0 if either is NULL
+ */
+int scoreboard_overlap(scoreboard_t* first, scoreboard_t* second);
 
 /********** scoreboard_delete *************/
 /* Delete the given scoreboard and free memory
@@ -40,8 +133,14 @@ void scoreboard_delete(scoreboard_t* sb);
  * Caller provides:
  *   A valid scoreboard_t*
  *   A valid pageDirectory (path to page files for URL lookup)
+ *   The pageDirectory's manifest, or NULL if it has none
  * We print:
  *   If size == 0: nothing; else:
- *   Each document's score, ID, and URL retrieved via pageDirectory
+ *   The number of entries: "Top k of n" if the board holds the best k
+ *   of n matches, just "Top k" if n is unknown, and otherwise how many
+ *   matched; then each document's score, ID, and URL, looked up in docs,
+ *   or read from its page in pageDirectory if docs doesn't have it
  */
-void scoreboard_print(scoreboard_t* sb, char* pageDirectory);
+void scoreboard_print(scoreboard_t* sb, char* pageDirectory, docmap_t* docs);
+
+#endif // __SCOREBOARD_H
@@ -0,0 +1,505 @@
+/*
+ * segments.c - CS50 'segments' module
+ *
+ * The manifest is a text file listing each segment's docID range,
+ * oldest first; segment k covers firstID up to (not including) endID,
+ * which is where segment k+1 starts:
+ *
+ *   TSESEGMENTS 1
+ *   <firstID> <endID>
+ *   ...
+ *
+ * A segment's file is "<manifest>.segs/seg.<firstID>-<lastID>". A merge
+ * always covers more than one segment, so its output never has the name
+ * of a file still in use.
+ *
+ * Three lock files in the segment directory keep things consistent:
+ * "lock" guards the manifest (shared while reading it and opening the
+ * segments, exclusive while replacing it or deleting merged segments),
+ * "append.lock" lets one writer add segments at a time, and
+ * "merge.lock" one compaction run at a time. Only the manifest lock is
+ * ever waited on for long by a querier, and only for a rename.
+ *
+ * See segments.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include "mem.h"
+#include "indexfile.h"
+#include "segments.h"
+
+// files smaller than this are all in the lowest tier, so tiny segments
+// are merged eagerly instead of forming tiers of their own
+#define TIER_BYTES (1 << 20)
+
+/**************** file-local types ****************/
+// the docIDs of one segment: firstID up to (not including) endID
+typedef struct range {
+  int firstID;
+  int endID;
+} range_t;
+
+struct segments {
+  char* manifest;
+  char* dir;              // "<manifest>.segs"
+  bool write;
+  int appendLock;         // append.lock held by a writer, else -1
+  int readLock;           // manifest lock held by a reader, else -1
+  range_t* list;          // in docID order
+  char** paths;           // file of each segment
+  int count;
+  int capacity;
+  int saved;              // list[saved..count) were added since the last save
+};
+
+// Static function prototypes
+static segments_t* newSegments(const char* manifest, bool write);
+static char* dirPath(segments_t* segs, const char* name);
+static char* segmentPath(segments_t* segs, range_t range);
+static int lockFile(segments_t* segs, const char* name, int operation);
+static void unlockFile(int fd);
+static bool readManifest(segments_t* segs);
+static bool writeManifest(segments_t* segs);
+static void appendRange(segments_t* segs, range_t range);
+static void clearList(segments_t* segs);
+static int tierOf(off_t bytes, int factor);
+static int findWindow(segments_t* segs, int factor, int* tier);
+static int mergeWindow(const char* manifest, range_t* window, int factor, range_t* merged);
+
+/*********** segments_isManifest ***********/
+/* see segments.h for more details */
+bool segments_isManifest(const char* filename)
+{
+  FILE* fp;
+  if (filename == NULL || (fp = fopen(filename, "r")) == NULL) {
+    return false;
+  }
+  char magic[12];
+  bool isManifest = fread(magic, 1, sizeof(magic), fp) == sizeof(magic)
+                    && memcmp(magic, "TSESEGMENTS ", sizeof(magic)) == 0;
+  fclose(fp);
+  return isManifest;
+}
+
+/*********** segments_open ***********/
+/* see segments.h for more details */
+segments_t* segments_open(const char* manifest, bool write)
+{
+  if (manifest == NULL) {
+    return NULL;
+  }
+  segments_t* segs = newSegments(manifest, write);
+  bool ok;
+  if (write) {
+    // one writer at a time; the manifest lock is only taken to read it.
+    // Some other file in the manifest's place is left alone.
+    ok = (access(manifest, F_OK) != 0 || segments_isManifest(manifest))
+         && (mkdir(segs->dir, 0755) == 0 || errno == EEXIST)
+         && (segs->appendLock = lockFile(segs, "append.lock", LOCK_EX)) >= 0;
+    int lock = ok ? lockFile(segs, "lock", LOCK_SH) : -1;
+    ok = ok && lock >= 0 && readManifest(segs);
+    unlockFile(lock);
+  } else {
+    // an index nobody has written to has no lock file; nothing can change under us
+    segs->readLock = lockFile(segs, "lock", LOCK_SH);
+    ok = readManifest(segs);
+  }
+  if (!ok) {
+    segments_delete(segs);
+    return NULL;
+  }
+  return segs;
+}
+
+/*********** segments_count ***********/
+/* see segments.h for more details */
+int segments_count(segments_t* segs)
+{
+  return segs == NULL ? 0 : segs->count;
+}
+
+/*********** segments_path ***********/
+/* see segments.h for more details */
+const char* segments_path(segments_t* segs, int i)
+{
+  return segs == NULL || i < 0 || i >= segs->count ? NULL : segs->paths[i];
+}
+
+/*********** segments_nextDocID ***********/
+/* see segments.h for more details */
+int segments_nextDocID(segments_t* segs)
+{
+  return segs == NULL || segs->count == 0 ? 1 : segs->list[segs->count - 1].endID;
+}
+
+/*********** segments_add ***********/
+/* see segments.h for more details */
+const char* segments_add(segments_t* segs, int firstID, int endID)
+{
+  if (segs == NULL || !segs->write || firstID != segments_nextDocID(segs) || endID <= firstID) {
+    return NULL;
+  }
+  range_t range = { firstID, endID };
+  appendRange(segs, range);
+  return segs->paths[segs->count - 1];
+}
+
+/*********** segments_save ***********/
+/* see segments.h for more details */
+bool segments_save(segments_t* segs)
+{
+  if (segs == NULL || !segs->write) {
+    return false;
+  }
+  int lock = lockFile(segs, "lock", LOCK_EX);
+  if (lock < 0) {
+    return false;
+  }
+
+  // a compaction may have replaced the manifest since we read it, so
+  // add our segments to what is there now
+  int numAdded = segs->count - segs->saved;
+  range_t* added = mem_calloc_assert(numAdded + 1, sizeof(range_t), "Couldn't allocate segments");
+  memcpy(added, segs->list + segs->saved, numAdded * sizeof(range_t));
+  bool ok = readManifest(segs)
+            && (numAdded == 0 || added[0].firstID == segments_nextDocID(segs));
+  for (int i = 0; ok && i < numAdded; i++) {
+    appendRange(segs, added[i]);
+  }
+  ok = ok && writeManifest(segs);
+  if (ok) {
+    segs->saved = segs->count;
+  }
+  free(added);
+  unlockFile(lock);
+  return ok;
+}
+
+/*********** segments_compact ***********/
+/* see segments.h for more details */
+int segments_compact(const char* manifest, int factor, FILE* log)
+{
+  if (manifest == NULL || factor < 2 || !segments_isManifest(manifest)) {
+    return -1;
+  }
+  segments_t* segs;
+  if ((segs = segments_open(manifest, false)) == NULL) {
+    return -1;
+  }
+  // only one compaction at a time; a second one has nothing to do
+  int mergeLock = lockFile(segs, "merge.lock", LOCK_EX | LOCK_NB);
+  bool running = mergeLock < 0 && errno == EWOULDBLOCK;
+  segments_delete(segs);
+  if (mergeLock < 0) {
+    return running ? 0 : -1;
+  }
+
+  int merges = 0;
+  range_t* window = mem_calloc_assert(factor, sizeof(range_t), "Couldn't allocate merge");
+  for (;;) {
+    // pick the next run of segments to merge
+    if ((segs = segments_open(manifest, false)) == NULL) {
+      merges = -1;
+      break;
+    }
+    int tier;
+    int start = findWindow(segs, factor, &tier);
+    if (start >= 0) {
+      memcpy(window, segs->list + start, factor * sizeof(range_t));
+    }
+    segments_delete(segs);
+    if (start < 0) {
+      break;
+    }
+
+    range_t merged;
+    if (mergeWindow(manifest, window, factor, &merged) != 0) {
+      merges = -1;
+      break;
+    }
+    merges++;
+    if (log != NULL) {
+      fprintf(log, "merged %d tier %d segments into docIDs %d-%d\n",
+              factor, tier, merged.firstID, merged.endID - 1);
+    }
+  }
+  free(window);
+  unlockFile(mergeLock);
+  return merges;
+}
+
+/*********** segments_delete ***********/
+/* see segments.h for more details */
+void segments_delete(segments_t* segs)
+{
+  if (segs != NULL) {
+    unlockFile(segs->readLock);
+    unlockFile(segs->appendLock);
+    clearList(segs);
+    free(segs->list);
+    free(segs->paths);
+    free(segs->manifest);
+    free(segs->dir);
+    free(segs);
+  }
+}
+
+/*********** newSegments ***********/
+/* Returns an empty, unlocked segments_t for manifest */
+static segments_t* newSegments(const char* manifest, bool write)
+{
+  segments_t* segs = mem_calloc_assert(1, sizeof(segments_t), "Couldn't allocate segments");
+  segs->manifest = mem_malloc_assert(strlen(manifest) + 1, "Couldn't allocate segments");
+  strcpy(segs->manifest, manifest);
+  segs->dir = mem_malloc_assert(strlen(manifest) + sizeof(".segs"), "Couldn't allocate segments");
+  sprintf(segs->dir, "%s.segs", manifest);
+  segs->write = write;
+  segs->appendLock = segs->readLock = -1;
+  return segs;
+}
+
+/*********** dirPath ***********/
+/* Returns "<dir>/<name>", which the caller must free */
+static char* dirPath(segments_t* segs, const char* name)
+{
+  size_t length = strlen(segs->dir) + strlen(name) + 2;
+  char* path = mem_malloc_assert(length, "Couldn't allocate path");
+  snprintf(path, length, "%s/%s", segs->dir, name);
+  return path;
+}
+
+/*********** segmentPath ***********/
+/* Returns the file name of a segment, which the caller must free */
+static char* segmentPath(segments_t* segs, range_t range)
+{
+  char name[32];
+  snprintf(name, sizeof(name), "seg.%d-%d", range.firstID, range.endID - 1);
+  return dirPath(segs, name);
+}
+
+/*********** lockFile ***********/
+/* Opens the named lock file in the segment directory and flocks it with
+ * operation. Returns the descriptor, or -1 if the file can't be opened
+ * or (with LOCK_NB) the lock is held elsewhere
+ */
+static int lockFile(segments_t* segs, const char* name, int operation)
+{
+  char* path = dirPath(segs, name);
+  int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0 && (operation & LOCK_SH)) {
+    fd = open(path, O_RDONLY);        // a reader may not be allowed to write
+  }
+  free(path);
+  if (fd >= 0 && flock(fd, operation) != 0) {
+    int error = errno;
+    close(fd);
+    errno = error;
+    fd = -1;
+  }
+  return fd;
+}
+
+/*********** unlockFile ***********/
+/* Releases a lock from lockFile; does nothing for -1 */
+static void unlockFile(int fd)
+{
+  if (fd >= 0) {
+    close(fd);            // closing the descriptor drops the flock
+  }
+}
+
+/*********** readManifest ***********/
+/* Replaces segs' list with the manifest's. A writer takes a missing
+ * manifest as empty. Returns false if the manifest can't be read or
+ * doesn't hold ranges that follow on from each other.
+ */
+static bool readManifest(segments_t* segs)
+{
+  clearList(segs);
+  FILE* fp = fopen(segs->manifest, "r");
+  if (fp == NULL) {
+    return segs->write && errno == ENOENT;
+  }
+  int version = 0;
+  bool ok = fscanf(fp, "TSESEGMENTS %d ", &version) == 1 && version == 1;
+  range_t range;
+  int fields;
+  while (ok && (fields = fscanf(fp, "%d %d ", &range.firstID, &range.endID)) == 2) {
+    ok = range.firstID == segments_nextDocID(segs) && range.endID > range.firstID;
+    if (ok) {
+      appendRange(segs, range);
+    }
+  }
+  ok = ok && feof(fp);
+  fclose(fp);
+  segs->saved = segs->count;
+  return ok;
+}
+
+/*********** writeManifest ***********/
+/* Atomically replaces the manifest with segs' list */
+static bool writeManifest(segments_t* segs)
+{
+  char* temp = mem_malloc_assert(strlen(segs->manifest) + sizeof(".tmp"), "Couldn't allocate path");
+  sprintf(temp, "%s.tmp", segs->manifest);
+  FILE* fp = fopen(temp, "w");
+  bool ok = fp != NULL && fprintf(fp, "TSESEGMENTS 1\n") > 0;
+  for (int i = 0; ok && i < segs->count; i++) {
+    ok = fprintf(fp, "%d %d\n", segs->list[i].firstID, segs->list[i].endID) > 0;
+  }
+  if (fp != NULL) {
+    // the rename below must not land before the data does
+    ok = fflush(fp) == 0 && fsync(fileno(fp)) == 0 && ok;
+    ok = fclose(fp) == 0 && ok;
+  }
+  ok = ok && rename(temp, segs->manifest) == 0;
+  free(temp);
+  return ok;
+}
+
+/*********** appendRange ***********/
+/* Adds a range, with its file name, to the end of segs' list */
+static void appendRange(segments_t* segs, range_t range)
+{
+  if (segs->count == segs->capacity) {
+    segs->capacity = segs->capacity == 0 ? 8 : 2 * segs->capacity;
+    segs->list = realloc(segs->list, segs->capacity * sizeof(range_t));
+    segs->paths = realloc(segs->paths, segs->capacity * sizeof(char*));
+    mem_assert(segs->list, "Couldn't grow segments");
+    mem_assert(segs->paths, "Couldn't grow segments");
+  }
+  segs->list[segs->count] = range;
+  segs->paths[segs->count] = segmentPath(segs, range);
+  segs->count++;
+}
+
+/*********** clearList ***********/
+/* Empties segs' list, keeping its memory */
+static void clearList(segments_t* segs)
+{
+  for (int i = 0; i < segs->count; i++) {
+    free(segs->paths[i]);
+  }
+  segs->count = 0;
+  segs->saved = 0;
+}
+
+/*********** tierOf ***********/
+/* Returns the tier of a segment of the given size: 0 below TIER_BYTES,
+ * then one more for every factor times larger
+ */
+static int tierOf(off_t bytes, int factor)
+{
+  int tier = 0;
+  for (double limit = TIER_BYTES; bytes >= limit; limit *= factor) {
+    tier++;
+  }
+  return tier;
+}
+
+/*********** findWindow ***********/
+/* Returns where the first run of factor neighbouring segments in the
+ * same tier starts, setting *tier to it; -1 if there is no such run
+ */
+static int findWindow(segments_t* segs, int factor, int* tier)
+{
+  int runStart = 0;
+  int runTier = -1;
+  for (int i = 0; i < segs->count; i++) {
+    struct stat info;
+    int thisTier = stat(segs->paths[i], &info) == 0 ? tierOf(info.st_size, factor) : -1;
+    if (thisTier < 0 || thisTier != runTier) {
+      runStart = i;
+      runTier = thisTier;
+    }
+    if (runTier >= 0 && i - runStart + 1 == factor) {
+      *tier = runTier;
+      return runStart;
+    }
+  }
+  return -1;
+}
+
+/*********** mergeWindow ***********/
+/* Merges the factor segments of window into one and, if they are still
+ * in the manifest, swaps it in for them and deletes them
+ *
+ * The merged segment is compressed if any of its inputs is. Returns 0
+ * and sets *merged to the new segment's range, or -1 on an error.
+ */
+static int mergeWindow(const char* manifest, range_t* window, int factor, range_t* merged)
+{
+  segments_t* segs = newSegments(manifest, false);
+  merged->firstID = window[0].firstID;
+  merged->endID = window[factor - 1].endID;
+  char* output = segmentPath(segs, *merged);
+
+  // merge without holding the manifest lock: only a compaction removes segments
+  indexfile_t** files = mem_calloc_assert(factor, sizeof(indexfile_t*), "Couldn't allocate merge");
+  bool ok = true;
+  int options = 0;
+  for (int i = 0; ok && i < factor; i++) {
+    char* path = segmentPath(segs, window[i]);
+    ok = (files[i] = indexfile_open(path)) != NULL;
+    free(path);
+    if (ok && indexfile_isCompressed(files[i])) {
+      options |= INDEXFILE_COMPRESSED;
+    }
+  }
+  ok = ok && indexfile_mergeWrite(output, files, factor, options);
+  for (int i = 0; i < factor; i++) {
+    indexfile_close(files[i]);
+  }
+  free(files);
+
+  // swap the merged segment in for the window, which must still be there
+  int lock = ok ? lockFile(segs, "lock", LOCK_EX) : -1;
+  ok = lock >= 0 && readManifest(segs);
+  int start = -1;
+  for (int i = 0; ok && start < 0 && i + factor <= segs->count; i++) {
+    if (memcmp(&segs->list[i], window, factor * sizeof(range_t)) == 0) {
+      start = i;
+    }
+  }
+  ok = ok && start >= 0;
+  if (ok) {
+    int count = segs->count;
+    range_t* list = mem_calloc_assert(count, sizeof(range_t), "Couldn't allocate segments");
+    memcpy(list, segs->list, count * sizeof(range_t));
+    clearList(segs);
+    for (int i = 0; i < count; i++) {
+      if (i == start) {
+        appendRange(segs, *merged);
+      } else if (i < start || i >= start + factor) {
+        appendRange(segs, list[i]);
+      }
+    }
+    free(list);
+    ok = writeManifest(segs);
+  }
+
+  // readers opening the index hold the manifest lock, so nobody is
+  // between reading the old manifest and opening the old segments
+  for (int i = 0; ok && i < factor; i++) {
+    char* path = segmentPath(segs, window[i]);
+    unlink(path);
+    free(path);
+  }
+  if (!ok) {
+    unlink(output);
+  }
+  unlockFile(lock);
+  free(output);
+  segments_delete(segs);
+  return ok ? 0 : -1;
+}
@@ -0,0 +1,102 @@
+/*
+ * segments.h - header file for CS50 'segments' module
+ *
+ * A *segmented index* is an index kept as several binary index files
+ * (segments), each holding a contiguous range of docIDs, listed in a
+ * small text manifest. The indexer adds a segment for the pages crawled
+ * since the last one instead of reindexing the whole page directory;
+ * index_reconstruct opens every segment of a manifest as one index; and
+ * segments_compact merges runs of similar-sized neighbouring segments,
+ * so lookups never have to visit too many of them.
+ *
+ * The manifest is replaced atomically and guarded by a lock file, so
+ * segments can be compacted while the indexer adds more and queriers
+ * open the index.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __SEGMENTS_H
+#define __SEGMENTS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/********* Global Type ***********/
+typedef struct segments segments_t;
+
+/********** Functions ***********/
+
+/*********** segments_isManifest ***********/
+/* Returns true if filename can be read and starts like a manifest */
+bool segments_isManifest(const char* filename);
+
+/*********** segments_open ***********/
+/* Reads a manifest, locking it
+ *
+ * Caller provides:
+ *   The manifest's file name, and whether the caller will change it
+ * We return:
+ *   The segments, or NULL if the manifest can't be read or isn't one.
+ *   For a writer a missing manifest is an empty segment set, its
+ *   segment directory "<manifest>.segs" is created, and the manifest
+ *   is locked against other writers until segments_delete; a reader
+ *   only holds off writers while it has the segments open.
+ * Caller is responsible for:
+ *   Later calling segments_delete
+ */
+segments_t* segments_open(const char* manifest, bool write);
+
+/*********** segments_count ***********/
+/* Returns the number of segments */
+int segments_count(segments_t* segs);
+
+/*********** segments_path ***********/
+/* Returns the file name of the i'th segment, in docID order; NULL if i
+ * is out of range. The name is valid until segments_delete.
+ */
+const char* segments_path(segments_t* segs, int i);
+
+/*********** segments_nextDocID ***********/
+/* Returns the first docID after every segment: 1 if there are none */
+int segments_nextDocID(segments_t* segs);
+
+/*********** segments_add ***********/
+/* Adds a segment for docIDs firstID up to (not including) endID
+ *
+ * We return:
+ *   The file name the caller must write the segment to, or NULL if
+ *   segs wasn't opened to write or the range doesn't start at
+ *   segments_nextDocID
+ * Notes:
+ *   The manifest only lists the segment once segments_save succeeds.
+ */
+const char* segments_add(segments_t* segs, int firstID, int endID);
+
+/*********** segments_save ***********/
+/* Atomically replaces the manifest with segs; returns true on success */
+bool segments_save(segments_t* segs);
+
+/*********** segments_compact ***********/
+/* Merges segments with a tiered policy until no tier is full
+ *
+ * Caller provides:
+ *   The manifest's file name, the merge factor (at least 2), and a
+ *   stream to report each merge on, or NULL
+ * We do:
+ *   Put every segment in a tier by size, each tier factor times larger
+ *   than the one below, and merge the first run of factor neighbouring
+ *   segments in one tier into a single segment, repeating until there
+ *   is none. The lock is only held while the manifest is read and
+ *   replaced, not while segments are merged.
+ * We return:
+ *   The number of merges done, or -1 on an error; 0 if another
+ *   compaction of the same index is already running
+ */
+int segments_compact(const char* manifest, int factor, FILE* log);
+
+/*********** segments_delete ***********/
+/* Releases the lock and frees segs; does nothing if segs is NULL */
+void segments_delete(segments_t* segs);
+
+#endif // __SEGMENTS_H
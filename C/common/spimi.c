@@ -0,0 +1,281 @@
+/*
+ * spimi.c - CS50 'spimi' module
+ *
+ * Each run is a binary index file (see indexfile.h) written from the
+ * in-memory index with index_saveBinary, so its words are sorted and
+ * its postings can be read in place from the mapping. Run k holds
+ * documents that all come before those of run k+1, so a word's merged
+ * postings are just its lists from each run, concatenated in run order.
+ *
+ * The merge itself is indexfile_merge, or indexfile_mergeWrite for a
+ * binary final index.
+ *
+ * The checkpoint is a small text file, replaced atomically by rename:
+ *
+ *   spimi 1
+ *   runs <number of complete runs>
+ *   nextDocID <first document not in a run>
+ *   pageDirectory <directory being indexed>
+ *
+ * See spimi.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "mem.h"
+#include "indexfile.h"
+#include "indextext.h"
+#include "spimi.h"
+
+/**************** file-local types ****************/
+struct spimi {
+  char* dir;              // "<indexFilename>.runs"
+  char* indexFilename;
+  char* pageDirectory;
+  size_t budget;
+  int numRuns;
+  int nextDocID;
+};
+
+// what the merge hands each merged word to
+typedef bool (*mergefunc_t)(void* arg, const char* word, const postings_t* postings);
+
+// Static function prototypes
+static char* runPath(spimi_t* spimi, const char* name, int run);
+static bool readCheckpoint(spimi_t* spimi);
+static bool writeCheckpoint(spimi_t* spimi);
+static void removeRuns(spimi_t* spimi);
+static bool mergeRuns(spimi_t* spimi, void* arg, mergefunc_t itemfunc, int options);
+static bool addText(void* arg, const char* word, const postings_t* postings);
+
+/*********** spimi_new ***********/
+/* see spimi.h for more details */
+spimi_t* spimi_new(const char* indexFilename, const char* pageDirectory, size_t budget)
+{
+  if (indexFilename == NULL || pageDirectory == NULL) {
+    return NULL;
+  }
+  spimi_t* spimi = mem_calloc_assert(1, sizeof(spimi_t), "Couldn't allocate build");
+  spimi->dir = mem_malloc_assert(strlen(indexFilename) + sizeof(".runs"), "Couldn't allocate build");
+  sprintf(spimi->dir, "%s.runs", indexFilename);
+  spimi->indexFilename = mem_malloc_assert(strlen(indexFilename) + 1, "Couldn't allocate build");
+  strcpy(spimi->indexFilename, indexFilename);
+  spimi->pageDirectory = mem_malloc_assert(strlen(pageDirectory) + 1, "Couldn't allocate build");
+  strcpy(spimi->pageDirectory, pageDirectory);
+  spimi->budget = budget;
+
+  if (mkdir(spimi->dir, 0755) != 0 && errno != EEXIST) {
+    spimi_delete(spimi);
+    return NULL;
+  }
+  // pick up an interrupted build of the same pages, else start over
+  if (!readCheckpoint(spimi)) {
+    spimi->numRuns = 0;
+    spimi->nextDocID = 1;
+  }
+  return spimi;
+}
+
+/*********** spimi_nextDocID ***********/
+/* see spimi.h for more details */
+int spimi_nextDocID(spimi_t* spimi)
+{
+  return spimi == NULL ? 1 : spimi->nextDocID;
+}
+
+/*********** spimi_numRuns ***********/
+/* see spimi.h for more details */
+int spimi_numRuns(spimi_t* spimi)
+{
+  return spimi == NULL ? 0 : spimi->numRuns;
+}
+
+/*********** spimi_isFull ***********/
+/* see spimi.h for more details */
+bool spimi_isFull(spimi_t* spimi, index_t* idx)
+{
+  return spimi != NULL && index_memoryUsed(idx) >= spimi->budget;
+}
+
+/*********** spimi_spill ***********/
+/* see spimi.h for more details */
+bool spimi_spill(spimi_t* spimi, index_t* idx, int nextDocID)
+{
+  if (spimi == NULL || idx == NULL || nextDocID < spimi->nextDocID) {
+    return false;
+  }
+  if (index_memoryUsed(idx) > 0) {
+    char* path = runPath(spimi, "run", spimi->numRuns);
+    bool saved = index_saveBinary(idx, path, 0);
+    free(path);
+    if (!saved) {
+      return false;
+    }
+    spimi->numRuns++;
+  }
+  spimi->nextDocID = nextDocID;
+  return writeCheckpoint(spimi);
+}
+
+/*********** spimi_merge ***********/
+/* see spimi.h for more details */
+bool spimi_merge(spimi_t* spimi, bool binary, int options)
+{
+  if (spimi == NULL) {
+    return false;
+  }
+  bool merged;
+  if (binary) {
+    merged = mergeRuns(spimi, NULL, NULL, options);
+  } else {
+    indextext_writer_t* writer = indextext_writerNew(spimi->indexFilename);
+    merged = writer != NULL && mergeRuns(spimi, writer, addText, 0);
+    if (writer != NULL && !indextext_writerClose(writer)) {
+      merged = false;
+    }
+  }
+  if (merged) {
+    removeRuns(spimi);
+  }
+  return merged;
+}
+
+/*********** spimi_delete ***********/
+/* see spimi.h for more details */
+void spimi_delete(spimi_t* spimi)
+{
+  if (spimi != NULL) {
+    free(spimi->dir);
+    free(spimi->indexFilename);
+    free(spimi->pageDirectory);
+    free(spimi);
+  }
+}
+
+/*********** runPath ***********/
+/* Returns "<dir>/<name>.<run>" (or "<dir>/<name>" if run < 0),
+ * which the caller must free
+ */
+static char* runPath(spimi_t* spimi, const char* name, int run)
+{
+  size_t length = strlen(spimi->dir) + strlen(name) + 16;
+  char* path = mem_malloc_assert(length, "Couldn't allocate run path");
+  if (run < 0) {
+    snprintf(path, length, "%s/%s", spimi->dir, name);
+  } else {
+    snprintf(path, length, "%s/%s.%d", spimi->dir, name, run);
+  }
+  return path;
+}
+
+/*********** readCheckpoint ***********/
+/* Loads the checkpoint into spimi; false if there is none, it can't be
+ * parsed, or it was written for a different page directory
+ */
+static bool readCheckpoint(spimi_t* spimi)
+{
+  char* path = runPath(spimi, "checkpoint", -1);
+  FILE* fp = fopen(path, "r");
+  free(path);
+  if (fp == NULL) {
+    return false;
+  }
+  int version = 0;
+  int numRuns = -1;
+  int nextDocID = 0;
+  char* line = NULL;
+  size_t capacity = 0;
+  bool ok = fscanf(fp, "spimi %d\nruns %d\nnextDocID %d\npageDirectory ",
+                   &version, &numRuns, &nextDocID) == 3
+            && version == 1 && numRuns >= 0 && nextDocID >= 1
+            && getline(&line, &capacity, fp) > 0;
+  fclose(fp);
+  if (ok) {
+    line[strcspn(line, "\n")] = '\0';
+    ok = strcmp(line, spimi->pageDirectory) == 0;
+  }
+  free(line);
+  if (ok) {
+    spimi->numRuns = numRuns;
+    spimi->nextDocID = nextDocID;
+  }
+  return ok;
+}
+
+/*********** writeCheckpoint ***********/
+/* Replaces the checkpoint with spimi's current state */
+static bool writeCheckpoint(spimi_t* spimi)
+{
+  char* path = runPath(spimi, "checkpoint", -1);
+  char* temp = runPath(spimi, "checkpoint.tmp", -1);
+  FILE* fp = fopen(temp, "w");
+  bool ok = fp != NULL
+            && fprintf(fp, "spimi 1\nruns %d\nnextDocID %d\npageDirectory %s\n",
+                       spimi->numRuns, spimi->nextDocID, spimi->pageDirectory) > 0;
+  if (fp != NULL) {
+    // the rename below must not land before the data does
+    ok = fflush(fp) == 0 && fsync(fileno(fp)) == 0 && ok;
+    ok = fclose(fp) == 0 && ok;
+  }
+  ok = ok && rename(temp, path) == 0;
+  free(path);
+  free(temp);
+  return ok;
+}
+
+/*********** removeRuns ***********/
+/* Deletes the runs, the checkpoint and the runs directory */
+static void removeRuns(spimi_t* spimi)
+{
+  for (int run = 0; run < spimi->numRuns; run++) {
+    char* path = runPath(spimi, "run", run);
+    unlink(path);
+    free(path);
+  }
+  char* path = runPath(spimi, "checkpoint", -1);
+  unlink(path);
+  free(path);
+  rmdir(spimi->dir);
+  spimi->numRuns = 0;
+}
+
+/*********** mergeRuns ***********/
+/* Opens every run and merges them: into the binary index file with
+ * indexfile_mergeWrite if itemfunc is NULL, else through itemfunc with
+ * indexfile_merge. Returns false if a run can't be opened or the merge
+ * fails.
+ */
+static bool mergeRuns(spimi_t* spimi, void* arg, mergefunc_t itemfunc, int options)
+{
+  indexfile_t** files = mem_calloc_assert(spimi->numRuns + 1, sizeof(indexfile_t*), "Couldn't allocate merge");
+  bool ok = true;
+  for (int run = 0; ok && run < spimi->numRuns; run++) {
+    char* path = runPath(spimi, "run", run);
+    ok = (files[run] = indexfile_open(path)) != NULL;
+    free(path);
+  }
+  if (ok) {
+    ok = itemfunc == NULL ? indexfile_mergeWrite(spimi->indexFilename, files, spimi->numRuns, options)
+                          : indexfile_merge(files, spimi->numRuns, arg, itemfunc);
+  }
+  for (int run = 0; run < spimi->numRuns; run++) {
+    indexfile_close(files[run]);
+  }
+  free(files);
+  return ok;
+}
+
+/*********** addText ***********/
+/* mergeRuns helper that writes a word to a text index */
+static bool addText(void* arg, const char* word, const postings_t* postings)
+{
+  return indextext_writerAdd((indextext_writer_t*) arg, word, postings);
+}
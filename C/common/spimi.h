@@ -0,0 +1,90 @@
+/*
+ * spimi.h - header file for CS50 'spimi' module
+ *
+ * This module builds an index too large to hold in memory, in the
+ * single-pass in-memory indexing (SPIMI) style: the indexer fills an
+ * in-memory index until it reaches a memory budget, writes it out as a
+ * sorted run, and starts a new one. At the end the runs are merged,
+ * word by word, into the final index file.
+ *
+ * Runs live in the directory "<indexFilename>.runs" next to a checkpoint
+ * recording how many runs are complete and which document comes next,
+ * so a build that dies part way can be restarted and pick up from the
+ * last run written.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __SPIMI_H
+#define __SPIMI_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "index.h"
+
+/********* Global Type ***********/
+typedef struct spimi spimi_t;
+
+/********** Functions ***********/
+
+/*********** spimi_new ***********/
+/* Starts or resumes a build
+ *
+ * Caller provides:
+ *   The final index file name, the page directory being indexed, and
+ *   the memory budget in bytes for the in-memory index
+ * We return:
+ *   A build, or NULL if the runs directory can't be created. If the
+ *   runs directory holds a checkpoint for the same page directory, the
+ *   build resumes after the runs it records.
+ * Caller is responsible for:
+ *   Later calling spimi_delete
+ */
+spimi_t* spimi_new(const char* indexFilename, const char* pageDirectory, size_t budget);
+
+/*********** spimi_nextDocID ***********/
+/* Returns the first document not yet in a run: 1 for a new build */
+int spimi_nextDocID(spimi_t* spimi);
+
+/*********** spimi_numRuns ***********/
+/* Returns the number of runs written so far */
+int spimi_numRuns(spimi_t* spimi);
+
+/*********** spimi_isFull ***********/
+/* Returns true if idx has grown past the build's memory budget */
+bool spimi_isFull(spimi_t* spimi, index_t* idx);
+
+/*********** spimi_spill ***********/
+/* Writes an in-memory index out as the next sorted run
+ *
+ * Caller provides:
+ *   The build, the index holding every document from the previous
+ *   spill's nextDocID up to (not including) nextDocID
+ * We return:
+ *   true if the run and the checkpoint were written
+ * Notes:
+ *   An index with no words writes no run but still moves the checkpoint.
+ *   The caller then deletes idx and carries on with a fresh index.
+ */
+bool spimi_spill(spimi_t* spimi, index_t* idx, int nextDocID);
+
+/*********** spimi_merge ***********/
+/* Merges every run into the final index file
+ *
+ * Caller provides:
+ *   The build, whether to write the binary format, and INDEXFILE_*
+ *   options for it
+ * We return:
+ *   true if the index file was written; the runs and checkpoint are
+ *   then removed. On failure they are kept, so the merge can be retried.
+ * Notes:
+ *   The merge holds one postings list per run at a time, however large
+ *   the index.
+ */
+bool spimi_merge(spimi_t* spimi, bool binary, int options);
+
+/*********** spimi_delete ***********/
+/* Frees the build; does nothing if spimi is NULL */
+void spimi_delete(spimi_t* spimi);
+
+#endif // __SPIMI_H
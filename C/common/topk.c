@@ -0,0 +1,93 @@
+/*
+ * topk.c - CS50 'topk' module
+ *
+ * The heap is an implicit binary tree in the caller's array, each entry
+ * ranking below its children. An entry added is moved up past every
+ * parent it ranks below; a new root is moved down past every child
+ * ranking below it, holding the entry aside and shifting the children
+ * up rather than swapping at each level.
+ *
+ * See topk.h for more information.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include "topk.h"
+
+// Static function prototypes
+static void siftDown(topk_entry_t* heap, int size, int at);
+static int sortFunc(const void* firstAddress, const void* secondAddress);
+
+/*********** topk_ranksAbove ***********/
+/* see topk.h for more details */
+bool topk_ranksAbove(const topk_entry_t* first, const topk_entry_t* second)
+{
+  return first->score != second->score ? first->score > second->score : first->id < second->id;
+}
+
+/*********** topk_offer ***********/
+/* see topk.h for more details */
+bool topk_offer(topk_entry_t* heap, int* size, int k, topk_entry_t entry)
+{
+  if (heap == NULL || size == NULL || k <= 0) {
+    return false;
+  }
+  if (*size < k) {
+    int at = (*size)++;
+    while (at > 0 && topk_ranksAbove(&heap[(at - 1) / 2], &entry)) {
+      heap[at] = heap[(at - 1) / 2];
+      at = (at - 1) / 2;
+    }
+    heap[at] = entry;
+    return true;
+  }
+  if (!topk_ranksAbove(&entry, &heap[0])) {
+    return false;
+  }
+  heap[0] = entry;
+  siftDown(heap, *size, 0);
+  return true;
+}
+
+/*********** topk_sort ***********/
+/* see topk.h for more details */
+void topk_sort(topk_entry_t* entries, int size)
+{
+  if (entries != NULL && size > 1) {
+    qsort(entries, size, sizeof(topk_entry_t), sortFunc);
+  }
+}
+
+/*********** siftDown ***********/
+/* Moves heap[at] down below every child it ranks above, so the heap's
+ * root is again its lowest-ranked entry
+ */
+static void siftDown(topk_entry_t* heap, int size, int at)
+{
+  topk_entry_t entry = heap[at];
+  while (2 * at + 1 < size) {
+    int child = 2 * at + 1;
+    if (child + 1 < size && topk_ranksAbove(&heap[child], &heap[child + 1])) {
+      child++;
+    }
+    if (!topk_ranksAbove(&entry, &heap[child])) {
+      break;
+    }
+    heap[at] = heap[child];
+    at = child;
+  }
+  heap[at] = entry;
+}
+
+/*********** sortFunc ***********/
+/* Sorting comparator for qsort: highest score first, then lowest ID */
+static int sortFunc(const void* firstAddress, const void* secondAddress)
+{
+  const topk_entry_t* first = (const topk_entry_t*) firstAddress;
+  const topk_entry_t* second = (const topk_entry_t*) secondAddress;
+  if (first->score != second->score) {
+    return second->score > first->score ? 1 : -1;
+  }
+  return (first->id > second->id) - (first->id < second->id);
+}
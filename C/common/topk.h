@@ -0,0 +1,53 @@
+/*
+ * topk.h - header file for CS50 'topk' module
+ *
+ * A *topk* heap keeps the best k of a stream of scored documents in a
+ * caller's array of k entries. It is a min-heap: its root is the worst
+ * entry kept, so a new entry that doesn't rank above the root is
+ * dropped at once, and one that does costs O(log k). Documents rank by
+ * score, highest first, and by docID, lowest first, among equal scores.
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#ifndef __TOPK_H
+#define __TOPK_H
+
+#include <stdbool.h>
+
+/********* Global Type ***********/
+// one scored document
+typedef struct topk_entry {
+  int id;
+  int score;
+} topk_entry_t;
+
+/********** Functions ***********/
+
+/*********** topk_ranksAbove ***********/
+/* Returns true if first ranks above second: a higher score, or the
+ * same score and a lower docID
+ */
+bool topk_ranksAbove(const topk_entry_t* first, const topk_entry_t* second);
+
+/*********** topk_offer ***********/
+/* Offers a document to a heap of the best k
+ *
+ * Caller provides:
+ *   An array heap with room for k entries, *size of them in use (0 to
+ *   start), and the entry to offer
+ * We do:
+ *   Add entry while the heap has room; once it holds k, put entry in
+ *   place of the root if it ranks above it
+ * We return:
+ *   True if entry was kept; false if it wasn't, or k <= 0
+ * We guarantee:
+ *   heap[0] is the worst entry kept, once there is one
+ */
+bool topk_offer(topk_entry_t* heap, int* size, int k, topk_entry_t entry);
+
+/*********** topk_sort ***********/
+/* Sorts size entries, such as a heap's, best first */
+void topk_sort(topk_entry_t* entries, int size);
+
+#endif // __TOPK_H
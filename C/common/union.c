@@ -3,26 +3,35 @@
  *
  * This module implements an abstraction for computing logical AND (conjunction)
  * and OR (disjunction) between sets of document scores using counters.
+ * Words come in as postings lists sorted by docID.
  * 
  *
  * Arthur Ufongene, May 2025
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "union.h"
 #include "mem.h"
-#include "bag.h"
 
 // Internal structure for union object
 struct unions {
   counters_t* counter;
 };
 
+// (id, score) pairs being gathered by union_postings
+typedef struct pairs {
+  int* pairs;
+  int size;
+} pairs_t;
+
 // Internal function prototypes
 static int union_get(union_t* uni, int id);
 static bool union_set(union_t* uni, int id, int count);
-static void disjunct(void* uni, int id, int count);
-static void addToBag(void* bag, int id, int count);
+static void disjunct(void* uni, const int id, const int count);
+static void countPair(void* arg, const int id, const int count);
+static void collectPair(void* arg, const int id, const int count);
+static int compareIds(const void* first, const void* second);
 
 /********** union_new *************/
 /* See union.h for more information */
@@ -35,36 +44,27 @@ union_t* union_new(void)
 
 /********** union_conjunction *************/
 /* See union.h for more information */
-void union_conjunction(union_t* uni, counters_t* counter)
+void union_conjunction(union_t* uni, const postings_t* postings)
 {
   counters_t* conjunction = counters_new();      // result of conjunction will be in here
-  bag_t* counterEntries = bag_new();             // bag of docID's that are in the counter
-
-  // Extract all docIDs from the input counter
-  counters_iterate(counter, counterEntries, addToBag);
 
-  int* currId;
   int unionCount;
-  int counterCount;
 
   // Compare values for shared keys
-  while ((currId = bag_extract(counterEntries)) != NULL) {
+  for (int i = 0; i < postings->size; i++) {
     // if the docID is in the union
-    if ((unionCount = union_get(uni, *currId)) > 0) {
+    if ((unionCount = union_get(uni, postings->ids[i])) > 0) {
 
     // add the score of whichever is lower
-      if ((counterCount = counters_get(counter, *currId)) < unionCount) {
-        counters_set(conjunction, *currId, counterCount);
+      if (postings->counts[i] < unionCount) {
+        counters_set(conjunction, postings->ids[i], postings->counts[i]);
       } else {
-        counters_set(conjunction, *currId, unionCount);
+        counters_set(conjunction, postings->ids[i], unionCount);
       }
     }
-    // free calloc'd int*
-    free(currId);
   }
   
   // clean up and replace old with new
-  bag_delete(counterEntries, NULL);
   counters_delete(uni->counter); 
 
   uni->counter = conjunction;
@@ -72,7 +72,15 @@ void union_conjunction(union_t* uni, counters_t* counter)
 
 /********** union_disjunction *************/
 /* See union.h for more information */
-void union_disjunction(union_t* uni, counters_t* counter)
+void union_disjunction(union_t* uni, const postings_t* postings)
+{
+  // call disjunct to add all entries to the union
+  postings_iterate(postings, uni, disjunct);
+}
+
+/********** union_disjunctionCounter *************/
+/* See union.h for more information */
+void union_disjunctionCounter(union_t* uni, counters_t* counter)
 {
   // call disjunct to add all entries to the union
   counters_iterate(counter, uni, disjunct);
@@ -85,6 +93,28 @@ counters_t* union_getCounter(union_t* uni)
   return uni->counter;
 }
 
+/********** union_postings *************/
+/* See union.h for more information */
+void union_postings(union_t* uni, postings_t* postings)
+{
+  // gather (id, score) pairs, sort them by id, then split them out
+  pairs_t gathered = { NULL, 0 };
+  counters_iterate(uni->counter, &gathered, countPair);
+  gathered.pairs = mem_malloc_assert((gathered.size + 1) * 2 * sizeof(int), "Couldn't allocate scores");
+  gathered.size = 0;
+  counters_iterate(uni->counter, &gathered, collectPair);
+  qsort(gathered.pairs, gathered.size, 2 * sizeof(int), compareIds);
+
+  *postings = postings_view(NULL, NULL, 0);
+  postings_reserve(postings, gathered.size + 1);
+  for (int i = 0; i < gathered.size; i++) {
+    postings->ids[i] = gathered.pairs[2 * i];
+    postings->counts[i] = gathered.pairs[2 * i + 1];
+  }
+  postings->size = gathered.size;
+  free(gathered.pairs);
+}
+
 /********** union_delete *************/
 /* See union.h for more information */
 void union_delete(union_t* uni) 
@@ -123,18 +153,34 @@ static bool union_set(union_t* uni, int id, int count)
  * adds the values of entries in a counter
  * to the values of corresponding entries in the union
  */
-static void disjunct(void* uni, int id, int count) 
+static void disjunct(void* uni, const int id, const int count) 
 {
                                // get current value and add the value of the counter
   union_set((union_t*) uni, id, union_get((union_t*) uni, id) + count);
 }
 
-/********** addToBag *************/
-/* Copy ID into bag to allow iteration */
-static void addToBag(void* bag, int id, int count)
+/********** countPair *************/
+/* counters_iterate helper counting the union's entries */
+static void countPair(void* arg, const int id, const int count)
+{
+  ((pairs_t*) arg)->size++;
+}
+
+/********** collectPair *************/
+/* counters_iterate helper appending an (id, score) pair */
+static void collectPair(void* arg, const int id, const int count)
+{
+  pairs_t* gathered = (pairs_t*) arg;
+  gathered->pairs[2 * gathered->size] = id;
+  gathered->pairs[2 * gathered->size + 1] = count;
+  gathered->size++;
+}
+
+/********** compareIds *************/
+/* qsort comparator ordering (id, score) pairs by id */
+static int compareIds(const void* first, const void* second)
 {
-  // store the id in an int and put it into the bag
-  int* idCopy = mem_malloc_assert(sizeof(int), "Couldn't add id to bag");
-  *idCopy = id;
-  bag_insert((bag_t*) bag, idCopy);
+  int a = *(const int*) first;
+  int b = *(const int*) second;
+  return (a > b) - (a < b);
 }
@@ -1,13 +1,15 @@
 /*
  * union.h - header file for CS50 'union' module
  *
- * This module provides an wrapper for combining counters sets using
- * logical conjunction (AND) and disjunction (OR) operations.
+ * This module provides an wrapper for combining a word's postings into a
+ * counters set of scores using logical conjunction (AND) and
+ * disjunction (OR) operations.
  *
  * Arthur Ufongene, May 2025
  */
 
 #include "counters.h"
+#include "postings.h"
 
 typedef struct unions union_t;
 
@@ -22,19 +24,30 @@ typedef struct unions union_t;
 union_t* union_new(void);
 
 /********** union_conjunction *************/
-/* Perform logical AND with the internal counter and the given counter
+/* Perform logical AND with the internal counter and the given postings
  *
  * Caller provides:
  *   A valid union_t*
- *   A counters_t* to combine via conjunction
+ *   A postings_t* to combine via conjunction
  * We do:
  *   Replace the internal counter with the minimum value per key
- *   Only keys common to both counters are preserved
+ *   Only keys common to both are preserved
  */
-void union_conjunction(union_t* uni, counters_t* counter);
+void union_conjunction(union_t* uni, const postings_t* postings);
 
 /********** union_disjunction *************/
-/* Perform logical OR with the internal counter and the given counter
+/* Perform logical OR with the internal counter and the given postings
+ *
+ * Caller provides:
+ *   A valid union_t*
+ *   A postings_t* to combine via disjunction
+ * We do:
+ *   Add values of matching keys; all keys are preserved
+ */
+void union_disjunction(union_t* uni, const postings_t* postings);
+
+/********** union_disjunctionCounter *************/
+/* Perform logical OR with the internal counter and another counters set
  *
  * Caller provides:
  *   A valid union_t*
@@ -42,7 +55,7 @@ void union_conjunction(union_t* uni, counters_t* counter);
  * We do:
  *   Add values of matching keys; all keys are preserved
  */
-void union_disjunction(union_t* uni, counters_t* counter);
+void union_disjunctionCounter(union_t* uni, counters_t* counter);
 
 /********** union_getCounter *************/
 /* Return the internal counters set from the union
@@ -55,6 +68,19 @@ void union_disjunction(union_t* uni, counters_t* counter);
  */
 counters_t* union_getCounter(union_t* uni);
 
+/********** union_postings *************/
+/* Copy the union's scores out as a postings list
+ *
+ * Caller provides:
+ *   A valid union_t*, and a postings_t to fill in
+ * We do:
+ *   Make *postings a list owning its arrays, holding every (docID,
+ *   score) in the union in increasing docID order
+ * Caller is responsible for:
+ *   Calling postings_release on *postings
+ */
+void union_postings(union_t* uni, postings_t* postings);
+
 /********** union_delete *************/
 /* Delete the union object and its internal counters
  *
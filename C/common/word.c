@@ -41,6 +41,9 @@ char** word_decomposeSequence(char* query)
   int place = 0;                      // Index in wordArray
   int length = strlen(query);         
   bool inWord = false;                // Track whether we're currently in a word
+  bool inPhrase = false;              // or between a pair of quotes
+  int phraseStart = 0;                // where the current phrase starts in query
+  int write = 0;                      // where its next character goes
 
   char** wordArray = mem_calloc_assert(arraySize, sizeof(char*), "Couldn't alloc"); // Allocate word pointer array
 
@@ -51,6 +54,29 @@ char** word_decomposeSequence(char* query)
       wordArray = realloc(wordArray, arraySize * sizeof(char*));
     }
 
+    // A quote opens a phrase, ending any word before it, or closes one
+    if (query[i] == '"') {
+      if (!inPhrase) {
+        query[i] = '\0';
+        inWord = false;
+        inPhrase = true;
+        phraseStart = write = i + 1;
+        wordArray[place] = query + phraseStart;
+        place++;
+      } else {
+        // drop a trailing space; an empty phrase is no word at all
+        if (write > phraseStart && query[write - 1] == ' ') {
+          write--;
+        }
+        if (write == phraseStart) {
+          place--;
+        }
+        query[write] = '\0';
+        inPhrase = false;
+      }
+      continue;
+    }
+
     // If we detect a non-letter non-space character,
     if (!isalpha(query[i]) && !isspace(query[i])) {
       free(wordArray);
@@ -59,6 +85,16 @@ char** word_decomposeSequence(char* query)
       return NULL;
     }
 
+    // Inside a phrase, copy it down with single spaces between its words
+    if (inPhrase) {
+      if (!isspace(query[i])) {
+        query[write++] = query[i];
+      } else if (write > phraseStart && query[write - 1] != ' ') {
+        query[write++] = ' ';
+      }
+      continue;
+    }
+
     // if we are not in a word yet and detect a letter
     if (!inWord && isalpha(query[i])) {
       wordArray[place] = query + i;   // Set array entry pointer to beginning of word
@@ -73,6 +109,12 @@ char** word_decomposeSequence(char* query)
     }
   }
 
+  if (inPhrase) {
+    free(wordArray);
+    fprintf(stderr, "Error: unmatched '\"' in query.\n\n");
+    return NULL;
+  }
+
   // Null-terminate remaining array entries
   for (; place < arraySize; place++) {
     wordArray[place] = NULL;
@@ -143,12 +185,19 @@ bool word_checkSyntax(char** sequence)
 }
 
 
+/********** word_isPhrase *************/
+/* See word.h for more info */
+bool word_isPhrase(const char* word)
+{
+  return strchr(word, ' ') != NULL;
+}
+
 void word_printSequence(char** wordSequence)
 {
   printf("Query: ");
-  // loop through the sequence printing each word in order
+  // loop through the sequence printing each word in order, phrases quoted
   for (int i = 0; wordSequence[i] != NULL; i++) {
-    printf("%s ", wordSequence[i]);
+    printf(word_isPhrase(wordSequence[i]) ? "\"%s\" " : "%s ", wordSequence[i]);
   }
   printf("\n");
 }
@@ -51,13 +51,17 @@ bool word_checkSyntax(char** sequence);
 /* Tokenize a query string into individual words
  *
  * This function splits a single string into an array of words.
- * All non-alphabetic, non-space characters are considered invalid.
+ * Words between a pair of double quotes are kept together as one
+ * phrase, with a single space between each of its words (see
+ * word_isPhrase). Any other non-alphabetic, non-space characters
+ * are considered invalid.
  *
  * Caller provides:
  *   A null-terminated query string (char*) which may be modified by this function.
  * We return:
  *   A NULL-terminated array of pointers to the beginning of each word in `query`.
- *   If the query contains invalid characters, returns NULL 
+ *   If the query contains invalid characters or an unmatched quote,
+ *   returns NULL 
  * Caller is responsible for:
  *   Freeing the returned array of words
  * 
@@ -66,10 +70,17 @@ bool word_checkSyntax(char** sequence);
  */
 char** word_decomposeSequence(char* query);
 
+/********** word_isPhrase *************/
+/* Returns true if a word from word_decomposeSequence is a quoted
+ * phrase of several words
+ */
+bool word_isPhrase(const char* word);
+
 /************* word_printSequence ****************/
 /* Prints a sequence of words to stdout
  *
  * Caller provides: a valid pointer to an array of strings terminated by a NULL
- * We do: Print all words on the same line separated by spaces
+ * We do: Print all words on the same line separated by spaces,
+ *   with phrases in quotes
  */
 void word_printSequence(char** wordSequence);
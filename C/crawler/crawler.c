@@ -3,7 +3,9 @@
  *
  * This module 'crawls' across interconnected webpages
  * starting from a given seed URL up to a given depth 
- * and saves the HTML of those webpages to a given directory
+ * and saves the HTML of those webpages to a given directory,
+ * along with a manifest of every saved page's URL and depth
+ * (see docmap.h)
  * 
  * Arthur Ufongene, May 2025
  */
@@ -19,6 +21,7 @@
 #include "bag.h"
 #include "hashtable.h"
 #include "pagedir.h"
+#include "docmap.h"
 
 // Function prototypes
 static void crawl(char* seedURL, char* pageDirectory, const int maxDepth);
@@ -111,6 +114,12 @@ static void crawl(char* seedURL, char* pageDirectory, const int maxDepth)
         // ID to number saved files
   int id = 1; 
 
+        // Manifest of the pages saved, for the querier to find URLs in
+  docmap_writer_t* docs = docmap_writerNew(pageDirectory);
+  if (docs == NULL) {
+    fprintf(stderr, "Couldn't write page manifest; continuing without one\n");
+  }
+
         // Hashtable to keep track of seen URLs
   hashtable_t* visitedPages = hashtable_new(200);
 
@@ -138,6 +147,7 @@ static void crawl(char* seedURL, char* pageDirectory, const int maxDepth)
         // Save the page to the specified directory with the current id, then increment id
       if (webpage_getHTML(currWebpage) != NULL) {
         pagedir_save(currWebpage, pageDirectory, id);
+        docmap_writerAdd(docs, id, url, webpage_getDepth(currWebpage));
         id++;
 
         // If the depth is less than the maxDepth, scan for new URLs
@@ -154,7 +164,10 @@ static void crawl(char* seedURL, char* pageDirectory, const int maxDepth)
     webpage_delete(currWebpage);
   }
 
-        // Cleanup
+        // Finish the manifest, then clean up
+  if (docs != NULL && !docmap_writerClose(docs)) {
+    fprintf(stderr, "Couldn't write page manifest\n");
+  }
   hashtable_delete(visitedPages, NULL);
   bag_delete(pagesToVisit, NULL);
 }
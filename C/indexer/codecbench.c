@@ -0,0 +1,188 @@
+/*
+ * codecbench.c - CS50 'codecbench' module
+ *
+ * This module loads an index (text or binary), compresses every postings
+ * list with the codec module, decodes it again, and checks that the
+ * result matches. It reports the compression ratio against the raw
+ * int arrays and against the text index, and the encode and decode
+ * throughput.
+ *
+ * usage: ./codecbench indexFilename [rounds]
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "mem.h"
+#include "clock.h"
+#include "index.h"
+#include "codec.h"
+
+// every list in the index, copied so each round works on the same input
+typedef struct benchList {
+  int* ids;
+  int* counts;
+  int size;
+} benchList_t;
+
+typedef struct bench {
+  benchList_t* lists;
+  int numLists;
+  int capacity;
+  long numPostings;
+  long textBytes;         // bytes the postings take in a text index
+  int longest;
+} bench_t;
+
+// Function prototypes
+int main(int argc, char* argv[]);
+static void collectList(void* arg, const char* word, const postings_t* postings);
+static int digits(int value);
+
+/**************** main ****************/
+/* Loads the index, then times encoding and decoding all of its lists */
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s indexFilename [rounds]\n", argv[0]);
+    exit(1);
+  }
+  int rounds = argc == 3 ? atoi(argv[2]) : 20;
+  if (rounds < 1) {
+    fprintf(stderr, "rounds must be a positive integer\n");
+    exit(1);
+  }
+
+  index_t* idx = index_reconstruct(argv[1]);
+  if (idx == NULL) {
+    fprintf(stderr, "Couldn't load index %s\n", argv[1]);
+    exit(2);
+  }
+  bench_t bench = { NULL, 0, 0, 0, 0, 0 };
+  index_iterate(idx, &bench, collectList);
+  index_delete(idx);
+
+  // one output buffer per list, so decoding reads what encoding wrote
+  unsigned char** coded = mem_calloc_assert(bench.numLists + 1, sizeof(unsigned char*),
+                                            "Couldn't allocate buffers");
+  size_t* codedLength = mem_calloc_assert(bench.numLists + 1, sizeof(size_t),
+                                          "Couldn't allocate buffers");
+  for (int i = 0; i < bench.numLists; i++) {
+    coded[i] = mem_malloc_assert(codec_maxBytes(bench.lists[i].size) + 1,
+                                 "Couldn't allocate buffers");
+  }
+  int* ids = mem_malloc_assert((bench.longest + 1) * sizeof(int), "Couldn't allocate buffers");
+  int* counts = mem_malloc_assert((bench.longest + 1) * sizeof(int), "Couldn't allocate buffers");
+
+  double start = clock_now();
+  size_t totalCoded = 0;
+  for (int r = 0; r < rounds; r++) {
+    totalCoded = 0;
+    for (int i = 0; i < bench.numLists; i++) {
+      benchList_t* list = &bench.lists[i];
+      codedLength[i] = codec_encode(list->ids, list->counts, list->size, coded[i]);
+      totalCoded += codedLength[i];
+    }
+  }
+  double encodeTime = clock_now() - start;
+
+  start = clock_now();
+  int bad = 0;
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < bench.numLists; i++) {
+      benchList_t* list = &bench.lists[i];
+      if (!codec_decode(coded[i], codedLength[i], list->size, ids, counts)) {
+        bad++;
+      }
+    }
+  }
+  double decodeTime = clock_now() - start;
+
+  // check the round trip once, outside the timed loops
+  for (int i = 0; i < bench.numLists; i++) {
+    benchList_t* list = &bench.lists[i];
+    if (!codec_decode(coded[i], codedLength[i], list->size, ids, counts)
+        || memcmp(ids, list->ids, list->size * sizeof(int)) != 0
+        || memcmp(counts, list->counts, list->size * sizeof(int)) != 0) {
+      bad++;
+    }
+  }
+
+  long rawBytes = bench.numPostings * 2 * (long) sizeof(int);
+  double postings = (double) bench.numPostings * rounds;
+  printf("index:          %s\n", argv[1]);
+  printf("words:          %d\n", bench.numLists);
+  printf("postings:       %ld\n", bench.numPostings);
+  printf("raw bytes:      %ld\n", rawBytes);
+  printf("text bytes:     %ld\n", bench.textBytes);
+  printf("coded bytes:    %zu\n", totalCoded);
+  if (totalCoded > 0) {
+    printf("ratio vs raw:   %.2f\n", (double) rawBytes / totalCoded);
+    printf("ratio vs text:  %.2f\n", (double) bench.textBytes / totalCoded);
+    printf("bits/posting:   %.2f\n", 8.0 * totalCoded / bench.numPostings);
+  }
+  if (encodeTime > 0 && decodeTime > 0) {
+    printf("encode:         %.1f Mpostings/s, %.1f MB/s raw\n",
+           postings / encodeTime / 1e6, rawBytes * (double) rounds / encodeTime / 1e6);
+    printf("decode:         %.1f Mpostings/s, %.1f MB/s raw\n",
+           postings / decodeTime / 1e6, rawBytes * (double) rounds / decodeTime / 1e6);
+  }
+  printf("round trip:     %s\n", bad == 0 ? "ok" : "FAILED");
+
+  for (int i = 0; i < bench.numLists; i++) {
+    free(bench.lists[i].ids);
+    free(bench.lists[i].counts);
+    free(coded[i]);
+  }
+  free(bench.lists);
+  free(coded);
+  free(codedLength);
+  free(ids);
+  free(counts);
+  return bad == 0 ? 0 : 3;
+}
+
+/**************** collectList ****************/
+/* index_iterate helper: copies one word's postings into the bench */
+static void collectList(void* arg, const char* word, const postings_t* postings)
+{
+  bench_t* bench = arg;
+  if (bench->numLists == bench->capacity) {
+    bench->capacity = bench->capacity == 0 ? 1024 : bench->capacity * 2;
+    bench->lists = realloc(bench->lists, bench->capacity * sizeof(benchList_t));
+    mem_assert(bench->lists, "Couldn't grow list array");
+  }
+  benchList_t* list = &bench->lists[bench->numLists++];
+  size_t bytes = (postings->size + 1) * sizeof(int);
+  list->ids = mem_malloc_assert(bytes, "Couldn't copy postings");
+  list->counts = mem_malloc_assert(bytes, "Couldn't copy postings");
+  memcpy(list->ids, postings->ids, postings->size * sizeof(int));
+  memcpy(list->counts, postings->counts, postings->size * sizeof(int));
+  list->size = postings->size;
+
+  bench->numPostings += postings->size;
+  if (postings->size > bench->longest) {
+    bench->longest = postings->size;
+  }
+  // "word id count id count ...\n"
+  bench->textBytes += strlen(word) + 1;
+  for (int i = 0; i < postings->size; i++) {
+    bench->textBytes += digits(postings->ids[i]) + digits(postings->counts[i]) + 2;
+  }
+}
+
+/**************** digits ****************/
+/* Number of decimal digits in a non-negative value */
+static int digits(int value)
+{
+  int n = 1;
+  while (value >= 10) {
+    value /= 10;
+    n++;
+  }
+  return n;
+}
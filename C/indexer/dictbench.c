@@ -0,0 +1,169 @@
+/*
+ * dictbench.c - CS50 'dictbench' module
+ *
+ * This module times term lookups in a binary index three ways: through
+ * a hashtable holding every word, as a text index is loaded; by binary
+ * search of the sorted dictionary, as binary files were searched before
+ * they had a dictionary hash; and through the file's dictionary hash
+ * (indexfile_lookup). Each is timed on every word of the index, in a
+ * shuffled order, and on as many words that aren't in it, and checked
+ * against the others.
+ *
+ * usage: ./dictbench indexFilename [rounds]
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "mem.h"
+#include "clock.h"
+#include "hashtable.h"
+#include "indexfile.h"
+
+// the ways to look a word up; each returns whether it was found
+typedef enum { BY_HASHTABLE, BY_SEARCH, BY_HASH, NUM_WAYS } way_t;
+static const char* WAY_NAMES[NUM_WAYS] = { "hashtable", "binary search", "dictionary hash" };
+
+// Function prototypes
+int main(int argc, char* argv[]);
+static bool lookup(way_t way, indexfile_t* file, hashtable_t* table, const char* word);
+static int searchWord(indexfile_t* file, const char* word);
+static double timeLookups(way_t way, indexfile_t* file, hashtable_t* table, char** words,
+                          int numWords, int rounds, int* found);
+
+/**************** main ****************/
+/* Opens the index, then times looking up its words and absent ones */
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s indexFilename [rounds]\n", argv[0]);
+    exit(1);
+  }
+  int rounds = argc == 3 ? atoi(argv[2]) : 20;
+  if (rounds < 1) {
+    fprintf(stderr, "rounds must be a positive integer\n");
+    exit(1);
+  }
+  indexfile_t* file = indexfile_open(argv[1]);
+  if (file == NULL) {
+    fprintf(stderr, "Couldn't open binary index %s\n", argv[1]);
+    exit(2);
+  }
+
+  // every word, shuffled so no way gets the sorted order's locality, and
+  // each with a digit after it: no indexed word has one, and the result
+  // sorts next to the word, so a search for it goes as deep as for a word
+  int numWords = indexfile_numWords(file);
+  char** present = mem_calloc_assert(numWords + 1, sizeof(char*), "Couldn't allocate words");
+  char** absent = mem_calloc_assert(numWords + 1, sizeof(char*), "Couldn't allocate words");
+  hashtable_t* table = hashtable_new(numWords > 0 ? numWords : 1);
+  for (int i = 0; i < numWords; i++) {
+    const char* word = indexfile_word(file, i);
+    present[i] = mem_malloc_assert(strlen(word) + 1, "Couldn't copy word");
+    strcpy(present[i], word);
+    absent[i] = mem_malloc_assert(strlen(word) + 2, "Couldn't copy word");
+    sprintf(absent[i], "%s0", word);
+    hashtable_insert(table, word, present[i]);
+  }
+  unsigned long long state = 1;
+  for (int i = numWords - 1; i > 0; i--) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    int j = (int) ((state >> 33) % (unsigned long long) (i + 1));
+    char* swap = present[i];
+    present[i] = present[j];
+    present[j] = swap;
+    swap = absent[i];
+    absent[i] = absent[j];
+    absent[j] = swap;
+  }
+
+  printf("index:            %s\n", argv[1]);
+  printf("words:            %d\n", numWords);
+  printf("dictionary hash:  %s\n", indexfile_isHashed(file) ? "yes" : "no (binary search)");
+  double lookups = (double) numWords * rounds;
+  int bad = 0;
+  for (way_t way = 0; way < NUM_WAYS; way++) {
+    int foundPresent;
+    int foundAbsent;
+    double presentTime = timeLookups(way, file, table, present, numWords, rounds, &foundPresent);
+    double absentTime = timeLookups(way, file, table, absent, numWords, rounds, &foundAbsent);
+    if (foundPresent != numWords || foundAbsent != 0) {
+      bad++;
+    }
+    if (presentTime > 0 && absentTime > 0) {
+      printf("%-16s  present %6.1f ns, %6.2f M/s   absent %6.1f ns, %6.2f M/s\n", WAY_NAMES[way],
+             presentTime / lookups * 1e9, lookups / presentTime / 1e6,
+             absentTime / lookups * 1e9, lookups / absentTime / 1e6);
+    }
+  }
+  printf("lookups:          %s\n", bad == 0 ? "ok" : "FAILED");
+
+  for (int i = 0; i < numWords; i++) {
+    free(present[i]);
+    free(absent[i]);
+  }
+  free(present);
+  free(absent);
+  hashtable_delete(table, NULL);
+  indexfile_close(file);
+  return bad == 0 ? 0 : 3;
+}
+
+/**************** timeLookups ****************/
+/* Looks every word up rounds times one way; returns the seconds taken
+ * and sets *found to how many words the last round found
+ */
+static double timeLookups(way_t way, indexfile_t* file, hashtable_t* table, char** words,
+                          int numWords, int rounds, int* found)
+{
+  double start = clock_now();
+  for (int r = 0; r < rounds; r++) {
+    *found = 0;
+    for (int i = 0; i < numWords; i++) {
+      if (lookup(way, file, table, words[i])) {
+        (*found)++;
+      }
+    }
+  }
+  return clock_now() - start;
+}
+
+/**************** lookup ****************/
+/* Looks one word up one way */
+static bool lookup(way_t way, indexfile_t* file, hashtable_t* table, const char* word)
+{
+  switch (way) {
+  case BY_HASHTABLE:
+    return hashtable_find(table, word) != NULL;
+  case BY_SEARCH:
+    return searchWord(file, word) >= 0;
+  default:
+    return indexfile_lookup(file, word) >= 0;
+  }
+}
+
+/**************** searchWord ****************/
+/* Binary searches the file's sorted words; returns the word's position
+ * or -1
+ */
+static int searchWord(indexfile_t* file, const char* word)
+{
+  int low = 0;
+  int high = indexfile_numWords(file) - 1;
+  while (low <= high) {
+    int mid = low + (high - low) / 2;
+    int cmp = strcmp(word, indexfile_word(file, mid));
+    if (cmp == 0) {
+      return mid;
+    } else if (cmp < 0) {
+      high = mid - 1;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return -1;
+}
@@ -6,52 +6,217 @@
  * stored in a given directory (output of the crawler), and saves
  * the index to a specified file for later searching.
  *
+ * Pages go through a three-stage pipeline joined by bounded queues:
+ * a reader thread loads upcoming pages from disk through a pageloader,
+ * which keeps dozens of reads in flight, tokenizer threads count
+ * each page's words into a docterms batch, and the main thread, which
+ * alone owns the index, posts the batches in docID order. Reading,
+ * tokenizing and inserting therefore overlap, and each stage keeps
+ * counters of how busy it was and how long it waited on its queues.
+ *
  * Arthur Ufongene, May 2025
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "mem.h"
+#include "clock.h"
 #include "index.h"
 #include "string.h"
 #include "pagedir.h"
 #include "file.h"
 #include "word.h"
+#include "docterms.h"
+#include "spimi.h"
+#include "bqueue.h"
+#include "pageloader.h"
+#include "segments.h"
+#include "prune.h"
+#include "docmap.h"
+
+// Pipeline sizes
+#define LOADER_DEPTH 32        // page reads in flight
+#define MAX_TOKENIZERS 8
+#define PAGE_QUEUE 64          // pages read ahead of the tokenizers
+#define BATCH_QUEUE 64         // batches tokenized ahead of the inserter
+
+// what flushTerm needs to post a document's words into the index
+typedef struct flushArgs {
+  index_t* idx;          // global index being built
+  int id;                // document the words came from
+} flushArgs_t;
+
+// one document on its way through the pipeline: a page from a reader,
+// then the page's word counts from a tokenizer
+typedef struct docItem {
+  int id;
+  webpage_t* page;
+  docterms_t* terms;
+} docItem_t;
+
+// utilization counters for one stage
+typedef struct stage {
+  const char* name;
+  int threads;
+  long items;            // documents the stage handled
+  double busy;           // seconds spent working, summed over threads
+} stage_t;
+
+// state shared by the pipeline's threads
+typedef struct pipeline {
+  pageloader_t* loader;
+  bool positions;        // whether tokenizers keep each word's positions
+  pthread_mutex_t lock;  // guards stopping, tokenizersLeft and stages
+  bool stopping;         // set to make the reader stop early
+  int tokenizersLeft;
+  bqueue_t* pages;       // reader -> tokenizers
+  bqueue_t* batches;     // tokenizers -> inserter
+  bqueue_t* spare;       // inserter -> tokenizers: cleared docterms to reuse
+  stage_t read;
+  stage_t tokenize;
+  stage_t insert;
+} pipeline_t;
 
 // Function prototypes
 int main(int argc, char* argv[]);
-static void parseArgs(int argc, char* argv[], char** pageDirectory, char** indexFilename);
-static index_t* indexBuild(const char* pageDirectory);
-static void indexPage(index_t* idx, webpage_t* page, int id);
+static void parseArgs(int argc, char* argv[], char** pageDirectory, char** indexFilename,
+                      bool* binary, int* options, size_t* budget, bool* append,
+                      bool* readahead, bool* verbose, int* pruneMode, double* pruneValue);
+static index_t* indexBuild(const char* pageDirectory, int firstID, spimi_t* runs,
+                           bool positions, bool readahead, bool verbose, int* endID);
+static void* readPages(void* arg);
+static void* tokenizePages(void* arg);
+static void tokenizePage(docterms_t* terms, webpage_t* page);
+static void insertTerms(index_t* idx, docterms_t* terms, int id, bool positions);
+static void flushTerm(void* arg, const char* word, int count);
+static void flushPositions(void* arg, const char* word, const int* positions, int count);
+static void stageDone(pipeline_t* pipeline, stage_t* stage, double busy);
+static void printStages(pipeline_t* pipeline, double wall);
+static void docItemDelete(void* item);
+static bool pruneIndex(const char* indexFilename, int mode, double value, bool verbose);
 
 /**************** main ****************/
 /* Parses arguments, builds index from a given directory,
  * and saves it to a file.
+ *
+ * Usage: ./indexer [-a] [-b] [-c] [-i] [-m MB] [-p] [-r] [-s percent | -t fraction] [-v]
+ *                  pageDirectory indexFilename
+ *   -a  add the pages after the last one indexed as a new segment of the
+ *       segmented index indexFilename, creating it if need be (see segments.h)
+ *   -b  save the index in the binary, memory-mappable format
+ *   -c  save it binary with compressed postings (implies -b); with -a,
+ *       compress the new segment
+ *   -i  also store each word's postings ordered by impact, for top-k
+ *       queries (implies -b)
+ *   -m  keep at most about MB (may be fractional) megabytes of index in memory, spilling
+ *       sorted runs to disk and merging them at the end; an interrupted
+ *       -m build resumes from its last run when rerun
+ *   -p  also record where each word occurs on a page, for phrase
+ *       queries (implies -b)
+ *   -r  read pages with a readahead thread rather than io_uring
+ *   -s  prune the index to about percent (0 to 100) of its postings,
+ *       dropping those with the lowest counts (implies -b; see prune.h)
+ *   -t  prune from each word the postings whose count is below fraction
+ *       (0 to 1) of the word's highest (implies -b)
+ *   -v  print each pipeline stage's utilization to stderr, and what
+ *       pruning kept
  */
 int main(int argc, char* argv[])
 {
   char* indexFilename;
   char* pageDirectory;
+  bool binary = false;
+  int options = 0;
+  size_t budget = 0;
+  bool append = false;
+  bool readahead = false;
+  bool verbose = false;
+  int pruneMode = 0;
+  double pruneValue = 0;
 
   // Parse command-line arguments to retrieve pageDirectory and indexFilename
-  parseArgs(argc, argv, &pageDirectory, &indexFilename);
+  parseArgs(argc, argv, &pageDirectory, &indexFilename, &binary, &options, &budget, &append,
+            &readahead, &verbose, &pruneMode, &pruneValue);
+
+  // An appended segment starts after the last segment
+  int firstID = 1;
+  segments_t* segs = NULL;
+  if (append) {
+    if ((segs = segments_open(indexFilename, true)) == NULL) {
+      fprintf(stderr, "Couldn't open segmented index\n");
+      exit(-1);
+    }
+    firstID = segments_nextDocID(segs);
+  }
+
+  // With a memory budget the index is built as runs on disk
+  spimi_t* runs = NULL;
+  if (budget > 0) {
+    if ((runs = spimi_new(indexFilename, pageDirectory, budget)) == NULL) {
+      fprintf(stderr, "Couldn't create run directory\n");
+      exit(-1);
+    }
+    if (spimi_nextDocID(runs) > 1) {
+      fprintf(stderr, "Resuming at document %d after %d runs\n",
+              spimi_nextDocID(runs), spimi_numRuns(runs));
+    }
+    firstID = spimi_nextDocID(runs);
+  }
 
   // Build the index from the pageDirectory
   index_t* pageIdx;
-  if ((pageIdx = indexBuild(pageDirectory)) == NULL) {
+  int endID;
+  bool positions = (options & INDEXFILE_POSITIONS) != 0;
+  if ((pageIdx = indexBuild(pageDirectory, firstID, runs, positions, readahead, verbose,
+                            &endID)) == NULL) {
     fprintf(stderr, "Couldn't build index\n");
     exit(-1);
   }
+  if (segs != NULL && endID == firstID) {
+    printf("No pages after document %d\n", firstID - 1);
+  }
 
-  // Save the index to the specified file
-  if (!index_save(pageIdx, indexFilename)) {
+  // Save the index to the specified file, in whichever format was asked for
+  bool saved;
+  if (segs != NULL) {
+    const char* path;
+    saved = endID == firstID
+            || ((path = segments_add(segs, firstID, endID)) != NULL
+                && index_saveBinary(pageIdx, (char*) path, options)
+                && segments_save(segs));
+  } else if (runs != NULL) {
+    saved = spimi_merge(runs, binary, options);
+  } else {
+    saved = binary ? index_saveBinary(pageIdx, indexFilename, options)
+                   : index_save(pageIdx, indexFilename);
+  }
+  if (!saved) {
     fprintf(stderr, "Couldn't open file\n");
     exit(-1);
   }
+  if (pruneMode != 0 && !pruneIndex(indexFilename, pruneMode, pruneValue, verbose)) {
+    fprintf(stderr, "Couldn't prune index\n");
+    exit(-1);
+  }
+
+  // A crawl with no manifest of its pages, or one missing pages just
+  // indexed, gets one for the querier; without it the querier reads URLs
+  // from the pages, so failing to write it isn't fatal
+  docmap_t* docs = docmap_open(pageDirectory);
+  if (docmap_numDocs(docs) < endID - 1 && !docmap_build(pageDirectory)) {
+    fprintf(stderr, "Couldn't write page manifest\n");
+  }
+  docmap_close(docs);
 
   // Clean up memory
   index_delete(pageIdx);
+  spimi_delete(runs);
+  segments_delete(segs);
   free(indexFilename);
   free(pageDirectory);
 
@@ -65,78 +230,321 @@ int main(int argc, char* argv[])
  * argv: argument vector
  * pageDirectory: pointer to store the directory of webpages
  * indexFilename: pointer to store the output index file name
+ * binary: set to true if a binary format was asked for
+ * options: INDEXFILE_* options for a binary save
+ * budget: set to the -m memory budget in bytes, if one was given
+ * append: set to true if a segment is to be added
+ * readahead: set to true if io_uring should not be used
+ * verbose: set to true if stage utilization was asked for
+ * pruneMode: set to an INDEXFILE_PRUNE_* mode if pruning was asked for
+ * pruneValue: set to the -s percentage or -t fraction
  */
-static void parseArgs(int argc, char* argv[], char** pageDirectory, char** indexFilename)
+static void parseArgs(int argc, char* argv[], char** pageDirectory, char** indexFilename,
+                      bool* binary, int* options, size_t* budget, bool* append,
+                      bool* readahead, bool* verbose, int* pruneMode, double* pruneValue)
 {
-  if (argc != 3) {
+  // Options come before the two positional arguments
+  int arg = 1;
+  for (; arg < argc && argv[arg][0] == '-'; arg++) {
+    if (strcmp(argv[arg], "-a") == 0) {
+      *append = true;
+    } else if (strcmp(argv[arg], "-b") == 0) {
+      *binary = true;
+    } else if (strcmp(argv[arg], "-c") == 0) {
+      *binary = true;
+      *options |= INDEXFILE_COMPRESSED;
+    } else if (strcmp(argv[arg], "-i") == 0) {
+      *binary = true;
+      *options |= INDEXFILE_IMPACTS;
+    } else if (strcmp(argv[arg], "-m") == 0 && arg + 1 < argc) {
+      char excess;
+      double megabytes;
+      if (sscanf(argv[++arg], "%lf%c", &megabytes, &excess) != 1 || !(megabytes > 0)) {
+        fprintf(stderr, "Memory budget must be a positive number of megabytes\n");
+        exit(-1);
+      }
+      *budget = megabytes * (1 << 20);
+    } else if (strcmp(argv[arg], "-p") == 0) {
+      *binary = true;
+      *options |= INDEXFILE_POSITIONS;
+    } else if (strcmp(argv[arg], "-r") == 0) {
+      *readahead = true;
+    } else if ((strcmp(argv[arg], "-s") == 0 || strcmp(argv[arg], "-t") == 0) && arg + 1 < argc) {
+      char excess;
+      bool global = argv[arg][1] == 's';
+      double limit = global ? 100 : 1;
+      if (*pruneMode != 0) {
+        fprintf(stderr, "Only one of -s and -t can be given\n");
+        exit(-1);
+      }
+      if (sscanf(argv[++arg], "%lf%c", pruneValue, &excess) != 1
+          || !(*pruneValue > 0 && *pruneValue <= limit)) {
+        fprintf(stderr, "Pruning %s must be above 0 and at most %g\n",
+                global ? "percentage" : "fraction", limit);
+        exit(-1);
+      }
+      *binary = true;
+      *pruneMode = global ? INDEXFILE_PRUNE_GLOBAL : INDEXFILE_PRUNE_TERM;
+    } else if (strcmp(argv[arg], "-v") == 0) {
+      *verbose = true;
+    } else {
+      fprintf(stderr, "Unknown option %s\n", argv[arg]);
+      exit(-1);
+    }
+  }
+
+  if (argc - arg != 2) {
     fprintf(stderr, "Incorrect number of arguments\n");
     exit(-1);
   }
+  if (*append && *budget > 0) {
+    fprintf(stderr, "-a can't be combined with -m\n");
+    exit(-1);
+  }
+  if (*append && *pruneMode != 0) {
+    fprintf(stderr, "-a can't be combined with pruning\n");
+    exit(-1);
+  }
   
   // Ensure the directory was created by the crawler
-  if (!pagedir_validate(argv[1])) {
+  if (!pagedir_validate(argv[arg])) {
     fprintf(stderr, "Not a crawler directory\n");
     exit(-1);
   }
 
-  // Make sure that the file can be written to
-  if (!pagedir_validateWriteFile(argv[2])) {
+  // Make sure that the file can be written to; a manifest being
+  // appended to must not be truncated, so segments_open checks that one
+  if (!*append && !pagedir_validateWriteFile(argv[arg + 1])) {
     fprintf(stderr, "Couldn't open indexFile\n");
     exit(-1);
   }
 
   // Allocate space for and copy pageDirectory
-  *pageDirectory = mem_calloc_assert(strlen(argv[1]) + 1, sizeof(char), "Couldn't assign space for pageDirectory\n");
-  strcpy(*pageDirectory, argv[1]);
+  *pageDirectory = mem_calloc_assert(strlen(argv[arg]) + 1, sizeof(char), "Couldn't assign space for pageDirectory\n");
+  strcpy(*pageDirectory, argv[arg]);
 
   // Allocate space for and copy indexFilename
-  *indexFilename = mem_calloc_assert(strlen(argv[2]) + 1, sizeof(char), "No space for file name\n");
-  strcpy(*indexFilename, argv[2]);
+  *indexFilename = mem_calloc_assert(strlen(argv[arg + 1]) + 1, sizeof(char), "No space for file name\n");
+  strcpy(*indexFilename, argv[arg + 1]);
 }
 
 /**************** indexBuild ****************/
 /* Builds an index from all webpages found in the given pageDirectory.
  * 
  * pageDirectory: directory containing crawler-produced HTML files
+ * firstID: the first document to index
+ * runs: NULL to build the whole index in memory; otherwise the index
+ *       is spilled as a sorted run whenever it passes the memory budget
+ *       and once more at the end, and the index returned is empty
+ * positions: record each word's positions as well as its count
+ * readahead: load pages with the readahead thread instead of io_uring
+ * verbose: print stage utilization to stderr when done
+ * endID: set to the docID after the last page indexed
  *
- * Returns: a pointer to the built index
+ * The reader and tokenizers run on their own threads while this thread
+ * inserts. Batches can arrive out of order, so they wait in a window
+ * indexed by docID until every earlier document has been inserted;
+ * documents are posted in increasing docID order, which keeps postings
+ * appends O(1) and runs disjoint.
+ *
+ * Returns: a pointer to the built index, NULL if there were no pages
+ *          or a run couldn't be written
  */
-static index_t* indexBuild(const char* pageDirectory)
+static index_t* indexBuild(const char* pageDirectory, int firstID, spimi_t* runs,
+                           bool positions, bool readahead, bool verbose, int* endID)
 {
   // Create a new index with a reasonable number of slots
   index_t* idx;
   if ((idx = index_new(200)) == NULL) {
     return NULL;
   }
-  
-  int id = 1;
 
-  webpage_t* page;
+  // one tokenizer per CPU left over after this thread
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int numTokenizers = cpus <= 2 ? 1 : (cpus - 1 > MAX_TOKENIZERS ? MAX_TOKENIZERS : (int) cpus - 1);
+
+  pipeline_t pipeline = {
+    .loader = pageloader_new(pageDirectory, firstID, LOADER_DEPTH, !readahead),
+    .positions = positions,
+    .tokenizersLeft = numTokenizers,
+    .pages = bqueue_new(PAGE_QUEUE),
+    .batches = bqueue_new(BATCH_QUEUE),
+    .spare = bqueue_new(PAGE_QUEUE + BATCH_QUEUE + MAX_TOKENIZERS),
+    .read = { "read", 1, 0, 0 },
+    .tokenize = { "tokenize", numTokenizers, 0, 0 },
+    .insert = { "insert", 1, 0, 0 },
+  };
+  pthread_mutex_init(&pipeline.lock, NULL);
 
-  // Load each page one-by-one from the directory until no more pages exist
-  while ((page = pagedir_load(pageDirectory, id)) != NULL) {
-    // Index the words in the current page
-    indexPage(idx, page, id);
-    // Clean up the page memory
-    webpage_delete(page);
-    id++;
+  double start = clock_now();
+  pthread_t threads[1 + MAX_TOKENIZERS];
+  int numThreads = 0;
+  for (int i = 0; i < 1 + numTokenizers; i++) {
+    void* (*body)(void*) = i == 0 ? readPages : tokenizePages;
+    if (pthread_create(&threads[numThreads++], NULL, body, &pipeline) != 0) {
+      fprintf(stderr, "Couldn't start pipeline thread\n");
+      exit(-1);
+    }
   }
 
-  if (id == 1) {
+  // window of batches that arrived ahead of nextID, indexed by id - nextID
+  int nextID = firstID;
+  int windowSize = PAGE_QUEUE + BATCH_QUEUE;
+  docItem_t** window = mem_calloc_assert(windowSize, sizeof(docItem_t*), "Couldn't allocate window");
+  bool ok = true;
+  docItem_t* item;
+  while ((item = bqueue_pop(pipeline.batches)) != NULL) {
+    if (!ok) {
+      docItemDelete(item);      // a run failed: just drain so the threads can finish
+      continue;
+    }
+    while (item->id - nextID >= windowSize) {
+      // grow the window, keeping every waiting batch at its offset
+      window = realloc(window, 2 * windowSize * sizeof(docItem_t*));
+      mem_assert(window, "Couldn't grow window");
+      memset(window + windowSize, 0, windowSize * sizeof(docItem_t*));
+      windowSize *= 2;
+    }
+    window[item->id - nextID] = item;
+
+    // insert every batch that is now next in line
+    while (ok && window[0] != NULL) {
+      item = window[0];
+      memmove(window, window + 1, (windowSize - 1) * sizeof(docItem_t*));
+      window[windowSize - 1] = NULL;
+
+      double began = clock_now();
+      insertTerms(idx, item->terms, item->id, positions);
+      if (!bqueue_tryPush(pipeline.spare, item->terms)) {
+        docterms_delete(item->terms);
+      }
+      free(item);
+      nextID++;
+
+      // Over the memory budget: write the index out as a run and start a fresh one
+      if (spimi_isFull(runs, idx)) {
+        if (spimi_spill(runs, idx, nextID)) {
+          index_delete(idx);
+          idx = index_new(200);
+        } else {
+          ok = false;
+          pthread_mutex_lock(&pipeline.lock);
+          pipeline.stopping = true;     // stop the reader
+          pthread_mutex_unlock(&pipeline.lock);
+        }
+      }
+      stageDone(&pipeline, &pipeline.insert, clock_now() - began);
+    }
+  }
+  for (int i = 0; i < numThreads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  if (verbose) {
+    printStages(&pipeline, clock_now() - start);
+  }
+
+  // batches past a missing page are not part of the index
+  for (int i = 0; i < windowSize; i++) {
+    docItemDelete(window[i]);
+  }
+  free(window);
+  bqueue_delete(pipeline.pages, docItemDelete);
+  bqueue_delete(pipeline.batches, docItemDelete);
+  bqueue_delete(pipeline.spare, (void (*)(void*)) docterms_delete);
+  pageloader_delete(pipeline.loader);
+  pthread_mutex_destroy(&pipeline.lock);
+
+  *endID = nextID;
+
+  // Whatever is left becomes the last run
+  if (!ok || nextID == 1 || (runs != NULL && !spimi_spill(runs, idx, nextID))) {
+    index_delete(idx);
     return NULL;
   }
 
   return idx;
 }
 
-/**************** indexPage ****************/
-/* Processes a single webpage and adds its words to the index.
+/**************** readPages ****************/
+/* Reader thread: takes pages from the loader in docID order until one
+ * is missing, then closes the page queue
+ *
+ * arg: the pipeline
+ */
+static void* readPages(void* arg)
+{
+  pipeline_t* pipeline = (pipeline_t*) arg;
+  for (;;) {
+    pthread_mutex_lock(&pipeline->lock);
+    bool stopping = pipeline->stopping;
+    pthread_mutex_unlock(&pipeline->lock);
+    if (stopping) {
+      break;
+    }
+
+    double start = clock_now();
+    int id;
+    webpage_t* page = pageloader_next(pipeline->loader, &id);
+    if (page == NULL) {
+      break;                      // the crawl ends at the first missing page
+    }
+    docItem_t* item = mem_malloc_assert(sizeof(docItem_t), "Couldn't allocate document");
+    item->id = id;
+    item->page = page;
+    item->terms = NULL;
+    stageDone(pipeline, &pipeline->read, clock_now() - start);
+    if (!bqueue_push(pipeline->pages, item)) {
+      docItemDelete(item);
+      break;
+    }
+  }
+  bqueue_close(pipeline->pages);
+  return NULL;
+}
+
+/**************** tokenizePages ****************/
+/* Tokenizer thread: turns each page into a batch of word counts
+ *
+ * arg: the pipeline
+ */
+static void* tokenizePages(void* arg)
+{
+  pipeline_t* pipeline = (pipeline_t*) arg;
+  docItem_t* item;
+  while ((item = bqueue_pop(pipeline->pages)) != NULL) {
+    double start = clock_now();
+    // reuse a docterms the inserter is done with if there is one
+    docterms_t* terms = bqueue_tryPop(pipeline->spare);
+    if (terms == NULL) {
+      terms = docterms_new(pipeline->positions);
+    }
+    tokenizePage(terms, item->page);
+    webpage_delete(item->page);
+    item->page = NULL;
+    item->terms = terms;
+    stageDone(pipeline, &pipeline->tokenize, clock_now() - start);
+    if (!bqueue_push(pipeline->batches, item)) {
+      docItemDelete(item);
+    }
+  }
+
+  // the last tokenizer out closes the batch queue
+  pthread_mutex_lock(&pipeline->lock);
+  bool last = --pipeline->tokenizersLeft == 0;
+  pthread_mutex_unlock(&pipeline->lock);
+  if (last) {
+    bqueue_close(pipeline->batches);
+  }
+  return NULL;
+}
+
+/**************** tokenizePage ****************/
+/* Counts the words of a single webpage into terms.
  * 
- * idx: the index to add words into
+ * terms: empty table to count this page's words in
  * page: the webpage to process
- * id: the document ID for this page
  */
-static void indexPage(index_t* idx, webpage_t* page, int id)
+static void tokenizePage(docterms_t* terms, webpage_t* page)
 {
   char* word;
   int pos = 0;
@@ -147,10 +555,136 @@ static void indexPage(index_t* idx, webpage_t* page, int id)
     if (strlen(word) >= 3) {
       // Normalize the word (e.g., lowercase)
       char* normalized = word_normalizeWord(word);
-      // Add or increment the word count in the index for this document ID
-      index_incrementCount(idx, normalized, id);
+      // Count the word for this page
+      docterms_add(terms, normalized);
       free(normalized);
     }
     free(word);
   }
 }
+
+/**************** insertTerms ****************/
+/* Posts one (word, id, count) entry per distinct word of a page,
+ * then clears terms for reuse
+ * 
+ * idx: the index to add words into
+ * terms: the page's word counts
+ * id: the document ID for this page
+ * positions: post each word's positions on the page too
+ */
+static void insertTerms(index_t* idx, docterms_t* terms, int id, bool positions)
+{
+  flushArgs_t args = { idx, id };
+  if (positions) {
+    docterms_iteratePositions(terms, &args, flushPositions);
+  } else {
+    docterms_iterate(terms, &args, flushTerm);
+  }
+  docterms_clear(terms);
+}
+
+/**************** flushTerm ****************/
+/* Posts one word's count for the current page into the index
+ *
+ * arg: pointer to the flushArgs_t for this page
+ * word: a distinct word from the page
+ * count: the number of times word occurred on the page
+ */
+static void flushTerm(void* arg, const char* word, int count)
+{
+  flushArgs_t* args = (flushArgs_t*) arg;
+  index_insertCount(args->idx, word, args->id, count);
+}
+
+/**************** flushPositions ****************/
+/* Posts one word's positions for the current page into the index
+ *
+ * arg: pointer to the flushArgs_t for this page
+ * word: a distinct word from the page
+ * positions: where the word occurred, counting indexed words from 0
+ * count: the number of positions
+ */
+static void flushPositions(void* arg, const char* word, const int* positions, int count)
+{
+  flushArgs_t* args = (flushArgs_t*) arg;
+  index_insertPositions(args->idx, word, args->id, positions, count);
+}
+
+/**************** stageDone ****************/
+/* Adds one document and busy seconds to a stage's counters */
+static void stageDone(pipeline_t* pipeline, stage_t* stage, double busy)
+{
+  pthread_mutex_lock(&pipeline->lock);
+  stage->items++;
+  stage->busy += busy;
+  pthread_mutex_unlock(&pipeline->lock);
+}
+
+/**************** printStages ****************/
+/* Prints each stage's utilization and the time spent waiting on each
+ * queue. The busiest stage, relative to its threads, is the bottleneck:
+ * the stage before it waits on a full queue, the one after on an empty one.
+ */
+static void printStages(pipeline_t* pipeline, double wall)
+{
+  stage_t* stages[] = { &pipeline->read, &pipeline->tokenize, &pipeline->insert };
+  fprintf(stderr, "%-9s %7s %8s %9s %6s\n", "stage", "threads", "docs", "busy(s)", "util");
+  for (int i = 0; i < 3; i++) {
+    stage_t* stage = stages[i];
+    double util = wall > 0 ? 100 * stage->busy / (wall * stage->threads) : 0;
+    fprintf(stderr, "%-9s %7d %8ld %9.3f %5.1f%%\n",
+            stage->name, stage->threads, stage->items, stage->busy, util);
+  }
+  double full, empty;
+  bqueue_waits(pipeline->pages, &full, &empty);
+  fprintf(stderr, "page loader: %s, %d reads in flight\n",
+          pageloader_isUring(pipeline->loader) ? "io_uring" : "readahead thread", LOADER_DEPTH);
+  fprintf(stderr, "page queue:  reader blocked %.3fs (full), tokenizers idle %.3fs (empty)\n",
+          full, empty);
+  bqueue_waits(pipeline->batches, &full, &empty);
+  fprintf(stderr, "batch queue: tokenizers blocked %.3fs (full), inserter idle %.3fs (empty)\n",
+          full, empty);
+  fprintf(stderr, "wall time:   %.3fs\n", wall);
+}
+
+/**************** docItemDelete ****************/
+/* Frees a docItem_t and whatever it still holds */
+static void docItemDelete(void* item)
+{
+  docItem_t* doc = (docItem_t*) item;
+  if (doc != NULL) {
+    webpage_delete(doc->page);
+    docterms_delete(doc->terms);
+    free(doc);
+  }
+}
+
+/**************** pruneIndex ****************/
+/* Replaces the binary index file with a pruned copy of itself
+ *
+ * indexFilename: the saved index
+ * mode, value: how to prune it (see prune_file)
+ * verbose: print how many postings were kept to stderr
+ *
+ * The copy is written next to the index and renamed over it, so the
+ * full index is left alone if pruning fails.
+ *
+ * Returns: true if the index was pruned
+ */
+static bool pruneIndex(const char* indexFilename, int mode, double value, bool verbose)
+{
+  char* prunedFilename = mem_malloc_assert(strlen(indexFilename) + strlen(".pruning") + 1,
+                                           "No space for file name\n");
+  sprintf(prunedFilename, "%s.pruning", indexFilename);
+  indexfile_pruning_t pruning;
+  bool pruned = prune_file(indexFilename, prunedFilename, mode, value, &pruning)
+                && rename(prunedFilename, indexFilename) == 0;
+  if (!pruned) {
+    remove(prunedFilename);
+  } else if (verbose) {
+    fprintf(stderr, "pruning kept %llu of %llu postings\n",
+            (unsigned long long) pruning.postingsAfter, (unsigned long long) pruning.postingsBefore);
+  }
+  free(prunedFilename);
+  return pruned;
+}
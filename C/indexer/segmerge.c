@@ -0,0 +1,72 @@
+/*
+ * segmerge.c - CS50 'segmerge' module
+ *
+ * This module compacts a segmented index built with indexer -a: it
+ * merges runs of similar-sized neighbouring segments until no size tier
+ * holds a full run (see segments_compact). It can run in the background
+ * while the indexer adds segments and queriers search the index; a
+ * second segmerge on the same index has nothing to do and exits.
+ *
+ * usage: ./segmerge [-f factor] indexFilename
+ *   -f  how many segments of a tier are merged at once (default 4)
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "segments.h"
+
+#define DEFAULT_FACTOR 4
+
+// Function prototypes
+int main(int argc, char* argv[]);
+static void parseArgs(int argc, char* argv[], const char** indexFilename, int* factor);
+
+/**************** main ****************/
+/* Parses arguments and compacts the index, reporting each merge */
+int main(int argc, char* argv[])
+{
+  const char* indexFilename;
+  int factor = DEFAULT_FACTOR;
+  parseArgs(argc, argv, &indexFilename, &factor);
+
+  int merges;
+  if ((merges = segments_compact(indexFilename, factor, stdout)) < 0) {
+    fprintf(stderr, "Couldn't compact %s\n", indexFilename);
+    exit(-1);
+  }
+  printf("%d merges\n", merges);
+  exit(0);
+}
+
+/**************** parseArgs ****************/
+/* Validates and parses command-line arguments.
+ *
+ * argc: number of arguments
+ * argv: argument vector
+ * indexFilename: set to the segment manifest
+ * factor: set to the -f merge factor, if one was given
+ */
+static void parseArgs(int argc, char* argv[], const char** indexFilename, int* factor)
+{
+  int arg = 1;
+  if (arg + 1 < argc && strcmp(argv[arg], "-f") == 0) {
+    char excess;
+    if (sscanf(argv[arg + 1], "%d%c", factor, &excess) != 1 || *factor < 2) {
+      fprintf(stderr, "Merge factor must be an integer of at least 2\n");
+      exit(-1);
+    }
+    arg += 2;
+  }
+  if (argc - arg != 1) {
+    fprintf(stderr, "usage: %s [-f factor] indexFilename\n", argv[0]);
+    exit(-1);
+  }
+  if (!segments_isManifest(argv[arg])) {
+    fprintf(stderr, "%s is not a segmented index\n", argv[arg]);
+    exit(-1);
+  }
+  *indexFilename = argv[arg];
+}
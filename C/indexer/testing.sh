@@ -50,6 +50,82 @@
 ./indexer ../data/wikipedia-depth-0 ../data/wikipedia-depth-0/wikipedia.index
 ./indextest ../data/wikipedia-depth-0/wikipedia.index ../data/wikipedia-depth-0/wikipedia.reindex
 
-# Valgrind test
-valgrind ./indexer ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index
-valgrind ./indextest ../data/toscrape-depth-1/toscrape.index ../data/toscrape-depth-1/toscrape.reindex
+# Binary format: save binary, convert back to text with indextest
+./indexer -b ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.bindex
+./indextest ../data/toscrape-depth-1/toscrape.bindex ../data/toscrape-depth-1/toscrape.binreindex
+
+# Every word, and none of the absent ones, found through the dictionary hash
+./dictbench ../data/toscrape-depth-1/toscrape.bindex 1
+
+# Compressed binary format, plus the codec ratio and round trip check
+./indexer -c ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.cindex
+./indextest ../data/toscrape-depth-1/toscrape.cindex ../data/toscrape-depth-1/toscrape.creindex
+./codecbench ../data/toscrape-depth-1/toscrape.cindex 1
+
+# Memory-budgeted build: spills many small runs, then merges them
+./indexer -m 0.05 ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.mindex
+./indextest ../data/wikipedia-depth-1/wikipedia.mindex ../data/wikipedia-depth-1/wikipedia.mreindex
+./indexer -c -m 0.05 ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.mcindex
+
+# Positional index, also compressed and on a memory budget; the
+# postings read back the same as the plain index's
+./indexer -p ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.pindex
+./indextest ../data/toscrape-depth-1/toscrape.pindex ../data/toscrape-depth-1/toscrape.preindex
+sort ../data/toscrape-depth-1/toscrape.index | cmp - <(sort ../data/toscrape-depth-1/toscrape.preindex) && echo "same index"
+./indexer -p -c -m 0.05 ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.pcindex
+
+# Impact-ordered index, also compressed, reads back the same
+./indexer -i ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.iindex
+./indexer -i -c ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.icindex
+./indextest ../data/toscrape-depth-1/toscrape.icindex ../data/toscrape-depth-1/toscrape.icreindex
+sort ../data/toscrape-depth-1/toscrape.index | cmp - <(sort ../data/toscrape-depth-1/toscrape.icreindex) && echo "same index"
+
+# Pruned to half the postings, and per term below half a word's top count
+./indexer -v -s 50 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.sindex
+./indexer -v -t 0.5 -p ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.tindex
+
+# Bad pruning settings
+./indexer -s 0 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.sindex
+./indexer -s 50 -t 0.5 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.sindex
+./indexer -a -t 0.5 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.sindex
+
+# Pipeline stage utilization
+./indexer -v ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index
+
+# Readahead thread instead of io_uring gives the same index
+./indexer -r ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.rindex
+cmp ../data/toscrape-depth-1/toscrape.index ../data/toscrape-depth-1/toscrape.rindex && echo "same index"
+
+# Segmented index: index depth 2, then only the new pages of depth 10,
+# then nothing new; compact the segments and compare with a full build
+rm -rf ../data/letters-depth-10/letters.aindex ../data/letters-depth-10/letters.aindex.segs
+./indexer -a ../data/letters-depth-2 ../data/letters-depth-10/letters.aindex
+./indexer -a -c ../data/letters-depth-10 ../data/letters-depth-10/letters.aindex
+./indexer -a ../data/letters-depth-10 ../data/letters-depth-10/letters.aindex
+./segmerge -f 2 ../data/letters-depth-10/letters.aindex
+./indextest ../data/letters-depth-10/letters.aindex ../data/letters-depth-10/letters.areindex
+./indexer ../data/letters-depth-10 ../data/letters-depth-10/letters.fullindex
+sort ../data/letters-depth-10/letters.fullindex | cmp - <(sort ../data/letters-depth-10/letters.areindex) && echo "same index"
+
+# Appending can't use a memory budget, or write over a non-segmented index
+./indexer -a -m 1 ../data/letters-depth-10 ../data/letters-depth-10/letters.aindex
+./indexer -a ../data/letters-depth-10 ../data/letters-depth-10/letters.fullindex
+./segmerge ../data/letters-depth-10/letters.fullindex
+
+# Bad memory budget
+./indexer -m zero ../data/letters-depth-2 ../data/letters-depth-2/letters.index
+
+# Malformed text index
+echo "cat 1 x" > ../data/malformed.index
+./indextest ../data/malformed.index ../data/malformed.reindex
+
+# Unknown option
+./indexer -x ../data/letters-depth-2 ../data/letters-depth-2/letters.index
+
+# Valgrind test, where valgrind is installed
+if command -v valgrind > /dev/null; then
+  valgrind ./indexer ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index
+  valgrind ./indextest ../data/toscrape-depth-1/toscrape.index ../data/toscrape-depth-1/toscrape.reindex
+else
+  echo "valgrind isn't installed; memory check skipped"
+fi
@@ -2,24 +2,59 @@
  * hashtable.c - CS50 'hashtable' module
  *
  * See hashtable.h for more implementation
- * This implementation uses an array of set_t* for buckets.
+ * This implementation uses a single open-addressing array with Robin Hood
+ * probing. Each slot caches the full hash of its key so that probes only
+ * call strcmp on a likely match, and key strings are interned in a chunked
+ * arena owned by the table instead of being allocated one at a time.
+ * The table doubles whenever it passes its maximum load factor, so the
+ * initial slot count is only a sizing hint.
  *
  * Arthur Ufongene, April 2025
  */
 
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "mem.h"
-#include "set.h"
 #include "hash.h"
 #include "hashtable.h"
 
-/**************** local types ****************/ 
+/**************** file-local constants ****************/
+static const size_t MIN_CAPACITY = 16;     // smallest slot array we allocate
+static const size_t ARENA_CHUNK = 64*1024; // default size of a key arena chunk
+// the table grows once count exceeds LOAD_NUM/LOAD_DEN of its capacity
+static const size_t LOAD_NUM = 7;
+static const size_t LOAD_DEN = 8;
+
+/**************** local types ****************/
+typedef struct ht_slot {
+  unsigned long hash;       // cached hash of key; 0 marks an empty slot
+  const char* key;          // key string, interned in the arena
+  void* item;               // item associated with key
+} ht_slot_t;
+
+typedef struct ht_chunk {
+  struct ht_chunk* next;    // previously filled chunk
+  size_t used;              // bytes of data[] handed out
+  size_t size;              // bytes available in data[]
+  char data[];              // interned key strings
+} ht_chunk_t;
+
 struct hashtable {
-  int table_size;           // number of slots in table
-  set_t** table;            // array of set pointers
+  size_t capacity;          // number of slots in table, a power of two
+  size_t count;             // number of occupied slots
+  ht_slot_t* table;         // array of slots
+  ht_chunk_t* arena;        // most recent key arena chunk
 };
 
+/**************** local functions ****************/
+static unsigned long hashKey(const char* key);
+static size_t probeDistance(const hashtable_t* ht, unsigned long hash, size_t pos);
+static ht_slot_t* findSlot(hashtable_t* ht, const char* key, unsigned long hash);
+static ht_slot_t* placeSlot(hashtable_t* ht, ht_slot_t entry);
+static void grow(hashtable_t* ht);
+static const char* internKey(hashtable_t* ht, const char* key);
+
 /**************** global functions ****************/
 
 /**************** hashtable_new() ****************/
@@ -27,10 +62,16 @@ struct hashtable {
 hashtable_t* hashtable_new(const int num_slots)
 {
   if (num_slots <= 0) return NULL; // invalid size
+
+  // round up so that num_slots items fit under the load factor
+  size_t capacity = MIN_CAPACITY;
+  while (capacity * LOAD_NUM / LOAD_DEN < (size_t) num_slots) {
+    capacity *= 2;
+  }
                                    // exit if errors with allocation
   hashtable_t* new_hashtable = mem_calloc_assert(1, sizeof(hashtable_t), "couldn't allocate for hashtable\n");
-  new_hashtable->table = mem_calloc_assert(num_slots, sizeof(set_t*), "couldn't allocate for table\n");
-  new_hashtable->table_size = num_slots;
+  new_hashtable->table = mem_calloc_assert(capacity, sizeof(ht_slot_t), "couldn't allocate for table\n");
+  new_hashtable->capacity = capacity;
   return new_hashtable;
 }
 
@@ -42,12 +83,22 @@ bool hashtable_insert(hashtable_t* ht, const char* key, void* item)
     fprintf(stderr, "Attempted to insert on null hashtable or with null parameters\n");
     return false;
   }
-  int idx = hash_jenkins(key, ht->table_size);     // compute hash index
-
-  if (ht->table[idx] == NULL) {
-    ht->table[idx] = set_new();                    // create new set if necessary
+  unsigned long hash = hashKey(key);               // compute hash once
+  ht_slot_t* slot = findSlot(ht, key, hash);
+  if (slot != NULL) {
+    if (slot->item != NULL) {
+      return false;                                // key already present
+    }
+    slot->item = item;                             // fill a slot left empty by upsert
+    return true;
+  }
+  if (ht->count + 1 > ht->capacity * LOAD_NUM / LOAD_DEN) {
+    grow(ht);                                      // keep probe chains short
   }
-  return set_insert(ht->table[idx], key, item);    // insert into set
+  ht_slot_t entry = { hash, internKey(ht, key), item };
+  placeSlot(ht, entry);
+  ht->count++;
+  return true;
 }
 
 /**************** hashtable_find() ****************/
@@ -57,25 +108,47 @@ void* hashtable_find(hashtable_t* ht, const char* key)
   if (ht == NULL || key == NULL) { // check for null parameters
     fprintf(stderr, "Attempted to find on null hashtable or with null key\n");
     return NULL;
-  }                                // obtain slot to search
-  set_t* slot = ht->table[hash_jenkins(key, ht->table_size)];
+  }
+  ht_slot_t* slot = findSlot(ht, key, hashKey(key));
   if (slot == NULL) {
     return NULL;
   }
-  return set_find(slot, key);      // search in that slot
+  return slot->item;
+}
+
+/**************** hashtable_upsert() ****************/
+// See hashtable.h for description
+void** hashtable_upsert(hashtable_t* ht, const char* key)
+{
+  if (ht == NULL || key == NULL) { // check for null parameters
+    fprintf(stderr, "Attempted to upsert on null hashtable or with null key\n");
+    return NULL;
+  }
+  unsigned long hash = hashKey(key);
+  ht_slot_t* slot = findSlot(ht, key, hash);
+  if (slot == NULL) {
+    // only a new key may grow the table, so a hit never moves a slot
+    if (ht->count + 1 > ht->capacity * LOAD_NUM / LOAD_DEN) {
+      grow(ht);
+    }
+    ht_slot_t entry = { hash, internKey(ht, key), NULL };
+    slot = placeSlot(ht, entry);
+    ht->count++;
+  }
+  return &slot->item;
 }
 
 /**************** hashtable_iterate() ****************/
 // See hashtable.h for description
 void hashtable_iterate(hashtable_t* ht, void* arg, void (*itemfunc)(void* arg, const char* key, void* item))
 {
-  if (ht == NULL) {                          // check for null hashtable
+  if (ht == NULL || itemfunc == NULL) {      // check for null hashtable
     fprintf(stderr, "Attempted to iterate on null hashtable or with null itemfunc\n");
     return;
   }
-  for (int i = 0; i < ht->table_size; i++) { // loop through all slot in hashtable
-    if (ht->table[i] != NULL) {
-      set_iterate(ht->table[i], arg, itemfunc); // iterate over each set
+  for (size_t i = 0; i < ht->capacity; i++) { // loop through all slots in hashtable
+    if (ht->table[i].item != NULL) {
+      itemfunc(arg, ht->table[i].key, ht->table[i].item);
     }
   }
 }
@@ -92,13 +165,12 @@ void hashtable_print(hashtable_t* ht, FILE* fp, void (*itemprint)(FILE* fp, cons
     fprintf(fp, "(null)\n");
     return;
   }
-  if (itemprint == NULL) {
-    for (int i = 0; i < ht->table_size; i++) printf("\n");
-    return;
-  }
-  for (int i = 0; i < ht->table_size; i++) { 
-    fprintf(fp, "%d ", i+1);  // print the slot number of each set
-    set_print(ht->table[i], fp, itemprint); // print each set
+  for (size_t i = 0; i < ht->capacity; i++) {
+    fprintf(fp, "%zu {", i+1);  // print the slot number of each slot
+    if (itemprint != NULL && ht->table[i].item != NULL) {
+      itemprint(fp, ht->table[i].key, ht->table[i].item);
+    }
+    fprintf(fp, "}\n");
   }
 }
 
@@ -110,13 +182,124 @@ void hashtable_delete(hashtable_t* ht, void (*itemdelete)(void* item))
     fprintf(stderr, "Attempted to delete on null hashtable or with null itemdelete\n");
     return;
   }
-  for (int i = 0; i < ht->table_size; i++) {// loop through all slots
-    if (ht->table[i] != NULL) {
-      set_delete(ht->table[i], itemdelete); // delete each set
+  if (itemdelete != NULL) {
+    for (size_t i = 0; i < ht->capacity; i++) {// loop through all slots
+      if (ht->table[i].item != NULL) {
+        (*itemdelete)(ht->table[i].item);    // delete each item
+      }
     }
   }
+  ht_chunk_t* chunk = ht->arena;             // free every key arena chunk
+  while (chunk != NULL) {
+    ht_chunk_t* next = chunk->next;
+    mem_free(chunk);
+    chunk = next;
+  }
   mem_free(ht->table); // free table array
   mem_free(ht); // free hashtable structure
 }
 
+/**************** local functions ****************/
+
+/**************** hashKey() ****************/
+/* Unreduced Jenkins hash of key; never returns 0,
+ * since 0 marks an empty slot.
+ */
+static unsigned long hashKey(const char* key)
+{
+  unsigned long hash = hash_jenkins(key, ULONG_MAX);
+  return hash == 0 ? 1 : hash;
+}
+
+/**************** probeDistance() ****************/
+/* How far slot pos is from the home slot of hash */
+static size_t probeDistance(const hashtable_t* ht, unsigned long hash, size_t pos)
+{
+  size_t mask = ht->capacity - 1;
+  return (pos - (hash & mask)) & mask;
+}
+
+/**************** findSlot() ****************/
+/* Return the slot holding key, or NULL if key is not present.
+ * Robin Hood ordering lets us stop as soon as we reach a slot whose
+ * occupant is closer to its home than we are to ours.
+ */
+static ht_slot_t* findSlot(hashtable_t* ht, const char* key, unsigned long hash)
+{
+  size_t mask = ht->capacity - 1;
+  size_t pos = hash & mask;
+  for (size_t dist = 0; ; dist++, pos = (pos + 1) & mask) {
+    ht_slot_t* slot = &ht->table[pos];
+    if (slot->hash == 0 || probeDistance(ht, slot->hash, pos) < dist) {
+      return NULL;
+    }
+    if (slot->hash == hash && strcmp(slot->key, key) == 0) {
+      return slot;
+    }
+  }
+}
 
+/**************** placeSlot() ****************/
+/* Place an entry known to be absent, displacing richer occupants.
+ * Returns the slot the given entry ended up in.
+ */
+static ht_slot_t* placeSlot(hashtable_t* ht, ht_slot_t entry)
+{
+  size_t mask = ht->capacity - 1;
+  size_t pos = entry.hash & mask;
+  ht_slot_t* placed = NULL;
+  for (size_t dist = 0; ; dist++, pos = (pos + 1) & mask) {
+    ht_slot_t* slot = &ht->table[pos];
+    if (slot->hash == 0) {
+      *slot = entry;
+      return placed != NULL ? placed : slot;
+    }
+    size_t slotDist = probeDistance(ht, slot->hash, pos);
+    if (slotDist < dist) {       // take from the rich, keep carrying the evictee
+      ht_slot_t evicted = *slot;
+      *slot = entry;
+      if (placed == NULL) {
+        placed = slot;
+      }
+      entry = evicted;
+      dist = slotDist;
+    }
+  }
+}
+
+/**************** grow() ****************/
+/* Double the slot array and re-place every entry using its cached hash */
+static void grow(hashtable_t* ht)
+{
+  ht_slot_t* old = ht->table;
+  size_t oldCapacity = ht->capacity;
+
+  ht->capacity = oldCapacity * 2;
+  ht->table = mem_calloc_assert(ht->capacity, sizeof(ht_slot_t), "couldn't grow table\n");
+  for (size_t i = 0; i < oldCapacity; i++) {
+    if (old[i].hash != 0) {
+      placeSlot(ht, old[i]);
+    }
+  }
+  mem_free(old);
+}
+
+/**************** internKey() ****************/
+/* Copy key into the arena and return the stable copy */
+static const char* internKey(hashtable_t* ht, const char* key)
+{
+  size_t len = strlen(key) + 1;
+  ht_chunk_t* chunk = ht->arena;
+  if (chunk == NULL || chunk->size - chunk->used < len) {
+    size_t size = len > ARENA_CHUNK ? len : ARENA_CHUNK;
+    chunk = mem_malloc_assert(sizeof(ht_chunk_t) + size, "couldn't allocate key arena\n");
+    chunk->next = ht->arena;
+    chunk->used = 0;
+    chunk->size = size;
+    ht->arena = chunk;
+  }
+  char* copy = chunk->data + chunk->used;
+  memcpy(copy, key, len);
+  chunk->used += len;
+  return copy;
+}
@@ -3,6 +3,7 @@
  *
  * A *hashtable* is a set of (key,item) pairs.  It acts just like a set, 
  * but is far more efficient for large collections.
+ * The table grows automatically as items are inserted.
  *
  * David Kotz, April 2016, 2017, 2019, 2021
  * updated by Xia Zhou, July 2016
@@ -23,11 +24,14 @@ typedef struct hashtable hashtable_t;  // opaque to users of the module
 /* Create a new (empty) hashtable.
  *
  * Caller provides:
- *   number of slots to be used for the hashtable (must be > 0).
+ *   expected number of items in the hashtable (must be > 0).
  * We return:
  *   pointer to the new hashtable; return NULL if error.
  * We guarantee:
  *   hashtable is initialized empty.
+ * Notes:
+ *   num_slots is a sizing hint; the table resizes itself when it fills,
+ *   so inserting more than num_slots items is fine.
  * Caller is responsible for:
  *   later calling hashtable_delete.
  */
@@ -62,6 +66,28 @@ bool hashtable_insert(hashtable_t* ht, const char* key, void* item);
  */
 void* hashtable_find(hashtable_t* ht, const char* key);
 
+/**************** hashtable_upsert ****************/
+/* Find the item slot for key, inserting key if it is not yet present.
+ *
+ * Caller provides:
+ *   valid pointer to hashtable, valid string for key.
+ * We return:
+ *   pointer to the item pointer stored for key;
+ *   NULL if hashtable is NULL or key is NULL.
+ * We guarantee:
+ *   the key is hashed and probed only once.
+ *   if key was not present, it is inserted and *result is NULL;
+ *   the caller then stores the new item through the returned pointer.
+ * Notes:
+ *   The key string is copied, just as in hashtable_insert.
+ *   The returned pointer is valid only until a new key is inserted, by
+ *   insert or upsert, which may move slots when the table grows; an
+ *   upsert of a key already present moves nothing.
+ *   A slot left holding NULL behaves as if key were absent for
+ *   hashtable_find, but it still occupies space in the table.
+ */
+void** hashtable_upsert(hashtable_t* ht, const char* key);
+
 /**************** hashtable_print ****************/
 /* Print the whole table; provide the output file and func to print each item.
  * 
@@ -73,7 +99,7 @@ void* hashtable_find(hashtable_t* ht, const char* key);
  *   nothing, if NULL fp.
  *   "(null)" if NULL ht.
  *   one line per hash slot, with no items, if NULL itemprint.
- *   otherwise, one line per hash slot, listing (key,item) pairs in that slot.
+ *   otherwise, one line per hash slot, listing the (key,item) pair in that slot.
  * Note:
  *   the hashtable and its contents are not changed by this function,
  */
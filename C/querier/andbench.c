@@ -0,0 +1,216 @@
+/*
+ * andbench.c - CS50 'andbench' module
+ *
+ * This module times two-word AND queries on a binary index: as the
+ * querier once evaluated them, into a counters set through the union
+ * module, and with the intersect module, by plain merge, galloping,
+ * block merge, and its own choice (INTERSECT_AUTO). It queries every
+ * pair of the index's most frequent words, whose lists are of similar
+ * size, and each of those words with a word about a hundred times
+ * rarer, and checks every way against the merge. The counters way is
+ * quadratic in the lists' sizes, so it answers each pair at most once,
+ * and no more once it has taken COUNTERS_SECONDS.
+ *
+ * usage: ./andbench indexFilename [rounds]
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "mem.h"
+#include "clock.h"
+#include "counters.h"
+#include "union.h"
+#include "intersect.h"
+#include "indexfile.h"
+
+// the most frequent words paired with each other
+#define FREQUENT 8
+// how much rarer the other word of a skewed pair is
+#define SKEW 100
+// seconds after which the counters way answers no more pairs
+#define COUNTERS_SECONDS 1.0
+
+// the ways to answer a query
+typedef enum { BY_COUNTERS, BY_MERGE, BY_GALLOP, BY_BLOCKS, BY_AUTO, NUM_WAYS } way_t;
+static const char* WAY_NAMES[NUM_WAYS] = { "counters", "merge", "gallop", "blocks", "auto" };
+
+// two lists to intersect
+typedef struct pair {
+  postings_t* first;
+  postings_t* second;
+} pair_t;
+
+// one pair's answer
+typedef struct answer {
+  int* ids;
+  int* counts;
+  int size;
+} answer_t;
+
+// Function prototypes
+int main(int argc, char* argv[]);
+static void timePairs(const char* title, pair_t* pairs, int numPairs, int rounds, int* bad);
+static int answer(way_t way, pair_t* pair, int* ids, int* counts);
+
+/**************** main ****************/
+/* Opens the index, picks the pairs, then times them every way */
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s indexFilename [rounds]\n", argv[0]);
+    exit(1);
+  }
+  int rounds = argc == 3 ? atoi(argv[2]) : 20;
+  if (rounds < 1) {
+    fprintf(stderr, "rounds must be a positive integer\n");
+    exit(1);
+  }
+  indexfile_t* file = indexfile_open(argv[1]);
+  if (file == NULL) {
+    fprintf(stderr, "Couldn't open binary index %s\n", argv[1]);
+    exit(2);
+  }
+
+  // every list, largest first
+  int numWords = indexfile_numWords(file);
+  postings_t* lists = mem_calloc_assert(numWords + 1, sizeof(postings_t), "Couldn't allocate lists");
+  for (int i = 0; i < numWords; i++) {
+    lists[i] = indexfile_postings(file, i);
+  }
+  qsort(lists, numWords, sizeof(postings_t), postings_compareSizes);
+
+  int frequent = numWords < FREQUENT ? numWords : FREQUENT;
+  pair_t* similar = mem_calloc_assert(frequent * frequent + 1, sizeof(pair_t), "Couldn't allocate pairs");
+  pair_t* skewed = mem_calloc_assert(frequent + 1, sizeof(pair_t), "Couldn't allocate pairs");
+  int numSimilar = 0;
+  int numSkewed = 0;
+  for (int i = 0; i < frequent; i++) {
+    for (int j = i + 1; j < frequent; j++) {
+      similar[numSimilar].first = &lists[i];
+      similar[numSimilar++].second = &lists[j];
+    }
+    // the largest list a hundred times smaller, if there is one
+    int rare = i;
+    while (rare < numWords && (int64_t) lists[rare].size * SKEW > lists[i].size) {
+      rare++;
+    }
+    if (rare < numWords && lists[rare].size > 0) {
+      skewed[numSkewed].first = &lists[i];
+      skewed[numSkewed++].second = &lists[rare];
+    }
+  }
+
+  printf("index:            %s\n", argv[1]);
+  printf("words:            %d\n", numWords);
+  printf("largest list:     %d\n", numWords > 0 ? lists[0].size : 0);
+  printf("SIMD blocks:      %s\n", intersect_hasSimd() ? "yes" : "no (plain merge)");
+  int bad = 0;
+  timePairs("frequent pairs", similar, numSimilar, rounds, &bad);
+  timePairs("skewed pairs", skewed, numSkewed, rounds, &bad);
+  printf("answers:          %s\n", bad == 0 ? "ok" : "FAILED");
+
+  for (int i = 0; i < numWords; i++) {
+    postings_release(&lists[i]);
+  }
+  free(lists);
+  free(similar);
+  free(skewed);
+  indexfile_close(file);
+  return bad == 0 ? 0 : 3;
+}
+
+/**************** timePairs ****************/
+/* Answers every pair rounds times each way (the counters way at most
+ * once), prints the mean time per query, and counts into *bad the ways whose
+ * answers differ from the merge
+ */
+static void timePairs(const char* title, pair_t* pairs, int numPairs, int rounds, int* bad)
+{
+  if (numPairs == 0) {
+    return;
+  }
+  answer_t* expected = mem_calloc_assert(numPairs, sizeof(answer_t), "Couldn't allocate answers");
+  int room = 1;
+  for (int p = 0; p < numPairs; p++) {
+    int size = pairs[p].first->size;
+    room = size > room ? size : room;
+    expected[p].ids = mem_malloc_assert((size + 1) * sizeof(int), "Couldn't allocate answer");
+    expected[p].counts = mem_malloc_assert((size + 1) * sizeof(int), "Couldn't allocate answer");
+    expected[p].size = intersect_pair(pairs[p].first, pairs[p].second, INTERSECT_MERGE,
+                                      expected[p].ids, expected[p].counts);
+  }
+  int* ids = mem_malloc_assert(room * sizeof(int), "Couldn't allocate answer");
+  int* counts = mem_malloc_assert(room * sizeof(int), "Couldn't allocate answer");
+
+  printf("%s (%d):\n", title, numPairs);
+  for (way_t way = 0; way < NUM_WAYS; way++) {
+    // one round checked against the merge, then the timed ones; the
+    // counters way is too slow for that, so its one round is timed
+    bool same = true;
+    int queries = 0;
+    double start = clock_now();
+    while (queries < numPairs && (way != BY_COUNTERS || clock_now() - start < COUNTERS_SECONDS)) {
+      int size = answer(way, &pairs[queries], ids, counts);
+      same = same && size == expected[queries].size
+             && memcmp(ids, expected[queries].ids, size * sizeof(int)) == 0
+             && memcmp(counts, expected[queries].counts, size * sizeof(int)) == 0;
+      queries++;
+    }
+    double seconds = clock_now() - start;
+    if (way != BY_COUNTERS) {
+      start = clock_now();
+      for (int r = 0; r < rounds; r++) {
+        for (int p = 0; p < numPairs; p++) {
+          answer(way, &pairs[p], ids, counts);
+        }
+      }
+      seconds = clock_now() - start;
+      queries = rounds * numPairs;
+    }
+    printf("  %-14s  %12.2f us/query%s\n", WAY_NAMES[way], seconds / queries * 1e6,
+           same ? "" : "   WRONG");
+    if (!same) {
+      (*bad)++;
+    }
+  }
+
+  for (int p = 0; p < numPairs; p++) {
+    free(expected[p].ids);
+    free(expected[p].counts);
+  }
+  free(expected);
+  free(ids);
+  free(counts);
+}
+
+/**************** answer ****************/
+/* Answers one pair one way; returns how many documents match, in
+ * increasing docID order in ids and with their scores in counts
+ */
+static int answer(way_t way, pair_t* pair, int* ids, int* counts)
+{
+  static const intersect_method_t METHODS[NUM_WAYS] = {
+    INTERSECT_AUTO, INTERSECT_MERGE, INTERSECT_GALLOP, INTERSECT_BLOCKS, INTERSECT_AUTO
+  };
+  if (way != BY_COUNTERS) {
+    return intersect_pair(pair->first, pair->second, METHODS[way], ids, counts);
+  }
+
+  // as the querier did: the first list into a union, and'ed with the second
+  union_t* uni = union_new();
+  union_disjunction(uni, pair->first);
+  union_conjunction(uni, pair->second);
+  postings_t found;
+  union_postings(uni, &found);
+  union_delete(uni);
+  memcpy(ids, found.ids, found.size * sizeof(int));
+  memcpy(counts, found.counts, found.size * sizeof(int));
+  int size = found.size;
+  postings_release(&found);
+  return size;
+}
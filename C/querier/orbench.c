@@ -0,0 +1,154 @@
+/*
+ * orbench.c - CS50 'orbench' module
+ *
+ * This module times OR queries on a binary index: as the querier once
+ * evaluated them, by adding each word's postings into a counters set
+ * through the union module, and with the accum module, both with its
+ * dense block and with every page allocated on its own. Each query ORs
+ * the index's 2, 4, 8, ... most frequent words, up to MAX_WIDTH, and
+ * every way is checked against the dense accumulator. The counters way
+ * is quadratic in the number of documents, so it answers each query at
+ * most once, and no more once it has taken COUNTERS_SECONDS.
+ *
+ * usage: ./orbench indexFilename [rounds]
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "mem.h"
+#include "clock.h"
+#include "counters.h"
+#include "union.h"
+#include "accum.h"
+#include "indexfile.h"
+
+// words in the widest query
+#define MAX_WIDTH 32
+// seconds after which the counters way answers no more queries
+#define COUNTERS_SECONDS 1.0
+
+// the ways to answer a query
+typedef enum { BY_COUNTERS, BY_DENSE, BY_PAGED, NUM_WAYS } way_t;
+static const char* WAY_NAMES[NUM_WAYS] = { "counters", "dense", "paged" };
+
+// Function prototypes
+int main(int argc, char* argv[]);
+static postings_t answer(way_t way, accum_t* accum, postings_t* lists, int width);
+
+/**************** main ****************/
+/* Opens the index, then times ever wider queries every way */
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s indexFilename [rounds]\n", argv[0]);
+    exit(1);
+  }
+  int rounds = argc == 3 ? atoi(argv[2]) : 20;
+  if (rounds < 1) {
+    fprintf(stderr, "rounds must be a positive integer\n");
+    exit(1);
+  }
+  indexfile_t* file = indexfile_open(argv[1]);
+  if (file == NULL) {
+    fprintf(stderr, "Couldn't open binary index %s\n", argv[1]);
+    exit(2);
+  }
+
+  // every list, largest first
+  int numWords = indexfile_numWords(file);
+  postings_t* lists = mem_calloc_assert(numWords + 1, sizeof(postings_t), "Couldn't allocate lists");
+  for (int i = 0; i < numWords; i++) {
+    lists[i] = indexfile_postings(file, i);
+  }
+  qsort(lists, numWords, sizeof(postings_t), postings_compareSizes);
+
+  accum_t* accums[NUM_WAYS] = { NULL, accum_new(ACCUM_DENSE_DOCS), accum_new(0) };
+  printf("index:            %s\n", argv[1]);
+  printf("words:            %d\n", numWords);
+  printf("largest docID:    %d\n", indexfile_maxDocID(file));
+  printf("%-8s %10s", "width", "matches");
+  for (way_t way = 0; way < NUM_WAYS; way++) {
+    printf("  %14s", WAY_NAMES[way]);
+  }
+  printf("\n");
+
+  int bad = 0;
+  double countersSeconds = 0;
+  for (int width = 2; width <= MAX_WIDTH && width <= numWords; width *= 2) {
+    postings_t expected = answer(BY_DENSE, accums[BY_DENSE], lists, width);
+    printf("%-8d %10d", width, expected.size);
+    for (way_t way = 0; way < NUM_WAYS; way++) {
+      if (way == BY_COUNTERS && countersSeconds > COUNTERS_SECONDS) {
+        printf("  %14s", "-");
+        continue;
+      }
+      // one answer checked, then the timed ones; just the one for counters
+      double start = clock_now();
+      postings_t scores = answer(way, accums[way], lists, width);
+      double seconds = clock_now() - start;
+      int queries = 1;
+      if (scores.size != expected.size
+          || memcmp(scores.ids, expected.ids, scores.size * sizeof(int)) != 0
+          || memcmp(scores.counts, expected.counts, scores.size * sizeof(int)) != 0) {
+        bad++;
+      }
+      postings_release(&scores);
+      if (way == BY_COUNTERS) {
+        countersSeconds += seconds;
+      } else {
+        start = clock_now();
+        for (int r = 0; r < rounds; r++) {
+          scores = answer(way, accums[way], lists, width);
+          postings_release(&scores);
+        }
+        seconds = clock_now() - start;
+        queries = rounds;
+      }
+      printf("  %11.1f us", seconds / queries * 1e6);
+    }
+    printf("\n");
+    postings_release(&expected);
+  }
+  printf("accumulators:     dense %zu bytes, paged %zu bytes\n",
+         accum_memory(accums[BY_DENSE]), accum_memory(accums[BY_PAGED]));
+  printf("answers:          %s\n", bad == 0 ? "ok" : "FAILED");
+
+  for (way_t way = 0; way < NUM_WAYS; way++) {
+    accum_delete(accums[way]);
+  }
+  for (int i = 0; i < numWords; i++) {
+    postings_release(&lists[i]);
+  }
+  free(lists);
+  indexfile_close(file);
+  return bad == 0 ? 0 : 3;
+}
+
+/**************** answer ****************/
+/* ORs the first width lists one way; returns the scores by docID */
+static postings_t answer(way_t way, accum_t* accum, postings_t* lists, int width)
+{
+  postings_t scores = postings_view(NULL, NULL, 0);
+  if (way != BY_COUNTERS) {
+    for (int w = 0; w < width; w++) {
+      accum_add(accum, &lists[w]);
+    }
+    accum_scores(accum, &scores);
+    return scores;
+  }
+
+  // as the querier did: every list into a union, then its counters
+  // sorted by docID
+  union_t* uni = union_new();
+  for (int w = 0; w < width; w++) {
+    union_disjunction(uni, &lists[w]);
+  }
+  union_postings(uni, &scores);
+  union_delete(uni);
+  return scores;
+}
@@ -5,34 +5,206 @@
  * retrieves matching documents using a given index, and displays results ranked
  * by score using a scoreboard.
  *
- * It supports logical "and" and "or" operators, with "and" taking precedence.
+ * It supports logical "and" and "or" operators, with "and" taking precedence,
+ * and quoted phrases, which match documents holding their words one after
+ * another; phrases need a positional index (indexer -p).
+ * And-sequences are intersected on their postings (intersect.h), and
+ * their scores summed across "or"s in an accumulator (accum.h).
  *
- * Usage: ./querier pageDirectory indexFilename
+ * With -k, only the k best documents are shown. On an index with
+ * impacts (indexer -i) they are found by reading each word's postings
+ * best first and stopping once no other document could make the top k.
+ *
+ * URLs are looked up in the crawl's manifest (docmap.h), mapped with the
+ * index, and only read from the pages themselves if it has none.
+ *
+ * With -e, each query is also run against a full index, and the top k
+ * (10 unless -k says otherwise) from the main index, typically a pruned
+ * one (indexer -s or -t), are compared with the full index's: each query
+ * reports how many of the full top k it found, and the mean of those
+ * overlaps is printed at the end. Queries may come from a file on stdin.
+ *
+ * With --serve, the index is loaded once and queries are answered for
+ * any number of clients over a Unix domain socket, one JSON line per
+ * query line, until the querier is interrupted. A pool of -j threads
+ * (one per CPU by default) serves the connections, each thread with
+ * its own accumulator; the index and manifest are only ever read, so
+ * the threads share them, locking only to take hold of them.
+ *
+ * With --batch, every query of a file (or stdin, for "-") is answered by
+ * a pool of -j threads, and the answers written to stdout as the same
+ * JSON lines, in the order of the queries, each with how long it took;
+ * a summary of throughput and latency goes to stderr at the end.
+ *
+ * Answers are cached (querycache.h), by the query's canonical form, in
+ * -c megabytes (16 by default, 0 for none), so a query asked again, in
+ * any mode, isn't ranked again. Whenever the index file changes, in any
+ * mode, it is loaded again, with the manifest, and the cache dropped;
+ * queries already using the old index finish with it. On an index
+ * whose lists are decoded (indexer -c) or joined (segments), the lists
+ * of the most asked-for words are also kept decoded (postcache.h), in
+ * -d megabytes (32 by default, 0 for none). --serve and --batch report
+ * both caches' hits and misses.
+ *
+ * Usage: ./querier [-k k] [-c megabytes] [-d megabytes] [-e fullIndexFilename] pageDirectory indexFilename
+ *        ./querier [-k k] [-c megabytes] [-d megabytes] [-j threads] --serve socketPath pageDirectory indexFilename
+ *        ./querier [-k k] [-c megabytes] [-d megabytes] [-j threads] --batch queryFile pageDirectory indexFilename
  *
  * Arthur Ufongene, May 2025
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 
 #include "file.h"
 #include "mem.h"
+#include "clock.h"
 #include "counters.h"
-#include "union.h"
 #include "index.h"
 #include "pagedir.h"
 #include "scoreboard.h"
 #include "word.h"
+#include "phrase.h"
+#include "intersect.h"
+#include "accum.h"
+#include "docmap.h"
+#include "impact.h"
+#include "indexfile.h"
+#include "bqueue.h"
+#include "plan.h"
+#include "maxscore.h"
+#include "querycache.h"
+#include "postcache.h"
 #include <unistd.h>  // add this to your list of includes
 
+// Server and batch sizes
+#define MAX_WORKERS 16         // threads serving connections or answering a batch
+#define CONNECTION_QUEUE 64    // connections accepted ahead of the workers
+#define CACHE_MEGABYTES 16     // for recent answers, unless -c says otherwise
+#define DECODED_MEGABYTES 32   // for decoded lists, unless -d says otherwise
+
+// what identifies one version of the index file
+typedef struct identity {
+  bool exists;
+  dev_t device;
+  ino_t inode;
+  off_t size;
+  struct timespec modified;
+} identity_t;
+
+// one loaded version of the index, and what was loaded with it; each
+// query holds it while it is answered, and it is freed once it has been
+// replaced and the last of them is done
+typedef struct loaded {
+  index_t* idx;
+  docmap_t* docs;              // URLs, if the crawl has a manifest
+  postcache_t* decoded;        // idx's decoded lists, or NULL
+  int version;                 // the cache's version when idx was loaded
+  int holders;                 // the engine, while idx is current, and queries
+} loaded_t;
+
+// what answering a query needs, shared by every thread; the index is
+// only ever read, but is swapped under the lock for a new one when its
+// file changes. The cache locks itself
+typedef struct engine {
+  char* indexFilename;
+  char* pageDirectory;
+  int k;
+  size_t decodedBudget;        // bytes for each loaded index's decoded lists
+  querycache_t* cache;         // recent answers, or NULL
+  pthread_mutex_t lock;        // guards the rest
+  loaded_t* loaded;            // the current index
+  identity_t identity;         // of the file it (or one loading) was read from
+  bool reloading;              // set while a thread loads a changed index
+} engine_t;
+
+// what every server thread shares; only the queue, and under the lock
+// the workers' fds and closing, change
+typedef struct server {
+  engine_t* engine;
+  bqueue_t* connections;       // accepted sockets, as int*
+  pthread_mutex_t lock;        // guards closing and each worker's fd
+  bool closing;                // set once the server stops accepting
+} server_t;
+
+// one thread of the pool, and the connection it is serving
+typedef struct worker {
+  server_t* server;
+  pthread_t thread;
+  int fd;                      // -1 while waiting for a connection
+} worker_t;
+
+// a batch of queries, shared by the threads answering it; under the
+// lock, each takes the next query and stores its answer
+typedef struct batch {
+  engine_t* engine;
+  char** queries;
+  int numQueries;
+  char** answers;              // JSON lines, NULL until answered
+  double* seconds;             // how long each query took
+  int nextQuery;               // the next one for a thread to take
+  pthread_mutex_t lock;
+  pthread_cond_t answered;     // signalled as each answer is stored
+} batch_t;
+
+// set by SIGINT or SIGTERM to stop the server, and only read by the
+// thread that takes them; the handler also shuts the listening socket so
+// the blocked accept returns
+static volatile sig_atomic_t stopping = 0;
+static int listener = -1;
+
 
 // Function declarations
 int fileno(FILE *stream);
 static void prompt(void);
-static void parseArgs(int argc, char* argv[], char** pageDir, char** filename);
-static counters_t* disjunctOrSequence(index_t* idx, char** wordSequence);
-static counters_t* conjunctAndSequence(index_t* idx, char** sequence, int* pos, int start);
+static void parseArgs(int argc, char* argv[], char** pageDir, char** filename, int* k,
+                      char** fullFilename, char** socketPath, char** batchFilename,
+                      int* threads, int* cacheMegabytes, int* decodedMegabytes);
+static char** parseQuery(char* query, index_t* idx, index_t* full, const char** error);
+static scoreboard_t* rankCached(querycache_t* cache, loaded_t* loaded, char** wordSequence, int k,
+                                accum_t* accum);
+static scoreboard_t* rankQuery(index_t* idx, char** wordSequence, int k, accum_t* accum);
+static void printPruning(const char* indexFilename);
+static postings_t disjunctOrSequence(index_t* idx, plan_t* plan, accum_t* accum);
+static counters_t* topScores(index_t* idx, plan_t* plan, int k);
+static counters_t* maxScores(index_t* idx, plan_t* plan, int k);
+static int termBound(index_t* idx, const plan_term_t* term);
+static postings_t conjunctAndSequence(index_t* idx, const plan_branch_t* branch);
+static postings_t termPostings(index_t* idx, const plan_term_t* term);
+static postings_t phrasePostings(index_t* idx, const char* phrase);
+static bool hasPhrase(char** wordSequence);
+static bool serve(const char* socketPath, int numWorkers, server_t* server);
+static void* serveConnections(void* arg);
+static void answerClient(server_t* server, int fd, accum_t* accum);
+static bool runBatch(const char* batchFilename, int numThreads, batch_t* batch);
+static void* answerBatch(void* arg);
+static double answerQuery(FILE* fp, char* query, engine_t* engine, accum_t* accum, bool timed);
+static void printJsonAnswer(FILE* fp, char** wordSequence, scoreboard_t* board,
+                            engine_t* engine, docmap_t* docs, double seconds);
+static void printJsonString(FILE* fp, const char* string);
+static void stopServing(int signum);
+static void closeConnection(void* item);
+static void printCacheStats(engine_t* engine);
+static int compareDoubles(const void* first, const void* second);
+static accum_t* newAccum(index_t* idx, index_t* full);
+static loaded_t* loadIndex(char* indexFilename, const char* pageDirectory, size_t decodedBudget);
+static void unloadIndex(loaded_t* loaded);
+static loaded_t* acquireIndex(engine_t* engine);
+static void reloadIndex(engine_t* engine);
+static void releaseIndex(engine_t* engine, loaded_t* loaded);
+static void closeEngine(engine_t* engine);
+static void readIdentity(const char* filename, identity_t* identity);
+static bool sameIdentity(const identity_t* first, const identity_t* second);
 int main(int argc, char* argv[]);
 
 /********** main **********/
@@ -45,56 +217,114 @@ int main(int argc, char* argv[])
 {
   char* pageDirectory;
   char* indexFilename;
+  char* fullFilename = NULL;
+  char* socketPath = NULL;
+  char* batchFilename = NULL;
+  int k = 0;
+  int threads = 0;
+  int cacheMegabytes = CACHE_MEGABYTES;
+  int decodedMegabytes = DECODED_MEGABYTES;
                                                    // parse arguments
-  parseArgs(argc, argv, &pageDirectory, &indexFilename);
+  parseArgs(argc, argv, &pageDirectory, &indexFilename, &k, &fullFilename, &socketPath,
+            &batchFilename, &threads, &cacheMegabytes, &decodedMegabytes);
+  if (fullFilename != NULL && k == 0) {
+    k = 10;                                        // overlap of the top 10 by default
+  }
+
+  engine_t engine = { .indexFilename = indexFilename, .pageDirectory = pageDirectory, .k = k,
+                      .decodedBudget = (size_t) decodedMegabytes << 20 };
+  index_t* full = NULL;                            // the index to compare with
+  readIdentity(indexFilename, &engine.identity);   // before loading, so a change
+                                                   // while loading is seen
+                                                   // Load (or map) the index
+  if ((engine.loaded = loadIndex(indexFilename, pageDirectory, engine.decodedBudget)) == NULL
+      || (fullFilename != NULL && (full = index_reconstruct(fullFilename)) == NULL)) {
+    fprintf(stderr, "Couldn't load index\n");
+    unloadIndex(engine.loaded);
+    free(pageDirectory);
+    free(indexFilename);
+    free(fullFilename);
+    free(socketPath);
+    free(batchFilename);
+    exit(-1);
+  }
 
-  index_t* idx = index_reconstruct(indexFilename); // Load the index
+  if (full != NULL) {
+    printPruning(indexFilename);
+  }
+  engine.cache = querycache_new((size_t) cacheMegabytes << 20);
+  pthread_mutex_init(&engine.lock, NULL);
+
+  if (socketPath != NULL || batchFilename != NULL) {   // serve clients, or answer a batch,
+    bool done;                                         // instead of stdin
+    if (socketPath != NULL) {
+      server_t server = { .engine = &engine };
+      done = serve(socketPath, threads, &server);
+    } else {
+      batch_t batch = { .engine = &engine };
+      done = runBatch(batchFilename, threads, &batch);
+    }
+    closeEngine(&engine);
+    free(pageDirectory);
+    free(indexFilename);
+    free(socketPath);
+    free(batchFilename);
+    exit(done ? 0 : -1);
+  }
 
   char* query;
   char** wordSequence;
-  counters_t* scores;
   scoreboard_t* board;
+  loaded_t* loaded;                                // the index each query holds
+  accum_t* accum = newAccum(engine.loaded->idx, full);   // OR scores, reused by every query
+  double overlapSum = 0;                           // of each query's overlap fraction
+  int overlapQueries = 0;
 
   prompt();                                // read from stdin until EOF is received
   while ((query = file_readLine(stdin)) != NULL) {
-    // Break the query into words, prompt the user again if null return
-    if ((wordSequence = word_decomposeSequence(query)) == NULL) {
+    // Hold the index, loaded again if its file has changed
+    loaded = acquireIndex(&engine);
+
+    // Break the query into words and check them, prompt the user again if invalid
+    const char* error;
+    if ((wordSequence = parseQuery(query, loaded->idx, full, &error)) == NULL) {
+      releaseIndex(&engine, loaded);
       free(query);
       prompt();
       continue;
     }
     // If query is empty, do nothing
     if (wordSequence[0] == NULL) {
+      releaseIndex(&engine, loaded);
       free(query);
       free(wordSequence);
       continue;
     }
-
-    // Normalize the sequence of words and then check the syntax
-    word_normalizeSequence(wordSequence);
-    if (!word_checkSyntax(wordSequence)) {
-      free(wordSequence);
-      free(query);
-
-      // prompt user again if incorrect syntax
-      prompt();
-      continue;
-    }
       // Echo normalized sequence
     word_printSequence(wordSequence); 
 
-      // Create a counter of scores from the sequence
-    scores = disjunctOrSequence(idx, wordSequence);
+      // Rank the matching documents and print the scoreboard
+    board = rankCached(engine.cache, loaded, wordSequence, k, accum);
+    scoreboard_print(board, pageDirectory, loaded->docs);
 
-      // Create a sorted scoreboard from the scores
-    board = scoreboard_new(scores, 100);
-      
-      // Print the scoreboard
-    scoreboard_print(board, pageDirectory);
+      // Compare with the full index's top k
+    if (full != NULL) {
+      scoreboard_t* fullBoard = rankQuery(full, wordSequence, k, accum);
+      int fullSize = scoreboard_size(fullBoard);
+      if (fullSize == 0) {
+        printf("No full index matches to compare with\n\n");
+      } else {
+        int shared = scoreboard_overlap(board, fullBoard);
+        printf("Top %d overlap with the full index: %d of %d\n\n", k, shared, fullSize);
+        overlapSum += (double) shared / fullSize;
+        overlapQueries++;
+      }
+      scoreboard_delete(fullBoard);
+    }
 
       // Clean up after each query
+    releaseIndex(&engine, loaded);
     scoreboard_delete(board);
-    counters_delete(scores);
     free(wordSequence);
     free(query);
 
@@ -103,9 +333,16 @@ int main(int argc, char* argv[])
 
     // Final cleanup after EOF reached
   printf("\n");
-  index_delete(idx);
+  if (full != NULL && overlapQueries > 0) {
+    printf("Mean top %d overlap over %d queries: %.3f\n", k, overlapQueries,
+           overlapSum / overlapQueries);
+  }
+  accum_delete(accum);
+  closeEngine(&engine);
+  index_delete(full);
   free(pageDirectory);
   free(indexFilename);
+  free(fullFilename);
   exit(0);
 }
 
@@ -116,16 +353,84 @@ int main(int argc, char* argv[])
  * Caller provides:
  *   argc, argv from main
  * We return:
- *   Nothing, but store allocated pageDir and filename pointers
+ *   Nothing, but store allocated pageDir and filename pointers, the
+ *   -k count in k (left alone if -k isn't given), an allocated -e
+ *   full index filename in fullFilename, --serve socket path in
+ *   socketPath and --batch query file in batchFilename (each left alone
+ *   if not given), the -j thread count in threads (set to one per
+ *   CPU, at most MAX_WORKERS, if not given), and the -c and -d cache
+ *   sizes in cacheMegabytes and decodedMegabytes (each left alone if
+ *   not given)
  * If invalid, exits the program with an error.
  */
-static void parseArgs(int argc, char* argv[], char** pageDir, char** filename)
+static void parseArgs(int argc, char* argv[], char** pageDir, char** filename, int* k,
+                      char** fullFilename, char** socketPath, char** batchFilename,
+                      int* threads, int* cacheMegabytes, int* decodedMegabytes)
 {
+  // optional -k count, -e full index, -j threads, -c and -d cache sizes,
+  // --serve socket and --batch query file come first
+  while (argc > 1 && (strcmp(argv[1], "-k") == 0 || strcmp(argv[1], "-e") == 0
+                      || strcmp(argv[1], "-j") == 0 || strcmp(argv[1], "-c") == 0
+                      || strcmp(argv[1], "-d") == 0 || strcmp(argv[1], "--serve") == 0
+                      || strcmp(argv[1], "--batch") == 0)) {
+    if (argc < 3) {
+      fprintf(stderr, "%s needs an argument\n", argv[1]);
+      exit(-1);
+    }
+    char excess;
+    if (argv[1][1] == 'k' && (sscanf(argv[2], "%d%c", k, &excess) != 1 || *k <= 0)) {
+      fprintf(stderr, "-k needs a positive number of results\n");
+      exit(-1);
+    }
+    if (argv[1][1] == 'j' && (sscanf(argv[2], "%d%c", threads, &excess) != 1 || *threads <= 0)) {
+      fprintf(stderr, "-j needs a positive number of threads\n");
+      exit(-1);
+    }
+    if (argv[1][1] == 'c' || argv[1][1] == 'd') {
+      int* megabytes = argv[1][1] == 'c' ? cacheMegabytes : decodedMegabytes;
+      if (sscanf(argv[2], "%d%c", megabytes, &excess) != 1 || *megabytes < 0 || *megabytes > 1 << 20) {
+        fprintf(stderr, "%s needs a number of megabytes, 0 for no cache\n", argv[1]);
+        exit(-1);
+      }
+    }
+    if (strcmp(argv[1], "--serve") == 0 || strcmp(argv[1], "--batch") == 0) {
+      if (*socketPath != NULL || *batchFilename != NULL) {
+        fprintf(stderr, "Only one of --serve and --batch, once\n");
+        exit(-1);
+      }
+      if (argv[1][2] == 'b' && strcmp(argv[2], "-") != 0 && !pagedir_validateReadFile(argv[2])) {
+        fprintf(stderr, "Invalid query file\n");
+        exit(-1);
+      }
+      char** path = argv[1][2] == 's' ? socketPath : batchFilename;
+      *path = mem_calloc_assert(strlen(argv[2]) + 1, sizeof(char), "Couldn't allocate space for path");
+      strcpy(*path, argv[2]);
+    }
+    if (argv[1][1] == 'e') {
+      if (*fullFilename != NULL || !pagedir_validateReadFile(argv[2])) {
+        fprintf(stderr, "Invalid full index file\n");
+        exit(-1);
+      }
+      *fullFilename = mem_calloc_assert(strlen(argv[2]) + 1, sizeof(char), "Couldn't allocate space for index filename");
+      strcpy(*fullFilename, argv[2]);
+    }
+    argc -= 2;
+    argv += 2;
+  }
+
   // validate that there are 3 arguments, the pagedir is valid, and the index file is readable
   if (argc != 3) {
     fprintf(stderr, "Wrong number of arguments\n");
     exit(-1);
   }
+  if ((*socketPath != NULL || *batchFilename != NULL) && *fullFilename != NULL) {
+    fprintf(stderr, "-e can't be used with --serve or --batch\n");
+    exit(-1);
+  }
+  if (*threads == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    *threads = cpus < 1 ? 1 : (cpus > MAX_WORKERS ? MAX_WORKERS : (int) cpus);
+  }
 
   if (!pagedir_validate(argv[1])) {
     fprintf(stderr, "Invalid page directory\n");
@@ -159,85 +464,406 @@ static void parseArgs(int argc, char* argv[], char** pageDir, char** filename)
 }
 
 
+/********** parseQuery **********/
+/* Breaks a query line into a normalized, checked sequence of words
+ *
+ * Caller provides:
+ *   char* query - the line; the sequence's words point into it
+ *   index_t* idx, full - the indexes it will be run on (full may be NULL)
+ *   const char** error - where to say what was wrong with it
+ * We return:
+ *   The sequence, NULL-terminated, with no words if the line is blank;
+ *   or NULL if the query is invalid, with *error set to why. The word
+ *   module and we also print the details to stderr.
+ * Caller is responsible for:
+ *   Freeing the sequence, but not its words
+ */
+static char** parseQuery(char* query, index_t* idx, index_t* full, const char** error)
+{
+  char** wordSequence;
+  if ((wordSequence = word_decomposeSequence(query)) == NULL) {
+    *error = "bad character or unmatched quote";
+    return NULL;
+  }
+  // Normalize the sequence of words and then check the syntax
+  word_normalizeSequence(wordSequence);
+  if (!word_checkSyntax(wordSequence)) {
+    *error = "misplaced 'and' or 'or'";
+    free(wordSequence);
+    return NULL;
+  }
+  // Phrases can only be matched with word positions
+  if (hasPhrase(wordSequence)
+      && (!index_hasPositions(idx) || (full != NULL && !index_hasPositions(full)))) {
+    fprintf(stderr, "Error: phrases need an index built with indexer -p.\n\n");
+    *error = "phrases need an index built with indexer -p";
+    free(wordSequence);
+    return NULL;
+  }
+  return wordSequence;
+}
+
+
+/********** rankCached **********/
+/* Ranks a query as rankQuery does, answering from the cache if it was
+ * asked before, and caching the answer if it wasn't
+ *
+ * Caller provides:
+ *   The cache of answers from idx, or NULL for none, and what rankQuery
+ *   needs; k must be the same for every query that uses the cache
+ * We return:
+ *   A scoreboard, as rankQuery does
+ * Caller is responsible for:
+ *   Calling scoreboard_delete on the result
+ */
+static scoreboard_t* rankCached(querycache_t* cache, loaded_t* loaded, char** wordSequence, int k,
+                                accum_t* accum)
+{
+  if (cache == NULL) {
+    return rankQuery(loaded->idx, wordSequence, k, accum);
+  }
+  char* key = querycache_key(wordSequence);
+  scoreboard_t* board = querycache_get(cache, key);
+  if (board == NULL) {
+    board = rankQuery(loaded->idx, wordSequence, k, accum);
+    querycache_put(cache, key, loaded->version, board);
+  }
+  free(key);
+  return board;
+}
+
+
+/********** rankQuery **********/
+/* Scores a query's matching documents and ranks them
+ *
+ * Caller provides:
+ *   index_t* idx - the index to query
+ *   char** wordSequence - validated array of query words
+ *   int k - how many documents to keep, 0 for all
+ *   accum_t* accum - an empty accumulator for OR scores
+ * We return:
+ *   A scoreboard of the best k matches (all if k is 0) and how many
+ *   matched; on an index with impacts and a query without phrases,
+ *   only those k are scored, and the total is unknown if k matched
+ * Caller is responsible for:
+ *   Calling scoreboard_delete on the result
+ * Notes:
+ *   The query is planned on idx first (see plan.h), so terms are read
+ *   cheapest first and only while they can still match, and a repeated
+ *   term or 'or' branch is only read once.
+ */
+static scoreboard_t* rankQuery(index_t* idx, char** wordSequence, int k, accum_t* accum)
+{
+  scoreboard_t* board;
+  plan_t* plan = plan_new(idx, wordSequence);
+  if (k > 0 && index_hasImpacts(idx) && !hasPhrase(wordSequence)) {
+    counters_t* scores = topScores(idx, plan, k);
+    board = scoreboard_new(scores, k);
+    if (scoreboard_size(board) == k) {
+      scoreboard_setTotal(board, SCOREBOARD_UNKNOWN);  // the rest were never counted
+    }
+    counters_delete(scores);
+  } else if (k > 0 && index_hasBounds(idx)) {
+    counters_t* scores = maxScores(idx, plan, k);
+    board = scoreboard_new(scores, k);
+    if (scoreboard_size(board) == k) {
+      scoreboard_setTotal(board, SCOREBOARD_UNKNOWN);  // documents were skipped uncounted
+    }
+    counters_delete(scores);
+  } else {
+    postings_t scores = disjunctOrSequence(idx, plan, accum);
+    board = scoreboard_newPostings(&scores, k);
+    postings_release(&scores);
+  }
+  plan_delete(plan);
+  return board;
+}
+
+
+/********** printPruning **********/
+/* Prints how an index file was pruned, from the settings it records,
+ * or that it wasn't; prints nothing for a text or segmented index
+ */
+static void printPruning(const char* indexFilename)
+{
+  indexfile_t* file;
+  if (!indexfile_isBinary(indexFilename) || (file = indexfile_open(indexFilename)) == NULL) {
+    return;
+  }
+  indexfile_pruning_t pruning;
+  if (!indexfile_pruning(file, &pruning)) {
+    printf("Index is not pruned\n\n");
+  } else {
+    if (pruning.mode == INDEXFILE_PRUNE_GLOBAL) {
+      printf("Index pruned to %g%% of its postings (threshold count %u)", pruning.value,
+             pruning.threshold);
+    } else {
+      printf("Index pruned below %g of each word's highest count", pruning.value);
+    }
+    printf(", keeping each word's best %u: %llu of %llu postings\n\n", pruning.keep,
+           (unsigned long long) pruning.postingsAfter, (unsigned long long) pruning.postingsBefore);
+  }
+  indexfile_close(file);
+}
+
+
 /********** disjunctOrSequence **********/
-/* Disjuncts scores across 'or's in the sequence
+/* Disjuncts scores across the 'or' branches of a plan
  *
  * Caller provides:
  *   index_t* idx - the reconstructed index
- *   char** wordSequence - validated array of query words
+ *   plan_t* plan - the query's plan on idx
+ *   accum_t* accum - an empty accumulator, left empty again
  * We return:
- *   counters_t* scores - combined scores across all query segments
+ *   The matching documents sorted by docID, each counted by its score
+ *   summed across all query segments; a repeated branch is read once
+ *   and its scores added as often as it was typed
  * Caller is responsible for:
- *   Deleting the returned counters
+ *   Calling postings_release on the result
  */
-static counters_t* disjunctOrSequence(index_t* idx, char** wordSequence)
+static postings_t disjunctOrSequence(index_t* idx, plan_t* plan, accum_t* accum)
 {
-  union_t* uni = union_new();    // empty union that we will perform disjunctions on
-  int pos = 0;                   // keeps track of where we are in the sequence
- 
+  if (plan->numBranches == 0) {
+    return postings_view(NULL, NULL, 0);    // some word of every branch is missing
+  }
+  if (plan->numBranches == 1 && plan->branches[0].repeats == 1) {
+    return conjunctAndSequence(idx, &plan->branches[0]);    // no 'or': that is every score
+  }
 
-  while (wordSequence[pos] != NULL) {
-    if (strcmp(wordSequence[pos], "or") == 0) {
-      pos++;                     // Skip over any 'or's 
+  for (int b = 0; b < plan->numBranches; b++) {
+                                 // Add the and sequence's scores to the accumulator
+    postings_t andSequenceResult = conjunctAndSequence(idx, &plan->branches[b]);
+    for (int r = 0; r < plan->branches[b].repeats; r++) {
+      accum_add(accum, &andSequenceResult);
     }
-                                 // Get the result of the and sequence
-    counters_t* andSequenceResult = conjunctAndSequence(idx, wordSequence, &pos, pos);
-                                 // Make the union a disjunction of itself and the and sequence result
-    union_disjunction(uni, andSequenceResult);  
-                                 // Delete the and sequence
-    counters_delete(andSequenceResult);
+    postings_release(&andSequenceResult);
+  }
 
-                       
+                                 // Compact the accumulated scores
+  postings_t scores;
+  accum_scores(accum, &scores);
+  return scores;
+}
+
+
+/********** topScores **********/
+/* Scores only the best k documents of a query, from impact blocks
+ *
+ * Caller provides:
+ *   index_t* idx - an index with impacts
+ *   plan_t* plan - the query's plan on idx, without phrases
+ *   int k - how many documents to find
+ * We return:
+ *   counters_t* scores - the k best documents (fewer if fewer match),
+ *   scored as disjunctOrSequence scores them
+ * Caller is responsible for:
+ *   Deleting the returned counters
+ */
+static counters_t* topScores(index_t* idx, plan_t* plan, int k)
+{
+  int numTerms = 0;
+  for (int b = 0; b < plan->numBranches; b++) {
+    numTerms += plan->branches[b].numTerms;
   }
+  impact_term_t* terms = mem_calloc_assert(numTerms + 1, sizeof(impact_term_t), "Couldn't allocate query terms");
 
-                                 // Retrieve the counter from the union and delete the structure
-  counters_t* scores = union_getCounter(uni);
-  union_pointerDelete(uni);
+  // each branch is a group of and'ed words, weighted by how often it was typed
+  numTerms = 0;
+  for (int b = 0; b < plan->numBranches; b++) {
+    const plan_branch_t* branch = &plan->branches[b];
+    for (int t = 0; t < branch->numTerms; t++) {
+      terms[numTerms].docs = index_get(idx, branch->terms[t].word);
+      terms[numTerms].impacts = index_getImpacts(idx, branch->terms[t].word);
+      terms[numTerms].group = b;
+      terms[numTerms].weight = branch->repeats;
+      numTerms++;
+    }
+  }
+  counters_t* scores = impact_topk(terms, numTerms, k);
 
+  for (int t = 0; t < numTerms; t++) {
+    postings_release(&terms[t].docs);
+    postings_release(&terms[t].impacts);
+  }
+  free(terms);
   return scores;
 }
 
 
-/********** conjunctAndSequence **********/
-/* Processes a conjunctive sequence (ANDs) of words from the query.
+/********** maxScores **********/
+/* Scores only the best k documents of a query, skipping the documents
+ * that can't make them
  *
  * Caller provides:
- *   index_t* idx - the index to query
- *   char** sequence - the full word sequence
- *   int* pos - pointer to the current word index 
- *   int start - original position where this segment started
+ *   index_t* idx - an index with bounds (see index_hasBounds)
+ *   plan_t* plan - the query's plan on idx
+ *   int k - how many documents to find
  * We return:
- *   A counters_t object of the document ID's and associated scores
+ *   counters_t* scores - the k best documents (fewer if fewer match),
+ *   scored as disjunctOrSequence scores them
  * Caller is responsible for:
  *   Deleting the returned counters
+ * Notes:
+ *   Each 'or' branch is one term for maxscore_topk: its intersection,
+ *   which for a single word is just the word's postings, bounded by the
+ *   lowest bound of its terms, since it scores a document by their lowest
+ *   count there.
  */
-static counters_t* conjunctAndSequence(index_t* idx, char** sequence, int* pos, int start)
+static counters_t* maxScores(index_t* idx, plan_t* plan, int k)
 {
-  union_t* uni = union_new();
-  
-  // Read sequence until we encounter end of sequence or an 'or'
-  for (; sequence[*pos] != NULL && strcmp(sequence[*pos], "or") != 0; (*pos)++) {
-    if (strcmp(sequence[*pos], "and") == 0) {
-      continue; // Skip explicit AND
+  maxscore_term_t* terms = mem_calloc_assert(plan->numBranches + 1, sizeof(maxscore_term_t), "Couldn't allocate query terms");
+  for (int b = 0; b < plan->numBranches; b++) {
+    const plan_branch_t* branch = &plan->branches[b];
+    terms[b].docs = conjunctAndSequence(idx, branch);
+    terms[b].weight = branch->repeats;
+    terms[b].bound = termBound(idx, &branch->terms[0]);
+    for (int t = 1; t < branch->numTerms; t++) {
+      int bound = termBound(idx, &branch->terms[t]);
+      terms[b].bound = bound < terms[b].bound ? bound : terms[b].bound;
     }
+  }
+  counters_t* scores = maxscore_topk(terms, plan->numBranches, k, NULL);
 
-    if ((*pos) == start) {
-      // First word: simply add its counter
-      union_disjunction(uni, index_get(idx, sequence[*pos]));
-    } else {
-      // Subsequent words: apply AND
-      union_conjunction(uni, index_get(idx, sequence[*pos]));
+  for (int b = 0; b < plan->numBranches; b++) {
+    postings_release(&terms[b].docs);
+  }
+  free(terms);
+  return scores;
+}
+
+
+/********** termBound **********/
+/* Returns the largest count a plan term can have in a document: the
+ * word's stored bound, or for a phrase, which occurs no more often than
+ * any of its words, the lowest bound of its indexed words
+ */
+static int termBound(index_t* idx, const plan_term_t* term)
+{
+  if (!term->phrase) {
+    return index_bound(idx, term->word);
+  }
+  char* words = mem_malloc_assert(strlen(term->word) + 1, "Couldn't allocate phrase");
+  strcpy(words, term->word);
+  int bound = INT_MAX;
+  char* rest;
+  for (char* word = strtok_r(words, " ", &rest); word != NULL; word = strtok_r(NULL, " ", &rest)) {
+    if (strlen(word) >= 3) {
+      int wordBound = index_bound(idx, word);
+      bound = wordBound < bound ? wordBound : bound;
     }
   }
-  
-  counters_t* ctr = union_getCounter(uni);
-  union_pointerDelete(uni);
+  free(words);
+  return bound == INT_MAX ? 0 : bound;
+}
+
+
+/********** conjunctAndSequence **********/
+/* Intersects the terms of one 'or' branch of a plan
+ *
+ * Caller provides:
+ *   index_t* idx - the index the plan was made on
+ *   const plan_branch_t* branch - the branch, cheapest term first
+ * We return:
+ *   The documents holding every term, each scored by its lowest count
+ * Caller is responsible for:
+ *   Calling postings_release on the result
+ * Notes:
+ *   The cheapest term's documents are narrowed by each dearer term in
+ *   turn, and once none are left the rest are never read, so a query
+ *   with one rare word costs about as much as that word's list.
+ */
+static postings_t conjunctAndSequence(index_t* idx, const plan_branch_t* branch)
+{
+  postings_t cheapest = termPostings(idx, &branch->terms[0]);
+  if (branch->numTerms == 1 || cheapest.size == 0) {
+    return cheapest;
+  }
+
+  // each result is narrowed by the next term into the other buffer; no
+  // result is larger than the cheapest list
+  postings_t buffers[2] = { postings_view(NULL, NULL, 0), postings_view(NULL, NULL, 0) };
+  postings_reserve(&buffers[0], cheapest.size);
+  postings_reserve(&buffers[1], cheapest.size);
+  const postings_t* sofar = &cheapest;
+  int into = 0;
+  for (int t = 1; t < branch->numTerms && sofar->size > 0; t++) {
+    postings_t list = termPostings(idx, &branch->terms[t]);
+    buffers[into].size = intersect_pair(sofar, &list, INTERSECT_AUTO, buffers[into].ids, buffers[into].counts);
+    postings_release(&list);
+    sofar = &buffers[into];
+    into = 1 - into;
+  }
+  postings_release(&cheapest);
+  postings_release(&buffers[into]);    // the one not written last
+  return buffers[1 - into];
+}
 
-       // return counter
-  return ctr;
+
+/********** termPostings **********/
+/* Returns the postings of a word, or the matches of a phrase; caller
+ * must postings_release them
+ */
+static postings_t termPostings(index_t* idx, const plan_term_t* term)
+{
+  return term->phrase ? phrasePostings(idx, term->word) : index_get(idx, term->word);
 }
 
 
+/********** phrasePostings **********/
+/* Finds the documents holding a quoted phrase
+ *
+ * Caller provides:
+ *   index_t* idx - a positional index
+ *   const char* phrase - the phrase's words separated by single spaces
+ * We return:
+ *   The documents holding the phrase, each counted by how often it
+ *   occurs there. Words shorter than three letters are dropped, since
+ *   the indexer skips them and they hold no positions.
+ * Caller is responsible for:
+ *   Calling postings_release on the result
+ */
+static postings_t phrasePostings(index_t* idx, const char* phrase)
+{
+  char* words = mem_malloc_assert(strlen(phrase) + 1, "Couldn't allocate phrase");
+  strcpy(words, phrase);
+  postings_t* lists = mem_calloc_assert(strlen(phrase) / 2 + 1, sizeof(postings_t), "Couldn't allocate phrase");
+  int numWords = 0;
+
+  // look up each indexed word of the phrase; strtok_r, as server threads
+  // may be doing the same
+  char* rest;
+  for (char* word = strtok_r(words, " ", &rest); word != NULL; word = strtok_r(NULL, " ", &rest)) {
+    if (strlen(word) >= 3) {
+      lists[numWords++] = index_get(idx, word);
+    }
+  }
+
+  postings_t matches;
+  if (numWords == 1) {
+    matches = lists[0];         // a phrase of one word is just that word
+  } else {
+    phrase_match(lists, numWords, &matches);
+    for (int i = 0; i < numWords; i++) {
+      postings_release(&lists[i]);
+    }
+  }
+  free(lists);
+  free(words);
+  return matches;
+}
+
+/********** hasPhrase **********/
+/* Returns true if a word sequence holds a quoted phrase */
+static bool hasPhrase(char** wordSequence)
+{
+  for (int i = 0; wordSequence[i] != NULL; i++) {
+    if (word_isPhrase(wordSequence[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
 /********* prompt ***********/
 /* From lab assignment readme
  * prompts only if a keyboard input
@@ -249,3 +875,640 @@ static void prompt(void)
     printf("Query? ");
   }
 }
+
+/********** serve **********/
+/* Answers clients of a Unix domain socket until SIGINT or SIGTERM
+ *
+ * Caller provides:
+ *   const char* socketPath - where to make the socket; a socket left
+ *     there by an earlier server is replaced, anything else is not
+ *   int numWorkers - threads to serve connections with
+ *   server_t* server - the index and what else queries need
+ * We return:
+ *   False if the socket couldn't be made, true once stopped
+ * Notes:
+ *   The main thread only accepts connections, queueing them for the
+ *   workers; each worker serves one connection at a time, to its end.
+ *   A client that finds CONNECTION_QUEUE others already waiting is
+ *   answered {"error":"server busy"} and hung up on.
+ *   When stopped, connections being served are shut for reading, so
+ *   their current answers are still sent, and the socket is removed.
+ */
+static bool serve(const char* socketPath, int numWorkers, server_t* server)
+{
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(socketPath) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "Socket path is too long\n");
+    return false;
+  }
+  strcpy(address.sun_path, socketPath);
+
+  struct stat info;
+  if (lstat(socketPath, &info) == 0 && S_ISSOCK(info.st_mode)) {
+    unlink(socketPath);
+  }
+  if ((listener = socket(AF_UNIX, SOCK_STREAM, 0)) < 0
+      || bind(listener, (struct sockaddr*) &address, sizeof(address)) != 0
+      || listen(listener, SOMAXCONN) != 0) {
+    perror("Couldn't make socket");
+    if (listener >= 0) {
+      close(listener);
+    }
+    return false;
+  }
+
+  // no SA_RESTART, so accept returns when we are stopped; a client that
+  // hangs up early must not kill the server with SIGPIPE
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = stopServing;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  // the workers start with the stop signals blocked, so only this thread
+  // takes them
+  sigset_t stops;
+  sigemptyset(&stops);
+  sigaddset(&stops, SIGINT);
+  sigaddset(&stops, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &stops, NULL);
+  server->connections = bqueue_new(CONNECTION_QUEUE);
+  pthread_mutex_init(&server->lock, NULL);
+  worker_t* workers = mem_calloc_assert(numWorkers, sizeof(worker_t), "Couldn't allocate workers");
+  for (int i = 0; i < numWorkers; i++) {
+    workers[i].server = server;
+    workers[i].fd = -1;
+    if (pthread_create(&workers[i].thread, NULL, serveConnections, &workers[i]) != 0) {
+      fprintf(stderr, "Couldn't start server thread\n");
+      exit(-1);
+    }
+  }
+  pthread_sigmask(SIG_UNBLOCK, &stops, NULL);
+  fprintf(stderr, "Serving %s with %d threads\n", socketPath, numWorkers);
+
+  while (!stopping) {
+    int fd = accept(listener, NULL, NULL);
+    if (fd < 0) {
+      if (errno != EINTR && errno != ECONNABORTED && !stopping) {
+        perror("Couldn't accept connection");
+      }
+      continue;
+    }
+    // with every worker busy and the queue full, turn the client away
+    // rather than stop accepting
+    int* connection = mem_malloc_assert(sizeof(int), "Couldn't allocate connection");
+    *connection = fd;
+    if (!bqueue_tryPush(server->connections, connection)) {
+      static const char busy[] = "{\"error\":\"server busy\"}\n";
+      write(fd, busy, sizeof(busy) - 1);     // best effort; the client may be gone
+      closeConnection(connection);
+    }
+  }
+
+  // let the workers finish what they are answering, then drain the queue
+  bqueue_close(server->connections);
+  pthread_mutex_lock(&server->lock);
+  server->closing = true;
+  for (int i = 0; i < numWorkers; i++) {
+    if (workers[i].fd >= 0) {
+      shutdown(workers[i].fd, SHUT_RD);
+    }
+  }
+  pthread_mutex_unlock(&server->lock);
+  for (int i = 0; i < numWorkers; i++) {
+    pthread_join(workers[i].thread, NULL);
+  }
+  fprintf(stderr, "Stopped serving %s\n", socketPath);
+  printCacheStats(server->engine);
+
+  free(workers);
+  bqueue_delete(server->connections, closeConnection);
+  pthread_mutex_destroy(&server->lock);
+  close(listener);
+  unlink(socketPath);
+  return true;
+}
+
+/********** serveConnections **********/
+/* Server thread: serves queued connections, one at a time, until the
+ * queue is closed and empty; connections popped once the server is
+ * closing are just closed
+ *
+ * arg: the worker_t
+ */
+static void* serveConnections(void* arg)
+{
+  worker_t* worker = (worker_t*) arg;
+  server_t* server = worker->server;
+  loaded_t* loaded = acquireIndex(server->engine);
+  accum_t* accum = newAccum(loaded->idx, NULL);    // this thread's OR scores
+  releaseIndex(server->engine, loaded);
+  int* connection;
+  while ((connection = bqueue_pop(server->connections)) != NULL) {
+    int fd = *connection;
+    free(connection);
+
+    // registered under the lock, so a closing server either sees the
+    // connection to shut it or we see that it is closing
+    pthread_mutex_lock(&server->lock);
+    bool closing = server->closing;
+    if (!closing) {
+      worker->fd = fd;
+    }
+    pthread_mutex_unlock(&server->lock);
+    if (!closing) {
+      answerClient(server, fd, accum);
+    }
+    pthread_mutex_lock(&server->lock);
+    worker->fd = -1;
+    pthread_mutex_unlock(&server->lock);
+    close(fd);
+  }
+  accum_delete(accum);
+  return NULL;
+}
+
+/********** answerClient **********/
+/* Reads queries from a connection, one per line, answering each with a
+ * line of JSON (see answerQuery), until the client hangs up
+ */
+static void answerClient(server_t* server, int fd, accum_t* accum)
+{
+  int readFd = dup(fd);
+  int writeFd = dup(fd);
+  FILE* in = readFd < 0 ? NULL : fdopen(readFd, "r");
+  FILE* out = writeFd < 0 ? NULL : fdopen(writeFd, "w");
+  char* query;
+  while (in != NULL && out != NULL && (query = file_readLine(in)) != NULL) {
+    answerQuery(out, query, server->engine, accum, false);
+    free(query);
+    if (fflush(out) != 0) {
+      break;                    // the client is gone
+    }
+  }
+  if (in != NULL) {
+    fclose(in);
+  } else if (readFd >= 0) {
+    close(readFd);
+  }
+  if (out != NULL) {
+    fclose(out);
+  } else if (writeFd >= 0) {
+    close(writeFd);
+  }
+}
+
+/********** runBatch **********/
+/* Answers every query of a file, "-" for stdin, on numThreads threads
+ *
+ * Caller provides:
+ *   The query file, a thread count from 1 to MAX_WORKERS, and a batch
+ *   whose engine is set and the rest zero
+ * We do:
+ *   Read every query, start the threads (see answerBatch), and print
+ *   each answer to stdout as soon as it and all before it are ready, so
+ *   the answers come in the order of the queries; then print to stderr
+ *   how long the batch took and how long its queries took
+ * We return:
+ *   False if the file can't be read or no thread can be started
+ */
+static bool runBatch(const char* batchFilename, int numThreads, batch_t* batch)
+{
+  FILE* fp = strcmp(batchFilename, "-") == 0 ? stdin : fopen(batchFilename, "r");
+  if (fp == NULL) {
+    fprintf(stderr, "Couldn't read %s\n", batchFilename);
+    return false;
+  }
+  int capacity = 64;
+  batch->queries = mem_malloc_assert(capacity * sizeof(char*), "Couldn't allocate queries");
+  char* query;
+  while ((query = file_readLine(fp)) != NULL) {
+    if (batch->numQueries == capacity) {
+      capacity *= 2;
+      batch->queries = realloc(batch->queries, capacity * sizeof(char*));
+      mem_assert(batch->queries, "Couldn't grow queries");
+    }
+    batch->queries[batch->numQueries++] = query;
+  }
+  if (fp != stdin) {
+    fclose(fp);
+  }
+  int numQueries = batch->numQueries;
+  batch->answers = mem_calloc_assert(numQueries + 1, sizeof(char*), "Couldn't allocate answers");
+  batch->seconds = mem_calloc_assert(numQueries + 1, sizeof(double), "Couldn't allocate latencies");
+  pthread_mutex_init(&batch->lock, NULL);
+  pthread_cond_init(&batch->answered, NULL);
+
+  if (numThreads > numQueries) {
+    numThreads = numQueries > 0 ? numQueries : 1;
+  }
+  double start = clock_now();
+  pthread_t threads[MAX_WORKERS];
+  int started = 0;
+  while (started < numThreads && pthread_create(&threads[started], NULL, answerBatch, batch) == 0) {
+    started++;
+  }
+  if (started == 0) {
+    fprintf(stderr, "Couldn't start threads\n");
+  }
+
+  // each answer in turn, waiting for it if a thread still has it
+  for (int i = 0; i < numQueries && started > 0; i++) {
+    pthread_mutex_lock(&batch->lock);
+    while (batch->answers[i] == NULL) {
+      pthread_cond_wait(&batch->answered, &batch->lock);
+    }
+    pthread_mutex_unlock(&batch->lock);
+    fputs(batch->answers[i], stdout);
+  }
+  fflush(stdout);
+  for (int t = 0; t < started; t++) {
+    pthread_join(threads[t], NULL);
+  }
+  double wall = clock_now() - start;
+
+  if (started > 0 && numQueries > 0) {
+    double sum = 0;
+    for (int i = 0; i < numQueries; i++) {
+      sum += batch->seconds[i];
+    }
+    qsort(batch->seconds, numQueries, sizeof(double), compareDoubles);
+    fprintf(stderr, "%d queries in %.3f s on %d thread%s: %.1f queries/s\n",
+            numQueries, wall, started, started == 1 ? "" : "s", numQueries / wall);
+    fprintf(stderr, "latency: mean %.1f us, median %.1f us, 99th percentile %.1f us\n",
+            sum / numQueries * 1e6, batch->seconds[numQueries / 2] * 1e6,
+            batch->seconds[(numQueries * 99 + 99) / 100 - 1] * 1e6);
+    printCacheStats(batch->engine);
+  }
+
+  for (int i = 0; i < numQueries; i++) {
+    free(batch->queries[i]);
+    free(batch->answers[i]);
+  }
+  free(batch->queries);
+  free(batch->answers);
+  free(batch->seconds);
+  pthread_cond_destroy(&batch->answered);
+  pthread_mutex_destroy(&batch->lock);
+  return started > 0;
+}
+
+/********** answerBatch **********/
+/* Batch thread: takes the next unanswered query until there are none,
+ * writing its answer into a string of its own, then storing it with
+ * how long the query took
+ *
+ * arg: the batch_t
+ */
+static void* answerBatch(void* arg)
+{
+  batch_t* batch = (batch_t*) arg;
+  loaded_t* loaded = acquireIndex(batch->engine);
+  accum_t* accum = newAccum(loaded->idx, NULL);    // this thread's OR scores
+  releaseIndex(batch->engine, loaded);
+  while (true) {
+    pthread_mutex_lock(&batch->lock);
+    int i = batch->nextQuery < batch->numQueries ? batch->nextQuery++ : -1;
+    pthread_mutex_unlock(&batch->lock);
+    if (i < 0) {
+      break;
+    }
+    char* answer = NULL;
+    size_t length = 0;
+    FILE* fp = open_memstream(&answer, &length);
+    mem_assert(fp, "Couldn't open answer");
+    double seconds = answerQuery(fp, batch->queries[i], batch->engine, accum, true);
+    fclose(fp);
+
+    pthread_mutex_lock(&batch->lock);
+    batch->answers[i] = answer;
+    batch->seconds[i] = seconds;
+    pthread_cond_broadcast(&batch->answered);
+    pthread_mutex_unlock(&batch->lock);
+  }
+  accum_delete(accum);
+  return NULL;
+}
+
+/********** answerQuery **********/
+/* Answers one query with a line of JSON (see printJsonAnswer); an
+ * invalid query is answered with what it was and why:
+ *
+ *   {"query":"...","error":"..."}
+ *
+ * Caller provides:
+ *   Where to print, the query, which is normalized in place, what to
+ *   answer it with, an accumulator of this thread's, and whether the
+ *   line should say how long the query took, in "micros"
+ * We return:
+ *   The seconds the query took to parse and rank
+ */
+static double answerQuery(FILE* fp, char* query, engine_t* engine, accum_t* accum, bool timed)
+{
+  char* line = mem_malloc_assert(strlen(query) + 1, "Couldn't allocate query");
+  strcpy(line, query);
+  double start = clock_now();
+  loaded_t* loaded = acquireIndex(engine);
+  const char* error;
+  char** wordSequence = parseQuery(query, loaded->idx, NULL, &error);
+  scoreboard_t* board = wordSequence == NULL || wordSequence[0] == NULL ? NULL
+                        : rankCached(engine->cache, loaded, wordSequence, engine->k, accum);
+  double seconds = clock_now() - start;
+
+  if (wordSequence == NULL) {
+    fprintf(fp, "{\"query\":");
+    printJsonString(fp, line);
+    fprintf(fp, ",\"error\":");
+    printJsonString(fp, error);
+    if (timed) {
+      fprintf(fp, ",\"micros\":%.1f", seconds * 1e6);
+    }
+    fprintf(fp, "}\n");
+  } else {
+    printJsonAnswer(fp, wordSequence, board, engine, loaded->docs, timed ? seconds : -1);
+  }
+  releaseIndex(engine, loaded);
+  scoreboard_delete(board);
+  free(wordSequence);
+  free(line);
+  return seconds;
+}
+
+/********** printJsonAnswer **********/
+/* Prints a query's answer as one line of JSON:
+ *
+ *   {"query":"...","matches":n,"results":[{"score":s,"doc":d,"url":"..."},...]}
+ *
+ * with the normalized query, phrases quoted, how many documents matched
+ * (null if the impact path didn't count them), and the ranked results,
+ * with URLs from docs if it has them; a NULL board is a blank query,
+ * with no matches. Unless seconds is negative, a last "micros" field
+ * gives how long the query took.
+ */
+static void printJsonAnswer(FILE* fp, char** wordSequence, scoreboard_t* board,
+                            engine_t* engine, docmap_t* docs, double seconds)
+{
+  fprintf(fp, "{\"query\":\"");
+  for (int i = 0; wordSequence[i] != NULL; i++) {
+    // words are letters and spaces by now, so only the quotes need escaping
+    fprintf(fp, word_isPhrase(wordSequence[i]) ? "%s\\\"%s\\\"" : "%s%s", i > 0 ? " " : "",
+            wordSequence[i]);
+  }
+  int total = scoreboard_total(board);
+  if (total == SCOREBOARD_UNKNOWN) {
+    fprintf(fp, "\",\"matches\":null,\"results\":[");
+  } else {
+    fprintf(fp, "\",\"matches\":%d,\"results\":[", total);
+  }
+  int id, score;
+  for (int i = 0; scoreboard_get(board, i, &id, &score); i++) {
+    const char* URL = docmap_url(docs, id);
+    char* pageURL = URL == NULL ? pagedir_getURL(engine->pageDirectory, id) : NULL;
+    fprintf(fp, "%s{\"score\":%d,\"doc\":%d,\"url\":", i > 0 ? "," : "", score, id);
+    printJsonString(fp, URL != NULL ? URL : pageURL);
+    fprintf(fp, "}");
+    free(pageURL);
+  }
+  fprintf(fp, "]");
+  if (seconds >= 0) {
+    fprintf(fp, ",\"micros\":%.1f", seconds * 1e6);
+  }
+  fprintf(fp, "}\n");
+}
+
+/********** printJsonString **********/
+/* Prints a string as a JSON string literal, null if it is NULL */
+static void printJsonString(FILE* fp, const char* string)
+{
+  if (string == NULL) {
+    fprintf(fp, "null");
+    return;
+  }
+  putc('"', fp);
+  for (const unsigned char* c = (const unsigned char*) string; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      fprintf(fp, "\\%c", *c);
+    } else if (*c < 0x20) {
+      fprintf(fp, "\\u%04x", *c);
+    } else {
+      putc(*c, fp);
+    }
+  }
+  putc('"', fp);
+}
+
+/********** stopServing **********/
+/* SIGINT and SIGTERM handler: marks the server stopping and shuts the
+ * listening socket, which wakes the accept; both are async-signal-safe
+ */
+static void stopServing(int signum)
+{
+  stopping = 1;
+  if (listener >= 0) {
+    shutdown(listener, SHUT_RDWR);
+  }
+}
+
+/********** closeConnection **********/
+/* bqueue_delete helper closing a connection no worker took */
+static void closeConnection(void* item)
+{
+  close(*(int*) item);
+  free(item);
+}
+
+/********** printCacheStats **********/
+/* Prints to stderr how the engine's caches did, a line for each it has;
+ * the decoded lists are the current index's. No query may be running.
+ */
+static void printCacheStats(engine_t* engine)
+{
+  if (engine->cache != NULL) {
+    querycache_stats_t stats;
+    querycache_stats(engine->cache, &stats);
+    long lookups = stats.hits + stats.misses;
+    fprintf(stderr, "cache: %ld hits, %ld misses (%.1f%% hit), %ld evicted, %ld invalidated, "
+            "%d entries in %zu of %zu bytes\n", stats.hits, stats.misses,
+            lookups > 0 ? 100.0 * stats.hits / lookups : 0.0, stats.evictions, stats.invalidations,
+            stats.entries, stats.bytes, stats.budget);
+  }
+  if (engine->loaded->decoded != NULL) {
+    postcache_stats_t stats;
+    postcache_stats(engine->loaded->decoded, &stats);
+    long lookups = stats.hits + stats.misses;
+    fprintf(stderr, "decoded lists: %ld hits, %ld misses (%.1f%% hit), %ld admitted, %ld rejected, "
+            "%ld evicted, %d lists in %zu of %zu bytes\n", stats.hits, stats.misses,
+            lookups > 0 ? 100.0 * stats.hits / lookups : 0.0, stats.admitted, stats.rejected,
+            stats.evicted, stats.entries, stats.bytes, stats.budget);
+  }
+}
+
+/********** compareDoubles **********/
+/* qsort comparator ordering doubles from smallest to largest */
+static int compareDoubles(const void* first, const void* second)
+{
+  double a = *(const double*) first;
+  double b = *(const double*) second;
+  return (a > b) - (a < b);
+}
+
+/********** newAccum **********/
+/* Creates an accumulator whose dense block just covers the docIDs of idx
+ * and full (which may be NULL), but never more than ACCUM_DENSE_DOCS;
+ * a small index doesn't need the whole block per thread
+ */
+static accum_t* newAccum(index_t* idx, index_t* full)
+{
+  int maxID = index_maxDocID(idx);
+  int fullMax = index_maxDocID(full);
+  maxID = fullMax > maxID ? fullMax : maxID;
+  return accum_new(maxID < ACCUM_DENSE_DOCS ? maxID + 1 : ACCUM_DENSE_DOCS);
+}
+
+/********** loadIndex **********/
+/* Loads (or maps) an index, with the crawl's manifest and, if the
+ * index's lists are decoded, a cache of them in decodedBudget bytes;
+ * returns NULL if the index can't be loaded. The engine holds it.
+ */
+static loaded_t* loadIndex(char* indexFilename, const char* pageDirectory, size_t decodedBudget)
+{
+  index_t* idx = index_reconstruct(indexFilename);
+  if (idx == NULL) {
+    return NULL;
+  }
+  loaded_t* loaded = mem_calloc_assert(1, sizeof(loaded_t), "Couldn't allocate index");
+  loaded->idx = idx;
+  loaded->docs = docmap_open(pageDirectory);
+  loaded->decoded = postcache_new(decodedBudget);
+  if (!index_setCache(idx, loaded->decoded)) {     // lists already in memory need none
+    postcache_delete(loaded->decoded);
+    loaded->decoded = NULL;
+  }
+  loaded->holders = 1;
+  return loaded;
+}
+
+/********** unloadIndex **********/
+/* Frees a loaded index and what was loaded with it; nothing if NULL */
+static void unloadIndex(loaded_t* loaded)
+{
+  if (loaded != NULL) {
+    docmap_close(loaded->docs);
+    index_delete(loaded->idx);
+    postcache_delete(loaded->decoded);
+    free(loaded);
+  }
+}
+
+/********** acquireIndex **********/
+/* Returns the engine's current index for a query to hold, first loading
+ * the index file again if it has changed since it was loaded (see
+ * reloadIndex); the query hands it back with releaseIndex
+ */
+static loaded_t* acquireIndex(engine_t* engine)
+{
+  identity_t identity;
+  readIdentity(engine->indexFilename, &identity);
+
+  pthread_mutex_lock(&engine->lock);
+  if (!engine->reloading && !sameIdentity(&identity, &engine->identity)) {
+    // this thread loads it; the others keep answering from the old one
+    engine->identity = identity;
+    engine->reloading = true;
+    pthread_mutex_unlock(&engine->lock);
+    reloadIndex(engine);
+    pthread_mutex_lock(&engine->lock);
+  }
+  loaded_t* loaded = engine->loaded;
+  loaded->holders++;
+  pthread_mutex_unlock(&engine->lock);
+  return loaded;
+}
+
+/********** reloadIndex **********/
+/* Loads the changed index file and swaps it in for the engine's index,
+ * clearing the cache of answers, without the lock held while it loads;
+ * the old index is freed once the last query holding it is done. If the
+ * new one can't be loaded, the old one stays.
+ */
+static void reloadIndex(engine_t* engine)
+{
+  loaded_t* fresh = loadIndex(engine->indexFilename, engine->pageDirectory,
+                              engine->decodedBudget);
+  loaded_t* old = NULL;
+  pthread_mutex_lock(&engine->lock);
+  if (fresh != NULL) {
+    // cleared before fresh is handed out, so answers from the old index
+    // that are still being ranked aren't cached
+    fresh->version = querycache_clear(engine->cache);
+    old = engine->loaded;
+    engine->loaded = fresh;
+    if (--old->holders > 0) {
+      old = NULL;                // its last query frees it
+    }
+  }
+  engine->reloading = false;
+  pthread_mutex_unlock(&engine->lock);
+
+  unloadIndex(old);
+  if (fresh != NULL) {
+    fprintf(stderr, "Reloaded %s\n", engine->indexFilename);
+  } else {
+    fprintf(stderr, "Couldn't reload %s; still answering from the old index\n",
+            engine->indexFilename);
+  }
+}
+
+/********** releaseIndex **********/
+/* Hands back an index from acquireIndex, freeing it if it has been
+ * replaced and this was its last query
+ */
+static void releaseIndex(engine_t* engine, loaded_t* loaded)
+{
+  pthread_mutex_lock(&engine->lock);
+  bool last = --loaded->holders == 0;
+  pthread_mutex_unlock(&engine->lock);
+  if (last) {
+    unloadIndex(loaded);
+  }
+}
+
+/********** closeEngine **********/
+/* Frees the engine's cache and index, once no query holds it */
+static void closeEngine(engine_t* engine)
+{
+  querycache_delete(engine->cache);
+  unloadIndex(engine->loaded);
+  pthread_mutex_destroy(&engine->lock);
+}
+
+/********** readIdentity **********/
+/* Reads what identifies the current version of a file; a file that
+ * can't be stat'ed is one that doesn't exist
+ */
+static void readIdentity(const char* filename, identity_t* identity)
+{
+  struct stat status;
+  memset(identity, 0, sizeof(identity_t));
+  if (stat(filename, &status) == 0) {
+    identity->exists = true;
+    identity->device = status.st_dev;
+    identity->inode = status.st_ino;
+    identity->size = status.st_size;
+    identity->modified = status.st_mtim;
+  }
+}
+
+/********** sameIdentity **********/
+/* Returns true if two identities are of the same version of a file */
+static bool sameIdentity(const identity_t* first, const identity_t* second)
+{
+  return first->exists == second->exists && first->device == second->device
+         && first->inode == second->inode && first->size == second->size
+         && first->modified.tv_sec == second->modified.tv_sec
+         && first->modified.tv_nsec == second->modified.tv_nsec;
+}
@@ -40,5 +40,120 @@
 ./querier ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.index < testingFiles/wikipedia-1-queries.txt
 
 
-# Valgrind test
-valgrind ./querier ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.index < testingFiles/wikipedia-1-queries.txt
+# On a binary index (mapped, not parsed)
+../indexer/indexer -b ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.bindex
+./querier ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.bindex < testingFiles/wikipedia-1-queries.txt
+
+# On a compressed binary index (postings decoded per query term)
+../indexer/indexer -c ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.cindex
+./querier ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.cindex < testingFiles/wikipedia-1-queries.txt
+
+# Phrases on a positional index, then on one without positions
+../indexer/indexer -p ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.pindex
+./querier ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.pindex < testingFiles/toscrape-1-phrases.txt
+./querier ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index < testingFiles/toscrape-1-phrases.txt
+
+# Repeated words and 'or' branches, in any order, are read once but score
+# as typed ("year or year" twice "year"), and a branch with a missing word
+# matches nothing without reading the rest
+./querier ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.pindex < testingFiles/toscrape-1-plans.txt
+
+
+# Top k on an impact-ordered index reads only the best blocks; it
+# gives the same top k as scoring every match on the text index, which
+# also reports how many matched in all, so only the ranked lines are compared
+../indexer/indexer -i ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.iindex
+./querier -k 5 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.iindex < testingFiles/toscrape-1-queries.txt | grep Score > toscrape.itop
+./querier -k 5 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index < testingFiles/toscrape-1-queries.txt | grep Score | cmp - toscrape.itop && echo "same top 5"
+
+# Top 3 of every match, with how many matched
+./querier -k 3 ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.index < testingFiles/wikipedia-1-queries.txt
+rm -f toscrape.itop
+
+# URLs from the manifest the indexer wrote for the crawl, and read from
+# the pages themselves once it is moved aside, are the same
+./querier ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index < testingFiles/toscrape-1-queries.txt > toscrape.docmap
+mv ../data/toscrape-depth-1/.docmap ../data/toscrape-depth-1/.docmap.saved
+./querier ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index < testingFiles/toscrape-1-queries.txt | cmp - toscrape.docmap && echo "same URLs"
+mv ../data/toscrape-depth-1/.docmap.saved ../data/toscrape-depth-1/.docmap
+rm -f toscrape.docmap
+
+# Serve the index on a Unix socket to two clients at once; each gets
+# one JSON line per query, the same for both, and SIGINT stops the server
+./querier -j 2 --serve querier.sock ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index &
+sleep 1
+for client in 1 2; do
+  python3 -c 'import socket, sys; s = socket.socket(socket.AF_UNIX); s.connect(sys.argv[1]); s.sendall(open(sys.argv[2], "rb").read()); s.shutdown(socket.SHUT_WR); sys.stdout.write(s.makefile().read())' querier.sock testingFiles/toscrape-1-queries.txt > client$client.out &
+done
+wait %2 %3
+head -3 client1.out
+cmp client1.out client2.out && echo "same answers"
+kill -INT %1
+wait %1
+
+# The same queries as a batch on two threads: the same answers, in order,
+# each with its time, then a summary of throughput and latency
+./querier -j 2 --batch testingFiles/toscrape-1-queries.txt ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index > batch.out
+sed 's/,"micros":[0-9.]*//' batch.out | cmp - client1.out && echo "same answers in order"
+rm -f client1.out client2.out batch.out
+
+# Batch and serve at once
+./querier --batch testingFiles/toscrape-1-queries.txt --serve querier.sock ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index
+
+# A pruned index against the full one: top 10 overlap per query and on average
+../indexer/indexer -s 50 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.sindex
+./querier -e ../data/toscrape-depth-1/toscrape.index ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.sindex < testingFiles/toscrape-1-queries.txt
+
+# Two-word AND queries on frequent words, every way, checked against each other
+../indexer/indexer -b ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.bindex
+./andbench ../data/toscrape-depth-1/toscrape.bindex 5
+
+# Wide OR queries on frequent words, dense and paged accumulators and the counters set
+./orbench ../data/toscrape-depth-1/toscrape.bindex 5
+
+# Top 10 of OR queries, exhaustively and by MaxScore with the stored bounds, checked against each other
+./topkbench ../data/toscrape-depth-1/toscrape.bindex testingFiles/toscrape-1-plans.txt 10 5
+
+# Top 3 by MaxScore on the binary index: the same scores as ranking everything on the text index
+./querier -k 3 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.bindex < testingFiles/toscrape-1-queries.txt | grep Score > topk.out
+./querier -k 3 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index < testingFiles/toscrape-1-queries.txt | grep Score | cmp - topk.out && echo "same top 3"
+rm -f topk.out
+
+# Every query twice: the second answered from the cache, with the same answers as with no cache;
+# the summary counts the hits and misses
+cat testingFiles/toscrape-1-queries.txt testingFiles/toscrape-1-queries.txt > repeat.txt
+./querier --batch repeat.txt ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index | sed 's/,"micros":[0-9.]*//' > cached.out
+./querier -c 0 --batch repeat.txt ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index 2> /dev/null | sed 's/,"micros":[0-9.]*//' | cmp - cached.out && echo "same answers from the cache"
+rm -f repeat.txt cached.out
+
+# Every query twice on the compressed index, with no cache of answers: the second decodes nothing,
+# with the same answers as with no cache of decoded lists; the summary counts the hits and misses
+cat testingFiles/wikipedia-1-queries.txt testingFiles/wikipedia-1-queries.txt > repeat.txt
+./querier -c 0 --batch repeat.txt ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.cindex | sed 's/,"micros":[0-9.]*//' > decoded.out
+./querier -c 0 -d 0 --batch repeat.txt ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.cindex 2> /dev/null | sed 's/,"micros":[0-9.]*//' | cmp - decoded.out && echo "same answers from decoded lists"
+rm -f repeat.txt decoded.out
+
+# An index rebuilt while the querier runs is loaded again and the cache emptied:
+# the same query, before and after, is answered from the index of the time
+../indexer/indexer ../data/letters-depth-0 live.index
+{ echo "the"; ../indexer/indexer ../data/letters-depth-10 live.index; echo "the"; } | ./querier ../data/letters-depth-10 live.index
+rm -f live.index
+
+# Bad cache size
+./querier -c -1 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index
+
+# Bad decoded cache size
+./querier -d -1 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.index
+
+# Bad result count
+./querier -k 0 ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.iindex
+
+# Missing full index
+./querier -e ../data/toscrape-depth-1/none.index ../data/toscrape-depth-1 ../data/toscrape-depth-1/toscrape.sindex
+
+# Valgrind test, where valgrind is installed
+if command -v valgrind > /dev/null; then
+  valgrind ./querier ../data/wikipedia-depth-1 ../data/wikipedia-depth-1/wikipedia.index < testingFiles/wikipedia-1-queries.txt
+else
+  echo "valgrind isn't installed; memory check skipped"
+fi
@@ -0,0 +1,215 @@
+/*
+ * topkbench.c - CS50 'topkbench' module
+ *
+ * This module times the top k of every query of a query log two ways:
+ * exhaustively, as the querier ranks a query without -k, by adding every
+ * posting of every 'or' branch into the accumulator and keeping the best
+ * k of all the scores; and with the maxscore module, which visits the
+ * branches' postings in docID order and skips the documents that can't
+ * make the top k. Each query is planned on the index first (see plan.h),
+ * and its branches intersected, once, outside the timing, so only the
+ * OR and the ranking are timed. Every top k is checked against the
+ * exhaustive one, document by document. Queries with phrases, and
+ * invalid ones, are skipped.
+ *
+ * usage: ./topkbench indexFilename queryFile [k] [rounds]
+ *
+ * Arthur Ufongene, May 2025
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "mem.h"
+#include "clock.h"
+#include "file.h"
+#include "word.h"
+#include "index.h"
+#include "plan.h"
+#include "intersect.h"
+#include "accum.h"
+#include "maxscore.h"
+#include "scoreboard.h"
+
+// the ways to find a query's top k
+typedef enum { BY_EXHAUSTIVE, BY_MAXSCORE, NUM_WAYS } way_t;
+static const char* WAY_NAMES[NUM_WAYS] = { "exhaustive", "maxscore" };
+
+// Function prototypes
+int main(int argc, char* argv[]);
+static int branchTerms(index_t* idx, plan_t* plan, maxscore_term_t* terms);
+static scoreboard_t* answer(way_t way, accum_t* accum, maxscore_term_t* terms, int numTerms,
+                            int k, maxscore_stats_t* stats);
+static bool sameBoards(scoreboard_t* first, scoreboard_t* second);
+
+/**************** main ****************/
+/* Loads the index, then times and checks every query of the log */
+int main(int argc, char* argv[])
+{
+  if (argc < 3 || argc > 5) {
+    fprintf(stderr, "usage: %s indexFilename queryFile [k] [rounds]\n", argv[0]);
+    exit(1);
+  }
+  int k = argc >= 4 ? atoi(argv[3]) : 10;
+  int rounds = argc == 5 ? atoi(argv[4]) : 20;
+  if (k < 1 || rounds < 1) {
+    fprintf(stderr, "k and rounds must be positive integers\n");
+    exit(1);
+  }
+  index_t* idx = index_reconstruct(argv[1]);
+  if (idx == NULL) {
+    fprintf(stderr, "Couldn't load index %s\n", argv[1]);
+    exit(2);
+  }
+  FILE* fp = fopen(argv[2], "r");
+  if (fp == NULL) {
+    fprintf(stderr, "Couldn't read query file %s\n", argv[2]);
+    index_delete(idx);
+    exit(2);
+  }
+
+  int maxID = index_maxDocID(idx);
+  accum_t* accum = accum_new(maxID < ACCUM_DENSE_DOCS ? maxID + 1 : ACCUM_DENSE_DOCS);
+  double seconds[NUM_WAYS] = { 0 };
+  long long postings = 0;
+  long long scored = 0;
+  int queries = 0;
+  int skipped = 0;
+  int bad = 0;
+  char* query;
+  while ((query = file_readLine(fp)) != NULL) {
+    char** wordSequence = word_decomposeSequence(query);
+    bool usable = wordSequence != NULL && wordSequence[0] != NULL;
+    if (usable) {
+      word_normalizeSequence(wordSequence);
+      usable = word_checkSyntax(wordSequence);
+      for (int i = 0; usable && wordSequence[i] != NULL; i++) {
+        usable = !word_isPhrase(wordSequence[i]);
+      }
+    }
+    if (!usable) {
+      skipped++;
+      free(wordSequence);
+      free(query);
+      continue;
+    }
+
+    // the branches, intersected once, then each way timed over them
+    plan_t* plan = plan_new(idx, wordSequence);
+    maxscore_term_t* terms = mem_calloc_assert(plan->numBranches + 1, sizeof(maxscore_term_t), "Couldn't allocate terms");
+    int numTerms = branchTerms(idx, plan, terms);
+    scoreboard_t* boards[NUM_WAYS];
+    maxscore_stats_t stats;
+    for (way_t way = 0; way < NUM_WAYS; way++) {
+      boards[way] = answer(way, accum, terms, numTerms, k, &stats);
+      double start = clock_now();
+      for (int r = 0; r < rounds; r++) {
+        scoreboard_delete(answer(way, accum, terms, numTerms, k, &stats));
+      }
+      seconds[way] += clock_now() - start;
+    }
+    if (!sameBoards(boards[BY_EXHAUSTIVE], boards[BY_MAXSCORE])) {
+      bad++;
+      fprintf(stderr, "Different top %d for: %s\n", k, query);
+    }
+    postings += stats.postings;
+    scored += stats.scored;
+    queries++;
+
+    for (way_t way = 0; way < NUM_WAYS; way++) {
+      scoreboard_delete(boards[way]);
+    }
+    for (int t = 0; t < numTerms; t++) {
+      postings_release(&terms[t].docs);
+    }
+    free(terms);
+    plan_delete(plan);
+    free(wordSequence);
+    free(query);
+  }
+  fclose(fp);
+
+  printf("index:            %s\n", argv[1]);
+  printf("queries:          %d (%d skipped)\n", queries, skipped);
+  printf("k:                %d\n", k);
+  printf("stored bounds:    %s\n", index_hasBounds(idx) ? "yes" : "no, read off the postings");
+  for (way_t way = 0; way < NUM_WAYS && queries > 0; way++) {
+    printf("%-18s%.1f us per query\n", WAY_NAMES[way], seconds[way] / queries / rounds * 1e6);
+  }
+  if (queries > 0 && seconds[BY_MAXSCORE] > 0) {
+    printf("speedup:          %.2fx\n", seconds[BY_EXHAUSTIVE] / seconds[BY_MAXSCORE]);
+  }
+  printf("documents scored: %lld of %lld postings\n", scored, postings);
+  printf("answers:          %s\n", bad == 0 ? "ok" : "FAILED");
+
+  accum_delete(accum);
+  index_delete(idx);
+  return bad == 0 ? 0 : 3;
+}
+
+/**************** branchTerms ****************/
+/* Fills terms with one term per branch of the plan: the intersection of
+ * its words, bounded by their lowest bound, and weighted by how often
+ * the branch was typed; returns how many
+ */
+static int branchTerms(index_t* idx, plan_t* plan, maxscore_term_t* terms)
+{
+  for (int b = 0; b < plan->numBranches; b++) {
+    const plan_branch_t* branch = &plan->branches[b];
+    postings_t* lists = mem_calloc_assert(branch->numTerms, sizeof(postings_t), "Couldn't allocate lists");
+    terms[b].bound = 0;
+    for (int t = 0; t < branch->numTerms; t++) {
+      lists[t] = index_get(idx, branch->terms[t].word);
+      int bound = index_bound(idx, branch->terms[t].word);
+      terms[b].bound = t == 0 || bound < terms[b].bound ? bound : terms[b].bound;
+    }
+    intersect_lists(lists, branch->numTerms, &terms[b].docs);
+    for (int t = 0; t < branch->numTerms; t++) {
+      postings_release(&lists[t]);
+    }
+    free(lists);
+    terms[b].weight = branch->repeats;
+  }
+  return plan->numBranches;
+}
+
+/**************** answer ****************/
+/* Finds the top k of the terms one way */
+static scoreboard_t* answer(way_t way, accum_t* accum, maxscore_term_t* terms, int numTerms,
+                            int k, maxscore_stats_t* stats)
+{
+  if (way == BY_MAXSCORE) {
+    counters_t* scores = maxscore_topk(terms, numTerms, k, stats);
+    scoreboard_t* board = scoreboard_new(scores, k);
+    counters_delete(scores);
+    return board;
+  }
+  postings_t scores;
+  for (int t = 0; t < numTerms; t++) {
+    for (int w = 0; w < terms[t].weight; w++) {
+      accum_add(accum, &terms[t].docs);
+    }
+  }
+  accum_scores(accum, &scores);
+  scoreboard_t* board = scoreboard_newPostings(&scores, k);
+  postings_release(&scores);
+  return board;
+}
+
+/**************** sameBoards ****************/
+/* Returns true if two boards rank the same documents with the same scores */
+static bool sameBoards(scoreboard_t* first, scoreboard_t* second)
+{
+  if (scoreboard_size(first) != scoreboard_size(second)) {
+    return false;
+  }
+  int id1, score1, id2, score2;
+  for (int i = 0; scoreboard_get(first, i, &id1, &score1); i++) {
+    if (!scoreboard_get(second, i, &id2, &score2) || id1 != id2 || score1 != score2) {
+      return false;
+    }
+  }
+  return true;
+}
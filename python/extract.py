@@ -1,5 +1,7 @@
 from bs4 import BeautifulSoup
 import subprocess
+import socket
+import json
 import re
 import requests
 import argparse
@@ -29,6 +31,23 @@ def query_loop(directory, indexFilepath):
 
     proc.stdin.close()
 
+def query_server(directory, socketPath):
+    conn = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    conn.connect(socketPath)
+    server = conn.makefile('rw')
+
+    for query in prompt():
+        server.write(query + '\n')
+        server.flush()
+        answer = json.loads(server.readline())
+        print("Search results: \n")
+        for result in answer.get("results", [])[:3]:
+            print(f'AI summary of {result["url"]}:')
+            print("\n".join(get_summary(directory + str(result["doc"])).split("\n")[1:]) + "\n")
+            time.sleep(2)
+
+    conn.close()
+
 def prompt():
     print("Query? ", end='', flush=True)
     for line in sys.stdin:
@@ -85,12 +104,18 @@ def get_structure(file) -> tuple[str,str]:
 def parseArgs():
     parser = argparse.ArgumentParser()
     parser.add_argument("directory", help="Directory containing html")
-    parser.add_argument("indexFilepath", help="Filepath to index")
+    parser.add_argument("indexFilepath", nargs="?", help="Filepath to index")
+    parser.add_argument("--socket", help="Socket of a running 'querier --serve' to query instead")
     return parser.parse_args()
 
 def main():
     args = parseArgs()
-    query_loop(args.directory, args.indexFilepath)
+    if args.socket:
+        query_server(args.directory, args.socket)
+    elif args.indexFilepath:
+        query_loop(args.directory, args.indexFilepath)
+    else:
+        sys.exit("Give an indexFilepath or a --socket")
     
 
 if __name__ == '__main__':